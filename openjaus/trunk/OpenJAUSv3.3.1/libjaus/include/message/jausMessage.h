@@ -249,6 +249,15 @@
 // Experimental Messages
 #define JAUS_SET_VELOCITY_STATE						0x0404
 #define JAUS_SET_MTT_LIGHTS						0xD000
+#define JAUS_REPORT_SYSTEM_TREE_CHANGE				0xD001	// OpenJAUS Node Manager to its local components, data is the system tree change count
+#define JAUS_LARGE_MESSAGE_NAK						0xD002	// OpenJAUS receiver of a large message set to its sender, data lists the missing packets
+// OpenJAUS large frames carry a whole message in one datagram between a component and its own Node Manager,
+// once they have agreed to use them. The frame header is followed by a JAUS header whose data size is 0, the
+// data size is the rest of the datagram.
+#define JAUS_LARGE_FRAME_HEADER						"OJLF01.0"
+#define JAUS_LARGE_FRAME_HEADER_SIZE_BYTES			8
+#define JAUS_LARGE_FRAME_MAX_DATA_SIZE_BYTES		65000	// Leaves room for both headers in a UDP datagram
+
 // Define JausMessage data structure
 struct JausMessageStruct
 {
@@ -292,6 +301,8 @@ struct JausMessageStruct
 	JausByte *data;
 	
 	struct JausMessageStruct *next;
+
+	void *owner;	// Message pool a received message goes back to, NULL for messages made any other way
 };
 
 typedef struct JausMessageStruct *JausMessage;
@@ -303,6 +314,14 @@ JAUS_EXPORT unsigned int jausMessageSize(JausMessage);
 
 JAUS_EXPORT JausBoolean jausMessageToBuffer(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes);
 JAUS_EXPORT JausBoolean jausMessageFromBuffer(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes);
+// Unpacks only the header, message->data is left alone for the caller to fill
+JAUS_EXPORT JausBoolean jausMessageHeaderFromBuffer(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes);
+JAUS_EXPORT unsigned int jausMessageLargeFrameSize(JausMessage message);
+JAUS_EXPORT JausBoolean jausMessageIsLargeFrame(unsigned char *buffer, unsigned int bufferSizeBytes);
+JAUS_EXPORT JausBoolean jausMessageToLargeFrame(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes);
+JAUS_EXPORT JausBoolean jausMessageFromLargeFrame(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes);
+JAUS_EXPORT unsigned int jausMessagePacketCount(JausMessage message);
+JAUS_EXPORT JausMessage jausMessagePacketCreate(JausMessage message, unsigned int index);
 JAUS_EXPORT char *jausMessageCommandCodeString(JausMessage);
 JAUS_EXPORT char *jausCommandCodeString(unsigned short commandCode);
 JAUS_EXPORT JausMessage jausMessageClone(JausMessage);
@@ -287,6 +287,7 @@ JausMessage activateServiceConnectionMessageToJausMessage(ActivateServiceConnect
 	jausMessage->dataSize = dataSize(message);
 	jausMessage->dataFlag = message->dataFlag;
 	jausMessage->sequenceNumber = message->sequenceNumber;
+	jausMessage->owner = NULL;
 	
 	jausMessage->data = (unsigned char *)malloc(jausMessage->dataSize);
 	jausMessage->dataSize = dataToBuffer(message, jausMessage->data, jausMessage->dataSize);
@@ -281,6 +281,7 @@ JausMessage clearEmergencyMessageToJausMessage(ClearEmergencyMessage message)
 	jausMessage->dataSize = dataSize(message);
 	jausMessage->dataFlag = message->dataFlag;
 	jausMessage->sequenceNumber = message->sequenceNumber;
+	jausMessage->owner = NULL;
 	
 	jausMessage->data = (unsigned char *)malloc(jausMessage->dataSize);
 	jausMessage->dataSize = dataToBuffer(message, jausMessage->data, jausMessage->dataSize);
@@ -312,6 +312,7 @@ JausMessage abortMissionMessageToJausMessage(AbortMissionMessage message)
   jausMessage->dataSize = dataSize(message);
   jausMessage->dataFlag = message->dataFlag;
   jausMessage->sequenceNumber = message->sequenceNumber;
+  jausMessage->owner = NULL;
   
   jausMessage->data = (unsigned char *)malloc(jausMessage->dataSize);
   jausMessage->dataSize = dataToBuffer(message, 
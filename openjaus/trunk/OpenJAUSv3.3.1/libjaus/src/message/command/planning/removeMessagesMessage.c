@@ -363,6 +363,7 @@ JausMessage removeMessagesMessageToJausMessage(RemoveMessagesMessage message)
   jausMessage->dataSize = dataSize(message);
   jausMessage->dataFlag = message->dataFlag;
   jausMessage->sequenceNumber = message->sequenceNumber;
+  jausMessage->owner = NULL;
   
   jausMessage->data = (unsigned char *)malloc(jausMessage->dataSize);
   jausMessage->dataSize = dataToBuffer(message,
@@ -282,6 +282,7 @@ JausMessage reportSelectedDataLinkStatusMessageToJausMessage(ReportSelectedDataL
 	jausMessage->dataSize = dataSize(message);
 	jausMessage->dataFlag = message->dataFlag;
 	jausMessage->sequenceNumber = message->sequenceNumber;
+	jausMessage->owner = NULL;
 	
 
 	jausMessage->data = (unsigned char *)malloc(jausMessage->dataSize);
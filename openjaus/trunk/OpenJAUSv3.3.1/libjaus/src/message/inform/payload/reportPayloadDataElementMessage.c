@@ -352,6 +352,7 @@ JausMessage reportPayloadDataElementMessageToJausMessage(ReportPayloadDataElemen
 	jausMessage->dataSize = dataSize(message);
 	jausMessage->dataFlag = message->dataFlag;
 	jausMessage->sequenceNumber = message->sequenceNumber;
+	jausMessage->owner = NULL;
 	
 	jausMessage->data = (unsigned char *)malloc(jausMessage->dataSize);	
 	jausMessage->dataSize = dataToBuffer(message, jausMessage->data, jausMessage->dataSize);
@@ -1026,6 +1026,7 @@ JausMessage reportPayloadInterfaceMessageToJausMessage(ReportPayloadInterfaceMes
 	jausMessage->dataSize = dataSize(message);
 	jausMessage->dataFlag = message->dataFlag;
 	jausMessage->sequenceNumber = message->sequenceNumber;
+	jausMessage->owner = NULL;
 	
 	jausMessage->data = (unsigned char *)malloc(jausMessage->dataSize);	
 	jausMessage->dataSize = dataToBuffer(message, jausMessage->data, jausMessage->dataSize);
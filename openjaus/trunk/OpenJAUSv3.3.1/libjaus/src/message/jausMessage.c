@@ -80,6 +80,7 @@ JausMessage jausMessageCreate(void)
 	message->sequenceNumber = 0;
 	
 	message->data = NULL;
+	message->owner = NULL;
 
 	return message;
 }
@@ -150,6 +151,119 @@ JausBoolean jausMessageFromBuffer(JausMessage message, unsigned char *buffer, un
 	}
 }
 
+JausBoolean jausMessageHeaderFromBuffer(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes)
+{
+	return headerFromBuffer(message, buffer, bufferSizeBytes);
+}
+
+unsigned int jausMessageLargeFrameSize(JausMessage message)
+{
+	return JAUS_LARGE_FRAME_HEADER_SIZE_BYTES + jausMessageSize(message);
+}
+
+JausBoolean jausMessageIsLargeFrame(unsigned char *buffer, unsigned int bufferSizeBytes)
+{
+	if(bufferSizeBytes >= JAUS_LARGE_FRAME_HEADER_SIZE_BYTES + JAUS_HEADER_SIZE_BYTES &&
+	   !memcmp(buffer, JAUS_LARGE_FRAME_HEADER, JAUS_LARGE_FRAME_HEADER_SIZE_BYTES))
+	{
+		return JAUS_TRUE;
+	}
+	return JAUS_FALSE;
+}
+
+JausBoolean jausMessageToLargeFrame(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes)
+{
+	struct JausMessageStruct header;
+
+	if(bufferSizeBytes < jausMessageLargeFrameSize(message) || message->dataSize > JAUS_LARGE_FRAME_MAX_DATA_SIZE_BYTES)
+	{
+		return JAUS_FALSE;
+	}
+
+	// The header data size field is only 12 bits wide, the frame length carries the size instead
+	header = *message;
+	header.dataSize = 0;
+	header.dataFlag = JAUS_SINGLE_DATA_PACKET;
+
+	memcpy(buffer, JAUS_LARGE_FRAME_HEADER, JAUS_LARGE_FRAME_HEADER_SIZE_BYTES);
+	if(!headerToBuffer(&header, buffer + JAUS_LARGE_FRAME_HEADER_SIZE_BYTES, bufferSizeBytes - JAUS_LARGE_FRAME_HEADER_SIZE_BYTES))
+	{
+		return JAUS_FALSE;
+	}
+	memcpy(buffer + JAUS_LARGE_FRAME_HEADER_SIZE_BYTES + JAUS_HEADER_SIZE_BYTES, message->data, message->dataSize);
+	return JAUS_TRUE;
+}
+
+// bufferSizeBytes must be the length of the received frame
+JausBoolean jausMessageFromLargeFrame(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes)
+{
+	if(!jausMessageIsLargeFrame(buffer, bufferSizeBytes) ||
+	   !headerFromBuffer(message, buffer + JAUS_LARGE_FRAME_HEADER_SIZE_BYTES, bufferSizeBytes - JAUS_LARGE_FRAME_HEADER_SIZE_BYTES))
+	{
+		return JAUS_FALSE;
+	}
+
+	message->dataSize = bufferSizeBytes - JAUS_LARGE_FRAME_HEADER_SIZE_BYTES - JAUS_HEADER_SIZE_BYTES;
+	message->dataFlag = JAUS_SINGLE_DATA_PACKET;
+	message->data = (unsigned char *) malloc(message->dataSize? message->dataSize : 1);
+	memcpy(message->data, buffer + JAUS_LARGE_FRAME_HEADER_SIZE_BYTES + JAUS_HEADER_SIZE_BYTES, message->dataSize);
+	return JAUS_TRUE;
+}
+
+// Number of standard packets a message is sent in
+unsigned int jausMessagePacketCount(JausMessage message)
+{
+	if(message->dataSize <= JAUS_MAX_DATA_SIZE_BYTES)
+	{
+		return 1;
+	}
+	return (message->dataSize + JAUS_MAX_DATA_SIZE_BYTES - 1) / JAUS_MAX_DATA_SIZE_BYTES;
+}
+
+// Creates standard packet index of a message which is larger than one packet. Packets are
+// numbered on from the message's sequence number, the first of the range its sender gave it.
+JausMessage jausMessagePacketCreate(JausMessage message, unsigned int index)
+{
+	JausMessage packet;
+	unsigned int packetCount = jausMessagePacketCount(message);
+	unsigned int offset = index * JAUS_MAX_DATA_SIZE_BYTES;
+
+	if(index >= packetCount)
+	{
+		return NULL;
+	}
+
+	packet = jausMessageCreate();
+	packet->properties = message->properties;
+	packet->commandCode = message->commandCode;
+	jausAddressCopy(packet->destination, message->destination);
+	jausAddressCopy(packet->source, message->source);
+	packet->sequenceNumber = (JausUnsignedShort)(message->sequenceNumber + index);
+	packet->dataSize = (message->dataSize - offset < JAUS_MAX_DATA_SIZE_BYTES)? message->dataSize - offset : JAUS_MAX_DATA_SIZE_BYTES;
+
+	if(packetCount == 1)
+	{
+		packet->dataFlag = message->dataFlag;
+		packet->sequenceNumber = message->sequenceNumber;
+	}
+	else if(index == 0)
+	{
+		packet->dataFlag = JAUS_FIRST_DATA_PACKET;
+	}
+	else if(index == packetCount - 1)
+	{
+		packet->dataFlag = JAUS_LAST_DATA_PACKET;
+	}
+	else
+	{
+		packet->dataFlag = JAUS_NORMAL_DATA_PACKET;
+	}
+
+	packet->data = (unsigned char *) malloc(packet->dataSize? packet->dataSize : 1);
+	memcpy(packet->data, message->data + offset, packet->dataSize);
+	return packet;
+}
+
 JausBoolean jausMessageIsRejectableCommand(JausMessage message)
 {
 	if(!message)
@@ -726,6 +840,7 @@ JausMessage jausMessageClone(JausMessage inputMessage)
 	outputMessage->sequenceNumber = inputMessage->sequenceNumber;
 
 	outputMessage->data = NULL;
+	outputMessage->owner = NULL;
 	if(inputMessage->dataSize)
 	{
 		outputMessage->data =  (unsigned char *)malloc(inputMessage->dataSize);
@@ -63,27 +63,133 @@ extern "C"
 
 #define OJ_CMPT_MAX_STATE_COUNT			32
 #define OJ_CMPT_MAX_INCOMING_SC_COUNT	32
+#define OJ_CMPT_MAX_TIMER_COUNT			32
+#define OJ_CMPT_MAX_QUERY_COUNT			256	// Queries awaiting a response at once
+#define OJ_CMPT_QUERY_HASH_BUCKETS		64
+#define OJ_CMPT_RT_HISTOGRAM_BINS		64
+#define OJ_CMPT_RT_HISTOGRAM_BIN_USEC	10	// Wakeup latency covered by each bin, the last one holds all beyond
 #define OJ_CMPT_MIN_FREQUENCY_HZ		0.1
 #define OJ_CMPT_MAX_FREQUENCY_HZ		1000.0
 #define OJ_CMPT_DEFAULT_FREQUENCY_HZ	1.0
+#define OJ_CMPT_RECEIVE_BATCH_SIZE		32	// Messages a component takes from the Node Manager Interface in one receive
+#define OJ_CMPT_EXECUTOR_MESSAGES_PER_TURN	32	// Messages a component handles before an executor worker moves on
+#define OJ_CMPT_MESSAGE_WORKER_QUEUE_SIZE	256	// Messages waiting for one message worker before the component waits for it
+#define OJ_CMPT_RATE_FILTER_GAIN		0.1	// Weight of the newest tick interval in the smoothed rate
 
 typedef struct OjCmptStruct *OjCmpt;
+typedef struct OjCmptExecutorStruct *OjCmptExecutor;
+
+// State callback timing, all times in seconds. Ticks are due at fixed multiples of the period from
+// the first one, a late tick does not move the ones after it.
+typedef struct
+{
+	unsigned int tickCount;				// State ticks run
+	unsigned int skippedTickCount;		// Deadlines which passed without a tick, dropped rather than run late in a burst
+	unsigned int overrunCount;			// Ticks whose callbacks ran past the next deadline
+	double lastJitterSec;				// How late the last tick started
+	double meanJitterSec;
+	double maxJitterSec;
+	double maxTickDurationSec;			// Longest run of the state callbacks
+	unsigned int messageCount;			// Messages processed, including service connection messages
+	unsigned int budgetExhaustedCount;	// Periods in which message processing used up its budget
+}OjCmptTimingStats;
+
+typedef struct
+{
+	unsigned int cycleCount;
+	unsigned int overrunCount;			// Cycles which ran past the next deadline
+	unsigned int skippedCycleCount;		// Deadlines dropped after an overrun
+	double maxLatencyUsec;				// Latest wakeup after a deadline
+	double maxCycleUsec;				// Longest run of the rt callback
+	JausBoolean isRealTime;				// The lane got SCHED_FIFO
+	JausBoolean isRunning;				// The lane is running, FALSE if it could not be started or has stopped
+	unsigned int latencyHistogram[OJ_CMPT_RT_HISTOGRAM_BINS];	// Wakeup latencies, OJ_CMPT_RT_HISTOGRAM_BIN_USEC per bin
+}OjCmptRtStats;
 
 JAUS_EXPORT OjCmpt ojCmptCreate(char *name, JausByte id, double frequency);
 JAUS_EXPORT void ojCmptDestroy(OjCmpt ojCmpt);
 JAUS_EXPORT int ojCmptRun(OjCmpt ojCmpt);
 
+// Executor: a fixed pool of worker threads shared by many components. Each component is run by
+// one worker at a time, whenever it has messages waiting or its state callbacks are due.
+// Components must be destroyed before the executor they run on; ojCmptExecutorDestroy returns -1
+// and leaves the executor running while any are still attached.
+JAUS_EXPORT OjCmptExecutor ojCmptExecutorCreate(int workerCount);
+JAUS_EXPORT int ojCmptExecutorDestroy(OjCmptExecutor executor);
+JAUS_EXPORT int ojCmptRunOnExecutor(OjCmpt ojCmpt, OjCmptExecutor executor);	// In place of ojCmptRun
+
 JAUS_EXPORT void ojCmptSetFrequencyHz(OjCmpt ojCmpt, double stateFrequencyHz);
+// Fraction of each state period which may be spent processing messages, those left over wait for the
+// tick. The default 1.0 processes messages right up to the tick; a tick due is always run first.
+JAUS_EXPORT void ojCmptSetMessageBudget(OjCmpt ojCmpt, double periodFraction);
+
+// Timers: callbacks run on the component's own thread (or executor worker) alongside the state
+// callbacks, each at its own rate. Periodic timers are due at fixed multiples of their period from
+// when they were added. These return a timer id, or -1 if all OJ_CMPT_MAX_TIMER_COUNT are in use.
+JAUS_EXPORT int ojCmptAddPeriodicTimer(OjCmpt ojCmpt, double frequencyHz, void (*timerFunction)(OjCmpt, void *), void *data);
+JAUS_EXPORT int ojCmptAddOneShotTimer(OjCmpt ojCmpt, double delaySec, void (*timerFunction)(OjCmpt, void *), void *data);
+JAUS_EXPORT int ojCmptRemoveTimer(OjCmpt ojCmpt, int timerId);	// A one-shot timer removes itself once run
+
+// Real-time lane: rtFunction runs at frequencyHz on a thread of its own, started by ojCmptRun or
+// ojCmptRunOnExecutor, with none of the message, service connection or state work. On Linux the thread
+// gets SCHED_FIFO at priority when that is above 0 and permitted, and is pinned to cpu when that is 0 or
+// more. rtFunction must not allocate, block or call the other ojCmpt functions; it exchanges fixed size
+// commands and reports with the component through the ojCmptRt mailbox calls below, which never block.
+// Each mailbox has one writer and one reader and keeps only the latest data. Call before running the
+// component; lock memory with mlockall in the application for the steadiest timing. ojCmptGetRtStats
+// may be called from any thread, its isRunning tells whether the lane started.
+JAUS_EXPORT int ojCmptSetRtCallback(OjCmpt ojCmpt, double frequencyHz, int priority, int cpu, size_t commandSize, size_t reportSize, void (*rtFunction)(OjCmpt));
+JAUS_EXPORT void ojCmptRtWriteCommand(OjCmpt ojCmpt, const void *command);	// Component side
+JAUS_EXPORT int ojCmptRtReadCommand(OjCmpt ojCmpt, void *command);		// rtFunction side, FALSE if nothing new was written
+JAUS_EXPORT void ojCmptRtWriteReport(OjCmpt ojCmpt, const void *report);		// rtFunction side
+JAUS_EXPORT int ojCmptRtReadReport(OjCmpt ojCmpt, void *report);			// Component side, FALSE if nothing new was written
+JAUS_EXPORT void ojCmptGetRtStats(OjCmpt ojCmpt, OjCmptRtStats *stats);
 JAUS_EXPORT void ojCmptSetState(OjCmpt ojCmpt, int state);
 
 JAUS_EXPORT int ojCmptSetStateCallback(OjCmpt ojCmpt, int state, void (*stateCallbackFunction)(OjCmpt));			// Calls method from stateHandler
 JAUS_EXPORT int ojCmptSetMainCallback(OjCmpt ojCmpt, void (*mainCallbackFunction)(OjCmpt));							// Calls method from stateHandler
 JAUS_EXPORT void ojCmptSetMessageCallback(OjCmpt ojCmpt, unsigned short commandCode, void (*messageFunction)(OjCmpt, JausMessage));	// Calls method from messageHandler
+JAUS_EXPORT void ojCmptSetDecodedMessageCallback(OjCmpt ojCmpt, unsigned short commandCode, void *(*fromJausMessage)(JausMessage), void (*destroy)(void *), void (*messageFunction)(OjCmpt, void *));
 JAUS_EXPORT void ojCmptSetMessageProcessorCallback(OjCmpt ojCmpt, void (*processMessageFunction)(OjCmpt, JausMessage));	// Calls method from messageHandler
+
+// Message workers: the message callbacks of command codes set parallel run on workerCount threads of the
+// component's own rather than on the component thread. Messages with the same source and command code go to
+// the same worker and are handled one at a time in the order received; the rest run alongside each other and
+// alongside the state, timer and query callbacks, so data they share must be locked, e.g. with
+// ojCmptLockUserData. Codes without a message callback, and query responses, are still handled on the component
+// thread. ojCmptWaitForMessageWorkers returns once every message handed to the workers so far has been handled;
+// it must not be called from a worker. Set the workers before running the component.
+JAUS_EXPORT JausBoolean ojCmptSetMessageWorkers(OjCmpt ojCmpt, int workerCount);
+JAUS_EXPORT void ojCmptSetParallelMessage(OjCmpt ojCmpt, unsigned short commandCode, JausBoolean isParallel);
+JAUS_EXPORT void ojCmptWaitForMessageWorkers(OjCmpt ojCmpt);
 JAUS_EXPORT void ojCmptSetUserData(OjCmpt ojCmpt, void *data);
+
+// Typed message callbacks: the library decodes the message once and hands the callback the decoded
+// message, which it destroys when the callback returns. Messages that fail to decode are dropped.
+// For a libjaus message type, OJ_CMPT_TYPED_MESSAGE defines once per file the functions which decode,
+// destroy and call with that type; a callback of any other type does not compile. E.g. for
+// void queryCallback(OjCmpt, QueryGlobalPoseMessage):
+//	OJ_CMPT_TYPED_MESSAGE(QueryGlobalPoseMessage, queryGlobalPoseMessage)
+//	...
+//	ojCmptSetTypedMessageCallback(cmpt, JAUS_QUERY_GLOBAL_POSE, queryGlobalPoseMessage, queryCallback);
+typedef void (*OjCmptTypedFunction)(void);
+JAUS_EXPORT void ojCmptSetTypedCallback(OjCmpt ojCmpt, unsigned short commandCode, void *(*fromJausMessage)(JausMessage), void (*destroy)(void *), void (*call)(OjCmptTypedFunction, OjCmpt, void *), OjCmptTypedFunction messageFunction);
+#define OJ_CMPT_TYPED_MESSAGE(MessageType, messageType) \
+	static void *messageType##OjCmptFromJausMessage(JausMessage message) { return (void *)messageType##FromJausMessage(message); } \
+	static void messageType##OjCmptDestroy(void *message) { messageType##Destroy((MessageType)message); } \
+	static void messageType##OjCmptCall(OjCmptTypedFunction function, OjCmpt ojCmpt, void *message) { ((void (*)(OjCmpt, MessageType))function)(ojCmpt, (MessageType)message); } \
+	static OjCmptTypedFunction messageType##OjCmptFunction(void (*function)(OjCmpt, MessageType)) { return (OjCmptTypedFunction)function; }
+#define ojCmptSetTypedMessageCallback(ojCmpt, commandCode, messageType, messageFunction) \
+	ojCmptSetTypedCallback(ojCmpt, commandCode, messageType##OjCmptFromJausMessage, messageType##OjCmptDestroy, messageType##OjCmptCall, messageType##OjCmptFunction(messageFunction))
 JAUS_EXPORT void ojCmptSetAuthority(OjCmpt ojCmpt, JausByte authority);
 
 JAUS_EXPORT int ojCmptSendMessage(OjCmpt ojCmpt, JausMessage message);
+// Sends query without waiting. The first message of responseCode from the query's destination (any
+// matching source for a broadcast destination) is handed to responseFunction instead of the message
+// callbacks; the message is destroyed when it returns. With no response in timeoutSec the query is
+// sent again, up to retryCount times, and then responseFunction is called with a NULL message.
+// Returns JAUS_FALSE without sending if OJ_CMPT_MAX_QUERY_COUNT queries are outstanding.
+JAUS_EXPORT JausBoolean ojCmptSendQuery(OjCmpt ojCmpt, JausMessage query, JausUnsignedShort responseCode, double timeoutSec, int retryCount, void (*responseFunction)(OjCmpt, JausMessage, void *), void *data);
 
 // Accessors
 JAUS_EXPORT JausByte ojCmptGetAuthority(OjCmpt ojCmpt);
@@ -97,6 +203,7 @@ JAUS_EXPORT void *ojCmptGetUserData(OjCmpt ojCmpt);
 JAUS_EXPORT void ojCmptUnlockUserData(OjCmpt ojCmpt);
 JAUS_EXPORT void ojCmptLockUserData(OjCmpt ojCmpt);
 JAUS_EXPORT double ojCmptGetRateHz(OjCmpt ojCmpt);
+JAUS_EXPORT void ojCmptGetTimingStats(OjCmpt ojCmpt, OjCmptTimingStats *stats);
 
 // Component Control
 JAUS_EXPORT JausBoolean ojCmptTerminateController(OjCmpt ojCmpt);
@@ -107,9 +214,11 @@ JAUS_EXPORT JausBoolean ojCmptAddServiceInputMessage(OjCmpt ojCmpt, JausUnsigned
 JAUS_EXPORT JausBoolean ojCmptAddServiceOutputMessage(OjCmpt ojCmpt, JausUnsignedShort serviceType, JausUnsignedShort commandCode, JausUnsignedInteger presenceVector);
 
 // Incoming Service Connections
+// qSize messages are queued at most, the oldest is dropped beyond it; 0 queues SC_DEFAULT_QUEUE_SIZE rather than without limit
 JAUS_EXPORT int ojCmptEstablishSc(OjCmpt ojCmpt, JausUnsignedShort cCode, JausUnsignedInteger pv, JausAddress address, double rateHz, double timeoutSec, int qSize);
 JAUS_EXPORT int ojCmptTerminateSc(OjCmpt ojCmpt, int scIndex);
 JAUS_EXPORT JausBoolean ojCmptIsIncomingScActive(OjCmpt ojCmpt, int scIndex);
+JAUS_EXPORT JausBoolean ojCmptGetIncomingScStats(OjCmpt ojCmpt, int scIndex, ServiceConnectionStats *stats);
 // OjCmpt add receive SC method
 
 // Outgoing Service Connections
@@ -117,7 +226,26 @@ JAUS_EXPORT void ojCmptAddSupportedSc(OjCmpt ojCmpt, unsigned short commandCode)
 JAUS_EXPORT void ojCmptRemoveSupportedSc(OjCmpt ojCmpt, unsigned short commandCode);	// Removes service connection support for this message
 JAUS_EXPORT ServiceConnection ojCmptGetScSendList(OjCmpt ojCmpt, unsigned short commandCode);
 JAUS_EXPORT void ojCmptDestroySendList(ServiceConnection scList);
+// Copies of every outgoing service connection of commandCode, with their stats in sc->stats
+JAUS_EXPORT ServiceConnection ojCmptGetScOutgoingList(OjCmpt ojCmpt, unsigned short commandCode);
+// Writes one line per incoming and outgoing service connection of the component's node manager interface
+JAUS_EXPORT int ojCmptScReportToString(OjCmpt ojCmpt, char *buffer, int bufferSize);
+// Sends to every due service connection of commandCode. encode returns the message for one presence
+// vector and is called once per distinct presence vector; returns the number of subscribers sent to.
+JAUS_EXPORT int ojCmptPublishSc(OjCmpt ojCmpt, unsigned short commandCode, JausMessage (*encode)(void *data, JausUnsignedInteger presenceVector), void *data);
 JAUS_EXPORT JausBoolean ojCmptIsOutgoingScActive(OjCmpt ojCmpt, unsigned short commandCode);
+JAUS_EXPORT void ojCmptSetScMessageSize(OjCmpt ojCmpt, unsigned short commandCode, unsigned int sizeBytes);	// Estimated size used by the bandwidth budgets
+JAUS_EXPORT void ojCmptSetScLimits(OjCmpt ojCmpt, double producerRateHz, double producerBandwidthBytesPerSec, double clientRateHz, double clientBandwidthBytesPerSec);	// 0 = unlimited
+
+// Events
+// Accepts Create Event for this report message. fieldValue gives the value of a report field from the data passed to
+// ojCmptPublishEvents, returning JAUS_FALSE if the field is not available; it is called with the event manager locked.
+// A NULL fieldValue only allows events which do not test a field.
+JAUS_EXPORT void ojCmptAddSupportedEvent(OjCmpt ojCmpt, unsigned short commandCode, JausBoolean (*fieldValue)(void *data, JausByte field, double *value));
+JAUS_EXPORT void ojCmptRemoveSupportedEvent(OjCmpt ojCmpt, unsigned short commandCode);	// Also removes the events created on it
+// Tests the events of commandCode against data and sends an Event message for each one which triggers. encode is
+// called as for ojCmptPublishSc, once per distinct presence vector; returns the number of events sent.
+JAUS_EXPORT int ojCmptPublishEvents(OjCmpt ojCmpt, unsigned short commandCode, JausMessage (*encode)(void *data, JausUnsignedInteger presenceVector), void *data);
 
 // System Discovery
 JAUS_EXPORT JausBoolean ojCmptLookupAddress(OjCmpt ojCmpt, JausAddress address);
@@ -122,6 +122,8 @@ private:
 	bool eventId[255];
 	SystemTree *systemTree;
 	bool nodeManagerSubsystemEventConfirmed;
+	double nextHeartbeatTime;
+	double nextQueryTime;
 };
 
 #endif
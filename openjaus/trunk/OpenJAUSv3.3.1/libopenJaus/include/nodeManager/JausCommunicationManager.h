@@ -60,6 +60,14 @@
 #include "SystemTree.h"
 #include "EventHandler.h"
 
+// Flow control state of the interface(s) a message would be queued on
+typedef struct JausFlowControlStatus
+{
+	unsigned long freeSpace;
+	unsigned long dropCount;
+	bool congested;
+}JausFlowControlStatus;
+
 class JausCommunicationManager
 {
 public:
@@ -79,10 +87,18 @@ public:
 	MessageRouter *getMessageRouter();
 	virtual bool startInterfaces(void) = 0;
 
+	void mergeFlowControlStatus(JausFlowControlStatus *status);
+	void mergeFlowControlStatus(int interfaceKey, JausFlowControlStatus *status);
+
 protected:
+	// interfaceMap is learned on the transport threads and read on the routing threads
+	void setInterfaceRoute(int interfaceKey, JausTransportInterface *jtInterface);
+	JausTransportInterface *getInterfaceRoute(int interfaceKey);
+
 	MessageRouter *msgRouter;
 	std::vector <JausTransportInterface *> interfaces;
 	HASH_MAP<int, JausTransportInterface *> interfaceMap;
+	pthread_mutex_t interfaceMapMutex;
 	FileLoader *configData;
 	SystemTree *systemTree;
 	EventHandler *eventHandler;
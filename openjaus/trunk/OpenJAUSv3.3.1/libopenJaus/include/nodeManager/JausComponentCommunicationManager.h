@@ -44,6 +44,7 @@
 #ifndef JAUS_CMPT_COMMS_MNGR_H
 #define JAUS_CMPT_COMMS_MNGR_H
 
+#include <set>
 #include "JausCommunicationManager.h"
 #include "SystemTree.h"
 #include "NodeManagerComponent.h"
@@ -62,8 +63,26 @@ public:
 	bool stopInterfaces(void);
 
 	NodeManagerComponent *getNodeManagerComponent(void);
+
+	// Local components which checked in through the OpenJAUS node manager interface
+	void checkInOpenJausComponent(int addressHash);
+	void checkOutOpenJausComponent(int addressHash);
+	bool sendToOpenJausComponents(JausMessage message);
+
+	// Large frames (see jausMessage.h) between local components and this Node Manager
+	unsigned int getLargeFrameSizeBytes(void);
+	unsigned int grantLargeFrames(int addressHash, unsigned int requestedSizeBytes);
+	void revokeLargeFrames(int addressHash);
+	bool acceptsLargeFrames(int addressHash);
 	
 private:
+	unsigned int largeFrameSizeBytes;		// Largest data size of a large frame, 0 if they are disabled
+	std::set <int> largeFrameComponents;	// Components which asked for large frames, by address hash
+	pthread_mutex_t largeFrameMutex;
+
+	std::set <int> openJausComponents;		// By address hash
+	pthread_mutex_t openJausComponentMutex;
+
 	OjUdpComponentInterface *udpCmptInf;
 	NodeManagerComponent *nodeManagerCmpt;
 	CommunicatorComponent *communicatorCmpt;
@@ -103,6 +103,7 @@ public:
 	InetAddress getInetAddress(void);
 
 	bool processMessage(JausMessage message);
+	unsigned int getMaxDataSizeBytes(void);
 
 	bool startInterface();
 	bool stopInterface();
@@ -124,7 +125,8 @@ private:
 	pthread_t recvThread;
 	pthread_attr_t recvThreadAttr;
 
-	void sendJausMessage(OpcUdpTransportData data, JausMessage message);
+	void sendJausMessage(OpcUdpTransportData data, JausMessage message, bool largeFrame = false);
+	bool acceptsLargeFrames(int addressHash);
 	void startRecvThread();
 	void stopRecvThread();
 
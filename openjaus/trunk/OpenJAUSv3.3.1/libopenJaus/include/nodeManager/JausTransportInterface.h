@@ -79,7 +79,14 @@ public:
 
 	JausTransportType getType(void);
 	unsigned long queueSize();
-	void queueJausMessage(JausMessage message);
+	bool queueJausMessage(JausMessage message);
+	virtual unsigned int getMaxDataSizeBytes(void);
+
+	// Flow control
+	void setQueueMaxSize(unsigned long maxSize);
+	unsigned long queueFreeSpace();
+	unsigned long queueDropCount();
+	bool isCongested();
 
 	virtual bool startInterface(void) = 0;
 	virtual bool stopInterface(void) = 0;
@@ -90,6 +97,7 @@ public:
 protected:
 	void startThread();
 	void wakeThread();
+	void configureQueue();
 
 	EventHandler *eventHandler;
 	std::string name;
@@ -48,21 +48,39 @@
 #include "jaus.h"
 #include "pthread.h"
 
+#define JAUS_TRANSPORT_QUEUE_DEFAULT_MAX_SIZE	1024 // Messages, 0 is unbounded
+#define JAUS_TRANSPORT_QUEUE_HIGH_WATERMARK		0.75 // Fraction of maxSize at which the queue becomes congested
+#define JAUS_TRANSPORT_QUEUE_LOW_WATERMARK		0.25 // Fraction of maxSize at which the queue is no longer congested
+
 class JausTransportQueue
 {
 public:
 	JausTransportQueue(void);
 	~JausTransportQueue(void);
 
-	void push(JausMessage inc);
+	bool push(JausMessage inc);
 	JausMessage pop(void);
 	bool isEmpty(void);
 	unsigned long size(void);
 	void emptyQueue(void);
 
+	void setMaxSize(unsigned long maxSize);
+	unsigned long getMaxSize(void);
+	unsigned long getFreeSpace(void);
+	unsigned long getDropCount(void);
+	bool isCongested(void);
+
 private:
 	std::queue <JausMessage> list;
 	pthread_mutex_t mutex;
+
+	unsigned long maxSize;
+	unsigned long highWatermark;
+	unsigned long lowWatermark;
+	unsigned long dropCount;
+	bool congested;
+
+	void updateCongestion(void);
 };
 
 #endif
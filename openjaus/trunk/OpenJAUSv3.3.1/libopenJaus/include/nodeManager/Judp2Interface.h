@@ -140,6 +140,7 @@ private:
 
 	bool multicast;
 	InetAddress hostIpAddress;
+	unsigned short hostPort;
 	InetAddress ipAddress;
 	InetAddress multicastGroup;
 	unsigned short portNumber;
@@ -56,6 +56,7 @@
 	#define HASH_MAP __gnu_cxx::hash_map
 #endif
 
+#include <vector>
 #include "JausTransportInterface.h"
 #include "utils/multicastSocket.h"
 #include "utils/inetAddress.h"
@@ -82,18 +83,21 @@
 #define JUDP_DEFAULT_COMPONENT_UDP_TIMEOUT_SEC		1.0f
 #define JUDP_DEFAULT_COMPONENT_MULTICAST			false
 #define JUDP_DEFAULT_COMPONENT_HEADER_COMPRESSION	false
+#define JUDP_DEFAULT_COMPONENT_PEER_TIMEOUT_SEC		0.0 // Off, a component which only receives sends nothing to refresh its entry
 
 // Node UDP Interface Default Values
 #define JUDP_DEFAULT_NODE_TTL						16 // per AS5669
 #define JUDP_DEFAULT_NODE_UDP_TIMEOUT_SEC			1.0f
 #define JUDP_DEFAULT_NODE_MULTICAST					true
 #define JUDP_DEFAULT_NODE_HEADER_COMPRESSION		false
+#define JUDP_DEFAULT_NODE_PEER_TIMEOUT_SEC			10.0
 
 // Subsystem UDP Interface Default Values
 #define JUDP_DEFAULT_SUBSYSTEM_TTL					16 // per AS5669
 #define JUDP_DEFAULT_SUBSYSTEM_UDP_TIMEOUT_SEC		1.0f
 #define JUDP_DEFAULT_SUBSYSTEM_MULTICAST			true
 #define JUDP_DEFAULT_SUBSYSTEM_HEADER_COMPRESSION	false
+#define JUDP_DEFAULT_SUBSYSTEM_PEER_TIMEOUT_SEC		10.0
 
 static const std::string JUDP_DEFAULT_COMPONENT_IP = "127.0.0.1"; // Per OpenJAUS Node Manager Interface document
 static const std::string JUDP_DEFAULT_SUBSYSTEM_MULTICAST_GROUP = "224.1.0.1"; // per AS5669
@@ -106,6 +110,7 @@ typedef struct
 {
 	unsigned int addressValue;
 	unsigned short port;
+	double lastSeenTime; // Time a packet was last received from this address, 0 if never
 }JudpTransportData;
 
 typedef struct
@@ -148,6 +153,13 @@ private:
 	pthread_attr_t recvThreadAttr;
 
 	void sendJausMessage(JudpTransportData data, JausMessage message);
+	void sendToAllPeers(JausMessage message);
+	bool findPeer(int key, JudpTransportData *data);
+	void updatePeer(int key, JudpTransportData data);
+	void evictDeadPeers(void);
+	bool isPeerAlive(JudpTransportData *data, double now);
+	bool readStaticPeers(std::string section);
+	bool isStaticPeer(unsigned int addressValue, unsigned short port);
 	void startRecvThread();
 	void stopRecvThread();
 
@@ -159,7 +171,12 @@ private:
 	bool receiveCompressedMessage(JausMessage rxMessage, JudpHeaderCompressionData *hcData, unsigned char *buffer, unsigned int bufferSizeBytes);
 
 
+	// addressMap and the subsystem gateway are learned on the receive thread and read on the send thread
 	HASH_MAP <int, JudpTransportData> addressMap;
+	pthread_rwlock_t addressMapLock;
+	double peerTimeoutSec;
+	double nextEvictionTime;
+	std::vector <JudpTransportData> staticPeers;
 	bool subsystemGatewayDiscovered;
 	JudpTransportData subsystemGatewayData;
 	JudpTransportData multicastData;
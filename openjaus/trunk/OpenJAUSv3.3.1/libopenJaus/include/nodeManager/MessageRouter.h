@@ -44,28 +44,39 @@
 #ifndef MESSAGE_ROUTER_H
 #define MESSAGE_ROUTER_H
 
+#include <vector>
 #include "EventHandler.h"
 #include "SystemTree.h"
 #include "utils/FileLoader.h"
 #include "jaus.h"
 
+#define MESSAGE_ROUTER_DEFAULT_THREADS		0		// Route on the receiving thread
+#define MESSAGE_ROUTER_MAXIMUM_THREADS		32
+
 class JausSubsystemCommunicationManager;
 class JausNodeCommunicationManager;
 class JausComponentCommunicationManager;
+class MessageRouterWorker;
+struct JausFlowControlStatus;
 
 class MessageRouter
 {
 public:
+	enum MessageSource {SubsystemSource, NodeSource, ComponentSource};
+
 	MessageRouter(FileLoader *configData, SystemTree *systemTree, EventHandler *eventHandler);
 	~MessageRouter(void);
 	bool routeSubsystemSourceMessage(JausMessage message);
 	bool routeNodeSourceMessage(JausMessage message);
 	bool routeComponentSourceMessage(JausMessage message);
+	bool processJausMessage(JausMessage message, int source);
 
 	bool subsystemCommunicationEnabled();
 	bool nodeCommunicationEnabled();
 	bool componentCommunicationEnabled();
 
+	bool getFlowControlStatus(JausAddress destination, JausFlowControlStatus *status);
+
 private:
 	FileLoader *configData;
 	JausSubsystemCommunicationManager *subsComms;
@@ -74,9 +85,17 @@ private:
 	SystemTree *systemTree;
 	EventHandler *eventHandler;
 
+	std::vector <MessageRouterWorker *> workers;
+
 	unsigned short mySubsystemId;
 	unsigned short myNodeId;
 	bool sendToCommunicator(JausMessage message);
+	bool queueToWorker(JausMessage message, int source);
+	void startWorkers(void);
+	void stopWorkers(void);
+	bool processSubsystemSourceMessage(JausMessage message);
+	bool processNodeSourceMessage(JausMessage message);
+	bool processComponentSourceMessage(JausMessage message);
 };
 
 #endif
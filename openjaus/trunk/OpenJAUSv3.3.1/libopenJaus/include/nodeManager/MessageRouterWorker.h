@@ -0,0 +1,84 @@
+/*****************************************************************************
+ *  Copyright (c) 2008, University of Florida
+ *  All rights reserved.
+ *
+ *  This file is part of OpenJAUS.  OpenJAUS is distributed under the BSD
+ *  license.  See the LICENSE file for details.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of the University of Florida nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+// File Name: MessageRouterWorker.h
+//
+// Version: 3.3.0
+//
+// Date: 07/09/08
+//
+// Description: A routing thread of the MessageRouter. Messages are sharded over the workers by
+// destination address, so each worker sees the messages for its destinations in arrival order.
+
+#ifndef MESSAGE_ROUTER_WORKER_H
+#define MESSAGE_ROUTER_WORKER_H
+
+#include <queue>
+#include "jaus.h"
+#include "pthread.h"
+
+class MessageRouter;
+
+class MessageRouterWorker
+{
+public:
+	MessageRouterWorker(MessageRouter *router, unsigned long maxQueueSize);
+	~MessageRouterWorker(void);
+
+	void startThread(void);
+	void stopThread(void);
+	bool queueJausMessage(JausMessage message, int source);
+	unsigned long queueSize(void);
+	unsigned long queueDropCount(void);
+
+	void run(void);
+
+private:
+	typedef struct
+	{
+		JausMessage message;
+		int source;
+	}RoutingJob;
+
+	MessageRouter *router;
+	std::queue <RoutingJob> jobs;
+	unsigned long maxQueueSize;
+	unsigned long dropCount;
+	bool running;
+
+	pthread_t pThread;
+	pthread_mutex_t threadMutex;
+	pthread_cond_t threadConditional;
+};
+
+#endif
@@ -62,6 +62,8 @@ class SystemTree;
 #define NM_RATE_HZ			5
 #define MAXIMUM_EVENT_ID	255
 #define REFRESH_TIME_SEC	1
+#define TREE_NOTICE_TIME_SEC		1.0	// Spacing of the repeats of a system tree change notice
+#define TREE_NOTICE_REPEAT_COUNT	2	// Repeats sent after a change, so a lost notice is recovered
 
 class NodeManagerComponent : public LocalComponent, EventHandler
 {
@@ -103,6 +105,7 @@ private:
 	void sendNodeChangedEvents();
 	void sendSubsystemChangedEvents();
 	void generateHeartbeats();
+	void generateSystemTreeNotices();
 	bool setupJausServices();
 
 	void sendNodeShutdownEvents();
@@ -131,6 +134,11 @@ private:
 	HASH_MAP <int, JausAddress> subsystemChangeList;
 	bool eventId[255];
 	SystemTree *systemTree;
+	double nextHeartbeatTime;
+	double nextRefreshTime;
+	double nextTreeNoticeTime;
+	int treeNoticeRepeatCount;
+	unsigned int noticedTreeChangeCount;
 };
 
 #endif
@@ -63,6 +63,14 @@
 #define OJ_UDP_INTERFACE_MESSAGE_SIZE_BYTES	8
 #define OJ_UDP_DEFAULT_PORT					24627 // Per OJ Nodemanager Interface Document
 #define OJ_UDP_DEFAULT_TIMEOUT				1.0f
+#define OJ_UDP_PAGE_HEADER_SIZE_BYTES		12
+#define OJ_UDP_DIRECTORY_PAGE_SIZE_BYTES	4096 // Directory data carried by each SYSTEM_DIRECTORY_RESPONSE
+#define OJ_UDP_ADDRESS_LIST_PAGE_SIZE		1024 // Addresses carried by each ADDRESS_LIST_RESPONSE
+#define OJ_UDP_VERIFY_LIST_HEADER_SIZE_BYTES	4
+#define OJ_UDP_VERIFY_LIST_MAX_ADDRESSES	256	 // Addresses one VERIFY_ADDRESS_LIST may carry
+#define OJ_UDP_ANY_SERVICE_TYPE				0xFF // GET_ADDRESS_LIST without a service filter
+#define OJ_UDP_INTERFACE_MAX_REQUEST_SIZE_BYTES	(OJ_UDP_VERIFY_LIST_HEADER_SIZE_BYTES + 4 * OJ_UDP_VERIFY_LIST_MAX_ADDRESSES)
+#define OJ_UDP_INTERFACE_MAX_REPLY_SIZE_BYTES	(OJ_UDP_PAGE_HEADER_SIZE_BYTES + OJ_UDP_DIRECTORY_PAGE_SIZE_BYTES)
 
 static const std::string OJ_UDP_DEFAULT_COMPONENT_IP = "127.0.0.1"; // Per OJ Nodemanager Interface Document
 
@@ -86,12 +94,20 @@ private:
 	unsigned short portNumber;
 	HASH_MAP<int, unsigned short> portMap;
 
+	std::vector <unsigned char> directory;	// Serialized system tree, rebuilt when the tree changes
+	unsigned int directoryChangeCount;
+	bool directoryValid;
+
 	bool sendDatagramPacket(DatagramPacket dgPacket);
 	bool openSocket(void);
 	void closeSocket(void);
 	void run();
 
 	bool processOjNodemanagerInterfaceMessage(char *buffer);
+	void sendDirectoryPage(DatagramPacket request, DatagramPacket reply);
+	void sendAddressListPage(DatagramPacket request, int requestSize, DatagramPacket reply);
+	void sendAddressListVerified(DatagramPacket request, int requestSize, DatagramPacket reply);
+	void sendReply(DatagramPacket request, DatagramPacket reply, unsigned int replySize);
 
 	// Message type codes
 	enum
@@ -110,7 +126,17 @@ private:
 		LOOKUP_SERVICE_ADDRESS_LIST				= 0x0C,
 		LOOKUP_SERVICE_ADDRESS_LIST_RESPONSE	= 0x0D,
 		READY_CHECK								= 0x0E,
-		REPORT_READY							= 0x0F
+		REPORT_READY							= 0x0F,
+		QUERY_FLOW_CONTROL						= 0x10,
+		REPORT_FLOW_CONTROL						= 0x11,
+		GET_SYSTEM_DIRECTORY					= 0x12,
+		SYSTEM_DIRECTORY_RESPONSE				= 0x13,
+		GET_ADDRESS_LIST						= 0x14,
+		ADDRESS_LIST_RESPONSE					= 0x15,
+		VERIFY_ADDRESS_LIST						= 0x16,
+		ADDRESS_LIST_VERIFIED					= 0x17,
+		REQUEST_LARGE_FRAMES					= 0x18,
+		LARGE_FRAMES_GRANTED					= 0x19
 	};
 };
 
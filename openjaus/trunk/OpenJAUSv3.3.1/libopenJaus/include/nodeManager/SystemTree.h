@@ -45,10 +45,14 @@
 #define SYSTEM_TREE_H
 
 #include <list>
+#include <vector>
+#include "pthread.h"
 #include "utils/FileLoader.h"
 #include "EventHandler.h"
 #include "jaus.h"
 
+// Safe to use from several threads: lookups share the tree and changes have it to themselves. Events
+// of a change are sent once it is done, so handlers may use the tree.
 class SystemTree
 {
 public:
@@ -157,8 +161,6 @@ public:
 	JausAddress lookUpAddress(JausAddress address);
 	JausAddress lookUpAddress(int lookupSubs, int lookupNode, int lookupCmpt, int lookupInst);
 	JausAddress lookUpAddress2(int lookupSubs, int lookupNode, int lookupCmpt, int lookupInst);
-	JausAddress lookUpAddressInNode(JausNode node, int lookupCmpt, int lookupInst);
-	JausAddress lookUpAddressInSubsystem(JausSubsystem subs, int lookupNode, int lookupCmpt, int lookupInst);
 	
 	JausAddress lookUpServiceInNode(int nodeId, int commandCode, int serviceType);
 	JausAddress lookUpServiceInNode(JausNode node, int commandCode, int serviceType);
@@ -166,6 +168,7 @@ public:
 	JausAddress lookUpServiceInSubsystem(JausSubsystem subs, int commandCode, int serviceType);
 	JausAddress lookUpServiceInSystem(int commandCode, int serviceType);
 	JausAddress lookUpService(JausAddress address, int commandCode, int serviceType);
+	JausAddress lookUpAddressList(JausAddress address, int commandCode, int serviceType);
 
 	unsigned char getNextInstanceId(JausAddress address);
 	bool registerEventHandler(EventHandler *handler);
@@ -174,6 +177,9 @@ public:
 	std::string toDetailedString();
 	void refresh();
 
+	unsigned int getChangeCount(void);
+	void getDirectory(std::vector <unsigned char> &directory);
+
 private:
 	FileLoader *configData;
 	std::list <EventHandler *> eventHandlers;
@@ -181,6 +187,24 @@ private:
 	int subsystemCount;
 	int mySubsystemId;
 	int myNodeId;
+	unsigned int changeCount;		// Incremented on every change to the components or their services
+	pthread_rwlock_t treeLock;		// Read for lookups, written for changes, the members below are called with it held
+	pthread_mutex_t eventMutex;
+	std::list <NodeManagerEvent *> pendingEvents;	// Events of changes, sent once treeLock is released
+
+	JausAddress findAddress(int lookupSubs, int lookupNode, int lookupCmpt, int lookupInst);
+	JausAddress findAddressInNode(JausNode node, int lookupCmpt, int lookupInst);
+	JausAddress findAddressInSubsystem(JausSubsystem subs, int lookupNode, int lookupCmpt, int lookupInst);
+	JausAddress findAddressList(JausAddress address, int commandCode, int serviceType);
+
+	bool insertSubsystem(int subsId, JausSubsystem subs);
+	bool insertNode(int subsId, int nodeId, JausNode node);
+	bool insertComponent(int subsId, int nodeId, int cmptId, int instId, JausComponent cmpt);
+	bool eraseSubsystem(int subsId);
+	bool eraseNode(int subsId, int nodeId);
+	bool eraseComponent(int subsId, int nodeId, int cmptId, int instId);
+	bool exchangeSubsystem(int subsId, JausSubsystem newSubs);
+	bool exchangeNode(int subsId, int nodeId, JausNode newNode);
 
 	JausNode findNode(JausNode node);
 	JausNode findNode(JausAddress address);
@@ -189,7 +213,9 @@ private:
 	JausComponent findComponent(JausComponent cmpt);
 	JausComponent findComponent(JausAddress address);
 	JausComponent findComponent(int subsId, int nodeId, int cmptId, int instId);
+	bool componentHasCommand(JausComponent cmpt, int commandCode, int serviceType);
 	void handleEvent(NodeManagerEvent *e);
+	void sendEvents(void);		// Called without treeLock
 };
 
 #endif
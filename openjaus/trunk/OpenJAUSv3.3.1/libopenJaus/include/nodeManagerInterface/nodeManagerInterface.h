@@ -37,6 +37,7 @@
 #include "utils/datagramSocket.h"
 #include "utils/inetAddress.h"
 #include "utils/queue.h"
+#include "utils/ringQueue.h"
 #include "utils/timeLib.h"
 #include <jaus.h>
 #include <pthread.h>
@@ -54,6 +55,20 @@
 #define	NMI_RECEIVE_TIMED_OUT		2
 #define NMI_CONDITIONAL_WAIT_ERROR	3
 #define NMI_CLOSED_ERROR			4
+#define NMI_SEND_CONGESTED_ERROR	5
+
+#define NMI_RECEIVE_QUEUE_CAPACITY	1024
+#define NMI_MESSAGE_POOL_CAPACITY	256		// Received messages kept for reuse
+#define NMI_MESSAGE_POOL_PREALLOCATED	32		// Allocated when the interface opens
+
+// Flow control modes, see nodeManagerSetFlowControl
+#define NMI_FLOW_CONTROL_OFF		0	// Send unconditionally (default)
+#define NMI_FLOW_CONTROL_ERROR		1	// nodeManagerSend returns NMI_SEND_CONGESTED_ERROR if the destination link is congested
+#define NMI_FLOW_CONTROL_BLOCK		2	// nodeManagerSend waits up to the flow control timeout for the link to clear
+// A message needing more packets than the link's whole credit is sent once the link is found idle, reporting
+// its most credits twice in a row
+
+#define NMI_FLOW_CONTROL_CREDIT_CACHE_SIZE	16
 
 #ifdef __cplusplus
 extern "C"
@@ -65,6 +80,23 @@ extern "C"
 #define SC_ERROR_SERVICE_CONNECTION_QUEUE_EMPTY		-1
 #define SC_ERROR_SERVICE_CONNECTION_DOES_NOT_EXIST	-2
 
+#define SC_MANAGER_HASH_BUCKETS						64
+#define SC_DEFAULT_QUEUE_SIZE						256
+
+// Kept on both ends of a service connection. The sequence counts are only kept on the incoming end.
+typedef struct
+{
+	unsigned int messageCount;			// Sent on an outgoing sc, received on an incoming one
+	unsigned int lostCount;				// Missing from the sequence numbers received
+	unsigned int reorderedCount;		// Received after a later message, these are not counted lost
+	unsigned int duplicateCount;		// Received with the sequence number of the message before
+	unsigned int overflowCount;			// Dropped because the queue of queueSize messages was full
+	double rateHz;						// Achieved rate, smoothed
+	double jitterSec;					// Smoothed deviation of the time between messages from its mean
+	double lastMessageTime;				// ojGetTimeSec of the last message, 0 before the first
+	double ageSec;						// Age of the last message when the stats were taken
+}ServiceConnectionStats;
+
 typedef struct ServiceConnectionStruct
 {
 	double requestedUpdateRateHz;
@@ -80,11 +112,24 @@ typedef struct ServiceConnectionStruct
 
 	int instanceId;
 	JausBoolean isActive;
+	JausBoolean isReady;		// On the manager's ready list
+	JausBoolean isSequenced;	// sequenceNumber holds a received message's, since the sc was confirmed
+
+	ServiceConnectionStats stats;
+	double intervalSec;			// Smoothed time between messages
+
+	RingQueue queue;			// Created when the sc is requested, holding queueSize messages
+	unsigned int queueSize;		// 0 for SC_DEFAULT_QUEUE_SIZE, the oldest message is dropped beyond it.
+								// The queue is always bounded, 0 no longer means unlimited
 
-	Queue queue;
-	unsigned int queueSize;
+	JausBoolean isAdmitted;		// An outgoing sc counted in the admission totals, with the rate and bandwidth below
+	double admittedRateHz;
+	double admittedBandwidth;
 
 	struct ServiceConnectionStruct *nextSc;
+	struct ServiceConnectionStruct *prevSc;			// Lists are doubly linked, so an sc found through the index is removed directly
+	struct ServiceConnectionStruct *nextIndexedSc;	// Chain of the manager's index bucket
+	struct ServiceConnectionStruct *nextReadySc;	// Chain of the manager's ready list
 }ServiceConnectionStruct;
 
 typedef ServiceConnectionStruct *ServiceConnection;
@@ -92,62 +137,344 @@ typedef ServiceConnectionStruct *ServiceConnection;
 typedef struct SupportedScMessageStruct
 {
 	unsigned short commandCode;
+	unsigned int messageSizeBytes;	// Estimated encoded size, used for the bandwidth budgets
 	ServiceConnection scList;
 	struct SupportedScMessageStruct *nextSupportedScMsg;
+	struct SupportedScMessageStruct *nextIndexedScMsg;	// Chain of the manager's index bucket
 }SupportedScMessageStruct;
 
 typedef SupportedScMessageStruct *SupportedScMessage;
 
+typedef struct
+{
+	double producerRateHz;				// Sum of the confirmed rates of all outgoing service connections (0 = unlimited)
+	double producerBandwidthBytesPerSec;	// Sum of rate * message size of all outgoing service connections (0 = unlimited)
+	double clientRateHz;				// Sum of the confirmed rates granted to one client component (0 = unlimited)
+	double clientBandwidthBytesPerSec;	// Sum of rate * message size granted to one client component (0 = unlimited)
+}ServiceConnectionLimits;
+
+typedef struct
+{
+	unsigned int grantedCount;			// Create and activate requests confirmed at the requested rate
+	unsigned int downgradedCount;		// Create and activate requests confirmed at a reduced rate
+	unsigned int deniedCount;			// Create and activate requests refused because a budget was exhausted
+	double grantedRateHz;				// Current sum of confirmed rates
+	double grantedBandwidthBytesPerSec;	// Current sum of confirmed bandwidth
+}ServiceConnectionAdmissionStats;
+
+// Admission totals of the active outgoing scs of one client component
+typedef struct ScClientStruct
+{
+	JausAddress address;
+	int scCount;
+	double rateHz;
+	double bandwidth;
+	struct ScClientStruct *nextClient;	// Chain of the manager's client index bucket
+}ScClientStruct;
+
+typedef ScClientStruct *ScClient;
+
 typedef struct
 {
 	SupportedScMessage supportedScMsgList;
 	ServiceConnection incomingSc;
+	SupportedScMessage supportedScMsgIndex[SC_MANAGER_HASH_BUCKETS];	// By command code
+	ServiceConnection outgoingScIndex[SC_MANAGER_HASH_BUCKETS];		// By command code and subscriber address, so one subscriber's instances share a bucket
+	ServiceConnection incomingScIndex[SC_MANAGER_HASH_BUCKETS];		// By command code and producer address, which is all an incoming sc message carries
+	ServiceConnection readyScHead;		// Incoming scs with queued messages, in the order they became ready
+	ServiceConnection readyScTail;
 	int supportedScMsgCount;
 	int outgoingScCount;
 	int incomingScCount;
+	ServiceConnectionLimits limits;
+	ServiceConnectionAdmissionStats admissionStats;	// Rate and bandwidth sums kept up to date as scs are admitted
+	int admittedScCount;
+	ScClient clientIndex[SC_MANAGER_HASH_BUCKETS];	// By client address
 	pthread_mutex_t mutex;
 }ServiceConnectionManagerStruct;
 
 typedef ServiceConnectionManagerStruct *ServiceConnectionManager;
 
+#define EVENT_MANAGER_HASH_BUCKETS					64
+#define EVENT_MANAGER_MAX_EVENTS					256		// Event ids are a byte
+
+// One event created by a client with Create Event. Limits are compared with the values the
+// component's fieldValue function gives, so clients state them in the units of the report structure
+typedef struct EventStruct
+{
+	JausAddress address;				// Client to send the Event messages to
+	JausUnsignedShort commandCode;		// Report message of the event
+	JausByte eventId;
+	JausByte eventType;					// EVENT_PERIODIC_TYPE, EVENT_EVERY_CHANGE_TYPE, ...
+	JausByte eventBoundary;				// EQUAL_BOUNDARY, ... when hasBoundary
+	JausByte limitDataField;			// Report field the boundary is tested on, when hasDataField
+	JausBoolean hasBoundary;
+	JausBoolean hasDataField;
+	double lowerLimit;
+	double upperLimit;
+	double stateLimit;
+	double changeThreshold;				// Smallest change of the field which counts, the lower limit of an event without boundary
+	double periodSec;					// Periodic types only
+	double nextSendTime;
+	JausUnsignedInteger presenceVector;	// Taken from the query message, selects the report fields sent
+	JausByte sequenceNumber;
+	JausBoolean wasInside;				// Trigger state at the last evaluation
+	JausBoolean hasLastValue;
+	double lastValue;					// Field value at the last evaluation
+	JausBoolean hasSentValue;
+	double sentValue;					// Field value at the last event sent
+	struct EventStruct *nextEvent;
+	struct EventStruct *prevEvent;
+}EventStruct;
+
+typedef EventStruct *Event;
+
+typedef struct SupportedEventMessageStruct
+{
+	unsigned short commandCode;			// Report message the events are created on
+	JausBoolean (*fieldValue)(void *data, JausByte field, double *value);	// NULL if no field can be tested
+	Event eventList;
+	struct SupportedEventMessageStruct *nextSupportedEventMsg;
+	struct SupportedEventMessageStruct *nextIndexedEventMsg;	// Chain of the manager's index bucket
+}SupportedEventMessageStruct;
+
+typedef SupportedEventMessageStruct *SupportedEventMessage;
+
+typedef struct
+{
+	SupportedEventMessage supportedEventMsgList;
+	SupportedEventMessage supportedEventMsgIndex[EVENT_MANAGER_HASH_BUCKETS];	// By command code
+	Event events[EVENT_MANAGER_MAX_EVENTS];		// By event id
+	int eventCount;
+	pthread_mutex_t mutex;
+}EventManagerStruct;
+
+typedef EventManagerStruct *EventManager;
+
 typedef struct JausAddressListStruct
 {
 	JausAddress address;
 	struct JausAddressListStruct *nextAddress;
 }JausAddressList;
 
+#define LM_HANDLER_HASH_BUCKETS					64
+#define LM_HANDLER_DEFAULT_TIMEOUT_SEC			2.0					// Partial messages are dropped after this long without a new packet
+#define LM_HANDLER_DEFAULT_MEMORY_BUDGET_BYTES	(8 * 1024 * 1024)	// Buffer space shared by all partial messages
+#define LM_HANDLER_NAK_INTERVAL_SEC				0.1					// A partial message without progress for this long asks for its missing packets
+#define LM_HANDLER_MAX_NAK_RETRIES				5					// NAKs sent for one partial message without any progress in between
+#define LM_HANDLER_MAX_NAK_PACKETS				512					// Missing packets listed in one NAK
+#define LM_HANDLER_NAK_HEADER_SIZE_BYTES		9					// Command code, flags, head and tail sequence numbers, packet count
+#define LM_HANDLER_NAK_RESEND_HEAD				0x01				// Resend the packets of the set before the head sequence number
+#define LM_HANDLER_NAK_RESEND_TAIL				0x02				// Resend the packets of the set after the tail sequence number
+#define LM_HANDLER_NAK_COMPLETE					0x04				// The set starting at the head sequence number was delivered
+#define LM_HANDLER_NAK_HELLO					0x08				// The sender numbers its sets on from the last one and reports them complete
+#define LM_HANDLER_NAK_HELLO_ANSWER				0x10				// Sent with LM_HANDLER_NAK_HELLO in answer to one, and not answered again
+#define LM_HANDLER_MAX_PACKETS					0x8000				// Packets in one large message, half the sequence number space
+#define LM_HANDLER_MAX_QUEUED_NAKS				64					// NAKs waiting to be sent or answered
+#define LM_HANDLER_PROBE_INTERVAL_SEC			0.5					// A message sent to one component and not reported complete has its first packet sent again
+#define LM_HANDLER_MAX_PROBES					3					// Probes of one message before it is left to expire
+#define LM_HANDLER_COMPLETED_HISTORY			64					// Delivered sets remembered, so their first packet sent again is only acknowledged
+#define LM_HANDLER_MAX_PEERS					64					// Components remembered as sent or having sent LM_HANDLER_NAK_HELLO
+#define LM_HANDLER_HELLO_WAIT_SEC				0.1					// The first large message to a component waits this long for the answer to its hello
+#define LM_HANDLER_DEFAULT_SEND_RATE_BYTES_PER_SEC	(16 * 1024 * 1024)	// Pacing of large message packets (0 = unpaced)
+#define LM_HANDLER_DEFAULT_SEND_BURST_PACKETS	16					// Packets sent back to back before pacing applies
+#define LM_HANDLER_DEFAULT_RETRANSMIT_BUFFER_BYTES	(4 * 1024 * 1024)	// Sent large messages kept to answer NAKs
+#define LM_HANDLER_RETRANSMIT_RETENTION_SEC		4.0					// Sent large messages are kept at most this long
+
+typedef struct LargeMessageListStruct
+{
+	JausUnsignedShort commandCode;
+	JausAddress source;
+	JausUnsignedShort firstSequenceNumber;
+	JausBoolean isFirstKnown;			// JAUS_FALSE while the first packet is missing and firstSequenceNumber is the lowest seen
+	JausMessage header;					// Header of the first packet, becomes the reassembled message
+	JausByte *data;						// Packet n is placed at n * packetSizeBytes
+	JausByte *received;					// One flag per packet slot
+	unsigned int packetSizeBytes;		// Size of every packet but the last
+	unsigned int packetCapacity;		// Slots allocated in data and received
+	unsigned int receivedCount;
+	unsigned int highestPacket;			// Highest index received so far
+	int lastPacket;						// Index of the last packet, -1 until it arrives
+	unsigned int lastPacketSizeBytes;
+	double timeoutTime;
+	double nakTime;						// Missing packets are asked for once this passes without progress
+	int nakRetries;
+	struct LargeMessageListStruct *nextInBucket;
+	struct LargeMessageListStruct *older;
+	struct LargeMessageListStruct *newer;
+}LargeMessageListStruct;
+
+typedef LargeMessageListStruct *LargeMessageList;
+
+typedef struct LargeMessageRetransmitStruct
+{
+	JausMessage message;				// Copy of a sent large message, before it was split
+	JausUnsignedShort firstSequenceNumber;
+	unsigned int packetCount;
+	double expireTime;
+	double probeTime;
+	int probeCount;
+	int useCount;						// NAK answers in progress, the copy is freed once they finish
+	JausBoolean isDropped;
+	struct LargeMessageRetransmitStruct *next;
+}LargeMessageRetransmitStruct;
+
+typedef LargeMessageRetransmitStruct *LargeMessageRetransmit;
+
+typedef struct LargeMessageNakStruct
+{
+	JausMessage nak;
+	JausBoolean isReceived;				// Received and to be answered, otherwise to be sent
+	struct LargeMessageNakStruct *next;
+}LargeMessageNakStruct;
+
+typedef LargeMessageNakStruct *LargeMessageNak;
+
 typedef struct
 {
-	JausArray messageLists;
+	int sourceHash;
+	JausUnsignedShort commandCode;
+	JausUnsignedShort firstSequenceNumber;
+}LargeMessageCompletedStruct;
+
+typedef struct
+{
+	JausBoolean isUsed;
+	int addressHash;
+	JausBoolean isNumbered;				// Announced LM_HANDLER_NAK_HELLO, sets to and from it are numbered on and reported complete
+	int helloCount;						// Announcements sent to it
+	double helloTime;					// When it may be sent another one
+}LargeMessagePeerStruct;
+
+typedef struct
+{
+	unsigned int completedCount;		// Messages reassembled and delivered
+	unsigned int timedOutCount;			// Partial messages dropped after the timeout
+	unsigned int evictedCount;			// Partial messages dropped to stay within the memory budget
+	unsigned int discardedPacketCount;	// Duplicate, malformed or orphaned packets
+	unsigned int memoryBytes;			// Buffer space currently held by partial messages
+	unsigned int nakSentCount;			// NAKs sent for missing packets
+	unsigned int retransmittedPacketCount;	// Packets sent again in answer to a NAK
+	unsigned int retransmitMissCount;	// NAKs for messages no longer in the retransmit buffer
+	unsigned int retransmitBufferBytes;	// Data currently kept to answer NAKs
+	unsigned int nakDropCount;			// NAKs neither sent nor answered because the NAK queue was full
+	unsigned int probeCount;			// First packets sent again because the receiver had not reported the message complete
+}LargeMessageHandlerStats;
+
+typedef struct
+{
+	LargeMessageList buckets[LM_HANDLER_HASH_BUCKETS];
+	LargeMessageList oldest;			// Partial messages in order of their last progress
+	LargeMessageList newest;
+	double timeoutSec;
+	unsigned int memoryBudgetBytes;
+	double nextCheckTime;
+	LargeMessageCompletedStruct completed[LM_HANDLER_COMPLETED_HISTORY];
+	unsigned int completedNext;
+	LargeMessageHandlerStats stats;
+	pthread_mutex_t mutex;
+
+	double sendRateBytesPerSec;
+	unsigned int sendBurstPackets;
+	double sendCredit;					// Bytes which may be sent before pacing waits, negative when behind
+	double sendCreditTime;
+	JausUnsignedShort sendSequenceNumber;	// First sequence number of the next large message sent to a numbered peer
+	LargeMessagePeerStruct peers[LM_HANDLER_MAX_PEERS];
+	unsigned int peerNext;
+	pthread_mutex_t peerMutex;
+	pthread_cond_t peerCondition;		// Signaled when a component announces numbering
+	LargeMessageRetransmit retransmitOldest;
+	LargeMessageRetransmit retransmitNewest;
+	unsigned int retransmitBudgetBytes;
+	pthread_mutex_t retransmitMutex;
+
+	// NAKs are sent and answered on their own thread, started with the first one,
+	// so pacing and congested sends never hold up the receive and heartbeat threads
+	LargeMessageNak nakFirst;
+	LargeMessageNak nakLast;
+	unsigned int nakCount;
+	unsigned int nakDropCount;
+	JausBoolean isNakThreadStarted;
+	JausBoolean isNakThreadStopping;
+	pthread_t nakThread;
+	pthread_mutex_t nakMutex;
+	pthread_cond_t nakCondition;
 }LargeMessageHandlerStruct;
 
 typedef LargeMessageHandlerStruct *LargeMessageHandler;
 
+// Received messages are taken from here, each with a data buffer large enough for any small frame
 typedef struct
 {
-	JausUnsignedShort commandCode;
-	JausAddress source;
-	JausArray messages;
-}LargeMessageListStruct;
+	JausMessage *idle;				// Messages ready to be reused, each holding its data buffer
+	int idleCount;
+	int capacity;					// Idle messages kept, more than this are freed when released
+	unsigned int allocatedCount;	// Messages allocated because none were idle
+	pthread_mutex_t mutex;
+}MessagePoolStruct;
 
-typedef LargeMessageListStruct *LargeMessageList;
+typedef MessagePoolStruct *MessagePool;
+
+typedef struct
+{
+	JausBoolean congested;			// Destination link is above its high watermark
+	int credits;					// Messages the destination link will accept before reaching its high watermark
+	unsigned int linkDropCount;		// Messages the Node Manager has dropped on the destination link(s)
+}NodeManagerFlowControl;
+
+typedef struct
+{
+	int addressHash;
+	int credits;
+	double expireTimeSec;
+	int reportedCredits;			// Credits in the last report, before any were used
+	int maxCredits;					// Most credits reported, the link's whole credit once it has been seen idle
+	double reportTimeSec;
+	JausBoolean isIdle;				// The last two reports, at least a poll apart, both gave maxCredits
+}NodeManagerFlowControlCredit;
+
+typedef struct
+{
+	unsigned char instance;
+	unsigned char component;
+	unsigned char node;
+	unsigned char subsystem;
+	unsigned short commandCount;
+	int commandIndex;				// First of this component's commands in the directory command table
+}NodeManagerDirectoryEntry;
+
+typedef struct
+{
+	unsigned short commandCode;
+	unsigned char serviceType;		// JAUS_SERVICE_INPUT_COMMAND or JAUS_SERVICE_OUTPUT_COMMAND
+}NodeManagerDirectoryCommand;
+
+// Read-only copy of the Node Manager's system tree, used to answer address and service lookups locally
+typedef struct
+{
+	unsigned int changeCount;		// Node Manager system tree change count this copy was taken at
+	int entryCount;
+	NodeManagerDirectoryEntry *entries;
+	int commandCount;
+	NodeManagerDirectoryCommand *commands;
+}NodeManagerDirectoryStruct;
+
+typedef NodeManagerDirectoryStruct *NodeManagerDirectory;
 
 typedef struct
 {
 	DatagramSocket interfaceSocket;
 	DatagramSocket messageSocket;
 
-	pthread_t heartbeatThreadId;
-	int heartbeatThreadRunning;
-	pthread_t receiveThreadId;
-	int receiveThreadRunning;
-
 	pthread_cond_t recvCondition;
-	pthread_cond_t hbWakeCondition;
+	pthread_mutex_t recvMutex;		// Held to signal recvCondition, so a wakeup between checking the queue and waiting is not lost
 
 	InetAddress ipAddress;
+	unsigned short interfacePort;
+	unsigned short messagePort;
 
-	Queue receiveQueue;
+	RingQueue receiveQueue;		// Holds NMI_RECEIVE_QUEUE_CAPACITY messages, newer ones are dropped and counted in receiveDropCount
+	MessagePool messagePool;	// Received messages come from here and go back with nodeManagerReleaseMessage
 
 	JausComponent cmpt;
 
@@ -156,10 +483,40 @@ typedef struct
 	int heartbeatCount;
 	int receiveCount;
 
+	// Served by the heartbeat, receive and directory threads shared by all interfaces of the process
+	JausMessage heartbeatMessage;
+	double nextHeartbeatTime;
+	int nodeManagerTimedOut;			// Heartbeats stop once the Node Manager has not been heard from in time
+	int serviceUsers;					// Shared threads currently working on this interface
+
+	void (*receiveCallback)(void *);	// Called from the receive thread whenever it has delivered something
+	void *receiveCallbackData;
+
 	double timestamp;
 
 	ServiceConnectionManager scm;
+	EventManager evm;
 	LargeMessageHandler lmh;
+
+	pthread_mutex_t interfaceMutex;
+
+	int flowControlMode;
+	double flowControlTimeoutSec;
+	NodeManagerFlowControlCredit flowControlCredits[NMI_FLOW_CONTROL_CREDIT_CACHE_SIZE];
+	pthread_mutex_t flowControlMutex;
+
+	unsigned int sendCongestedCount;	// Sends refused because the destination link was congested
+	unsigned int sendDropCount;			// Sends which failed on the message socket
+	unsigned int receiveDropCount;		// Received messages which were malformed or overflowed a service connection queue
+
+	NodeManagerDirectory directory;		// NULL until fetched, lookups then go to the Node Manager
+	pthread_rwlock_t directoryLock;
+	int directoryStale;					// Set when the Node Manager announces a tree change, guarded by directoryLock
+	unsigned int directoryRefreshCount;	// Times the directory was fetched from the Node Manager
+	int addressListFailureCount;		// List requests in a row left unanswered while the single address ones were answered
+	double addressListRetryTime;		// The list requests are skipped until then once ADDRESS_LIST_MAX_FAILURES is reached
+
+	unsigned int largeFrameSizeBytes;	// Largest message passed whole to and from the Node Manager, 0 until it agrees
 }NodeManagerInterfaceStruct;
 
 typedef NodeManagerInterfaceStruct *NodeManagerInterface;
@@ -167,18 +524,32 @@ typedef NodeManagerInterfaceStruct *NodeManagerInterface;
 JAUS_EXPORT JausBoolean checkNodeManagerReady(double timeout);
 
 JAUS_EXPORT NodeManagerInterface nodeManagerOpen(JausComponent);
+JAUS_EXPORT NodeManagerInterface nodeManagerOpenAt(JausComponent cmpt, char *ipAddressString, unsigned short interfacePort, unsigned short messagePort);
 JAUS_EXPORT int nodeManagerClose(NodeManagerInterface);
 JAUS_EXPORT int nodeManagerReceive(NodeManagerInterface, JausMessage *);
 JAUS_EXPORT int nodeManagerTimedReceive(NodeManagerInterface nmi, JausMessage *message, double timeLimitSec);
+JAUS_EXPORT int nodeManagerReceiveBatch(NodeManagerInterface nmi, JausMessage *messages, int maxCount);
+JAUS_EXPORT int nodeManagerTimedReceiveBatch(NodeManagerInterface nmi, JausMessage *messages, int maxCount, int *messageCount, double timeLimitSec);
+// Gives a received message back to nmi for reuse, in place of jausMessageDestroy. Messages which did not come
+// from nmi, by the calls above or from its service connections, are destroyed.
+JAUS_EXPORT void nodeManagerReleaseMessage(NodeManagerInterface nmi, JausMessage message);
+// Object destroy function for ring queues of received messages, created with the nmi as the destroy data
+JAUS_EXPORT void nodeManagerReleaseQueuedMessage(void *message, void *nmi);
 JAUS_EXPORT int nodeManagerSend(NodeManagerInterface, JausMessage);
 JAUS_EXPORT int nodeManagerSendSingleMessage(NodeManagerInterface, JausMessage);
+JAUS_EXPORT void nodeManagerSetReceiveCallback(NodeManagerInterface nmi, void (*receiveCallback)(void *), void *callbackData);
 JAUS_EXPORT JausAddressList *nodeManagerGetComponentAddressList(NodeManagerInterface, unsigned char);
 JAUS_EXPORT void nodeManagerDestroyAddressList(JausAddressList *);
 JAUS_EXPORT int nodeManagerVerifyAddress(NodeManagerInterface, JausAddress);
+JAUS_EXPORT int nodeManagerVerifyAddressList(NodeManagerInterface nmi, JausAddress *addresses, int addressCount, JausBoolean *verified);
 JAUS_EXPORT JausBoolean nodeManagerLookupAddress(NodeManagerInterface, JausAddress);
+JAUS_EXPORT JausAddressList *nodeManagerLookupAddressList(NodeManagerInterface nmi, JausAddress lookupAddress);
 JAUS_EXPORT void nodeManagerSendCoreServiceConnections(NodeManagerInterface);
 JAUS_EXPORT JausBoolean nodeManagerLookupServiceAddress(NodeManagerInterface, JausAddress, unsigned short, int);
 JAUS_EXPORT JausAddressList* nodeManagerLookupServiceAddressList(NodeManagerInterface, JausAddress, unsigned short, int);
+JAUS_EXPORT void nodeManagerSetFlowControl(NodeManagerInterface nmi, int mode, double timeoutSec);
+JAUS_EXPORT JausBoolean nodeManagerQueryFlowControl(NodeManagerInterface nmi, JausAddress destination, NodeManagerFlowControl *flowControl);
+JAUS_EXPORT JausBoolean nodeManagerCanSend(NodeManagerInterface nmi, JausAddress destination);
 
 JAUS_EXPORT ServiceConnection serviceConnectionCreate(void);
 JAUS_EXPORT void serviceConnectionDestroy(ServiceConnection sc, ServiceConnectionManager scm);
@@ -195,16 +566,43 @@ JAUS_EXPORT void scManagerProcessUpdatedSubystem(NodeManagerInterface, JausSubsy
 
 JAUS_EXPORT void scManagerAddSupportedMessage(NodeManagerInterface, unsigned short);
 JAUS_EXPORT void scManagerRemoveSupportedMessage(NodeManagerInterface, unsigned short);
+JAUS_EXPORT void scManagerSetSupportedMessageSize(NodeManagerInterface nmi, unsigned short commandCode, unsigned int sizeBytes);
+JAUS_EXPORT void scManagerSetLimits(NodeManagerInterface nmi, ServiceConnectionLimits *limits);
+JAUS_EXPORT void scManagerGetAdmissionStats(NodeManagerInterface nmi, ServiceConnectionAdmissionStats *stats);
 JAUS_EXPORT JausBoolean scManagerQueryActiveMessage(NodeManagerInterface, unsigned short);
 
 JAUS_EXPORT ServiceConnection scManagerGetSendList(NodeManagerInterface, unsigned short);
+JAUS_EXPORT int scManagerPublish(NodeManagerInterface nmi, unsigned short commandCode, JausMessage (*encode)(void *data, JausUnsignedInteger presenceVector), void *data);
 JAUS_EXPORT void scManagerDestroySendList(ServiceConnection);
 
 JAUS_EXPORT JausBoolean scManagerCreateServiceConnection(NodeManagerInterface nmi, ServiceConnection sc);
 JAUS_EXPORT JausBoolean scManagerTerminateServiceConnection(NodeManagerInterface, ServiceConnection);
 JAUS_EXPORT JausBoolean scManagerReceiveServiceConnection(NodeManagerInterface nmi, ServiceConnection requestSc, JausMessage *message);
-JAUS_EXPORT void scManagerReceiveMessage(NodeManagerInterface, JausMessage);
-
+JAUS_EXPORT void scManagerReceiveMessage(NodeManagerInterface, JausMessage);
+// Takes up to maxCount messages from the incoming scs which have any, one sc after another;
+// returns the number taken
+JAUS_EXPORT int scManagerReceiveReadyMessages(NodeManagerInterface nmi, JausMessage *messages, int maxCount);
+JAUS_EXPORT JausBoolean scManagerHasReadyMessages(NodeManagerInterface nmi);
+// Deactivates the incoming scs which have received nothing for their timeout
+JAUS_EXPORT void scManagerTimeoutServiceConnections(NodeManagerInterface nmi);
+JAUS_EXPORT JausBoolean scManagerGetServiceConnectionStats(NodeManagerInterface nmi, ServiceConnection sc, ServiceConnectionStats *stats);
+// Copies of every outgoing sc of commandCode with their stats, free with scManagerDestroySendList
+JAUS_EXPORT ServiceConnection scManagerGetOutgoingList(NodeManagerInterface nmi, unsigned short commandCode);
+// One line per incoming and outgoing sc, returns the length written, truncated to bufferSize - 1
+JAUS_EXPORT int scManagerReportToString(NodeManagerInterface nmi, char *buffer, int bufferSize);
+
+JAUS_EXPORT EventManager eventManagerCreate(void);
+JAUS_EXPORT void eventManagerDestroy(EventManager);
+
+JAUS_EXPORT void eventManagerProcessCreateEventMessage(NodeManagerInterface nmi, CreateEventMessage message);
+JAUS_EXPORT void eventManagerProcessUpdateEventMessage(NodeManagerInterface nmi, UpdateEventMessage message);
+JAUS_EXPORT void eventManagerProcessCancelEventMessage(NodeManagerInterface nmi, CancelEventMessage message);
+JAUS_EXPORT void eventManagerProcessUpdatedSubsystem(NodeManagerInterface nmi);
+
+JAUS_EXPORT void eventManagerAddSupportedMessage(NodeManagerInterface nmi, unsigned short commandCode, JausBoolean (*fieldValue)(void *data, JausByte field, double *value));
+JAUS_EXPORT void eventManagerRemoveSupportedMessage(NodeManagerInterface nmi, unsigned short commandCode);
+JAUS_EXPORT int eventManagerPublish(NodeManagerInterface nmi, unsigned short commandCode, JausMessage (*encode)(void *data, JausUnsignedInteger presenceVector), void *data);
+
 JAUS_EXPORT void defaultJausMessageProcessor(JausMessage, NodeManagerInterface, JausComponent);
 JAUS_EXPORT void defaultJausMessageProcessorNoDestroy(JausMessage message, NodeManagerInterface nmi, JausComponent cmpt);
 
@@ -217,6 +615,21 @@ JAUS_EXPORT int lmHandlerMessageListEqual(LargeMessageList, LargeMessageList);
 JAUS_EXPORT LargeMessageList lmHandlerGetMessageList(LargeMessageHandler, JausMessage);
 JAUS_EXPORT int lmHandlerLargeMessageCheck(JausMessage, JausMessage);
 JAUS_EXPORT int lmHandlerSendLargeMessage(NodeManagerInterface, JausMessage);
+JAUS_EXPORT void lmHandlerReceiveNak(NodeManagerInterface nmi, JausMessage nak);
+JAUS_EXPORT void lmHandlerCheckTimeouts(NodeManagerInterface nmi);
+JAUS_EXPORT void lmHandlerSetLimits(NodeManagerInterface nmi, double timeoutSec, unsigned int memoryBudgetBytes);
+JAUS_EXPORT void lmHandlerSetSendLimits(NodeManagerInterface nmi, double sendRateBytesPerSec, unsigned int burstPackets, unsigned int retransmitBufferBytes);
+JAUS_EXPORT void lmHandlerGetStats(NodeManagerInterface nmi, LargeMessageHandlerStats *stats);
+
+// Messages from a pool are freed by jausMessageDestroy like any other, but their data must be
+// freed with messagePoolFreeData rather than directly. messagePoolRelease destroys messages of other pools.
+JAUS_EXPORT MessagePool messagePoolCreate(int capacity, int preallocatedCount);
+JAUS_EXPORT void messagePoolDestroy(MessagePool pool);
+JAUS_EXPORT JausMessage messagePoolGet(MessagePool pool);
+JAUS_EXPORT void messagePoolRelease(MessagePool pool, JausMessage message);
+JAUS_EXPORT JausBoolean messagePoolMessageFromBuffer(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes);
+JAUS_EXPORT JausBoolean messagePoolMessageFromLargeFrame(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes);
+JAUS_EXPORT void messagePoolFreeData(JausMessage message);
 
 #ifdef __cplusplus
 }
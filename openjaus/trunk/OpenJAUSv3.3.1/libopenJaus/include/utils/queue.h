@@ -71,6 +71,7 @@ typedef QueueStruct *Queue;
 JAUS_EXPORT Queue queueCreate(void);
 JAUS_EXPORT void queueDestroy(Queue, void (*)(void *));
 JAUS_EXPORT void *queuePop(Queue);
+JAUS_EXPORT int queuePopMany(Queue queue, void **objects, int maxCount);	// Pops up to maxCount objects under one lock, returns the number popped
 JAUS_EXPORT void queuePush(Queue, void *);
 JAUS_EXPORT void queueEmpty(Queue queue, void (*objectDestroy)(void *));
 
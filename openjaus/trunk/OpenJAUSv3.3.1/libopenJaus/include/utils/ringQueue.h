@@ -0,0 +1,88 @@
+/*****************************************************************************
+ *  Copyright (c) 2008, University of Florida
+ *  All rights reserved.
+ *  
+ *  This file is part of OpenJAUS.  OpenJAUS is distributed under the BSD 
+ *  license.  See the LICENSE file for details.
+ * 
+ *  Redistribution and use in source and binary forms, with or without 
+ *  modification, are permitted provided that the following conditions 
+ *  are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of the University of Florida nor the names of its 
+ *       contributors may be used to endorse or promote products derived from 
+ *       this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+// File Name: ringQueue.h
+//
+// Version: 3.3.0
+//
+// Date: 07/09/08
+//
+// Description:	This file describes a bounded void pointer queue which keeps its objects in preallocated slots.
+//				Any number of threads may push, one thread at a time may pop. A push claims its slot with a
+//				single compare and swap and a pop takes no lock, neither allocates.
+
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#ifdef WIN32
+	#define JAUS_EXPORT	__declspec(dllexport)
+#else
+	#define JAUS_EXPORT
+#endif
+
+#define RING_QUEUE_DROP_NEWEST		0	// A push to a full queue drops the pushed object
+#define RING_QUEUE_DROP_OLDEST		1	// A push to a full queue drops the oldest object, pushes must then not run alongside pops
+
+typedef struct
+{
+	volatile unsigned int sequence;	// Position the slot is next pushed at, or that position + 1 once it holds an object
+	void *object;
+}RingQueueSlot;
+
+typedef struct
+{
+	RingQueueSlot *slots;
+	unsigned int mask;					// Slot count - 1, the slot count is a power of two
+	unsigned int capacity;				// Objects held at most
+	int overflowPolicy;
+	void (*objectDestroy)(void *, void *);	// Applied to dropped objects and to those left at destruction
+	void *objectDestroyData;			// Passed to objectDestroy after the object
+
+	volatile unsigned int tail;			// Next position to push, claimed by the producers
+	volatile unsigned int head;			// Next position to pop, moved only by the consumer
+
+	volatile unsigned int highWaterMark;	// Most objects held at once
+	volatile unsigned int dropCount;		// Objects dropped by the overflow policy
+}RingQueueStruct;
+
+typedef RingQueueStruct *RingQueue;
+
+JAUS_EXPORT RingQueue ringQueueCreate(unsigned int capacity, int overflowPolicy, void (*objectDestroy)(void *, void *), void *objectDestroyData);
+JAUS_EXPORT void ringQueueDestroy(RingQueue queue);
+JAUS_EXPORT int ringQueuePush(RingQueue queue, void *object);	// Returns 0 if the overflow policy dropped an object
+JAUS_EXPORT void *ringQueuePop(RingQueue queue);				// Returns NULL if the queue is empty
+JAUS_EXPORT int ringQueuePopMany(RingQueue queue, void **objects, int maxCount);
+JAUS_EXPORT void ringQueueEmpty(RingQueue queue);
+JAUS_EXPORT unsigned int ringQueueSize(RingQueue queue);
+
+#endif // RING_QUEUE_H
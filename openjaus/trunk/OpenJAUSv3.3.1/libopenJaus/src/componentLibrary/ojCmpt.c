@@ -44,22 +44,85 @@
 //				common component functionality which accelerates and eases
 //				the creation of JAUS components.
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE		// CPU affinity of the real-time lane
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
 #include <jaus.h>
 #include "nodeManagerInterface/nodeManagerInterface.h"
 #include "componentLibrary/ojCmpt.h"
 
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#endif
+
+#define OJ_CMPT_CALLBACK_PAGE_SIZE		256		// Command codes per page of the message callback table
+#define OJ_CMPT_CALLBACK_PAGE_COUNT		256		// Pages covering the 16 bit command code space
+
 typedef	struct
 {
 	void (*function)(OjCmpt, JausMessage);
-	unsigned short commandCode;
-}MessageCallback;				// An array to hold the pointers to the message callback functions
+	OjCmptTypedFunction typedFunction;			// Typed callback, handed the message decoded by fromJausMessage through call
+	void (*call)(OjCmptTypedFunction, OjCmpt, void *);
+	void *(*fromJausMessage)(JausMessage);
+	void (*destroy)(void *);
+	JausBoolean isParallel;						// Handled by a message worker
+}MessageCallback;
+
+typedef struct
+{
+	OjCmpt ojCmpt;
+	pthread_t thread;
+	RingQueue queue;					// Messages handed to this worker, in the order they were received
+	int pendingCount;					// Messages queued or being handled
+	pthread_mutex_t mutex;
+	pthread_cond_t workCondition;		// Signalled as messages are queued
+	pthread_cond_t doneCondition;		// Signalled as messages are handled
+}OjCmptMessageWorker;
+
+typedef struct
+{
+	void (*function)(OjCmpt, void *);	// NULL when the slot is free
+	void *data;
+	double periodSec;					// 0 for a one-shot timer
+	double dueTime;
+	int heapIndex;						// Position in timerHeap
+}OjCmptTimer;
+
+typedef struct OjCmptQueryStruct
+{
+	JausMessage query;					// Kept to send again, NULL when the slot is free
+	JausUnsignedShort responseCode;
+	void (*function)(OjCmpt, JausMessage, void *);
+	void *data;
+	double timeoutSec;
+	double dueTime;						// When the query is sent again or fails
+	int retryCount;						// Sends left after this one
+	JausBoolean isBroadcast;
+	struct OjCmptQueryStruct *nextQuery;	// Chain of an index bucket, the broadcast list or the free list
+}OjCmptQuery;
+
+typedef struct
+{
+	void *buffer[3];
+	size_t size;						// 0 when the mailbox is not used
+	int writeIndex;						// Buffer owned by the writer
+	volatile unsigned int shared;		// Buffer between the two, with OJ_CMPT_RT_MAILBOX_FRESH
+	int readIndex;						// Buffer owned by the reader
+}OjCmptRtMailbox;
 
 struct OjCmptStruct
 {
 	double frequencyHz;		// Desired frequency of the component
 	double rateHz;		// Actual running frequency of the component
+	double intervalSec;		// Smoothed time between ticks, rateHz is its inverse
 
 	JausComponent jaus;				// A pointer to the JausComponent structure found in the OpenJAUS libjaus library.
 
@@ -70,8 +133,7 @@ struct OjCmptStruct
 	void (*mainCallback)(OjCmpt);
 	void (*processMessageCallback)(OjCmpt, JausMessage);
 
-	MessageCallback *messageCallback;				// An array to hold the pointers to the message callback functions
-	int messageCallbackCount;
+	MessageCallback *messageCallback[OJ_CMPT_CALLBACK_PAGE_COUNT];	// Callbacks indexed by command code, each page allocated when first used
 
 	int state;
 	int run;
@@ -82,11 +144,85 @@ struct OjCmptStruct
 
 	void *userData;
 	pthread_mutex_t userDataMutex;	// This mutex protects user data from being accessed twice
+
+	double time;				// Time the state callbacks last ran
+	double nextStateTime;		// Time the state callbacks are due
+	double messageBudget;		// Fraction of the period messages may use
+	double messageTimeSec;		// Time spent on messages since the last tick
+	int messageBudgetExhausted;
+	double jitterSumSec;
+	OjCmptTimingStats timingStats;
+
+	OjCmptTimer timer[OJ_CMPT_MAX_TIMER_COUNT];	// Indexed by timer id
+	int timerHeap[OJ_CMPT_MAX_TIMER_COUNT];	// Timer ids, the next one due first
+	int timerCount;
+	double nextTimerTime;		// Due time of timerHeap[0]
+	pthread_mutex_t timerMutex;
+
+	OjCmptQuery query[OJ_CMPT_MAX_QUERY_COUNT];
+	OjCmptQuery *queryIndex[OJ_CMPT_QUERY_HASH_BUCKETS];	// By response code and destination
+	OjCmptQuery *broadcastQueryList;
+	OjCmptQuery *freeQueryList;
+	int queryCount;
+	double nextQueryTime;		// No query times out before this
+	pthread_mutex_t queryMutex;
+
+	void (*rtFunction)(OjCmpt);	// NULL when the component has no real-time lane
+	double rtPeriodSec;
+	int rtPriority;
+	int rtCpu;
+	pthread_t rtThread;
+	volatile int rtRun;
+	OjCmptRtMailbox rtCommand;	// Component to rtFunction
+	OjCmptRtMailbox rtReport;	// rtFunction to component
+	OjCmptRtStats rtStats;		// Published by the rt thread under rtStatsMutex
+	pthread_mutex_t rtStatsMutex;
+
+	OjCmptMessageWorker *messageWorker;	// NULL when all messages are handled on the component thread
+	int messageWorkerCount;
+	int messageWorkerRun;		// Set while the workers are started, parallel messages are handed to them
+	OjCmptExecutor executor;	// NULL when the component runs on its own thread
+	int executorRunning;		// A worker is running the component
+	int executorMessagePending;	// The receive thread has delivered messages since the component last ran
+};
+
+struct OjCmptExecutorStruct
+{
+	pthread_t *workers;
+	int workerCount;
+	int run;
+
+	OjCmpt *cmpts;				// Components run by the workers
+	int cmptCount;
+	int nextCmpt;				// Where the next search for a ready component starts, so none is starved
+
+	pthread_mutex_t mutex;
+	pthread_cond_t workCondition;	// Signalled when a component may have become ready
+	pthread_cond_t idleCondition;	// Signalled when a worker puts a component down
 };
 
 void* ojCmptThread(void *threadData);
 void ojCmptProcessMessage(OjCmpt ojCmpt, JausMessage message);
 void ojCmptManageServiceConnections(OjCmpt ojCmpt);
+static int ojCmptReceiveServiceConnections(OjCmpt ojCmpt, int maxCount);
+static void ojCmptProcessMessages(OjCmpt ojCmpt, JausMessage *messages, int count);
+static int ojCmptHasMessageBudget(OjCmpt ojCmpt);
+static void ojCmptRunState(OjCmpt ojCmpt);
+static double ojCmptNextDeadline(OjCmpt ojCmpt);
+static int ojCmptRunDue(OjCmpt ojCmpt);
+static JausBoolean ojCmptCompleteQuery(OjCmpt ojCmpt, JausMessage message);
+static void ojCmptCancelQueries(OjCmpt ojCmpt);
+static int ojCmptRtMailboxCreate(OjCmptRtMailbox *mailbox, size_t size);
+static void ojCmptRtMailboxDestroy(OjCmptRtMailbox *mailbox);
+static int ojCmptRtStart(OjCmpt ojCmpt);
+static void ojCmptRtStop(OjCmpt ojCmpt);
+static void ojCmptHandleMessage(OjCmpt ojCmpt, JausMessage message, MessageCallback *callback);
+static void ojCmptQueueParallelMessage(OjCmpt ojCmpt, JausMessage message);
+static void *ojCmptMessageWorkerThread(void *threadData);
+static void ojCmptMessageWorkersStart(OjCmpt ojCmpt);
+static void ojCmptMessageWorkersStop(OjCmpt ojCmpt);
+static void *ojCmptExecutorThread(void *threadData);
+static void ojCmptExecutorNotify(void *data);
 
 OjCmpt ojCmptCreate(char *name, JausByte id, double stateFrequencyHz)
 {
@@ -111,10 +247,49 @@ OjCmpt ojCmptCreate(char *name, JausByte id, double stateFrequencyHz)
 	}
 	ojCmpt->mainCallback = NULL;
 	ojCmpt->processMessageCallback = NULL;
-	ojCmpt->messageCallback = NULL;
-	ojCmpt->messageCallbackCount = 0;
+	for(i=0; i<OJ_CMPT_CALLBACK_PAGE_COUNT; i++)
+	{
+		ojCmpt->messageCallback[i] = NULL;
+	}
 
 	ojCmpt->run = FALSE;
+	ojCmpt->time = ojGetTimeSec();
+	ojCmpt->nextStateTime = ojCmpt->time;
+	ojCmpt->rateHz = ojCmpt->frequencyHz;
+	ojCmpt->intervalSec = 1.0/ojCmpt->frequencyHz;
+	ojCmpt->messageBudget = 1.0;
+	ojCmpt->messageTimeSec = 0;
+	ojCmpt->messageBudgetExhausted = FALSE;
+	ojCmpt->jitterSumSec = 0;
+	memset(&ojCmpt->timingStats, 0, sizeof(OjCmptTimingStats));
+	memset(ojCmpt->timer, 0, sizeof(ojCmpt->timer));
+	ojCmpt->timerCount = 0;
+	ojCmpt->nextTimerTime = 0;
+	pthread_mutex_init(&ojCmpt->timerMutex, NULL);
+	memset(ojCmpt->query, 0, sizeof(ojCmpt->query));
+	memset(ojCmpt->queryIndex, 0, sizeof(ojCmpt->queryIndex));
+	ojCmpt->broadcastQueryList = NULL;
+	ojCmpt->freeQueryList = NULL;
+	for(i = OJ_CMPT_MAX_QUERY_COUNT - 1; i >= 0; i--)
+	{
+		ojCmpt->query[i].nextQuery = ojCmpt->freeQueryList;
+		ojCmpt->freeQueryList = &ojCmpt->query[i];
+	}
+	ojCmpt->queryCount = 0;
+	ojCmpt->nextQueryTime = 0;
+	pthread_mutex_init(&ojCmpt->queryMutex, NULL);
+	ojCmpt->rtFunction = NULL;
+	ojCmpt->rtRun = FALSE;
+	ojCmptRtMailboxCreate(&ojCmpt->rtCommand, 0);
+	ojCmptRtMailboxCreate(&ojCmpt->rtReport, 0);
+	memset(&ojCmpt->rtStats, 0, sizeof(OjCmptRtStats));
+	pthread_mutex_init(&ojCmpt->rtStatsMutex, NULL);
+	ojCmpt->messageWorker = NULL;
+	ojCmpt->messageWorkerCount = 0;
+	ojCmpt->messageWorkerRun = FALSE;
+	ojCmpt->executor = NULL;
+	ojCmpt->executorRunning = FALSE;
+	ojCmpt->executorMessagePending = FALSE;
 
 	if (!jausServiceAddCoreServices(ojCmpt->jaus->services))	// Add core services
 	{
@@ -148,10 +323,12 @@ int ojCmptRun(OjCmpt ojCmpt)
 	pthread_attr_t attr;	// Thread attributed for the component threads spawned in this function
 
 	ojCmpt->run = TRUE;
+	ojCmptMessageWorkersStart(ojCmpt);
 
 	pthread_attr_init(&attr);
 	if(pthread_create(&ojCmpt->thread, &attr, ojCmptThread, (void*)ojCmpt) != 0)
 	{
+		ojCmptMessageWorkersStop(ojCmpt);
 		nodeManagerClose(ojCmpt->nmi); // Close Node Manager Connection
 		free(ojCmpt->jaus->identification);
 		ojCmpt->jaus->identification = NULL;
@@ -162,22 +339,55 @@ int ojCmptRun(OjCmpt ojCmpt)
 	}
 	pthread_attr_destroy(&attr);
 
+	if(ojCmpt->rtFunction)
+	{
+		ojCmptRtStart(ojCmpt);
+	}
+
 	return 0;
 }
 
 void ojCmptDestroy(OjCmpt ojCmpt)
 {
 	RejectComponentControlMessage rejectComponentControl;
-	JausMessage txMessage;
+	JausMessage txMessage;
 	int i = 0;
 
-	if(ojCmpt->run == TRUE)
+	ojCmptRtStop(ojCmpt);
+
+	if(ojCmpt->run == TRUE && ojCmpt->executor)
+	{
+		OjCmptExecutor executor = ojCmpt->executor;
+
+		nodeManagerSetReceiveCallback(ojCmpt->nmi, NULL, NULL);
+
+		pthread_mutex_lock(&executor->mutex);
+		ojCmpt->run = FALSE;
+		for(i = 0; i < executor->cmptCount; i++)
+		{
+			if(executor->cmpts[i] == ojCmpt)
+			{
+				executor->cmpts[i] = executor->cmpts[--executor->cmptCount];
+				break;
+			}
+		}
+		while(ojCmpt->executorRunning)
+		{
+			pthread_cond_wait(&executor->idleCondition, &executor->mutex);
+		}
+		pthread_mutex_unlock(&executor->mutex);
+		ojCmpt->executor = NULL;
+	}
+	else if(ojCmpt->run == TRUE)
 	{
 		ojCmpt->run = FALSE;
 		pthread_cond_signal(&ojCmpt->nmi->recvCondition);
 		pthread_join(ojCmpt->thread, NULL);
 	}
 
+	// Nothing queues messages now, the workers finish those they have
+	ojCmptMessageWorkersStop(ojCmpt);
+
 	if(ojCmpt->jaus->controller.active)
 	{
 		// Terminate control of current component
@@ -205,9 +415,12 @@ void ojCmptDestroy(OjCmpt ojCmpt)
 		}
 	}
 
-	if(ojCmpt->messageCallback)
+	for(i=0; i<OJ_CMPT_CALLBACK_PAGE_COUNT; i++)
 	{
-		free(ojCmpt->messageCallback);
+		if(ojCmpt->messageCallback[i])
+		{
+			free(ojCmpt->messageCallback[i]);
+		}
 	}
 
 	if(ojCmpt->nmi)
@@ -215,6 +428,12 @@ void ojCmptDestroy(OjCmpt ojCmpt)
 		nodeManagerClose(ojCmpt->nmi); // Close Node Manager Connection
 	}
 
+	ojCmptCancelQueries(ojCmpt);
+	ojCmptRtMailboxDestroy(&ojCmpt->rtCommand);
+	ojCmptRtMailboxDestroy(&ojCmpt->rtReport);
+	pthread_mutex_destroy(&ojCmpt->queryMutex);
+	pthread_mutex_destroy(&ojCmpt->rtStatsMutex);
+	pthread_mutex_destroy(&ojCmpt->timerMutex);
 	pthread_mutex_destroy(&ojCmpt->userDataMutex);
 	free(ojCmpt->jaus->identification);
 	ojCmpt->jaus->identification = NULL;
@@ -234,6 +453,18 @@ void ojCmptSetFrequencyHz(OjCmpt ojCmpt, double stateFrequencyHz)
 	}
 }
 
+void ojCmptSetMessageBudget(OjCmpt ojCmpt, double periodFraction)
+{
+	if(periodFraction > 0 && periodFraction < 1.0)
+	{
+		ojCmpt->messageBudget = periodFraction;
+	}
+	else
+	{
+		ojCmpt->messageBudget = 1.0;
+	}
+}
+
 void ojCmptSetState(OjCmpt ojCmpt, int state)
 {
 	if(state < 0 || state > OJ_CMPT_MAX_STATE_COUNT)
@@ -278,32 +509,59 @@ int ojCmptSetStateCallback(OjCmpt ojCmpt, int state, void (*stateCallbackFunctio
 	}
 }
 
-void ojCmptSetMessageCallback(OjCmpt ojCmpt, unsigned short commandCode, void (*messageFunction)(OjCmpt, JausMessage))	// Calls method from messageHandler
+// Returns the table entry for commandCode, allocating its page if needed
+static MessageCallback *ojCmptGetMessageCallback(OjCmpt ojCmpt, unsigned short commandCode)
 {
-	int i;
+	MessageCallback **page = &ojCmpt->messageCallback[commandCode / OJ_CMPT_CALLBACK_PAGE_SIZE];
 
-	for(i=0; i<ojCmpt->messageCallbackCount; i++)
+	if(*page == NULL)
 	{
-		if(ojCmpt->messageCallback[i].commandCode == commandCode)
+		*page = (MessageCallback *)calloc(OJ_CMPT_CALLBACK_PAGE_SIZE, sizeof(MessageCallback));
+		if(*page == NULL)
 		{
-			ojCmpt->messageCallback[i].function = messageFunction;
-			return;
+			return NULL;
 		}
 	}
 
-	if(ojCmpt->messageCallback)
+	return &(*page)[commandCode % OJ_CMPT_CALLBACK_PAGE_SIZE];
+}
+
+void ojCmptSetMessageCallback(OjCmpt ojCmpt, unsigned short commandCode, void (*messageFunction)(OjCmpt, JausMessage))	// Calls method from messageHandler
+{
+	MessageCallback *callback = ojCmptGetMessageCallback(ojCmpt, commandCode);
+
+	if(callback)
 	{
-		ojCmpt->messageCallbackCount++;
-		ojCmpt->messageCallback = (MessageCallback *)realloc(ojCmpt->messageCallback, ojCmpt->messageCallbackCount * sizeof(MessageCallback));
+		callback->function = messageFunction;
+		callback->typedFunction = NULL;
+		callback->call = NULL;
+		callback->fromJausMessage = NULL;
+		callback->destroy = NULL;
 	}
-	else
+}
+
+void ojCmptSetTypedCallback(OjCmpt ojCmpt, unsigned short commandCode, void *(*fromJausMessage)(JausMessage), void (*destroy)(void *), void (*call)(OjCmptTypedFunction, OjCmpt, void *), OjCmptTypedFunction messageFunction)
+{
+	MessageCallback *callback = ojCmptGetMessageCallback(ojCmpt, commandCode);
+
+	if(callback)
 	{
-		ojCmpt->messageCallbackCount = 1;
-		ojCmpt->messageCallback = (MessageCallback *)malloc(sizeof(MessageCallback));
+		callback->function = NULL;
+		callback->typedFunction = messageFunction;
+		callback->call = messageFunction? call : NULL;
+		callback->fromJausMessage = messageFunction? fromJausMessage : NULL;
+		callback->destroy = messageFunction? destroy : NULL;
 	}
+}
+
+static void ojCmptCallDecoded(OjCmptTypedFunction function, OjCmpt ojCmpt, void *message)
+{
+	((void (*)(OjCmpt, void *))function)(ojCmpt, message);
+}
 
-	ojCmpt->messageCallback[ojCmpt->messageCallbackCount - 1].commandCode = commandCode;
-	ojCmpt->messageCallback[ojCmpt->messageCallbackCount - 1].function = messageFunction;
+void ojCmptSetDecodedMessageCallback(OjCmpt ojCmpt, unsigned short commandCode, void *(*fromJausMessage)(JausMessage), void (*destroy)(void *), void (*messageFunction)(OjCmpt, void *))
+{
+	ojCmptSetTypedCallback(ojCmpt, commandCode, fromJausMessage, destroy, ojCmptCallDecoded, (OjCmptTypedFunction)messageFunction);
 }
 
 void ojCmptSetMessageProcessorCallback(OjCmpt ojCmpt, void (*processMessageFunction)(OjCmpt, JausMessage))	// Calls method from messageHandler
@@ -311,6 +569,49 @@ void ojCmptSetMessageProcessorCallback(OjCmpt ojCmpt, void (*processMessageFunct
 	ojCmpt->processMessageCallback = processMessageFunction;
 }
 
+JausBoolean ojCmptSetMessageWorkers(OjCmpt ojCmpt, int workerCount)
+{
+	if(ojCmpt->run == TRUE || workerCount < 1)
+	{
+		return JAUS_FALSE;
+	}
+
+	ojCmpt->messageWorkerCount = workerCount;
+	return JAUS_TRUE;
+}
+
+void ojCmptSetParallelMessage(OjCmpt ojCmpt, unsigned short commandCode, JausBoolean isParallel)
+{
+	MessageCallback *callback = ojCmptGetMessageCallback(ojCmpt, commandCode);
+
+	if(callback)
+	{
+		callback->isParallel = isParallel;
+	}
+}
+
+void ojCmptWaitForMessageWorkers(OjCmpt ojCmpt)
+{
+	OjCmptMessageWorker *worker;
+	int i;
+
+	if(ojCmpt->messageWorker == NULL)
+	{
+		return;
+	}
+
+	for(i = 0; i < ojCmpt->messageWorkerCount; i++)
+	{
+		worker = &ojCmpt->messageWorker[i];
+		pthread_mutex_lock(&worker->mutex);
+		while(worker->pendingCount)
+		{
+			pthread_cond_wait(&worker->doneCondition, &worker->mutex);
+		}
+		pthread_mutex_unlock(&worker->mutex);
+	}
+}
+
 void ojCmptSetUserData(OjCmpt ojCmpt, void *data)
 {
 	ojCmpt->userData = data;
@@ -333,19 +634,47 @@ void ojCmptUnlockUserData(OjCmpt ojCmpt)
 
 void ojCmptProcessMessage(OjCmpt ojCmpt, JausMessage message)
 {
-	int i = 0;
+	MessageCallback *page = ojCmpt->messageCallback[message->commandCode / OJ_CMPT_CALLBACK_PAGE_SIZE];
+	MessageCallback *callback = page? &page[message->commandCode % OJ_CMPT_CALLBACK_PAGE_SIZE] : NULL;
+
+	// A response to an outstanding query goes to the query's callback instead
+	if(ojCmpt->queryCount && ojCmptCompleteQuery(ojCmpt, message))
+	{
+		nodeManagerReleaseMessage(ojCmpt->nmi, message);
+		return;
+	}
+
+	if(callback && callback->isParallel && ojCmpt->messageWorkerRun && (callback->function || callback->typedFunction))
+	{
+		ojCmptQueueParallelMessage(ojCmpt, message);
+		return;
+	}
+
+	ojCmptHandleMessage(ojCmpt, message, callback);
+}
+
+// Runs the callback for message and releases it, on the component thread or a message worker
+static void ojCmptHandleMessage(OjCmpt ojCmpt, JausMessage message, MessageCallback *callback)
+{
+	void *decoded;
 
-	for(i=0; i<ojCmpt->messageCallbackCount; i++)
+	if(callback && callback->function)
+	{
+		callback->function(ojCmpt, message);
+	}
+	else if(callback && callback->typedFunction && callback->fromJausMessage)
 	{
-		if(ojCmpt->messageCallback[i].commandCode == message->commandCode && ojCmpt->messageCallback[i].function)
+		decoded = callback->fromJausMessage(message);
+		if(decoded)
 		{
-			ojCmpt->messageCallback[i].function(ojCmpt, message);
-			i = -1;
-			break;
+			callback->call(callback->typedFunction, ojCmpt, decoded);
+			if(callback->destroy)
+			{
+				callback->destroy(decoded);
+			}
 		}
 	}
-
-	if(i == ojCmpt->messageCallbackCount)
+	else
 	{
 		if(ojCmpt->processMessageCallback)
 		{
@@ -357,7 +686,7 @@ void ojCmptProcessMessage(OjCmpt ojCmpt, JausMessage message)
 		}
 	}
 
-	jausMessageDestroy(message);
+	nodeManagerReleaseMessage(ojCmpt->nmi, message);
 }
 
 double ojCmptGetRateHz(OjCmpt ojCmpt)
@@ -365,181 +694,1433 @@ double ojCmptGetRateHz(OjCmpt ojCmpt)
 	return ojCmpt->rateHz;
 }
 
-void* ojCmptThread(void *threadData)
+void ojCmptGetTimingStats(OjCmpt ojCmpt, OjCmptTimingStats *stats)
 {
-	int i = 0;
-	OjCmpt ojCmpt;
-	JausMessage rxMessage;
-	double prevTime = 0;
-	double time = ojGetTimeSec();
-	double nextStateTime = ojGetTimeSec();
-
-	// Get handle to OpenJausComponent that was created
-	ojCmpt = (OjCmpt)threadData;
+	*stats = ojCmpt->timingStats;
+}
 
-	while(ojCmpt->run) // Execute state machine code while not in the SHUTDOWN state
+// Wakes the component if it is waiting for a deadline later than one just added
+static void ojCmptWake(OjCmpt ojCmpt)
+{
+	if(ojCmpt->executor)
 	{
-		switch(nodeManagerTimedReceive(ojCmpt->nmi, &rxMessage, nextStateTime))
-		{
-			case NMI_MESSAGE_RECEIVED:
-				// If we were sent a message
-				if(rxMessage)
-				{
-					ojCmptProcessMessage(ojCmpt, rxMessage);
-				}
-
-				// Always check for messages on incoming SC queues
-				for(i=0; i<OJ_CMPT_MAX_INCOMING_SC_COUNT; i++)
-				{
-					if(ojCmpt->inConnection[i] && ojCmpt->inConnection[i]->isActive) // Attempt to process incoming message
-					{
-						if(scManagerReceiveServiceConnection(ojCmpt->nmi, ojCmpt->inConnection[i], &rxMessage))
-						{
-							ojCmptProcessMessage(ojCmpt, rxMessage);
-						}
-					}
-				}
-				break;
-
-			case NMI_RECEIVE_TIMED_OUT:
-				prevTime = time;
-				time = ojGetTimeSec();
-				ojCmpt->rateHz = 1.0/(time-prevTime); // Compute the update rate of this thread
-				nextStateTime = time + 1.0/ojCmpt->frequencyHz;
+		pthread_mutex_lock(&ojCmpt->executor->mutex);
+		pthread_cond_signal(&ojCmpt->executor->workCondition);
+		pthread_mutex_unlock(&ojCmpt->executor->mutex);
+	}
+	else if(ojCmpt->run)
+	{
+		pthread_mutex_lock(&ojCmpt->nmi->recvMutex);
+		pthread_cond_signal(&ojCmpt->nmi->recvCondition);
+		pthread_mutex_unlock(&ojCmpt->nmi->recvMutex);
+	}
+}
 
-				if(ojCmpt->mainCallback)
-				{
-					ojCmpt->mainCallback(ojCmpt);
-				}
+// Timers are kept in a binary min-heap of slot numbers ordered by due time, so the next one due is
+// found at the top and adding or removing one costs O(log n)
+static void ojCmptTimerHeapSwap(OjCmpt ojCmpt, int a, int b)
+{
+	int timerId = ojCmpt->timerHeap[a];
 
-				if(ojCmpt->state != JAUS_UNDEFINED_STATE && ojCmpt->stateCallback[ojCmpt->state])
-				{
-					ojCmpt->stateCallback[ojCmpt->state](ojCmpt);
-				}
+	ojCmpt->timerHeap[a] = ojCmpt->timerHeap[b];
+	ojCmpt->timerHeap[b] = timerId;
+	ojCmpt->timer[ojCmpt->timerHeap[a]].heapIndex = a;
+	ojCmpt->timer[ojCmpt->timerHeap[b]].heapIndex = b;
+}
 
-				ojCmptManageServiceConnections(ojCmpt);
-				nodeManagerSendCoreServiceConnections(ojCmpt->nmi);
-				break;
+static void ojCmptTimerHeapUp(OjCmpt ojCmpt, int index)
+{
+	int parent;
 
-			case NMI_CONDITIONAL_WAIT_ERROR:
-				printf("ojCmpt.c : Conditional Wait Error in nodeManagerTimedReceive, Exiting ojCmpt Thread\n");
-				ojCmpt->run = FALSE;
-				break;
+	while(index > 0)
+	{
+		parent = (index - 1) / 2;
+		if(ojCmpt->timer[ojCmpt->timerHeap[parent]].dueTime <= ojCmpt->timer[ojCmpt->timerHeap[index]].dueTime)
+		{
+			break;
+		}
+		ojCmptTimerHeapSwap(ojCmpt, parent, index);
+		index = parent;
+	}
+}
 
-			case NMI_CLOSED_ERROR:
-				printf("ojCmpt.c : Node Manager Interface closed when calling nodeManagerTimedReceive, Exiting ojCmpt Thread\n");
-				ojCmpt->run = FALSE;
-				break;
+static void ojCmptTimerHeapDown(OjCmpt ojCmpt, int index)
+{
+	int child;
 
-			default:
-				printf("ojCmpt.c : Error in nodeManagerTimedReceive, Exiting ojCmpt Thread\n");
-				ojCmpt->run = FALSE;
-				break;
+	while((child = 2 * index + 1) < ojCmpt->timerCount)
+	{
+		if(child + 1 < ojCmpt->timerCount && ojCmpt->timer[ojCmpt->timerHeap[child + 1]].dueTime < ojCmpt->timer[ojCmpt->timerHeap[child]].dueTime)
+		{
+			child++;
 		}
-
+		if(ojCmpt->timer[ojCmpt->timerHeap[index]].dueTime <= ojCmpt->timer[ojCmpt->timerHeap[child]].dueTime)
+		{
+			break;
+		}
+		ojCmptTimerHeapSwap(ojCmpt, index, child);
+		index = child;
 	}
-
-	return NULL;
 }
 
-char* ojCmptGetName(OjCmpt ojCmpt)
+// Called with timerMutex held, keeps nextTimerTime at the top of the heap
+static void ojCmptTimerHeapRemove(OjCmpt ojCmpt, int timerId)
 {
-	char *name;
+	int index = ojCmpt->timer[timerId].heapIndex;
+	int movedId;
 
-	name = (char *)malloc(strlen(ojCmpt->jaus->identification)+1);
-	strcpy(name, ojCmpt->jaus->identification);
+	// The last timer takes the removed one's place, then moves to where its due time belongs
+	ojCmpt->timerCount--;
+	if(index != ojCmpt->timerCount)
+	{
+		movedId = ojCmpt->timerHeap[ojCmpt->timerCount];
+		ojCmptTimerHeapSwap(ojCmpt, index, ojCmpt->timerCount);
+		ojCmptTimerHeapUp(ojCmpt, index);
+		ojCmptTimerHeapDown(ojCmpt, ojCmpt->timer[movedId].heapIndex);
+	}
+	ojCmpt->timer[timerId].heapIndex = -1;
+	ojCmpt->timer[timerId].function = NULL;
 
-	return name;
+	if(ojCmpt->timerCount)
+	{
+		ojCmpt->nextTimerTime = ojCmpt->timer[ojCmpt->timerHeap[0]].dueTime;
+	}
 }
 
-JausAddress ojCmptGetAddress(OjCmpt ojCmpt)
+static int ojCmptAddTimer(OjCmpt ojCmpt, double delaySec, double periodSec, void (*timerFunction)(OjCmpt, void *), void *data)
 {
-	return jausAddressClone(ojCmpt->jaus->address);
-}
+	int timerId;
 
-JausAddress ojCmptGetControllerAddress(OjCmpt ojCmpt)
-{
-	if(ojCmptHasController(ojCmpt))
+	if(timerFunction == NULL || delaySec < 0)
 	{
-		return jausAddressClone(ojCmpt->jaus->controller.address);
+		return -1;
 	}
-	else
+
+	pthread_mutex_lock(&ojCmpt->timerMutex);
+	for(timerId = 0; timerId < OJ_CMPT_MAX_TIMER_COUNT; timerId++)
 	{
-		return jausAddressCreate();
+		if(ojCmpt->timer[timerId].function == NULL)
+		{
+			break;
+		}
+	}
+	if(timerId == OJ_CMPT_MAX_TIMER_COUNT)
+	{
+		pthread_mutex_unlock(&ojCmpt->timerMutex);
+		return -1;
 	}
-}
 
-JausBoolean ojCmptHasController(OjCmpt ojCmpt)
-{
-	return ojCmpt->jaus->controller.active;
-}
-
-JausBoolean ojCmptTerminateController(OjCmpt ojCmpt)
-{
-	RejectComponentControlMessage rejectComponentControl = NULL;
-	JausMessage txMessage = NULL;
-
-	if(!ojCmpt)
-	{
-		return JAUS_FALSE;
-	}
-
-	if(!ojCmpt->jaus->controller.active)
-	{
-		return JAUS_FALSE;
-	}
-
-	// Send a reject control message
-	rejectComponentControl = rejectComponentControlMessageCreate();
-	jausAddressCopy(rejectComponentControl->source, ojCmpt->jaus->address);
-	jausAddressCopy(rejectComponentControl->destination, ojCmpt->jaus->controller.address);
-	txMessage = rejectComponentControlMessageToJausMessage(rejectComponentControl);
-	nodeManagerSend(ojCmpt->nmi, txMessage);
-	jausMessageDestroy(txMessage);
-
-	// Clear out the controller structure
-	ojCmpt->jaus->controller.active = JAUS_FALSE;
-	ojCmpt->jaus->controller.authority = 0;
-	ojCmpt->jaus->controller.address->subsystem = 0;
-	ojCmpt->jaus->controller.address->node = 0;
-	ojCmpt->jaus->controller.address->component = 0;
-	ojCmpt->jaus->controller.address->instance = 0;
-	ojCmpt->jaus->controller.state = JAUS_UNDEFINED_STATE;
-
-	return JAUS_TRUE;
-}
-
-void ojCmptDefaultMessageProcessor(OjCmpt ojCmpt, JausMessage message)
-{
-	defaultJausMessageProcessorNoDestroy(message, ojCmpt->nmi, ojCmpt->jaus);
+	ojCmpt->timer[timerId].function = timerFunction;
+	ojCmpt->timer[timerId].data = data;
+	ojCmpt->timer[timerId].periodSec = periodSec;
+	ojCmpt->timer[timerId].dueTime = ojGetTimeSec() + delaySec;
+	ojCmpt->timer[timerId].heapIndex = ojCmpt->timerCount;
+	ojCmpt->timerHeap[ojCmpt->timerCount++] = timerId;
+	ojCmptTimerHeapUp(ojCmpt, ojCmpt->timer[timerId].heapIndex);
+	ojCmpt->nextTimerTime = ojCmpt->timer[ojCmpt->timerHeap[0]].dueTime;
+	pthread_mutex_unlock(&ojCmpt->timerMutex);
+
+	ojCmptWake(ojCmpt);
+	return timerId;
 }
 
-int ojCmptGetState(OjCmpt ojCmpt)
+int ojCmptAddPeriodicTimer(OjCmpt ojCmpt, double frequencyHz, void (*timerFunction)(OjCmpt, void *), void *data)
 {
-	return ojCmpt->state;
+	if(frequencyHz <= 0)
+	{
+		return -1;
+	}
+	return ojCmptAddTimer(ojCmpt, 1.0/frequencyHz, 1.0/frequencyHz, timerFunction, data);
 }
 
-int ojCmptSendMessage(OjCmpt ojCmpt, JausMessage message)
+int ojCmptAddOneShotTimer(OjCmpt ojCmpt, double delaySec, void (*timerFunction)(OjCmpt, void *), void *data)
 {
-	jausAddressCopy(message->source, ojCmpt->jaus->address);
-	return nodeManagerSend(ojCmpt->nmi, message);
+	return ojCmptAddTimer(ojCmpt, delaySec, 0, timerFunction, data);
 }
 
-JausBoolean ojCmptAddService(OjCmpt ojCmpt, JausUnsignedShort serviceType)
+int ojCmptRemoveTimer(OjCmpt ojCmpt, int timerId)
 {
-	JausService service = jausServiceCreate(serviceType);
-	if(service)
+	if(timerId < 0 || timerId >= OJ_CMPT_MAX_TIMER_COUNT)
 	{
-		return jausServiceAddService(ojCmpt->jaus->services, service);
+		return FALSE;
 	}
-	return JAUS_FALSE;
-}
-
-JausBoolean ojCmptAddServiceInputMessage(OjCmpt ojCmpt, JausUnsignedShort serviceType, JausUnsignedShort commandCode, JausUnsignedInteger presenceVector)
-{
-	JausService service = jausServiceRetrieveService(ojCmpt->jaus->services, serviceType);
 
-	if(service)
+	pthread_mutex_lock(&ojCmpt->timerMutex);
+	if(ojCmpt->timer[timerId].function == NULL)
+	{
+		pthread_mutex_unlock(&ojCmpt->timerMutex);
+		return FALSE;
+	}
+	ojCmptTimerHeapRemove(ojCmpt, timerId);
+	pthread_mutex_unlock(&ojCmpt->timerMutex);
+
+	return TRUE;
+}
+
+// Runs each timer which is due once; a periodic timer keeps the phase it was added with, periods it
+// has already missed are dropped rather than run in a burst
+static void ojCmptRunTimers(OjCmpt ojCmpt)
+{
+	OjCmptTimer *timer;
+	void (*timerFunction)(OjCmpt, void *);
+	void *data;
+	double now = ojGetTimeSec();
+
+	pthread_mutex_lock(&ojCmpt->timerMutex);
+	while(ojCmpt->timerCount && ojCmpt->timer[ojCmpt->timerHeap[0]].dueTime <= now)
+	{
+		timer = &ojCmpt->timer[ojCmpt->timerHeap[0]];
+		timerFunction = timer->function;
+		data = timer->data;
+
+		if(timer->periodSec > 0)
+		{
+			timer->dueTime += timer->periodSec;
+			if(timer->dueTime <= now)
+			{
+				timer->dueTime += ((unsigned int)((now - timer->dueTime) / timer->periodSec) + 1) * timer->periodSec;
+			}
+			ojCmptTimerHeapDown(ojCmpt, 0);
+			ojCmpt->nextTimerTime = ojCmpt->timer[ojCmpt->timerHeap[0]].dueTime;
+		}
+		else
+		{
+			ojCmptTimerHeapRemove(ojCmpt, ojCmpt->timerHeap[0]);
+		}
+
+		// Unlocked, so the callback may add and remove timers
+		pthread_mutex_unlock(&ojCmpt->timerMutex);
+		timerFunction(ojCmpt, data);
+		pthread_mutex_lock(&ojCmpt->timerMutex);
+	}
+	pthread_mutex_unlock(&ojCmpt->timerMutex);
+}
+
+// Queries to one component are indexed by response code and destination, which is the source of the
+// response. Queries to a broadcast address are kept on their own list and completed by the first response.
+static unsigned int ojCmptQueryHash(JausUnsignedShort responseCode, JausAddress address)
+{
+	unsigned int hash = (unsigned int)jausAddressHash(address);
+
+	hash ^= hash >> 16;
+	hash ^= hash >> 8;
+	return ((hash & 0xFF) * 31 + responseCode) % OJ_CMPT_QUERY_HASH_BUCKETS;
+}
+
+static JausBoolean ojCmptQueryIsBroadcast(JausAddress address)
+{
+	return (JausBoolean)(address->subsystem == JAUS_BROADCAST_SUBSYSTEM_ID || address->node == JAUS_BROADCAST_NODE_ID ||
+			address->component == JAUS_BROADCAST_COMPONENT_ID || address->instance == JAUS_BROADCAST_INSTANCE_ID);
+}
+
+static JausBoolean ojCmptQueryMatches(OjCmptQuery *query, JausMessage message)
+{
+	JausAddress destination = query->query->destination;
+
+	if(query->responseCode != message->commandCode)
+	{
+		return JAUS_FALSE;
+	}
+	if(!query->isBroadcast)
+	{
+		return jausAddressEqual(destination, message->source);
+	}
+	return (JausBoolean)((destination->subsystem == JAUS_BROADCAST_SUBSYSTEM_ID || destination->subsystem == message->source->subsystem) &&
+			(destination->node == JAUS_BROADCAST_NODE_ID || destination->node == message->source->node) &&
+			(destination->component == JAUS_BROADCAST_COMPONENT_ID || destination->component == message->source->component) &&
+			(destination->instance == JAUS_BROADCAST_INSTANCE_ID || destination->instance == message->source->instance));
+}
+
+// Called with queryMutex held, takes the query off its list and returns its slot to the free list
+static void ojCmptQueryRemove(OjCmpt ojCmpt, OjCmptQuery *query)
+{
+	OjCmptQuery **listQuery;
+
+	if(query->isBroadcast)
+	{
+		listQuery = &ojCmpt->broadcastQueryList;
+	}
+	else
+	{
+		listQuery = &ojCmpt->queryIndex[ojCmptQueryHash(query->responseCode, query->query->destination)];
+	}
+	while(*listQuery && *listQuery != query)
+	{
+		listQuery = &(*listQuery)->nextQuery;
+	}
+	if(*listQuery)
+	{
+		*listQuery = query->nextQuery;
+	}
+
+	jausMessageDestroy(query->query);
+	query->query = NULL;
+	query->nextQuery = ojCmpt->freeQueryList;
+	ojCmpt->freeQueryList = query;
+	ojCmpt->queryCount--;
+}
+
+JausBoolean ojCmptSendQuery(OjCmpt ojCmpt, JausMessage query, JausUnsignedShort responseCode, double timeoutSec, int retryCount, void (*responseFunction)(OjCmpt, JausMessage, void *), void *data)
+{
+	OjCmptQuery *pendingQuery;
+	OjCmptQuery **listQuery;
+
+	if(responseFunction == NULL || timeoutSec <= 0)
+	{
+		return JAUS_FALSE;
+	}
+
+	pthread_mutex_lock(&ojCmpt->queryMutex);
+	pendingQuery = ojCmpt->freeQueryList;
+	if(pendingQuery == NULL)
+	{
+		// OJ_CMPT_MAX_QUERY_COUNT are outstanding
+		pthread_mutex_unlock(&ojCmpt->queryMutex);
+		return JAUS_FALSE;
+	}
+
+	jausAddressCopy(query->source, ojCmpt->jaus->address);
+	pendingQuery->query = jausMessageClone(query);
+	if(pendingQuery->query == NULL)
+	{
+		pthread_mutex_unlock(&ojCmpt->queryMutex);
+		return JAUS_FALSE;
+	}
+	ojCmpt->freeQueryList = pendingQuery->nextQuery;
+
+	pendingQuery->responseCode = responseCode;
+	pendingQuery->function = responseFunction;
+	pendingQuery->data = data;
+	pendingQuery->timeoutSec = timeoutSec;
+	pendingQuery->retryCount = retryCount > 0? retryCount : 0;
+	pendingQuery->dueTime = ojGetTimeSec() + timeoutSec;
+	pendingQuery->isBroadcast = ojCmptQueryIsBroadcast(query->destination);
+
+	// Appended, so of two queries waiting on the same response the older is completed first
+	if(pendingQuery->isBroadcast)
+	{
+		listQuery = &ojCmpt->broadcastQueryList;
+	}
+	else
+	{
+		listQuery = &ojCmpt->queryIndex[ojCmptQueryHash(responseCode, query->destination)];
+	}
+	while(*listQuery)
+	{
+		listQuery = &(*listQuery)->nextQuery;
+	}
+	pendingQuery->nextQuery = NULL;
+	*listQuery = pendingQuery;
+
+	if(ojCmpt->queryCount == 0 || pendingQuery->dueTime < ojCmpt->nextQueryTime)
+	{
+		ojCmpt->nextQueryTime = pendingQuery->dueTime;
+	}
+	ojCmpt->queryCount++;
+	pthread_mutex_unlock(&ojCmpt->queryMutex);
+
+	// Sent from the caller's message, the kept clone may already be gone with a quick response
+	nodeManagerSend(ojCmpt->nmi, query);
+
+	ojCmptWake(ojCmpt);
+	return JAUS_TRUE;
+}
+
+// Hands message to the oldest query waiting for it, returns FALSE if there is none
+static JausBoolean ojCmptCompleteQuery(OjCmpt ojCmpt, JausMessage message)
+{
+	OjCmptQuery *pendingQuery;
+	void (*responseFunction)(OjCmpt, JausMessage, void *);
+	void *data;
+
+	pthread_mutex_lock(&ojCmpt->queryMutex);
+	pendingQuery = ojCmpt->queryIndex[ojCmptQueryHash(message->commandCode, message->source)];
+	while(pendingQuery && !ojCmptQueryMatches(pendingQuery, message))
+	{
+		pendingQuery = pendingQuery->nextQuery;
+	}
+	if(pendingQuery == NULL)
+	{
+		pendingQuery = ojCmpt->broadcastQueryList;
+		while(pendingQuery && !ojCmptQueryMatches(pendingQuery, message))
+		{
+			pendingQuery = pendingQuery->nextQuery;
+		}
+	}
+	if(pendingQuery == NULL)
+	{
+		pthread_mutex_unlock(&ojCmpt->queryMutex);
+		return JAUS_FALSE;
+	}
+
+	responseFunction = pendingQuery->function;
+	data = pendingQuery->data;
+	ojCmptQueryRemove(ojCmpt, pendingQuery);
+	pthread_mutex_unlock(&ojCmpt->queryMutex);
+
+	responseFunction(ojCmpt, message, data);
+	return JAUS_TRUE;
+}
+
+// Sends again the queries which have timed out with retries left, and fails the others
+static void ojCmptRunQueryTimeouts(OjCmpt ojCmpt)
+{
+	void (*expiredFunction[OJ_CMPT_MAX_QUERY_COUNT])(OjCmpt, JausMessage, void *);
+	void *expiredData[OJ_CMPT_MAX_QUERY_COUNT];
+	JausMessage retryQuery[OJ_CMPT_MAX_QUERY_COUNT];
+	OjCmptQuery *pendingQuery;
+	double now = ojGetTimeSec();
+	int expiredCount = 0;
+	int retryCount = 0;
+	int i;
+
+	pthread_mutex_lock(&ojCmpt->queryMutex);
+	ojCmpt->nextQueryTime = now + 1.0/OJ_CMPT_MIN_FREQUENCY_HZ;
+	for(i = 0; i < OJ_CMPT_MAX_QUERY_COUNT; i++)
+	{
+		pendingQuery = &ojCmpt->query[i];
+		if(pendingQuery->query == NULL)
+		{
+			continue;
+		}
+
+		if(pendingQuery->dueTime <= now)
+		{
+			if(pendingQuery->retryCount > 0)
+			{
+				pendingQuery->retryCount--;
+				pendingQuery->dueTime = now + pendingQuery->timeoutSec;
+				retryQuery[retryCount] = jausMessageClone(pendingQuery->query);
+				if(retryQuery[retryCount])
+				{
+					retryCount++;
+				}
+			}
+			else
+			{
+				expiredFunction[expiredCount] = pendingQuery->function;
+				expiredData[expiredCount] = pendingQuery->data;
+				expiredCount++;
+				ojCmptQueryRemove(ojCmpt, pendingQuery);
+				continue;
+			}
+		}
+
+		if(pendingQuery->dueTime < ojCmpt->nextQueryTime)
+		{
+			ojCmpt->nextQueryTime = pendingQuery->dueTime;
+		}
+	}
+	pthread_mutex_unlock(&ojCmpt->queryMutex);
+
+	// Sent from copies once unlocked, so a slow send does not hold up responses to other queries
+	for(i = 0; i < retryCount; i++)
+	{
+		nodeManagerSend(ojCmpt->nmi, retryQuery[i]);
+		jausMessageDestroy(retryQuery[i]);
+	}
+
+	// A NULL response tells the callback its query timed out
+	for(i = 0; i < expiredCount; i++)
+	{
+		expiredFunction[i](ojCmpt, NULL, expiredData[i]);
+	}
+}
+
+// Drops every outstanding query without calling back, when the component is destroyed
+static void ojCmptCancelQueries(OjCmpt ojCmpt)
+{
+	int i;
+
+	pthread_mutex_lock(&ojCmpt->queryMutex);
+	for(i = 0; i < OJ_CMPT_MAX_QUERY_COUNT; i++)
+	{
+		if(ojCmpt->query[i].query)
+		{
+			ojCmptQueryRemove(ojCmpt, &ojCmpt->query[i]);
+		}
+	}
+	pthread_mutex_unlock(&ojCmpt->queryMutex);
+}
+
+// Real-time lane. The lane thread wakes at absolute deadlines on the monotonic clock and only runs
+// the rt callback, which talks to the rest of the component through two mailboxes. A mailbox is a
+// triple buffer: the writer fills its own buffer and swaps it with the shared one in one atomic
+// exchange, the reader swaps the shared one for its own when it is marked fresh. Neither ever
+// waits on the other and nothing is allocated once the lane runs.
+#define OJ_CMPT_RT_MAILBOX_FRESH	4	// Set in shared when it holds data the reader has not taken
+
+#ifdef WIN32
+static unsigned int ojCmptRtExchange(volatile unsigned int *value, unsigned int newValue)
+{
+	return (unsigned int)InterlockedExchange((volatile LONG *)value, (LONG)newValue);
+}
+
+static double ojCmptRtTimeSec(void)
+{
+	return ojGetTimeSec();
+}
+
+static void ojCmptRtSleepUntil(double timeSec)
+{
+	double sleepSec = timeSec - ojCmptRtTimeSec();
+
+	if(sleepSec > 0)
+	{
+		Sleep((DWORD)(sleepSec * 1000.0));
+	}
+}
+#else
+static unsigned int ojCmptRtExchange(volatile unsigned int *value, unsigned int newValue)
+{
+	return __atomic_exchange_n(value, newValue, __ATOMIC_ACQ_REL);
+}
+
+static double ojCmptRtTimeSec(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec + (double)now.tv_nsec / 1.0e9;
+}
+
+static void ojCmptRtSleepUntil(double timeSec)
+{
+	struct timespec deadline;
+
+	deadline.tv_sec = (time_t)timeSec;
+	deadline.tv_nsec = (long)(1e9 * (timeSec - (double)deadline.tv_sec));
+#if defined(__linux__)
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR);
+#else
+	{
+		double sleepSec = timeSec - ojCmptRtTimeSec();
+		if(sleepSec > 0)
+		{
+			usleep((useconds_t)(sleepSec * 1.0e6));
+		}
+	}
+#endif
+}
+#endif
+
+static int ojCmptRtMailboxCreate(OjCmptRtMailbox *mailbox, size_t size)
+{
+	int i;
+
+	mailbox->size = size;
+	for(i = 0; i < 3; i++)
+	{
+		mailbox->buffer[i] = NULL;
+	}
+	mailbox->writeIndex = 0;
+	mailbox->shared = 1;
+	mailbox->readIndex = 2;
+
+	if(size == 0)
+	{
+		return TRUE;
+	}
+
+	for(i = 0; i < 3; i++)
+	{
+		mailbox->buffer[i] = calloc(1, size);
+		if(mailbox->buffer[i] == NULL)
+		{
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static void ojCmptRtMailboxDestroy(OjCmptRtMailbox *mailbox)
+{
+	int i;
+
+	for(i = 0; i < 3; i++)
+	{
+		free(mailbox->buffer[i]);
+		mailbox->buffer[i] = NULL;
+	}
+	mailbox->size = 0;
+}
+
+static void ojCmptRtMailboxWrite(OjCmptRtMailbox *mailbox, const void *data)
+{
+	if(mailbox->size == 0)
+	{
+		return;
+	}
+
+	memcpy(mailbox->buffer[mailbox->writeIndex], data, mailbox->size);
+	mailbox->writeIndex = ojCmptRtExchange(&mailbox->shared, mailbox->writeIndex | OJ_CMPT_RT_MAILBOX_FRESH) & ~OJ_CMPT_RT_MAILBOX_FRESH;
+}
+
+// Copies the latest data written to data, returns FALSE if none was written since the last read
+static int ojCmptRtMailboxRead(OjCmptRtMailbox *mailbox, void *data)
+{
+	int fresh = FALSE;
+
+	if(mailbox->size == 0)
+	{
+		return FALSE;
+	}
+
+	if(mailbox->shared & OJ_CMPT_RT_MAILBOX_FRESH)
+	{
+		mailbox->readIndex = ojCmptRtExchange(&mailbox->shared, mailbox->readIndex) & ~OJ_CMPT_RT_MAILBOX_FRESH;
+		fresh = TRUE;
+	}
+	memcpy(data, mailbox->buffer[mailbox->readIndex], mailbox->size);
+	return fresh;
+}
+
+int ojCmptSetRtCallback(OjCmpt ojCmpt, double frequencyHz, int priority, int cpu, size_t commandSize, size_t reportSize, void (*rtFunction)(OjCmpt))
+{
+	if(ojCmpt->run == TRUE || rtFunction == NULL || frequencyHz <= 0)
+	{
+		return FALSE;
+	}
+
+	ojCmptRtMailboxDestroy(&ojCmpt->rtCommand);
+	ojCmptRtMailboxDestroy(&ojCmpt->rtReport);
+	if(!ojCmptRtMailboxCreate(&ojCmpt->rtCommand, commandSize) || !ojCmptRtMailboxCreate(&ojCmpt->rtReport, reportSize))
+	{
+		ojCmptRtMailboxDestroy(&ojCmpt->rtCommand);
+		ojCmptRtMailboxDestroy(&ojCmpt->rtReport);
+		return FALSE;
+	}
+
+	ojCmpt->rtFunction = rtFunction;
+	ojCmpt->rtPeriodSec = 1.0/frequencyHz;
+	ojCmpt->rtPriority = priority;
+	ojCmpt->rtCpu = cpu;
+	return TRUE;
+}
+
+void ojCmptRtWriteCommand(OjCmpt ojCmpt, const void *command)
+{
+	ojCmptRtMailboxWrite(&ojCmpt->rtCommand, command);
+}
+
+int ojCmptRtReadCommand(OjCmpt ojCmpt, void *command)
+{
+	return ojCmptRtMailboxRead(&ojCmpt->rtCommand, command);
+}
+
+void ojCmptRtWriteReport(OjCmpt ojCmpt, const void *report)
+{
+	ojCmptRtMailboxWrite(&ojCmpt->rtReport, report);
+}
+
+int ojCmptRtReadReport(OjCmpt ojCmpt, void *report)
+{
+	return ojCmptRtMailboxRead(&ojCmpt->rtReport, report);
+}
+
+void ojCmptGetRtStats(OjCmpt ojCmpt, OjCmptRtStats *stats)
+{
+	pthread_mutex_lock(&ojCmpt->rtStatsMutex);
+	*stats = ojCmpt->rtStats;
+	pthread_mutex_unlock(&ojCmpt->rtStatsMutex);
+}
+
+static void *ojCmptRtThread(void *threadData)
+{
+	OjCmpt ojCmpt = (OjCmpt)threadData;
+	OjCmptRtStats localStats;
+	OjCmptRtStats *stats = &localStats;
+	double deadline = ojCmptRtTimeSec();
+	double wakeTime;
+	double endTime;
+	double latencyUsec;
+	double cycleUsec;
+	unsigned int bin;
+	unsigned int missedCount;
+#if defined(__linux__)
+	struct sched_param schedParam;
+	int policy;
+#endif
+
+	// Counted locally and published when rtStatsMutex is free, so the lane never waits on a reader
+	memset(stats, 0, sizeof(OjCmptRtStats));
+	stats->isRunning = JAUS_TRUE;
+#if defined(__linux__)
+	if(pthread_getschedparam(pthread_self(), &policy, &schedParam) == 0 && policy == SCHED_FIFO)
+	{
+		stats->isRealTime = JAUS_TRUE;
+	}
+#endif
+
+	while(ojCmpt->rtRun)
+	{
+		deadline += ojCmpt->rtPeriodSec;
+		ojCmptRtSleepUntil(deadline);
+
+		wakeTime = ojCmptRtTimeSec();
+		ojCmpt->rtFunction(ojCmpt);
+		endTime = ojCmptRtTimeSec();
+
+		latencyUsec = (wakeTime - deadline) * 1.0e6;
+		bin = latencyUsec > 0? (unsigned int)(latencyUsec / OJ_CMPT_RT_HISTOGRAM_BIN_USEC) : 0;
+		if(bin >= OJ_CMPT_RT_HISTOGRAM_BINS)
+		{
+			bin = OJ_CMPT_RT_HISTOGRAM_BINS - 1;
+		}
+		stats->latencyHistogram[bin]++;
+		if(latencyUsec > stats->maxLatencyUsec)
+		{
+			stats->maxLatencyUsec = latencyUsec;
+		}
+		cycleUsec = (endTime - wakeTime) * 1.0e6;
+		if(cycleUsec > stats->maxCycleUsec)
+		{
+			stats->maxCycleUsec = cycleUsec;
+		}
+		stats->cycleCount++;
+
+		// Deadlines keep their phase, those already passed are dropped rather than run back to back
+		if(endTime > deadline + ojCmpt->rtPeriodSec)
+		{
+			stats->overrunCount++;
+			missedCount = (unsigned int)((endTime - deadline) / ojCmpt->rtPeriodSec);
+			stats->skippedCycleCount += missedCount;
+			deadline += missedCount * ojCmpt->rtPeriodSec;
+		}
+
+		if(pthread_mutex_trylock(&ojCmpt->rtStatsMutex) == 0)
+		{
+			ojCmpt->rtStats = localStats;
+			pthread_mutex_unlock(&ojCmpt->rtStatsMutex);
+		}
+	}
+
+	localStats.isRunning = JAUS_FALSE;
+	pthread_mutex_lock(&ojCmpt->rtStatsMutex);
+	ojCmpt->rtStats = localStats;
+	pthread_mutex_unlock(&ojCmpt->rtStatsMutex);
+	return NULL;
+}
+
+static int ojCmptRtStart(OjCmpt ojCmpt)
+{
+	pthread_attr_t attr;
+#if defined(__linux__)
+	struct sched_param schedParam;
+	cpu_set_t cpus;
+#endif
+
+	pthread_mutex_lock(&ojCmpt->rtStatsMutex);
+	memset(&ojCmpt->rtStats, 0, sizeof(OjCmptRtStats));
+	ojCmpt->rtStats.isRunning = JAUS_TRUE;
+	pthread_mutex_unlock(&ojCmpt->rtStatsMutex);
+	ojCmpt->rtRun = TRUE;
+
+	pthread_attr_init(&attr);
+#if defined(__linux__)
+	if(ojCmpt->rtCpu >= 0)
+	{
+		CPU_ZERO(&cpus);
+		CPU_SET(ojCmpt->rtCpu, &cpus);
+		pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+	}
+	if(ojCmpt->rtPriority > 0)
+	{
+		pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		schedParam.sched_priority = ojCmpt->rtPriority;
+		pthread_attr_setschedparam(&attr, &schedParam);
+		if(pthread_create(&ojCmpt->rtThread, &attr, ojCmptRtThread, (void*)ojCmpt) == 0)
+		{
+			pthread_attr_destroy(&attr);
+			return TRUE;
+		}
+
+		// Without the privilege for SCHED_FIFO the lane runs on the normal scheduler
+		pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+	}
+#endif
+	if(pthread_create(&ojCmpt->rtThread, &attr, ojCmptRtThread, (void*)ojCmpt) != 0)
+	{
+		ojCmpt->rtRun = FALSE;
+		pthread_mutex_lock(&ojCmpt->rtStatsMutex);
+		ojCmpt->rtStats.isRunning = JAUS_FALSE;
+		pthread_mutex_unlock(&ojCmpt->rtStatsMutex);
+		pthread_attr_destroy(&attr);
+		return FALSE;
+	}
+	pthread_attr_destroy(&attr);
+	return TRUE;
+}
+
+static void ojCmptRtStop(OjCmpt ojCmpt)
+{
+	if(ojCmpt->rtRun)
+	{
+		ojCmpt->rtRun = FALSE;
+		pthread_join(ojCmpt->rtThread, NULL);
+	}
+}
+
+// Hands message to the worker for its source and command code, waiting while that worker is full
+static void ojCmptQueueParallelMessage(OjCmpt ojCmpt, JausMessage message)
+{
+	unsigned int key = (unsigned int)jausAddressHash(message->source) * 31 + message->commandCode;
+	OjCmptMessageWorker *worker = &ojCmpt->messageWorker[key % ojCmpt->messageWorkerCount];
+
+	pthread_mutex_lock(&worker->mutex);
+	while(worker->pendingCount >= OJ_CMPT_MESSAGE_WORKER_QUEUE_SIZE)
+	{
+		pthread_cond_wait(&worker->doneCondition, &worker->mutex);
+	}
+	worker->pendingCount++;
+	ringQueuePush(worker->queue, message);
+	pthread_cond_signal(&worker->workCondition);
+	pthread_mutex_unlock(&worker->mutex);
+}
+
+static void *ojCmptMessageWorkerThread(void *threadData)
+{
+	OjCmptMessageWorker *worker = (OjCmptMessageWorker *)threadData;
+	OjCmpt ojCmpt = worker->ojCmpt;
+	MessageCallback *page;
+	JausMessage message;
+
+	pthread_mutex_lock(&worker->mutex);
+	while(ojCmpt->messageWorkerRun || worker->pendingCount)
+	{
+		message = (JausMessage)ringQueuePop(worker->queue);
+		if(message == NULL)
+		{
+			pthread_cond_wait(&worker->workCondition, &worker->mutex);
+			continue;
+		}
+		pthread_mutex_unlock(&worker->mutex);
+
+		page = ojCmpt->messageCallback[message->commandCode / OJ_CMPT_CALLBACK_PAGE_SIZE];
+		ojCmptHandleMessage(ojCmpt, message, &page[message->commandCode % OJ_CMPT_CALLBACK_PAGE_SIZE]);
+
+		pthread_mutex_lock(&worker->mutex);
+		worker->pendingCount--;
+		pthread_cond_broadcast(&worker->doneCondition);
+	}
+	pthread_mutex_unlock(&worker->mutex);
+
+	return NULL;
+}
+
+// Starts the workers set by ojCmptSetMessageWorkers, if any fails all messages stay on the component thread
+static void ojCmptMessageWorkersStart(OjCmpt ojCmpt)
+{
+	OjCmptMessageWorker *worker;
+	int i;
+
+	if(ojCmpt->messageWorkerCount < 1)
+	{
+		return;
+	}
+
+	ojCmpt->messageWorker = (OjCmptMessageWorker *)calloc(ojCmpt->messageWorkerCount, sizeof(OjCmptMessageWorker));
+	if(ojCmpt->messageWorker == NULL)
+	{
+		return;
+	}
+
+	ojCmpt->messageWorkerRun = TRUE;
+	for(i = 0; i < ojCmpt->messageWorkerCount; i++)
+	{
+		worker = &ojCmpt->messageWorker[i];
+		worker->ojCmpt = ojCmpt;
+		worker->queue = ringQueueCreate(OJ_CMPT_MESSAGE_WORKER_QUEUE_SIZE, RING_QUEUE_DROP_NEWEST, nodeManagerReleaseQueuedMessage, ojCmpt->nmi);
+		if(worker->queue == NULL)
+		{
+			break;
+		}
+		pthread_mutex_init(&worker->mutex, NULL);
+		pthread_cond_init(&worker->workCondition, NULL);
+		pthread_cond_init(&worker->doneCondition, NULL);
+		if(pthread_create(&worker->thread, NULL, ojCmptMessageWorkerThread, (void *)worker) != 0)
+		{
+			pthread_cond_destroy(&worker->doneCondition);
+			pthread_cond_destroy(&worker->workCondition);
+			pthread_mutex_destroy(&worker->mutex);
+			ringQueueDestroy(worker->queue);
+			break;
+		}
+	}
+
+	if(i < ojCmpt->messageWorkerCount)
+	{
+		// Stop the workers started so far
+		ojCmpt->messageWorkerCount = i;
+		ojCmptMessageWorkersStop(ojCmpt);
+	}
+}
+
+static void ojCmptMessageWorkersStop(OjCmpt ojCmpt)
+{
+	OjCmptMessageWorker *worker;
+	int i;
+
+	if(ojCmpt->messageWorker == NULL)
+	{
+		return;
+	}
+
+	ojCmpt->messageWorkerRun = FALSE;
+	for(i = 0; i < ojCmpt->messageWorkerCount; i++)
+	{
+		worker = &ojCmpt->messageWorker[i];
+		pthread_mutex_lock(&worker->mutex);
+		pthread_cond_signal(&worker->workCondition);
+		pthread_mutex_unlock(&worker->mutex);
+	}
+
+	for(i = 0; i < ojCmpt->messageWorkerCount; i++)
+	{
+		worker = &ojCmpt->messageWorker[i];
+		pthread_join(worker->thread, NULL);
+		ringQueueDestroy(worker->queue);
+		pthread_cond_destroy(&worker->doneCondition);
+		pthread_cond_destroy(&worker->workCondition);
+		pthread_mutex_destroy(&worker->mutex);
+	}
+
+	free(ojCmpt->messageWorker);
+	ojCmpt->messageWorker = NULL;
+}
+
+// Time the next state tick, timer or query timeout is due
+static double ojCmptNextDeadline(OjCmpt ojCmpt)
+{
+	double deadline = ojCmpt->nextStateTime;
+
+	if(ojCmpt->timerCount && ojCmpt->nextTimerTime < deadline)
+	{
+		deadline = ojCmpt->nextTimerTime;
+	}
+	if(ojCmpt->queryCount && ojCmpt->nextQueryTime < deadline)
+	{
+		deadline = ojCmpt->nextQueryTime;
+	}
+	return deadline;
+}
+
+// Runs the state callbacks, timers and query timeouts which are due, returns FALSE if nothing was
+static int ojCmptRunDue(OjCmpt ojCmpt)
+{
+	double now = ojGetTimeSec();
+	int ran = FALSE;
+
+	if(now >= ojCmpt->nextStateTime)
+	{
+		ojCmptRunState(ojCmpt);
+		ran = TRUE;
+	}
+	if(ojCmpt->timerCount && now >= ojCmpt->nextTimerTime)
+	{
+		ojCmptRunTimers(ojCmpt);
+		ran = TRUE;
+	}
+	if(ojCmpt->queryCount && now >= ojCmpt->nextQueryTime)
+	{
+		ojCmptRunQueryTimeouts(ojCmpt);
+		ran = TRUE;
+	}
+	return ran;
+}
+
+// Fraction of the period messages may still use before the next tick
+static int ojCmptHasMessageBudget(OjCmpt ojCmpt)
+{
+	return ojCmpt->messageBudget >= 1.0 || ojCmpt->messageTimeSec < ojCmpt->messageBudget / ojCmpt->frequencyHz;
+}
+
+static void ojCmptAddMessageTime(OjCmpt ojCmpt, double timeSec)
+{
+	ojCmpt->messageTimeSec += timeSec;
+	if(!ojCmpt->messageBudgetExhausted && !ojCmptHasMessageBudget(ojCmpt))
+	{
+		ojCmpt->messageBudgetExhausted = TRUE;
+		ojCmpt->timingStats.budgetExhaustedCount++;
+	}
+}
+
+// Processes the messages in order, running the state callbacks and timers between two of them as they come due
+static void ojCmptProcessMessages(OjCmpt ojCmpt, JausMessage *messages, int count)
+{
+	double startTime = ojGetTimeSec();
+	double now;
+	int i;
+
+	for(i = 0; i < count; i++)
+	{
+		ojCmptProcessMessage(ojCmpt, messages[i]);
+		ojCmpt->timingStats.messageCount++;
+
+		now = ojGetTimeSec();
+		if(now >= ojCmptNextDeadline(ojCmpt))
+		{
+			ojCmptAddMessageTime(ojCmpt, now - startTime);
+			ojCmptRunDue(ojCmpt);
+			startTime = ojGetTimeSec();
+		}
+	}
+	ojCmptAddMessageTime(ojCmpt, ojGetTimeSec() - startTime);
+}
+
+// Processes up to maxCount messages from the incoming SC queues which have any, returns how many were processed
+static int ojCmptReceiveServiceConnections(OjCmpt ojCmpt, int maxCount)
+{
+	JausMessage rxMessages[OJ_CMPT_RECEIVE_BATCH_SIZE];
+	int count;
+
+	if(maxCount > OJ_CMPT_RECEIVE_BATCH_SIZE)
+	{
+		maxCount = OJ_CMPT_RECEIVE_BATCH_SIZE;
+	}
+
+	count = scManagerReceiveReadyMessages(ojCmpt->nmi, rxMessages, maxCount);
+	ojCmptProcessMessages(ojCmpt, rxMessages, count);
+	return count;
+}
+
+static void ojCmptRunState(OjCmpt ojCmpt)
+{
+	OjCmptTimingStats *stats = &ojCmpt->timingStats;
+	double periodSec = 1.0/ojCmpt->frequencyHz;
+	double scheduledTime = ojCmpt->nextStateTime;
+	double prevTime = ojCmpt->time;
+	double jitterSec;
+	double durationSec;
+	unsigned int missedCount;
+
+	ojCmpt->time = ojGetTimeSec();
+	jitterSec = ojCmpt->time - scheduledTime;
+
+	// Compute the update rate of this thread, smoothed so one late tick does not swing it
+	if(stats->tickCount)
+	{
+		ojCmpt->intervalSec += OJ_CMPT_RATE_FILTER_GAIN * ((ojCmpt->time - prevTime) - ojCmpt->intervalSec);
+	}
+	else
+	{
+		ojCmpt->intervalSec = periodSec;
+	}
+	ojCmpt->rateHz = 1.0/ojCmpt->intervalSec;
+
+	stats->tickCount++;
+	stats->lastJitterSec = jitterSec;
+	ojCmpt->jitterSumSec += jitterSec;
+	stats->meanJitterSec = ojCmpt->jitterSumSec / stats->tickCount;
+	if(jitterSec > stats->maxJitterSec)
+	{
+		stats->maxJitterSec = jitterSec;
+	}
+
+	// The next deadline keeps the phase of the schedule, deadlines already passed are dropped
+	ojCmpt->nextStateTime = scheduledTime + periodSec;
+	if(ojCmpt->nextStateTime <= ojCmpt->time)
+	{
+		missedCount = (unsigned int)((ojCmpt->time - scheduledTime) / periodSec);
+		stats->skippedTickCount += missedCount;
+		ojCmpt->nextStateTime = scheduledTime + (missedCount + 1) * periodSec;
+	}
+	ojCmpt->messageTimeSec = 0;
+	ojCmpt->messageBudgetExhausted = FALSE;
+
+	if(ojCmpt->mainCallback)
+	{
+		ojCmpt->mainCallback(ojCmpt);
+	}
+
+	if(ojCmpt->state != JAUS_UNDEFINED_STATE && ojCmpt->stateCallback[ojCmpt->state])
+	{
+		ojCmpt->stateCallback[ojCmpt->state](ojCmpt);
+	}
+
+	ojCmptManageServiceConnections(ojCmpt);
+	nodeManagerSendCoreServiceConnections(ojCmpt->nmi);
+
+	durationSec = ojGetTimeSec() - ojCmpt->time;
+	if(durationSec > stats->maxTickDurationSec)
+	{
+		stats->maxTickDurationSec = durationSec;
+	}
+	if(ojCmpt->time + durationSec > ojCmpt->nextStateTime)
+	{
+		stats->overrunCount++;
+	}
+}
+
+// Waits for the next tick or timer without taking messages, ojCmptDestroy's signal ends the wait early
+static void ojCmptWaitForDeadline(OjCmpt ojCmpt)
+{
+	struct timespec timeLimitSpec;
+	double timeLimitSec = ojCmptNextDeadline(ojCmpt);
+
+	timeLimitSpec.tv_sec = (long)timeLimitSec;
+	timeLimitSpec.tv_nsec = (long)(1e9 * (timeLimitSec - (double)timeLimitSpec.tv_sec));
+
+	pthread_mutex_lock(&ojCmpt->nmi->recvMutex);
+	if(ojCmpt->run)
+	{
+		pthread_cond_timedwait(&ojCmpt->nmi->recvCondition, &ojCmpt->nmi->recvMutex, &timeLimitSpec);
+	}
+	pthread_mutex_unlock(&ojCmpt->nmi->recvMutex);
+}
+
+void* ojCmptThread(void *threadData)
+{
+	OjCmpt ojCmpt;
+	JausMessage rxMessages[OJ_CMPT_RECEIVE_BATCH_SIZE];
+	int rxCount;
+
+	// Get handle to OpenJausComponent that was created
+	ojCmpt = (OjCmpt)threadData;
+	ojCmpt->time = ojGetTimeSec();
+	ojCmpt->nextStateTime = ojCmpt->time;
+
+	while(ojCmpt->run) // Execute state machine code while not in the SHUTDOWN state
+	{
+		// Deadlines are checked before every receive, so a steady stream of messages cannot hold them back
+		if(ojCmptRunDue(ojCmpt))
+		{
+			continue;
+		}
+
+		if(!ojCmptHasMessageBudget(ojCmpt))
+		{
+			ojCmptWaitForDeadline(ojCmpt);
+			continue;
+		}
+
+		switch(nodeManagerTimedReceiveBatch(ojCmpt->nmi, rxMessages, OJ_CMPT_RECEIVE_BATCH_SIZE, &rxCount, ojCmptNextDeadline(ojCmpt)))
+		{
+			case NMI_MESSAGE_RECEIVED:
+				// Woken with no messages when only service connection traffic arrived
+				ojCmptProcessMessages(ojCmpt, rxMessages, rxCount);
+				ojCmptReceiveServiceConnections(ojCmpt, OJ_CMPT_RECEIVE_BATCH_SIZE);
+				break;
+
+			case NMI_RECEIVE_TIMED_OUT:
+				// The state callbacks or a timer are due, they run at the top of the loop
+				break;
+
+			case NMI_CONDITIONAL_WAIT_ERROR:
+				printf("ojCmpt.c : Conditional Wait Error in nodeManagerTimedReceive, Exiting ojCmpt Thread\n");
+				ojCmpt->run = FALSE;
+				break;
+
+			case NMI_CLOSED_ERROR:
+				printf("ojCmpt.c : Node Manager Interface closed when calling nodeManagerTimedReceive, Exiting ojCmpt Thread\n");
+				ojCmpt->run = FALSE;
+				break;
+
+			default:
+				printf("ojCmpt.c : Error in nodeManagerTimedReceive, Exiting ojCmpt Thread\n");
+				ojCmpt->run = FALSE;
+				break;
+		}
+
+	}
+
+	return NULL;
+}
+
+OjCmptExecutor ojCmptExecutorCreate(int workerCount)
+{
+	OjCmptExecutor executor;
+	int i;
+
+	if(workerCount < 1)
+	{
+		return NULL;
+	}
+
+	executor = (OjCmptExecutor)malloc(sizeof(struct OjCmptExecutorStruct));
+	if(executor == NULL)
+	{
+		return NULL;
+	}
+
+	executor->workers = (pthread_t *)malloc(workerCount * sizeof(pthread_t));
+	executor->workerCount = 0;
+	executor->run = TRUE;
+	executor->cmpts = NULL;
+	executor->cmptCount = 0;
+	executor->nextCmpt = 0;
+	pthread_mutex_init(&executor->mutex, NULL);
+	pthread_cond_init(&executor->workCondition, NULL);
+	pthread_cond_init(&executor->idleCondition, NULL);
+
+	for(i = 0; i < workerCount; i++)
+	{
+		if(pthread_create(&executor->workers[i], NULL, ojCmptExecutorThread, (void*)executor) != 0)
+		{
+			ojCmptExecutorDestroy(executor);
+			return NULL;
+		}
+		executor->workerCount++;
+	}
+
+	return executor;
+}
+
+int ojCmptExecutorDestroy(OjCmptExecutor executor)
+{
+	int i;
+
+	pthread_mutex_lock(&executor->mutex);
+	if(executor->cmptCount > 0)
+	{
+		pthread_mutex_unlock(&executor->mutex);
+		return -1;
+	}
+	executor->run = FALSE;
+	pthread_cond_broadcast(&executor->workCondition);
+	pthread_mutex_unlock(&executor->mutex);
+
+	for(i = 0; i < executor->workerCount; i++)
+	{
+		pthread_join(executor->workers[i], NULL);
+	}
+
+	pthread_cond_destroy(&executor->idleCondition);
+	pthread_cond_destroy(&executor->workCondition);
+	pthread_mutex_destroy(&executor->mutex);
+	free(executor->cmpts);
+	free(executor->workers);
+	free(executor);
+	return 0;
+}
+
+int ojCmptRunOnExecutor(OjCmpt ojCmpt, OjCmptExecutor executor)
+{
+	if(executor == NULL || ojCmpt->run == TRUE)
+	{
+		return -1;
+	}
+
+	ojCmptMessageWorkersStart(ojCmpt);
+
+	pthread_mutex_lock(&executor->mutex);
+	executor->cmpts = (OjCmpt *)realloc(executor->cmpts, (executor->cmptCount + 1) * sizeof(OjCmpt));
+	executor->cmpts[executor->cmptCount++] = ojCmpt;
+
+	ojCmpt->executor = executor;
+	ojCmpt->run = TRUE;
+	ojCmpt->time = ojGetTimeSec();
+	ojCmpt->nextStateTime = ojCmpt->time;
+	ojCmpt->executorMessagePending = TRUE;
+	pthread_cond_signal(&executor->workCondition);
+	pthread_mutex_unlock(&executor->mutex);
+
+	nodeManagerSetReceiveCallback(ojCmpt->nmi, ojCmptExecutorNotify, (void*)ojCmpt);
+
+	if(ojCmpt->rtFunction)
+	{
+		ojCmptRtStart(ojCmpt);
+	}
+	return 0;
+}
+
+// Called by the node manager interface receive thread
+static void ojCmptExecutorNotify(void *data)
+{
+	OjCmpt ojCmpt = (OjCmpt)data;
+	OjCmptExecutor executor = ojCmpt->executor;
+
+	if(executor)
+	{
+		pthread_mutex_lock(&executor->mutex);
+		ojCmpt->executorMessagePending = TRUE;
+		pthread_cond_signal(&executor->workCondition);
+		pthread_mutex_unlock(&executor->mutex);
+	}
+}
+
+static void *ojCmptExecutorThread(void *threadData)
+{
+	OjCmptExecutor executor = (OjCmptExecutor)threadData;
+	OjCmpt ojCmpt;
+	JausMessage rxMessages[OJ_CMPT_EXECUTOR_MESSAGES_PER_TURN];
+	struct timespec timeLimitSpec;
+	double timeLimitSec;
+	double now;
+	int messagePending;
+	int count;
+	int scCount;
+	int i;
+
+	pthread_mutex_lock(&executor->mutex);
+	while(executor->run)
+	{
+		// Take the first ready component, the others stay for the next worker. Messages for a
+		// component which has used up its message budget wait for its tick.
+		now = ojGetTimeSec();
+		timeLimitSec = now + 1.0/OJ_CMPT_MIN_FREQUENCY_HZ;
+		ojCmpt = NULL;
+		for(count = 0; count < executor->cmptCount; count++)
+		{
+			i = (executor->nextCmpt + count) % executor->cmptCount;
+			if(executor->cmpts[i]->executorRunning)
+			{
+				continue;
+			}
+			if((executor->cmpts[i]->executorMessagePending && ojCmptHasMessageBudget(executor->cmpts[i])) || ojCmptNextDeadline(executor->cmpts[i]) <= now)
+			{
+				ojCmpt = executor->cmpts[i];
+				executor->nextCmpt = i + 1;
+				break;
+			}
+			if(ojCmptNextDeadline(executor->cmpts[i]) < timeLimitSec)
+			{
+				timeLimitSec = ojCmptNextDeadline(executor->cmpts[i]);
+			}
+		}
+
+		if(ojCmpt == NULL)
+		{
+			timeLimitSpec.tv_sec = (long)timeLimitSec;
+			timeLimitSpec.tv_nsec = (long)(1e9 * (timeLimitSec - (double)timeLimitSpec.tv_sec));
+			pthread_cond_timedwait(&executor->workCondition, &executor->mutex, &timeLimitSpec);
+			continue;
+		}
+
+		ojCmpt->executorRunning = TRUE;
+		messagePending = ojCmpt->executorMessagePending && ojCmptHasMessageBudget(ojCmpt);
+		if(messagePending)
+		{
+			ojCmpt->executorMessagePending = FALSE;
+		}
+		pthread_mutex_unlock(&executor->mutex);
+
+		ojCmptRunDue(ojCmpt);
+
+		// A bounded number of messages per turn, the rest wait for the next one
+		count = 0;
+		scCount = 0;
+		if(messagePending)
+		{
+			count = nodeManagerReceiveBatch(ojCmpt->nmi, rxMessages, OJ_CMPT_EXECUTOR_MESSAGES_PER_TURN);
+			ojCmptProcessMessages(ojCmpt, rxMessages, count);
+			scCount = ojCmptReceiveServiceConnections(ojCmpt, OJ_CMPT_EXECUTOR_MESSAGES_PER_TURN);
+		}
+
+		ojCmptRunDue(ojCmpt);
+
+		pthread_mutex_lock(&executor->mutex);
+		if(count == OJ_CMPT_EXECUTOR_MESSAGES_PER_TURN || scCount == OJ_CMPT_EXECUTOR_MESSAGES_PER_TURN)
+		{
+			ojCmpt->executorMessagePending = TRUE;
+		}
+		ojCmpt->executorRunning = FALSE;
+		pthread_cond_broadcast(&executor->idleCondition);
+	}
+	pthread_mutex_unlock(&executor->mutex);
+
+	return NULL;
+}
+
+char* ojCmptGetName(OjCmpt ojCmpt)
+{
+	char *name;
+
+	name = (char *)malloc(strlen(ojCmpt->jaus->identification)+1);
+	strcpy(name, ojCmpt->jaus->identification);
+
+	return name;
+}
+
+JausAddress ojCmptGetAddress(OjCmpt ojCmpt)
+{
+	return jausAddressClone(ojCmpt->jaus->address);
+}
+
+JausAddress ojCmptGetControllerAddress(OjCmpt ojCmpt)
+{
+	if(ojCmptHasController(ojCmpt))
+	{
+		return jausAddressClone(ojCmpt->jaus->controller.address);
+	}
+	else
+	{
+		return jausAddressCreate();
+	}
+}
+
+JausBoolean ojCmptHasController(OjCmpt ojCmpt)
+{
+	return ojCmpt->jaus->controller.active;
+}
+
+JausBoolean ojCmptTerminateController(OjCmpt ojCmpt)
+{
+	RejectComponentControlMessage rejectComponentControl = NULL;
+	JausMessage txMessage = NULL;
+
+	if(!ojCmpt)
+	{
+		return JAUS_FALSE;
+	}
+
+	if(!ojCmpt->jaus->controller.active)
+	{
+		return JAUS_FALSE;
+	}
+
+	// Send a reject control message
+	rejectComponentControl = rejectComponentControlMessageCreate();
+	jausAddressCopy(rejectComponentControl->source, ojCmpt->jaus->address);
+	jausAddressCopy(rejectComponentControl->destination, ojCmpt->jaus->controller.address);
+	txMessage = rejectComponentControlMessageToJausMessage(rejectComponentControl);
+	nodeManagerSend(ojCmpt->nmi, txMessage);
+	jausMessageDestroy(txMessage);
+
+	// Clear out the controller structure
+	ojCmpt->jaus->controller.active = JAUS_FALSE;
+	ojCmpt->jaus->controller.authority = 0;
+	ojCmpt->jaus->controller.address->subsystem = 0;
+	ojCmpt->jaus->controller.address->node = 0;
+	ojCmpt->jaus->controller.address->component = 0;
+	ojCmpt->jaus->controller.address->instance = 0;
+	ojCmpt->jaus->controller.state = JAUS_UNDEFINED_STATE;
+
+	return JAUS_TRUE;
+}
+
+void ojCmptDefaultMessageProcessor(OjCmpt ojCmpt, JausMessage message)
+{
+	defaultJausMessageProcessorNoDestroy(message, ojCmpt->nmi, ojCmpt->jaus);
+}
+
+int ojCmptGetState(OjCmpt ojCmpt)
+{
+	return ojCmpt->state;
+}
+
+int ojCmptSendMessage(OjCmpt ojCmpt, JausMessage message)
+{
+	jausAddressCopy(message->source, ojCmpt->jaus->address);
+	return nodeManagerSend(ojCmpt->nmi, message);
+}
+
+JausBoolean ojCmptAddService(OjCmpt ojCmpt, JausUnsignedShort serviceType)
+{
+	JausService service = jausServiceCreate(serviceType);
+	if(service)
+	{
+		return jausServiceAddService(ojCmpt->jaus->services, service);
+	}
+	return JAUS_FALSE;
+}
+
+JausBoolean ojCmptAddServiceInputMessage(OjCmpt ojCmpt, JausUnsignedShort serviceType, JausUnsignedShort commandCode, JausUnsignedInteger presenceVector)
+{
+	JausService service = jausServiceRetrieveService(ojCmpt->jaus->services, serviceType);
+
+	if(service)
 	{
 		return jausServiceAddInputCommand(service, commandCode, presenceVector);
 	}
@@ -577,17 +2158,66 @@ void ojCmptDestroySendList(ServiceConnection scList)
 	scManagerDestroySendList(scList);
 }
 
+ServiceConnection ojCmptGetScOutgoingList(OjCmpt ojCmpt, unsigned short commandCode)
+{
+	return scManagerGetOutgoingList(ojCmpt->nmi, commandCode);
+}
+
+int ojCmptScReportToString(OjCmpt ojCmpt, char *buffer, int bufferSize)
+{
+	return scManagerReportToString(ojCmpt->nmi, buffer, bufferSize);
+}
+
+int ojCmptPublishSc(OjCmpt ojCmpt, unsigned short commandCode, JausMessage (*encode)(void *data, JausUnsignedInteger presenceVector), void *data)
+{
+	return scManagerPublish(ojCmpt->nmi, commandCode, encode, data);
+}
+
+void ojCmptAddSupportedEvent(OjCmpt ojCmpt, unsigned short commandCode, JausBoolean (*fieldValue)(void *data, JausByte field, double *value))
+{
+	eventManagerAddSupportedMessage(ojCmpt->nmi, commandCode, fieldValue);
+}
+
+void ojCmptRemoveSupportedEvent(OjCmpt ojCmpt, unsigned short commandCode)
+{
+	eventManagerRemoveSupportedMessage(ojCmpt->nmi, commandCode);
+}
+
+int ojCmptPublishEvents(OjCmpt ojCmpt, unsigned short commandCode, JausMessage (*encode)(void *data, JausUnsignedInteger presenceVector), void *data)
+{
+	return eventManagerPublish(ojCmpt->nmi, commandCode, encode, data);
+}
+
 JausBoolean ojCmptIsOutgoingScActive(OjCmpt ojCmpt, unsigned short commandCode)
 {
 	return scManagerQueryActiveMessage(ojCmpt->nmi, commandCode);
 }
 
+void ojCmptSetScMessageSize(OjCmpt ojCmpt, unsigned short commandCode, unsigned int sizeBytes)
+{
+	scManagerSetSupportedMessageSize(ojCmpt->nmi, commandCode, sizeBytes);
+}
+
+void ojCmptSetScLimits(OjCmpt ojCmpt, double producerRateHz, double producerBandwidthBytesPerSec, double clientRateHz, double clientBandwidthBytesPerSec)
+{
+	ServiceConnectionLimits limits;
+
+	limits.producerRateHz = producerRateHz;
+	limits.producerBandwidthBytesPerSec = producerBandwidthBytesPerSec;
+	limits.clientRateHz = clientRateHz;
+	limits.clientBandwidthBytesPerSec = clientBandwidthBytesPerSec;
+	scManagerSetLimits(ojCmpt->nmi, &limits);
+}
+
 // Incoming Service Connections
 void ojCmptManageServiceConnections(OjCmpt ojCmpt)
 {
 	int i = 0;
 	double time = ojGetTimeSec();
 
+	// Incoming scs are no longer polled, so their timeouts are checked here
+	scManagerTimeoutServiceConnections(ojCmpt->nmi);
+
 	// Manage Incoming Connections
 	for(i=0; i<OJ_CMPT_MAX_INCOMING_SC_COUNT; i++)
 	{
@@ -664,6 +2294,16 @@ JausBoolean ojCmptIsIncomingScActive(OjCmpt ojCmpt, int scIndex)
 	return ojCmpt->inConnection[scIndex]->isActive;
 }
 
+JausBoolean ojCmptGetIncomingScStats(OjCmpt ojCmpt, int scIndex, ServiceConnectionStats *stats)
+{
+	if(scIndex < 0 || scIndex >= OJ_CMPT_MAX_INCOMING_SC_COUNT || ojCmpt->inConnection[scIndex] == NULL)
+	{
+		return JAUS_FALSE;
+	}
+
+	return scManagerGetServiceConnectionStats(ojCmpt->nmi, ojCmpt->inConnection[scIndex], stats);
+}
+
 JausBoolean ojCmptLookupAddress(OjCmpt ojCmpt, JausAddress address)
 {
 	return nodeManagerLookupAddress(ojCmpt->nmi, address);
@@ -77,6 +77,8 @@ CommunicatorComponent::CommunicatorComponent(FileLoader *configData, EventHandle
 	this->cmptRateHz = COMMUNICATOR_RATE_HZ;
 	this->systemTree = cmptComms->getSystemTree();
 	this->nodeManagerSubsystemEventConfirmed = false;
+	this->nextHeartbeatTime = ojGetTimeSec();
+	this->nextQueryTime = 0;
 	for(int i = 0; i < MAXIMUM_EVENT_ID; i++)
 	{
 		eventId[i] = false;
@@ -277,9 +279,8 @@ void CommunicatorComponent::readyState()
 	CreateEventMessage createEventMsg = NULL;
 	QueryConfigurationMessage query = NULL;
 	JausMessage txMessage = NULL;
-	static double nextSendTime = 0;
 
-	if(!nodeManagerSubsystemEventConfirmed && ojGetTimeSec() > nextSendTime)
+	if(!nodeManagerSubsystemEventConfirmed && ojGetTimeSec() > nextQueryTime)
 	{
 		// Create query message
 		query = queryConfigurationMessageCreate();
@@ -332,7 +333,7 @@ void CommunicatorComponent::readyState()
 		createEventMessageDestroy(createEventMsg);
 		queryConfigurationMessageDestroy(query);
 		
-		nextSendTime = ojGetTimeSec() + 1.0;
+		nextQueryTime = ojGetTimeSec() + 1.0;
 	}
 }
 
@@ -985,11 +986,10 @@ void CommunicatorComponent::sendSubsystemShutdownEvents()
 
 void CommunicatorComponent::generateHeartbeats()
 {
-	static double nextSendTime = ojGetTimeSec();
 	ReportHeartbeatPulseMessage heartbeat;
 	JausMessage subsHeartbeat;
 	
-	if(ojGetTimeSec() >= nextSendTime)
+	if(ojGetTimeSec() >= nextHeartbeatTime)
 	{
 		heartbeat = reportHeartbeatPulseMessageCreate();
 		if(!heartbeat)
@@ -1020,7 +1020,7 @@ void CommunicatorComponent::generateHeartbeats()
 		subsHeartbeat->destination->instance = 1;
 		this->commMngr->receiveJausMessage(subsHeartbeat, this);
 
-		nextSendTime = ojGetTimeSec() + 1.0;
+		nextHeartbeatTime = ojGetTimeSec() + 1.0;
 		reportHeartbeatPulseMessageDestroy(heartbeat);
 	}
 }
@@ -46,9 +46,15 @@
 #include "nodeManager/JausCommunicationManager.h"
 #include "nodeManager/JausTransportInterface.h"
 
-JausCommunicationManager::JausCommunicationManager(void) {}
+JausCommunicationManager::JausCommunicationManager(void)
+{
+	pthread_mutex_init(&interfaceMapMutex, NULL);
+}
 
-JausCommunicationManager::~JausCommunicationManager(void) {}
+JausCommunicationManager::~JausCommunicationManager(void)
+{
+	pthread_mutex_destroy(&interfaceMapMutex);
+}
 
 unsigned long JausCommunicationManager::getInterfaceCount(void)
 {
@@ -116,4 +122,66 @@ MessageRouter *JausCommunicationManager::getMessageRouter()
 	return this->msgRouter;
 }
 
+void JausCommunicationManager::mergeFlowControlStatus(JausFlowControlStatus *status)
+{
+	std::vector <JausTransportInterface *>::iterator iter;
+	unsigned long freeSpace;
+
+	// The worst interface determines the state of a broadcast
+	for(iter = interfaces.begin(); iter != interfaces.end(); iter++)
+	{
+		freeSpace = (*iter)->queueFreeSpace();
+		if(freeSpace < status->freeSpace)
+		{
+			status->freeSpace = freeSpace;
+		}
+		status->dropCount += (*iter)->queueDropCount();
+		status->congested = status->congested || (*iter)->isCongested();
+	}
+}
+
+void JausCommunicationManager::mergeFlowControlStatus(int interfaceKey, JausFlowControlStatus *status)
+{
+	JausTransportInterface *jtInf = getInterfaceRoute(interfaceKey);
+	unsigned long freeSpace;
+
+	if(jtInf == NULL)
+	{
+		// Route not learned yet, report on every interface it could go out on
+		mergeFlowControlStatus(status);
+		return;
+	}
+
+	freeSpace = jtInf->queueFreeSpace();
+	if(freeSpace < status->freeSpace)
+	{
+		status->freeSpace = freeSpace;
+	}
+	status->dropCount += jtInf->queueDropCount();
+	status->congested = status->congested || jtInf->isCongested();
+}
+
+void JausCommunicationManager::setInterfaceRoute(int interfaceKey, JausTransportInterface *jtInterface)
+{
+	pthread_mutex_lock(&interfaceMapMutex);
+	interfaceMap[interfaceKey] = jtInterface;
+	pthread_mutex_unlock(&interfaceMapMutex);
+}
+
+JausTransportInterface *JausCommunicationManager::getInterfaceRoute(int interfaceKey)
+{
+	HASH_MAP<int, JausTransportInterface *>::iterator iter;
+	JausTransportInterface *jtInterface = NULL;
+
+	pthread_mutex_lock(&interfaceMapMutex);
+	iter = interfaceMap.find(interfaceKey);
+	if(iter != interfaceMap.end())
+	{
+		jtInterface = iter->second;
+	}
+	pthread_mutex_unlock(&interfaceMapMutex);
+
+	return jtInterface;
+}
+
 
@@ -61,6 +61,8 @@ JausComponentCommunicationManager::JausComponentCommunicationManager(FileLoader
 	this->eventHandler = handler;
 	this->interfaces.empty();
 	this->interfaceMap.empty();
+	pthread_mutex_init(&this->largeFrameMutex, NULL);
+	pthread_mutex_init(&this->openJausComponentMutex, NULL);
 
 	// NOTE: These two values should exist in the properties file and should be checked 
 	// in the NodeManager class prior to constructing this object
@@ -82,6 +84,20 @@ JausComponentCommunicationManager::JausComponentCommunicationManager(FileLoader
 		return;
 	}
 
+	// Whole messages up to this size pass between local components in one datagram
+	if(configData->GetConfigDataString("Component_Communications", "Large_Frame_Size_Bytes") == "")
+	{
+		this->largeFrameSizeBytes = JAUS_LARGE_FRAME_MAX_DATA_SIZE_BYTES;
+	}
+	else
+	{
+		this->largeFrameSizeBytes = configData->GetConfigDataInt("Component_Communications", "Large_Frame_Size_Bytes");
+		if(this->largeFrameSizeBytes > JAUS_LARGE_FRAME_MAX_DATA_SIZE_BYTES)
+		{
+			this->largeFrameSizeBytes = JAUS_LARGE_FRAME_MAX_DATA_SIZE_BYTES;
+		}
+	}
+
 	ConfigurationEvent *e = new ConfigurationEvent(__FUNCTION__, __LINE__, "Starting Component Interfaces");
 	this->eventHandler->handleEvent(e);
 
@@ -154,6 +170,8 @@ JausComponentCommunicationManager::~JausComponentCommunicationManager(void)
 	}
 	
 	if(udpCmptInf) delete udpCmptInf;
+	pthread_mutex_destroy(&this->largeFrameMutex);
+	pthread_mutex_destroy(&this->openJausComponentMutex);
 }
 
 bool JausComponentCommunicationManager::startInterfaces(void)
@@ -268,7 +286,7 @@ bool JausComponentCommunicationManager::receiveJausMessage(JausMessage message,
 	}
 
 	// Add this source to our interface table
-	interfaceMap[jausAddressHash(message->source)] = srcInf;
+	setInterfaceRoute(jausAddressHash(message->source), srcInf);
 
 	if(message->destination->subsystem == mySubsystemId)
 	{
@@ -324,9 +342,98 @@ NodeManagerComponent *JausComponentCommunicationManager::getNodeManagerComponent
 	return this->nodeManagerCmpt;
 }
 
+void JausComponentCommunicationManager::checkInOpenJausComponent(int addressHash)
+{
+	pthread_mutex_lock(&this->openJausComponentMutex);
+	this->openJausComponents.insert(addressHash);
+	pthread_mutex_unlock(&this->openJausComponentMutex);
+}
+
+void JausComponentCommunicationManager::checkOutOpenJausComponent(int addressHash)
+{
+	pthread_mutex_lock(&this->openJausComponentMutex);
+	this->openJausComponents.erase(addressHash);
+	pthread_mutex_unlock(&this->openJausComponentMutex);
+}
+
+// Sends a copy of the message to each OpenJAUS component, others on the same interfaces do not see it
+bool JausComponentCommunicationManager::sendToOpenJausComponents(JausMessage message)
+{
+	std::set <int> components;
+	std::set <int>::iterator iter;
+	JausMessage copy;
+
+	if(!message)
+	{
+		// Error: Invalid message
+		ErrorEvent *e = new ErrorEvent(ErrorEvent::NullPointer, __FUNCTION__, __LINE__, "Invalid message pointer");
+		this->eventHandler->handleEvent(e);
+		return false;
+	}
+
+	pthread_mutex_lock(&this->openJausComponentMutex);
+	components = this->openJausComponents;
+	pthread_mutex_unlock(&this->openJausComponentMutex);
+
+	for(iter = components.begin(); iter != components.end(); iter++)
+	{
+		copy = jausMessageClone(message);
+		copy->destination->subsystem = (*iter >> 24) & 0xFF;
+		copy->destination->node = (*iter >> 16) & 0xFF;
+		copy->destination->component = (*iter >> 8) & 0xFF;
+		copy->destination->instance = *iter & 0xFF;
+		sendToComponentX(copy);
+	}
+	jausMessageDestroy(message);
+	return true;
+}
+
+unsigned int JausComponentCommunicationManager::getLargeFrameSizeBytes(void)
+{
+	return this->largeFrameSizeBytes;
+}
+
+// Returns the large frame size the component may use, 0 if it has to send standard packets
+unsigned int JausComponentCommunicationManager::grantLargeFrames(int addressHash, unsigned int requestedSizeBytes)
+{
+	unsigned int grantedSizeBytes = requestedSizeBytes < this->largeFrameSizeBytes? requestedSizeBytes : this->largeFrameSizeBytes;
+
+	pthread_mutex_lock(&this->largeFrameMutex);
+	if(grantedSizeBytes > JAUS_MAX_DATA_SIZE_BYTES)
+	{
+		this->largeFrameComponents.insert(addressHash);
+	}
+	else
+	{
+		this->largeFrameComponents.erase(addressHash);
+		grantedSizeBytes = 0;
+	}
+	pthread_mutex_unlock(&this->largeFrameMutex);
+
+	return grantedSizeBytes;
+}
+
+void JausComponentCommunicationManager::revokeLargeFrames(int addressHash)
+{
+	pthread_mutex_lock(&this->largeFrameMutex);
+	this->largeFrameComponents.erase(addressHash);
+	pthread_mutex_unlock(&this->largeFrameMutex);
+}
+
+bool JausComponentCommunicationManager::acceptsLargeFrames(int addressHash)
+{
+	bool accepts;
+
+	pthread_mutex_lock(&this->largeFrameMutex);
+	accepts = this->largeFrameComponents.count(addressHash) > 0;
+	pthread_mutex_unlock(&this->largeFrameMutex);
+
+	return accepts;
+}
+
 bool JausComponentCommunicationManager::sendToComponentX(JausMessage message)
 {
-	HASH_MAP<int, JausTransportInterface *>::iterator iter;
+	JausTransportInterface *jtInf;
 
 	if(!message)
 	{
@@ -345,17 +452,17 @@ bool JausComponentCommunicationManager::sendToComponentX(JausMessage message)
 		lookupAddress->subsystem = mySubsystemId;
 		lookupAddress->node = myNodeId;
 
-		iter = interfaceMap.find(jausAddressHash(lookupAddress));
+		jtInf = getInterfaceRoute(jausAddressHash(lookupAddress));
 		jausAddressDestroy(lookupAddress);
 	}
 	else
 	{
-		iter = interfaceMap.find(jausAddressHash(message->destination));
+		jtInf = getInterfaceRoute(jausAddressHash(message->destination));
 	}
 	
-	if(iter != interfaceMap.end())
+	if(jtInf)
 	{
-		iter->second->queueJausMessage(message);
+		jtInf->queueJausMessage(message);
 		return true;
 	}
 	else
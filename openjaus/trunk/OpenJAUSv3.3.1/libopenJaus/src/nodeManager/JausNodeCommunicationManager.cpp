@@ -312,7 +312,7 @@ bool JausNodeCommunicationManager::receiveJausMessage(JausMessage message, JausT
 			if(message->source->subsystem == mySubsystemId)
 			{
 				// Put Interface data on the map
-				interfaceMap[message->source->node] = srcInf;
+				setInterfaceRoute(message->source->node, srcInf);
 			}
 			else
 			{
@@ -404,7 +404,7 @@ bool JausNodeCommunicationManager::sendToSubsystemGateway(JausMessage message)
 	else if(myNodeId != JAUS_PRIMARY_NODE_MANAGER_NODE)
 	{
 		// Send to the Primary Node Manager (note this is mainly for backwards compatibility)
-		JausTransportInterface *jtInf = interfaceMap[JAUS_PRIMARY_NODE_MANAGER_NODE];
+		JausTransportInterface *jtInf = getInterfaceRoute(JAUS_PRIMARY_NODE_MANAGER_NODE);
 		if(jtInf)
 		{
 			jtInf->queueJausMessage(message);
@@ -437,7 +437,7 @@ bool JausNodeCommunicationManager::sendToNodeX(JausMessage message)
 		return false;
 	}
 
-	JausTransportInterface *jtInf = interfaceMap[message->destination->node];
+	JausTransportInterface *jtInf = getInterfaceRoute(message->destination->node);
 	if(jtInf)
 	{
 		jtInf->queueJausMessage(message);
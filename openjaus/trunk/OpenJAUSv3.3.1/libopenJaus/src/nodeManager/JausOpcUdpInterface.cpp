@@ -262,7 +262,7 @@ bool JausOpcUdpInterface::processMessage(JausMessage message)
 					HASH_MAP<int, OpcUdpTransportData>::iterator iter;
 					for(iter = addressMap.begin(); iter != addressMap.end(); iter++)
 					{
-						sendJausMessage(iter->second, message);
+						sendJausMessage(iter->second, message, acceptsLargeFrames(iter->first));
 					}
 					jausMessageDestroy(message);
 					return true;
@@ -273,7 +273,7 @@ bool JausOpcUdpInterface::processMessage(JausMessage message)
 				// Unicast
 				if(addressMap.find(jausAddressHash(message->destination)) != addressMap.end())
 				{
-					sendJausMessage(addressMap.find(jausAddressHash(message->destination))->second, message);
+					sendJausMessage(addressMap.find(jausAddressHash(message->destination))->second, message, acceptsLargeFrames(jausAddressHash(message->destination)));
 					jausMessageDestroy(message);
 					return true;
 				}
@@ -294,6 +294,29 @@ bool JausOpcUdpInterface::processMessage(JausMessage message)
 	}
 }
 
+// Local components which asked for large frames get messages from other local components whole
+unsigned int JausOpcUdpInterface::getMaxDataSizeBytes(void)
+{
+	if(this->type == COMPONENT_INTERFACE)
+	{
+		unsigned int largeFrameSizeBytes = ((JausComponentCommunicationManager *)this->commMngr)->getLargeFrameSizeBytes();
+		if(largeFrameSizeBytes > JAUS_MAX_DATA_SIZE_BYTES)
+		{
+			return largeFrameSizeBytes;
+		}
+	}
+	return JAUS_MAX_DATA_SIZE_BYTES;
+}
+
+bool JausOpcUdpInterface::acceptsLargeFrames(int addressHash)
+{
+	if(this->type == COMPONENT_INTERFACE)
+	{
+		return ((JausComponentCommunicationManager *)this->commMngr)->acceptsLargeFrames(addressHash);
+	}
+	return false;
+}
+
 void JausOpcUdpInterface::run()
 {
 	// Lock our mutex
@@ -301,7 +324,11 @@ void JausOpcUdpInterface::run()
 
 	while(this->running)
 	{
-		pthread_cond_wait(&threadConditional, &threadMutex);
+		// Messages queued while we were sending did not see us waiting
+		if(this->queue.isEmpty())
+		{
+			pthread_cond_wait(&threadConditional, &threadMutex);
+		}
 		
 		while(!this->queue.isEmpty())
 		{
@@ -339,8 +366,15 @@ bool JausOpcUdpInterface::openSocket(void)
 	{
 		case SUBSYSTEM_INTERFACE:
 			// Read Subsystem UDP Parameters
-			// Port is constant per JAUS Standard
-			this->portNumber = JAUS_OPC_UDP_DATA_PORT;
+			// Port defaults to the JAUS Standard port, it is only changed to run several node managers on one host
+			if(this->configData->GetConfigDataString("Subsystem_Communications", "JAUS_OPC_UDP_Port") == "")
+			{
+				this->portNumber = JAUS_OPC_UDP_DATA_PORT;
+			}
+			else
+			{
+				this->portNumber = this->configData->GetConfigDataInt("Subsystem_Communications", "JAUS_OPC_UDP_Port");
+			}
 
 			// IP Address
 			if(this->configData->GetConfigDataString("Subsystem_Communications", "JAUS_OPC_UDP_IP_Address") == "")
@@ -411,8 +445,15 @@ bool JausOpcUdpInterface::openSocket(void)
 
 		case NODE_INTERFACE:
 			// Setup Node Configuration
-			// Port is constant per JAUS Standard
-			this->portNumber = JAUS_OPC_UDP_DATA_PORT;
+			// Port defaults to the JAUS Standard port, it is only changed to run several node managers on one host
+			if(this->configData->GetConfigDataString("Node_Communications", "JAUS_OPC_UDP_Port") == "")
+			{
+				this->portNumber = JAUS_OPC_UDP_DATA_PORT;
+			}
+			else
+			{
+				this->portNumber = this->configData->GetConfigDataInt("Node_Communications", "JAUS_OPC_UDP_Port");
+			}
 
 			// IP Address
 			if(this->configData->GetConfigDataString("Node_Communications", "JAUS_OPC_UDP_IP_Address") == "")
@@ -638,10 +679,23 @@ bool JausOpcUdpInterface::openSocket(void)
 	return true;
 }
 
-void JausOpcUdpInterface::sendJausMessage(OpcUdpTransportData data, JausMessage message)
+void JausOpcUdpInterface::sendJausMessage(OpcUdpTransportData data, JausMessage message, bool largeFrame)
 {
-	DatagramPacket packet = NULL;
-	int result;
+	DatagramPacket packet = NULL;
+	int result;
+
+	if(message->dataSize > JAUS_MAX_DATA_SIZE_BYTES && !largeFrame)
+	{
+		// This peer only takes standard packets
+		unsigned int packetCount = jausMessagePacketCount(message);
+		for(unsigned int i = 0; i < packetCount; i++)
+		{
+			JausMessage packetMessage = jausMessagePacketCreate(message, i);
+			sendJausMessage(data, packetMessage);
+			jausMessageDestroy(packetMessage);
+		}
+		return;
+	}
 
 	JausMessage tempMessage = jausMessageClone(message);
 	JausMessageEvent *e = new JausMessageEvent(tempMessage, this, JausMessageEvent::Outbound);
@@ -669,14 +723,26 @@ void JausOpcUdpInterface::sendJausMessage(OpcUdpTransportData data, JausMessage
 
 		case COMPONENT_INTERFACE:
 			packet = datagramPacketCreate();
-			packet->bufferSizeBytes = (int) jausMessageSize(message);
-			packet->buffer = (unsigned char *) calloc(packet->bufferSizeBytes, 1);
 			packet->port = data.port;
 			packet->address->value = data.addressValue;
 
-			if(jausMessageToBuffer(message, packet->buffer, packet->bufferSizeBytes))
+			if(message->dataSize > JAUS_MAX_DATA_SIZE_BYTES)
 			{
-				result = multicastSocketSend(this->socket, packet);
+				packet->bufferSizeBytes = (int) jausMessageLargeFrameSize(message);
+				packet->buffer = (unsigned char *) calloc(packet->bufferSizeBytes, 1);
+				if(jausMessageToLargeFrame(message, packet->buffer, packet->bufferSizeBytes))
+				{
+					result = multicastSocketSend(this->socket, packet);
+				}
+			}
+			else
+			{
+				packet->bufferSizeBytes = (int) jausMessageSize(message);
+				packet->buffer = (unsigned char *) calloc(packet->bufferSizeBytes, 1);
+				if(jausMessageToBuffer(message, packet->buffer, packet->bufferSizeBytes))
+				{
+					result = multicastSocketSend(this->socket, packet);
+				}
 			}
 
 			free(packet->buffer);
@@ -717,19 +783,33 @@ void JausOpcUdpInterface::recvThreadRun()
 	OpcUdpTransportData data;
 	int index = 0;
 	long bytesRecv = 0;
+	bool largeFrame = false;
 
 	packet = datagramPacketCreate();
-	packet->bufferSizeBytes = JAUS_HEADER_SIZE_BYTES + JAUS_MAX_DATA_SIZE_BYTES + JAUS_OPC_UDP_HEADER_SIZE_BYTES;
-	packet->buffer = (unsigned char *) calloc(packet->bufferSizeBytes, 1);
+	if(this->type == COMPONENT_INTERFACE)
+	{
+		packet->bufferSizeBytes = JAUS_LARGE_FRAME_HEADER_SIZE_BYTES + JAUS_HEADER_SIZE_BYTES + JAUS_LARGE_FRAME_MAX_DATA_SIZE_BYTES;
+	}
+	else
+	{
+		packet->bufferSizeBytes = JAUS_HEADER_SIZE_BYTES + JAUS_MAX_DATA_SIZE_BYTES + JAUS_OPC_UDP_HEADER_SIZE_BYTES;
+	}
+	packet->buffer = (unsigned char *) calloc(packet->bufferSizeBytes, 1);
 	
 	while(this->running)
 	{
 		index = 0;
+		largeFrame = false;
 		bytesRecv = multicastSocketReceive(this->socket, packet);
 		
 		if(bytesRecv > 0)
 		{
-			if(!strncmp((char *)packet->buffer, JAUS_OPC_UDP_HEADER, JAUS_OPC_UDP_HEADER_SIZE_BYTES)) // equals 1 if same
+			if(this->type == COMPONENT_INTERFACE && jausMessageIsLargeFrame(packet->buffer, bytesRecv))
+			{
+				// Whole message from a local component
+				largeFrame = true;
+			}
+			else if(!strncmp((char *)packet->buffer, JAUS_OPC_UDP_HEADER, JAUS_OPC_UDP_HEADER_SIZE_BYTES)) // equals 1 if same
 			{
 				index += JAUS_OPC_UDP_HEADER_SIZE_BYTES;
 			}
@@ -743,7 +823,7 @@ void JausOpcUdpInterface::recvThreadRun()
 			}
 
 			rxMessage = jausMessageCreate();
-			if(jausMessageFromBuffer(rxMessage, packet->buffer + index, packet->bufferSizeBytes - index))
+			if(largeFrame? jausMessageFromLargeFrame(rxMessage, packet->buffer, bytesRecv) : jausMessageFromBuffer(rxMessage, packet->buffer + index, packet->bufferSizeBytes - index))
 			{
 				JausMessage tempMessage = jausMessageClone(rxMessage);
 				JausMessageEvent *e = new JausMessageEvent(tempMessage, this, JausMessageEvent::Inbound);
@@ -754,13 +834,13 @@ void JausOpcUdpInterface::recvThreadRun()
 				{
 					case SUBSYSTEM_INTERFACE:
 						data.addressValue = packet->address->value;
-						data.port = JAUS_OPC_UDP_DATA_PORT;
+						data.port = packet->port;
 						this->addressMap[rxMessage->source->subsystem] = data;
 						break;
 
 					case NODE_INTERFACE:
 						data.addressValue = packet->address->value;
-						data.port = JAUS_OPC_UDP_DATA_PORT;
+						data.port = packet->port;
 						if(rxMessage->source->subsystem == mySubsystemId)
 						{
 							this->addressMap[rxMessage->source->node] = data;
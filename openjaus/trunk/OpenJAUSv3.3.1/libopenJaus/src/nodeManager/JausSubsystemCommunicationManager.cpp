@@ -250,7 +250,7 @@ bool JausSubsystemCommunicationManager::receiveJausMessage(JausMessage message,
 	}
 
 	// Ok, this is a valid source. Add/Update its interface on the map
-	interfaceMap[message->source->subsystem] = srcInf;
+	setInterfaceRoute(message->source->subsystem, srcInf);
 
 	if(	message->destination->subsystem == mySubsystemId ||
 		message->destination->subsystem == JAUS_BROADCAST_SUBSYSTEM_ID)
@@ -279,7 +279,7 @@ bool JausSubsystemCommunicationManager::sendToSubsystemX(JausMessage message)
 	}
 
 	// Route to subsystem X
-	JausTransportInterface *jtInf = interfaceMap[message->destination->subsystem];
+	JausTransportInterface *jtInf = getInterfaceRoute(message->destination->subsystem);
 	if(jtInf)
 	{
 		jtInf->queueJausMessage(message);
@@ -47,6 +47,7 @@
 JausTransportInterface::JausTransportInterface(void)
 {
 	this->running = false;
+	this->configData = NULL;
 }
 
 JausTransportInterface::~JausTransportInterface(void) {}
@@ -85,6 +86,9 @@ void JausTransportInterface::startThread()
 	int retVal;
 	char errorString[128] = {0};
 	
+	// Bound the outgoing queue before the thread starts servicing it
+	configureQueue();
+
 	retVal = pthread_cond_init(&this->threadConditional, NULL); 
 	if(retVal != 0)
 	{
@@ -138,17 +142,88 @@ unsigned long JausTransportInterface::queueSize()
 	return this->queue.size();
 }
 
-void JausTransportInterface::queueJausMessage(JausMessage message)
+bool JausTransportInterface::queueJausMessage(JausMessage message)
 {
-	if(this->running)
+	bool retVal = false;
+
+	if(this->running && message->dataSize > this->getMaxDataSizeBytes())
 	{
-		this->queue.push(message);
+		// Too large for one frame of this transport, it goes out as a standard packet set
+		unsigned int packetCount = jausMessagePacketCount(message);
+
+		retVal = true;
+		for(unsigned int i = 0; i < packetCount; i++)
+		{
+			retVal = this->queue.push(jausMessagePacketCreate(message, i)) && retVal;
+		}
+		wakeThread();
+		jausMessageDestroy(message);
+	}
+	else if(this->running)
+	{
+		// The queue destroys the message itself if it is full
+		retVal = this->queue.push(message);
 		wakeThread();
 	}
 	else
 	{
 		jausMessageDestroy(message);
 	}
+	return retVal;
+}
+
+// Largest message data this transport sends in one frame
+unsigned int JausTransportInterface::getMaxDataSizeBytes(void)
+{
+	return JAUS_MAX_DATA_SIZE_BYTES;
+}
+
+void JausTransportInterface::setQueueMaxSize(unsigned long maxSize)
+{
+	this->queue.setMaxSize(maxSize);
+}
+
+unsigned long JausTransportInterface::queueFreeSpace()
+{
+	return this->queue.getFreeSpace();
+}
+
+unsigned long JausTransportInterface::queueDropCount()
+{
+	return this->queue.getDropCount();
+}
+
+bool JausTransportInterface::isCongested()
+{
+	return this->queue.isCongested();
+}
+
+void JausTransportInterface::configureQueue()
+{
+	std::string section;
+
+	switch(this->type)
+	{
+		case SUBSYSTEM_INTERFACE:
+			section = "Subsystem_Communications";
+			break;
+
+		case NODE_INTERFACE:
+			section = "Node_Communications";
+			break;
+
+		case COMPONENT_INTERFACE:
+			section = "Component_Communications";
+			break;
+
+		default:
+			return;
+	}
+
+	if(this->configData && this->configData->GetConfigDataString(section, "Queue_Max_Size") != "")
+	{
+		this->queue.setMaxSize(this->configData->GetConfigDataInt(section, "Queue_Max_Size"));
+	}
 }
 
 void JausTransportInterface::wakeThread()
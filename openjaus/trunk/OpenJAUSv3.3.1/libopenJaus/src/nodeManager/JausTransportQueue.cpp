@@ -48,6 +48,9 @@
 JausTransportQueue::JausTransportQueue(void)
 {
 	pthread_mutex_init(&mutex, NULL);
+	this->dropCount = 0;
+	this->congested = false;
+	this->setMaxSize(JAUS_TRANSPORT_QUEUE_DEFAULT_MAX_SIZE);
 }
 
 JausTransportQueue::~JausTransportQueue(void)
@@ -65,15 +68,30 @@ void JausTransportQueue::emptyQueue(void)
 		list.pop();
 		jausMessageDestroy(out);
 	}
+	this->congested = false;
 
 	pthread_mutex_unlock(&mutex);
 }
 
-void JausTransportQueue::push(JausMessage inc)
+bool JausTransportQueue::push(JausMessage inc)
 {
 	pthread_mutex_lock(&mutex);
+	if(this->maxSize && list.size() >= this->maxSize)
+	{
+		// Queue is full, the newest message is dropped so that the
+		// messages already accepted are delivered in order
+		this->dropCount++;
+		this->congested = true;
+		pthread_mutex_unlock(&mutex);
+
+		jausMessageDestroy(inc);
+		return false;
+	}
+
 	list.push(inc);
+	updateCongestion();
 	pthread_mutex_unlock(&mutex);
+	return true;
 }
 
 JausMessage JausTransportQueue::pop(void)
@@ -83,6 +101,7 @@ JausMessage JausTransportQueue::pop(void)
 	{
 		JausMessage out = list.front();
 		list.pop();
+		updateCongestion();
 
 		pthread_mutex_unlock(&mutex);
 		return out;
@@ -103,3 +122,72 @@ unsigned long JausTransportQueue::size()
 	return (unsigned long)list.size();
 }
 
+void JausTransportQueue::setMaxSize(unsigned long maxSize)
+{
+	pthread_mutex_lock(&mutex);
+	this->maxSize = maxSize;
+	this->highWatermark = (unsigned long)(JAUS_TRANSPORT_QUEUE_HIGH_WATERMARK * maxSize);
+	this->lowWatermark = (unsigned long)(JAUS_TRANSPORT_QUEUE_LOW_WATERMARK * maxSize);
+	if(maxSize && !this->highWatermark)
+	{
+		this->highWatermark = maxSize;
+	}
+	updateCongestion();
+	pthread_mutex_unlock(&mutex);
+}
+
+unsigned long JausTransportQueue::getMaxSize(void)
+{
+	return this->maxSize;
+}
+
+unsigned long JausTransportQueue::getFreeSpace(void)
+{
+	unsigned long freeSpace;
+
+	pthread_mutex_lock(&mutex);
+	if(!this->maxSize)
+	{
+		freeSpace = (unsigned long)-1;
+	}
+	else if(this->congested)
+	{
+		// Do not hand out space while above the watermark, this keeps producers
+		// from oscillating around the high watermark
+		freeSpace = 0;
+	}
+	else
+	{
+		freeSpace = this->highWatermark - (unsigned long)list.size();
+	}
+	pthread_mutex_unlock(&mutex);
+
+	return freeSpace;
+}
+
+unsigned long JausTransportQueue::getDropCount(void)
+{
+	return this->dropCount;
+}
+
+bool JausTransportQueue::isCongested(void)
+{
+	return this->congested;
+}
+
+// Note: Caller must hold the mutex
+void JausTransportQueue::updateCongestion(void)
+{
+	if(!this->maxSize)
+	{
+		this->congested = false;
+	}
+	else if(list.size() >= this->highWatermark)
+	{
+		this->congested = true;
+	}
+	else if(list.size() <= this->lowWatermark)
+	{
+		this->congested = false;
+	}
+}
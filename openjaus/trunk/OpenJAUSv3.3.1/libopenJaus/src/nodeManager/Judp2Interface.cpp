@@ -78,6 +78,15 @@ Judp2Interface::Judp2Interface(FileLoader *configData, EventHandler *handler, Ja
 		{
 			this->hostIpAddress = inetAddressGetByString((char *)this->configData->GetConfigDataString("Subsystem_Communications", "System_Host").c_str());
 		}
+
+		if(this->configData->GetConfigDataString("Subsystem_Communications", "System_Host_Port") == "")
+		{
+			this->hostPort = JUDP2_DATA_PORT;
+		}
+		else
+		{
+			this->hostPort = this->configData->GetConfigDataInt("Subsystem_Communications", "System_Host_Port");
+		}
 	}
 	else if(dynamic_cast<JausNodeCommunicationManager *>(this->commMngr))
 	{
@@ -321,7 +330,11 @@ void Judp2Interface::run()
 
 	while(this->running)
 	{
-		pthread_cond_wait(&threadConditional, &threadMutex);
+		// Messages queued while we were sending did not see us waiting
+		if(this->queue.isEmpty())
+		{
+			pthread_cond_wait(&threadConditional, &threadMutex);
+		}
 		
 		while(!this->queue.isEmpty())
 		{
@@ -363,7 +376,14 @@ bool Judp2Interface::openSocket(void)
 	{
 		case SUBSYSTEM_INTERFACE:
 			communicationLevelString = "Subsystem_Communications";
-			this->portNumber = JUDP2_DATA_PORT;
+			if(this->configData->GetConfigDataString(communicationLevelString, "JUDP2_Port") == "")
+			{
+				this->portNumber = JUDP2_DATA_PORT;
+			}
+			else
+			{
+				this->portNumber = this->configData->GetConfigDataInt(communicationLevelString, "JUDP2_Port");
+			}
 			socketTimeoutSec = JUDP2_DEFAULT_SUBSYSTEM_UDP_TIMEOUT_SEC;
 			socketTTL = JUDP2_DEFAULT_SUBSYSTEM_TTL;
 			this->multicast = JUDP2_DEFAULT_SUBSYSTEM_MULTICAST;
@@ -373,7 +393,14 @@ bool Judp2Interface::openSocket(void)
 			
 		case NODE_INTERFACE:
 			communicationLevelString = "Node_Communications";
-			this->portNumber = JUDP2_DATA_PORT;
+			if(this->configData->GetConfigDataString(communicationLevelString, "JUDP2_Port") == "")
+			{
+				this->portNumber = JUDP2_DATA_PORT;
+			}
+			else
+			{
+				this->portNumber = this->configData->GetConfigDataInt(communicationLevelString, "JUDP2_Port");
+			}
 			socketTimeoutSec = JUDP2_DEFAULT_NODE_UDP_TIMEOUT_SEC;
 			socketTTL = JUDP2_DEFAULT_NODE_TTL;
 			this->multicast = JUDP2_DEFAULT_NODE_MULTICAST;
@@ -615,7 +642,7 @@ void Judp2Interface::recvThreadRun()
 		txMsg->source->component = 1;
 		txMsg->source->instance = 1;	
 		data.addressValue = this->hostIpAddress->value;
-		data.port = JUDP2_DATA_PORT;
+		data.port = this->hostPort;
 		this->sendJausMessage(data, txMsg);
 		queryTransportAddressesMessageDestroy(query);
 		jausMessageDestroy(txMsg);
@@ -728,7 +755,7 @@ void Judp2Interface::recvThreadRun()
 
 						case NODE_INTERFACE:
 							data.addressValue = packet->address->value;
-							data.port = JUDP_DATA_PORT;
+							data.port = packet->port;
 							if(rxMessage->source->subsystem == mySubsystemId)
 							{
 								this->addressMap[rxMessage->source->node] = data;
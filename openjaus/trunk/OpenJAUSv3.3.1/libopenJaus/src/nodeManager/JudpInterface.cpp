@@ -48,6 +48,7 @@
 #include "nodeManager/JausComponentCommunicationManager.h"
 #include "nodeManager/events/ErrorEvent.h"
 #include "nodeManager/events/JausMessageEvent.h"
+#include "utils/timeLib.h"
 
 JudpInterface::JudpInterface(FileLoader *configData, EventHandler *handler, JausCommunicationManager *commMngr)
 {
@@ -57,6 +58,9 @@ JudpInterface::JudpInterface(FileLoader *configData, EventHandler *handler, Jaus
 	this->configData = configData;
 	this->multicast = false;
 	this->subsystemGatewayDiscovered = false;
+	this->peerTimeoutSec = 0;
+	this->nextEvictionTime = 0;
+	pthread_rwlock_init(&this->addressMapLock, NULL);
 	
 	// Determine the type of our commMngr
 	if(dynamic_cast<JausSubsystemCommunicationManager  *>(this->commMngr))
@@ -129,6 +133,7 @@ JudpInterface::~JudpInterface(void)
 		this->stopInterface();
 	}
 	this->closeSocket();
+	pthread_rwlock_destroy(&this->addressMapLock);
 
 	// TODO: Check our threadIds to see if they terminated properly
 }
@@ -140,6 +145,9 @@ InetAddress JudpInterface::getInetAddress(void)
 
 bool JudpInterface::processMessage(JausMessage message)
 {
+	JudpTransportData data;
+	bool gatewayDiscovered;
+
 	switch(this->type)
 	{
 		case SUBSYSTEM_INTERFACE:
@@ -156,11 +164,7 @@ bool JudpInterface::processMessage(JausMessage message)
 				else
 				{
 					// Unicast to all known subsystems
-					HASH_MAP<int, JudpTransportData>::iterator iter;
-					for(iter = addressMap.begin(); iter != addressMap.end(); iter++)
-					{
-						sendJausMessage(iter->second, message);
-					}
+					sendToAllPeers(message);
 					jausMessageDestroy(message);
 					return true;
 				}
@@ -168,9 +172,9 @@ bool JudpInterface::processMessage(JausMessage message)
 			else
 			{
 				// Unicast
-				if(addressMap.find(message->destination->subsystem) != addressMap.end())
+				if(findPeer(message->destination->subsystem, &data))
 				{
-					sendJausMessage(addressMap.find(message->destination->subsystem)->second, message);
+					sendJausMessage(data, message);
 					jausMessageDestroy(message);
 					return true;
 				}
@@ -200,11 +204,7 @@ bool JudpInterface::processMessage(JausMessage message)
 					else
 					{
 						// Unicast to all known nodes
-						HASH_MAP<int, JudpTransportData>::iterator iter;
-						for(iter = addressMap.begin(); iter != addressMap.end(); iter++)
-						{
-							sendJausMessage(iter->second, message);
-						}
+						sendToAllPeers(message);
 						jausMessageDestroy(message);
 						return true;
 					}
@@ -212,9 +212,9 @@ bool JudpInterface::processMessage(JausMessage message)
 				else
 				{
 					// Unicast
-					if(addressMap.find(message->destination->node) != addressMap.end())
+					if(findPeer(message->destination->node, &data))
 					{
-						sendJausMessage(addressMap.find(message->destination->node)->second, message);
+						sendJausMessage(data, message);
 						jausMessageDestroy(message);
 						return true;
 					}
@@ -229,9 +229,14 @@ bool JudpInterface::processMessage(JausMessage message)
 			else
 			{
 				// Message for other subsystem
-				if(subsystemGatewayDiscovered)
+				pthread_rwlock_rdlock(&this->addressMapLock);
+				gatewayDiscovered = this->subsystemGatewayDiscovered;
+				data = this->subsystemGatewayData;
+				pthread_rwlock_unlock(&this->addressMapLock);
+
+				if(gatewayDiscovered)
 				{
-					sendJausMessage(subsystemGatewayData, message);
+					sendJausMessage(data, message);
 					jausMessageDestroy(message);
 					return true;
 				}
@@ -259,11 +264,7 @@ bool JudpInterface::processMessage(JausMessage message)
 				else
 				{
 					// Unicast to all known subsystems
-					HASH_MAP<int, JudpTransportData>::iterator iter;
-					for(iter = addressMap.begin(); iter != addressMap.end(); iter++)
-					{
-						sendJausMessage(iter->second, message);
-					}
+					sendToAllPeers(message);
 					jausMessageDestroy(message);
 					return true;
 				}
@@ -271,9 +272,9 @@ bool JudpInterface::processMessage(JausMessage message)
 			else
 			{
 				// Unicast
-				if(addressMap.find(jausAddressHash(message->destination)) != addressMap.end())
+				if(findPeer(jausAddressHash(message->destination), &data))
 				{
-					sendJausMessage(addressMap.find(jausAddressHash(message->destination))->second, message);
+					sendJausMessage(data, message);
 					jausMessageDestroy(message);
 					return true;
 				}
@@ -301,7 +302,11 @@ void JudpInterface::run()
 
 	while(this->running)
 	{
-		pthread_cond_wait(&threadConditional, &threadMutex);
+		// Messages queued while we were sending did not see us waiting
+		if(this->queue.isEmpty())
+		{
+			pthread_cond_wait(&threadConditional, &threadMutex);
+		}
 		
 		while(!this->queue.isEmpty())
 		{
@@ -339,8 +344,21 @@ bool JudpInterface::openSocket(void)
 	{
 		case SUBSYSTEM_INTERFACE:
 			// Read Subsystem UDP Parameters
-			// Port is constant per JAUS Standard
-			this->portNumber = JUDP_DATA_PORT;
+			// Port defaults to the JAUS Standard port, it is only changed to run several node managers on one host
+			if(this->configData->GetConfigDataString("Subsystem_Communications", "JUDP_Port") == "")
+			{
+				this->portNumber = JUDP_DATA_PORT;
+			}
+			else
+			{
+				this->portNumber = this->configData->GetConfigDataInt("Subsystem_Communications", "JUDP_Port");
+			}
+
+			// Peers to unicast broadcasts to when multicast is not available
+			if(!this->readStaticPeers("Subsystem_Communications"))
+			{
+				return false;
+			}
 
 			// IP Address
 			if(this->configData->GetConfigDataString("Subsystem_Communications", "JUDP_IP_Address") == "")
@@ -375,6 +393,16 @@ bool JudpInterface::openSocket(void)
 				socketTimeoutSec = this->configData->GetConfigDataDouble("Subsystem_Communications", "JUDP_Timeout_Sec");
 			}
 
+			// Peers not heard from within this time are dropped from the address map, 0 disables aging
+			if(this->configData->GetConfigDataString("Subsystem_Communications", "JUDP_Peer_Timeout_Sec") == "")
+			{
+				this->peerTimeoutSec = JUDP_DEFAULT_SUBSYSTEM_PEER_TIMEOUT_SEC;
+			}
+			else
+			{
+				this->peerTimeoutSec = this->configData->GetConfigDataDouble("Subsystem_Communications", "JUDP_Peer_Timeout_Sec");
+			}
+
 			// TTL
 			if(this->configData->GetConfigDataString("Subsystem_Communications", "JUDP_TTL") == "")
 			{
@@ -421,8 +449,21 @@ bool JudpInterface::openSocket(void)
 
 		case NODE_INTERFACE:
 			// Setup Node Configuration
-			// Port is constant per JAUS Standard
-			this->portNumber = JUDP_DATA_PORT;
+			// Port defaults to the JAUS Standard port, it is only changed to run several node managers on one host
+			if(this->configData->GetConfigDataString("Node_Communications", "JUDP_Port") == "")
+			{
+				this->portNumber = JUDP_DATA_PORT;
+			}
+			else
+			{
+				this->portNumber = this->configData->GetConfigDataInt("Node_Communications", "JUDP_Port");
+			}
+
+			// Peers to unicast broadcasts to when multicast is not available
+			if(!this->readStaticPeers("Node_Communications"))
+			{
+				return false;
+			}
 
 			// IP Address
 			if(this->configData->GetConfigDataString("Node_Communications", "JUDP_IP_Address") == "")
@@ -457,6 +498,16 @@ bool JudpInterface::openSocket(void)
 				socketTimeoutSec = this->configData->GetConfigDataDouble("Node_Communications", "JUDP_Timeout_Sec");
 			}
 
+			// Peers not heard from within this time are dropped from the address map, 0 disables aging
+			if(this->configData->GetConfigDataString("Node_Communications", "JUDP_Peer_Timeout_Sec") == "")
+			{
+				this->peerTimeoutSec = JUDP_DEFAULT_NODE_PEER_TIMEOUT_SEC;
+			}
+			else
+			{
+				this->peerTimeoutSec = this->configData->GetConfigDataDouble("Node_Communications", "JUDP_Peer_Timeout_Sec");
+			}
+
 			// TTL
 			if(this->configData->GetConfigDataString("Node_Communications", "JUDP_TTL") == "")
 			{
@@ -553,6 +604,16 @@ bool JudpInterface::openSocket(void)
 				socketTimeoutSec = this->configData->GetConfigDataDouble("Component_Communications", "JUDP_Timeout_Sec");
 			}
 
+			// Peers not heard from within this time are dropped from the address map, 0 disables aging
+			if(this->configData->GetConfigDataString("Component_Communications", "JUDP_Peer_Timeout_Sec") == "")
+			{
+				this->peerTimeoutSec = JUDP_DEFAULT_COMPONENT_PEER_TIMEOUT_SEC;
+			}
+			else
+			{
+				this->peerTimeoutSec = this->configData->GetConfigDataDouble("Component_Communications", "JUDP_Peer_Timeout_Sec");
+			}
+
 			// TTL
 			if(this->configData->GetConfigDataString("Component_Communications", "JUDP_TTL") == "")
 			{
@@ -655,6 +716,7 @@ bool JudpInterface::openSocket(void)
 		// Setup Multicast UdpData
 		multicastData.addressValue = multicastGroup->value;
 		multicastData.port = this->socket->port;
+		multicastData.lastSeenTime = 0;
 		
 		inetAddressDestroy(this->multicastGroup);
 	}
@@ -707,6 +769,208 @@ void JudpInterface::sendJausMessage(JudpTransportData data, JausMessage message)
 	}
 }
 
+void JudpInterface::sendToAllPeers(JausMessage message)
+{
+	HASH_MAP<int, JudpTransportData>::iterator iter;
+	std::vector<JudpTransportData> peers;
+	std::vector<JudpTransportData>::iterator peer;
+	std::vector<JudpTransportData>::iterator livePeer;
+	double now = ojGetTimeSec();
+	bool known;
+
+	// Copy the live peers out so the sends are not made holding the lock
+	pthread_rwlock_rdlock(&this->addressMapLock);
+	peers.reserve(addressMap.size());
+	for(iter = addressMap.begin(); iter != addressMap.end(); iter++)
+	{
+		if(isPeerAlive(&iter->second, now))
+		{
+			peers.push_back(iter->second);
+		}
+	}
+	pthread_rwlock_unlock(&this->addressMapLock);
+
+	for(livePeer = peers.begin(); livePeer != peers.end(); livePeer++)
+	{
+		sendJausMessage(*livePeer, message);
+	}
+
+	// Static peers which have not been heard from yet, or have gone silent, are still probed
+	for(peer = staticPeers.begin(); peer != staticPeers.end(); peer++)
+	{
+		known = false;
+		for(livePeer = peers.begin(); livePeer != peers.end(); livePeer++)
+		{
+			if(livePeer->addressValue == peer->addressValue && livePeer->port == peer->port)
+			{
+				known = true;
+				break;
+			}
+		}
+
+		if(!known)
+		{
+			sendJausMessage(*peer, message);
+		}
+	}
+}
+
+bool JudpInterface::isStaticPeer(unsigned int addressValue, unsigned short port)
+{
+	std::vector<JudpTransportData>::iterator peer;
+
+	for(peer = staticPeers.begin(); peer != staticPeers.end(); peer++)
+	{
+		if(peer->addressValue == addressValue && peer->port == port)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool JudpInterface::isPeerAlive(JudpTransportData *data, double now)
+{
+	return this->peerTimeoutSec <= 0 || data->lastSeenTime + this->peerTimeoutSec >= now;
+}
+
+bool JudpInterface::findPeer(int key, JudpTransportData *data)
+{
+	HASH_MAP<int, JudpTransportData>::iterator iter;
+	bool found = false;
+
+	pthread_rwlock_rdlock(&this->addressMapLock);
+	iter = addressMap.find(key);
+	if(iter != addressMap.end())
+	{
+		*data = iter->second;
+		found = true;
+	}
+	pthread_rwlock_unlock(&this->addressMapLock);
+
+	return found;
+}
+
+void JudpInterface::updatePeer(int key, JudpTransportData data)
+{
+	HASH_MAP<int, JudpTransportData>::iterator iter;
+
+	// Most packets come from known peers, only take the write lock when the entry
+	// changes or its last seen time is getting old compared to the peer timeout
+	pthread_rwlock_rdlock(&this->addressMapLock);
+	iter = addressMap.find(key);
+	if(	iter != addressMap.end() &&
+		iter->second.addressValue == data.addressValue &&
+		iter->second.port == data.port &&
+		(this->peerTimeoutSec <= 0 || iter->second.lastSeenTime + this->peerTimeoutSec / 4.0 > data.lastSeenTime))
+	{
+		pthread_rwlock_unlock(&this->addressMapLock);
+		return;
+	}
+	pthread_rwlock_unlock(&this->addressMapLock);
+
+	pthread_rwlock_wrlock(&this->addressMapLock);
+	addressMap[key] = data;
+	pthread_rwlock_unlock(&this->addressMapLock);
+}
+
+void JudpInterface::evictDeadPeers(void)
+{
+	HASH_MAP<int, JudpTransportData>::iterator iter;
+	std::vector<int> deadKeys;
+	std::vector<int>::iterator key;
+	double now = ojGetTimeSec();
+
+	if(this->peerTimeoutSec <= 0 || now < this->nextEvictionTime)
+	{
+		return;
+	}
+	this->nextEvictionTime = now + this->peerTimeoutSec / 2.0;
+
+	pthread_rwlock_rdlock(&this->addressMapLock);
+	for(iter = addressMap.begin(); iter != addressMap.end(); iter++)
+	{
+		if(!isPeerAlive(&iter->second, now))
+		{
+			deadKeys.push_back(iter->first);
+		}
+	}
+	pthread_rwlock_unlock(&this->addressMapLock);
+
+	if(deadKeys.empty())
+	{
+		return;
+	}
+
+	pthread_rwlock_wrlock(&this->addressMapLock);
+	for(key = deadKeys.begin(); key != deadKeys.end(); key++)
+	{
+		// The peer may have been heard from while we were not holding the lock
+		iter = addressMap.find(*key);
+		if(iter != addressMap.end() && !isPeerAlive(&iter->second, now))
+		{
+			addressMap.erase(iter);
+		}
+	}
+	pthread_rwlock_unlock(&this->addressMapLock);
+}
+
+bool JudpInterface::readStaticPeers(std::string section)
+{
+	std::vector<std::string> *peerStrings;
+	std::vector<std::string>::iterator iter;
+	JudpTransportData data;
+	InetAddress peerAddress;
+	std::string hostString;
+	size_t colon;
+	char errorString[128] = {0};
+
+	this->staticPeers.clear();
+
+	// JUDP_Peers: ip[:port], ip[:port], ...
+	peerStrings = this->configData->GetConfigDataVector(section, "JUDP_Peers");
+	if(!peerStrings)
+	{
+		return true;
+	}
+
+	for(iter = peerStrings->begin(); iter != peerStrings->end(); iter++)
+	{
+		colon = iter->find(':');
+		hostString = iter->substr(0, colon);
+		if(colon == std::string::npos)
+		{
+			data.port = JUDP_DATA_PORT;
+		}
+		else
+		{
+			data.port = (unsigned short) atoi(iter->substr(colon + 1).c_str());
+		}
+
+		peerAddress = inetAddressGetByString((char *)hostString.c_str());
+		if(peerAddress == NULL || data.port == 0)
+		{
+			sprintf(errorString, "Invalid JUDP peer: %s", iter->c_str());
+			ErrorEvent *e = new ErrorEvent(ErrorEvent::Configuration, __FUNCTION__, __LINE__, errorString);
+			this->eventHandler->handleEvent(e);
+			if(peerAddress)
+			{
+				inetAddressDestroy(peerAddress);
+			}
+			delete peerStrings;
+			return false;
+		}
+
+		data.addressValue = peerAddress->value;
+		data.lastSeenTime = 0;
+		inetAddressDestroy(peerAddress);
+		this->staticPeers.push_back(data);
+	}
+
+	delete peerStrings;
+	return true;
+}
+
 void JudpInterface::closeSocket(void)
 {
 	multicastSocketDestroy(this->socket);
@@ -743,6 +1007,7 @@ void JudpInterface::recvThreadRun()
 	while(this->running)
 	{
 		index = 0;
+		evictDeadPeers();
 		bytesRecv = multicastSocketReceive(this->socket, packet);
 		
 		if(bytesRecv > 0)
@@ -786,32 +1051,40 @@ void JudpInterface::recvThreadRun()
 			}
 
 			// Add to transportMap
+			// AS5669 peers may send from any port but listen on the data port. Only components, and peers
+			// listed with their port in JUDP_Peers, are answered on the port they send from.
+			data.addressValue = packet->address->value;
+			if(this->type == COMPONENT_INTERFACE || isStaticPeer(packet->address->value, packet->port))
+			{
+				data.port = packet->port;
+			}
+			else
+			{
+				data.port = this->portNumber;
+			}
+			data.lastSeenTime = ojGetTimeSec();
 			switch(this->type)
 			{
 				case SUBSYSTEM_INTERFACE:
-					data.addressValue = packet->address->value;
-					data.port = JUDP_DATA_PORT;
-					this->addressMap[rxMessage->source->subsystem] = data;
+					updatePeer(rxMessage->source->subsystem, data);
 					break;
 
 				case NODE_INTERFACE:
-					data.addressValue = packet->address->value;
-					data.port = JUDP_DATA_PORT;
 					if(rxMessage->source->subsystem == mySubsystemId)
 					{
-						this->addressMap[rxMessage->source->node] = data;
+						updatePeer(rxMessage->source->node, data);
 					}
 					else
 					{
+						pthread_rwlock_wrlock(&this->addressMapLock);
 						this->subsystemGatewayData = data;
 						this->subsystemGatewayDiscovered = true;
+						pthread_rwlock_unlock(&this->addressMapLock);
 					}
 					break;
 
 				case COMPONENT_INTERFACE:
-					data.addressValue = packet->address->value;
-					data.port = packet->port;
-					this->addressMap[jausAddressHash(rxMessage->source)] = data;
+					updatePeer(jausAddressHash(rxMessage->source), data);
 					break;
 
 				default:
@@ -81,7 +81,20 @@ void LocalComponent::run()
 			timeout.tv_sec++;
 		}
 	
-		int rc = pthread_cond_timedwait(&this->threadConditional, &this->threadMutex, &timeout);
+		// Messages queued while we were busy did not see us waiting
+		int rc = 0;
+		if(this->queue.isEmpty())
+		{
+			rc = pthread_cond_timedwait(&this->threadConditional, &this->threadMutex, &timeout);
+		}
+		else
+		{
+			gettimeofday(&now, NULL);
+			if(now.tv_sec > timeout.tv_sec || (now.tv_sec == timeout.tv_sec && (now.tv_usec*1000) >= timeout.tv_nsec))
+			{
+				rc = ETIMEDOUT;
+			}
+		}
 		switch(rc)
 		{
 			case 0: // Conditional Signal
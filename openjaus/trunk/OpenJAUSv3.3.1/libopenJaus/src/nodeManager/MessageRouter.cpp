@@ -46,6 +46,8 @@
 #include "nodeManager/JausSubsystemCommunicationManager.h"
 #include "nodeManager/JausNodeCommunicationManager.h"
 #include "nodeManager/JausComponentCommunicationManager.h"
+#include "nodeManager/JausTransportQueue.h"
+#include "nodeManager/MessageRouterWorker.h"
 #include "nodeManager/events/ErrorEvent.h"
 
 MessageRouter::MessageRouter(FileLoader *configData, SystemTree *sysTree, EventHandler *handler)
@@ -99,6 +101,19 @@ MessageRouter::MessageRouter(FileLoader *configData, SystemTree *sysTree, EventH
 		throw;
 	}
 
+	try
+	{
+		startWorkers();
+	}
+	catch(...)
+	{
+		stopWorkers();
+		delete this->subsComms;
+		delete this->nodeComms;
+		delete this->cmptComms;
+		throw;
+	}
+
 	this->subsComms->startInterfaces();
 	this->nodeComms->startInterfaces();
 	this->cmptComms->startInterfaces();
@@ -106,6 +121,9 @@ MessageRouter::MessageRouter(FileLoader *configData, SystemTree *sysTree, EventH
 
 MessageRouter::~MessageRouter(void)
 {
+	// Workers are stopped first, messages received afterwards are dropped
+	stopWorkers();
+
 	this->cmptComms->stopInterfaces();
 	this->nodeComms->stopInterfaces();
 	this->subsComms->stopInterfaces();
@@ -115,7 +133,103 @@ MessageRouter::~MessageRouter(void)
 	delete cmptComms;
 }
 
+void MessageRouter::startWorkers(void)
+{
+	int threadCount = MESSAGE_ROUTER_DEFAULT_THREADS;
+	unsigned long queueMaxSize = JAUS_TRANSPORT_QUEUE_DEFAULT_MAX_SIZE;
+	char errorString[128] = {0};
+
+	if(configData->GetConfigDataString("JAUS", "Message_Router_Threads") != "")
+	{
+		threadCount = configData->GetConfigDataInt("JAUS", "Message_Router_Threads");
+	}
+
+	if(threadCount < 0 || threadCount > MESSAGE_ROUTER_MAXIMUM_THREADS)
+	{
+		sprintf(errorString, "Invalid Message_Router_Threads (%d), routing on the receiving threads", threadCount);
+		ErrorEvent *e = new ErrorEvent(ErrorEvent::Configuration, __FUNCTION__, __LINE__, errorString);
+		this->eventHandler->handleEvent(e);
+		return;
+	}
+
+	if(configData->GetConfigDataString("JAUS", "Message_Router_Queue_Max_Size") != "")
+	{
+		queueMaxSize = configData->GetConfigDataInt("JAUS", "Message_Router_Queue_Max_Size");
+	}
+
+	for(int i = 0; i < threadCount; i++)
+	{
+		MessageRouterWorker *worker = new MessageRouterWorker(this, queueMaxSize);
+		this->workers.push_back(worker);
+		worker->startThread();
+	}
+}
+
+void MessageRouter::stopWorkers(void)
+{
+	std::vector <MessageRouterWorker *>::iterator iter;
+
+	for(iter = this->workers.begin(); iter != this->workers.end(); iter++)
+	{
+		delete (*iter);
+	}
+	this->workers.clear();
+}
+
+// Shards by destination so the messages of each source/destination pair stay in order
+bool MessageRouter::queueToWorker(JausMessage message, int source)
+{
+	unsigned int shard = (unsigned int)jausAddressHash(message->destination) % (unsigned int)this->workers.size();
+	return this->workers[shard]->queueJausMessage(message, source);
+}
+
+bool MessageRouter::processJausMessage(JausMessage message, int source)
+{
+	switch(source)
+	{
+		case SubsystemSource:
+			return processSubsystemSourceMessage(message);
+
+		case NodeSource:
+			return processNodeSourceMessage(message);
+
+		case ComponentSource:
+			return processComponentSourceMessage(message);
+
+		default:
+			jausMessageDestroy(message);
+			return false;
+	}
+}
+
 bool MessageRouter::routeSubsystemSourceMessage(JausMessage message)
+{
+	if(message && !this->workers.empty())
+	{
+		return queueToWorker(message, SubsystemSource);
+	}
+	return processSubsystemSourceMessage(message);
+}
+
+bool MessageRouter::routeNodeSourceMessage(JausMessage message)
+{
+	if(message && !this->workers.empty())
+	{
+		return queueToWorker(message, NodeSource);
+	}
+	return processNodeSourceMessage(message);
+}
+
+bool MessageRouter::routeComponentSourceMessage(JausMessage message)
+{
+	if(message && !this->workers.empty())
+	{
+		return queueToWorker(message, ComponentSource);
+	}
+	return processComponentSourceMessage(message);
+}
+
+bool MessageRouter::processSubsystemSourceMessage(JausMessage message)
 {
 	// This complies with the MessageRouter Subsystem Source Table v2.0
 	if(!message)
@@ -165,7 +279,7 @@ bool MessageRouter::routeSubsystemSourceMessage(JausMessage message)
 	return true;
 }
 
-bool MessageRouter::routeNodeSourceMessage(JausMessage message)
+bool MessageRouter::processNodeSourceMessage(JausMessage message)
 {
 	// This complies with the MessageRouter Node Source Table v2.0
 	if(!message)
@@ -259,7 +373,7 @@ bool MessageRouter::routeNodeSourceMessage(JausMessage message)
 	}
 }
 
-bool MessageRouter::routeComponentSourceMessage(JausMessage message)
+bool MessageRouter::processComponentSourceMessage(JausMessage message)
 {
 
 	// This complies with the MessageRouter Component Source Table v2.0
@@ -392,4 +506,75 @@ bool MessageRouter::componentCommunicationEnabled()
 	return this->cmptComms->isEnabled();
 }
 
+bool MessageRouter::getFlowControlStatus(JausAddress destination, JausFlowControlStatus *status)
+{
+	// This follows the same tables as routeComponentSourceMessage and the cmptComms
+	// and reports the state of the interfaces a message to destination would be queued on
+	status->freeSpace = (unsigned long)-1;
+	status->dropCount = 0;
+	status->congested = false;
+
+	if(!destination)
+	{
+		ErrorEvent *e = new ErrorEvent(ErrorEvent::NullPointer,  __FUNCTION__, __LINE__, "Invalid JausAddress");
+		this->eventHandler->handleEvent(e);
+		return false;
+	}
+
+	if(	destination->subsystem == mySubsystemId ||
+		destination->subsystem == JAUS_BROADCAST_SUBSYSTEM_ID)
+	{
+		if(	destination->node == myNodeId ||
+			destination->node == JAUS_BROADCAST_NODE_ID)
+		{
+			if(	destination->component == JAUS_BROADCAST_COMPONENT_ID ||
+				destination->instance == JAUS_BROADCAST_INSTANCE_ID)
+			{
+				cmptComms->mergeFlowControlStatus(status);
+			}
+			else
+			{
+				JausAddress lookupAddress = jausAddressClone(destination);
+				lookupAddress->subsystem = mySubsystemId;
+				lookupAddress->node = myNodeId;
+				cmptComms->mergeFlowControlStatus(jausAddressHash(lookupAddress), status);
+				jausAddressDestroy(lookupAddress);
+			}
+		}
+
+		if(destination->node != myNodeId)
+		{
+			if(destination->node == JAUS_BROADCAST_NODE_ID)
+			{
+				nodeComms->mergeFlowControlStatus(status);
+			}
+			else
+			{
+				nodeComms->mergeFlowControlStatus(destination->node, status);
+			}
+		}
+	}
+
+	if(destination->subsystem != mySubsystemId)
+	{
+		if(this->subsComms->isEnabled())
+		{
+			if(destination->subsystem == JAUS_BROADCAST_SUBSYSTEM_ID)
+			{
+				subsComms->mergeFlowControlStatus(status);
+			}
+			else
+			{
+				subsComms->mergeFlowControlStatus(destination->subsystem, status);
+			}
+		}
+		else
+		{
+			nodeComms->mergeFlowControlStatus(status);
+		}
+	}
+
+	return true;
+}
+
 
@@ -0,0 +1,171 @@
+/*****************************************************************************
+ *  Copyright (c) 2008, University of Florida
+ *  All rights reserved.
+ *
+ *  This file is part of OpenJAUS.  OpenJAUS is distributed under the BSD
+ *  license.  See the LICENSE file for details.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of the University of Florida nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+// File Name: MessageRouterWorker.cpp
+//
+// Version: 3.3.0
+//
+// Date: 07/09/08
+//
+// Description: This file defines the MessageRouterWorker class.
+
+#include "nodeManager/MessageRouterWorker.h"
+#include "nodeManager/MessageRouter.h"
+
+void *MessageRouterWorkerThreadRun(void *obj);
+
+MessageRouterWorker::MessageRouterWorker(MessageRouter *router, unsigned long maxQueueSize)
+{
+	this->router = router;
+	this->maxQueueSize = maxQueueSize;
+	this->dropCount = 0;
+	this->running = false;
+
+	pthread_mutex_init(&this->threadMutex, NULL);
+	pthread_cond_init(&this->threadConditional, NULL);
+}
+
+MessageRouterWorker::~MessageRouterWorker(void)
+{
+	if(this->running)
+	{
+		stopThread();
+	}
+	pthread_mutex_destroy(&this->threadMutex);
+	pthread_cond_destroy(&this->threadConditional);
+}
+
+void MessageRouterWorker::startThread(void)
+{
+	char errorString[128] = {0};
+	int retVal;
+
+	this->running = true;
+	retVal = pthread_create(&this->pThread, NULL, MessageRouterWorkerThreadRun, this);
+	if(retVal != 0)
+	{
+		this->running = false;
+		sprintf(errorString, "MessageRouterWorker: pthread_create returned error code: %d", retVal);
+		throw errorString;
+	}
+}
+
+void MessageRouterWorker::stopThread(void)
+{
+	pthread_mutex_lock(&this->threadMutex);
+	this->running = false;
+	pthread_cond_signal(&this->threadConditional);
+	pthread_mutex_unlock(&this->threadMutex);
+
+	pthread_join(this->pThread, NULL);
+}
+
+bool MessageRouterWorker::queueJausMessage(JausMessage message, int source)
+{
+	RoutingJob job;
+
+	pthread_mutex_lock(&this->threadMutex);
+	if(!this->running || (this->maxQueueSize && this->jobs.size() >= this->maxQueueSize))
+	{
+		this->dropCount++;
+		pthread_mutex_unlock(&this->threadMutex);
+
+		jausMessageDestroy(message);
+		return false;
+	}
+
+	job.message = message;
+	job.source = source;
+	this->jobs.push(job);
+	pthread_cond_signal(&this->threadConditional);
+	pthread_mutex_unlock(&this->threadMutex);
+	return true;
+}
+
+unsigned long MessageRouterWorker::queueSize(void)
+{
+	unsigned long size;
+
+	pthread_mutex_lock(&this->threadMutex);
+	size = (unsigned long)this->jobs.size();
+	pthread_mutex_unlock(&this->threadMutex);
+	return size;
+}
+
+unsigned long MessageRouterWorker::queueDropCount(void)
+{
+	unsigned long count;
+
+	pthread_mutex_lock(&this->threadMutex);
+	count = this->dropCount;
+	pthread_mutex_unlock(&this->threadMutex);
+	return count;
+}
+
+void MessageRouterWorker::run(void)
+{
+	RoutingJob job;
+
+	pthread_mutex_lock(&this->threadMutex);
+	while(this->running)
+	{
+		if(this->jobs.empty())
+		{
+			pthread_cond_wait(&this->threadConditional, &this->threadMutex);
+			continue;
+		}
+
+		job = this->jobs.front();
+		this->jobs.pop();
+
+		// Route without holding the lock so the receive threads can keep queueing
+		pthread_mutex_unlock(&this->threadMutex);
+		this->router->processJausMessage(job.message, job.source);
+		pthread_mutex_lock(&this->threadMutex);
+	}
+
+	// Messages still queued at shutdown are not routed
+	while(!this->jobs.empty())
+	{
+		jausMessageDestroy(this->jobs.front().message);
+		this->jobs.pop();
+	}
+	pthread_mutex_unlock(&this->threadMutex);
+}
+
+void *MessageRouterWorkerThreadRun(void *obj)
+{
+	MessageRouterWorker *worker = (MessageRouterWorker *)obj;
+	worker->run();
+	return NULL;
+}
@@ -80,6 +80,11 @@ NodeManagerComponent::NodeManagerComponent(FileLoader *configData, EventHandler
 	this->name = "OpenJAUS Node Manager";
 	this->cmptRateHz = NM_RATE_HZ;
 	this->systemTree = cmptComms->getSystemTree();
+	this->nextHeartbeatTime = ojGetTimeSec();
+	this->nextRefreshTime = 0;
+	this->nextTreeNoticeTime = 0;
+	this->treeNoticeRepeatCount = 0;
+	this->noticedTreeChangeCount = 0;
 	this->systemTree->registerEventHandler(this);
 	for(int i = 0; i < MAXIMUM_EVENT_ID; i++)
 	{
@@ -358,13 +363,13 @@ void NodeManagerComponent::shutdownState()
 
 void NodeManagerComponent::allState()
 {
-	static double refreshTime = 0;
 	generateHeartbeats();
-	if(ojGetTimeSec() >= refreshTime)
+	if(ojGetTimeSec() >= nextRefreshTime)
 	{
 		systemTree->refresh();
-		refreshTime = ojGetTimeSec() + REFRESH_TIME_SEC;
+		nextRefreshTime = ojGetTimeSec() + REFRESH_TIME_SEC;
 	}
+	generateSystemTreeNotices();
 
 	// TODO: Check for serviceConnections
 }
@@ -1837,12 +1842,11 @@ void NodeManagerComponent::sendSubsystemShutdownEvents()
 
 void NodeManagerComponent::generateHeartbeats()
 {
-	static double nextSendTime = ojGetTimeSec();
 	ReportHeartbeatPulseMessage heartbeat;
 	JausMessage nodeHeartbeat;
 	JausMessage cmptHeartbeat;
 	
-	if(ojGetTimeSec() >= nextSendTime)
+	if(ojGetTimeSec() >= nextHeartbeatTime)
 	{
 		heartbeat = reportHeartbeatPulseMessageCreate();
 		if(!heartbeat)
@@ -1886,11 +1890,61 @@ void NodeManagerComponent::generateHeartbeats()
 		cmptHeartbeat->destination->instance = JAUS_BROADCAST_INSTANCE_ID;
 		this->commMngr->receiveJausMessage(cmptHeartbeat, this);
 
-		nextSendTime = ojGetTimeSec() + 1.0;
+		nextHeartbeatTime = ojGetTimeSec() + 1.0;
 		reportHeartbeatPulseMessageDestroy(heartbeat);
 	}
 }
 
+// Tells the local components' node manager interfaces to refresh their replicated copy of the
+// system tree. Sent as soon as the tree changes, then repeated a few times so a lost notice is recovered.
+void NodeManagerComponent::generateSystemTreeNotices()
+{
+	JausMessage txMessage;
+	unsigned int changeCount = systemTree->getChangeCount();
+
+	if(changeCount != noticedTreeChangeCount)
+	{
+		treeNoticeRepeatCount = TREE_NOTICE_REPEAT_COUNT;
+	}
+	else if(treeNoticeRepeatCount <= 0 || ojGetTimeSec() < nextTreeNoticeTime)
+	{
+		return;
+	}
+	else
+	{
+		treeNoticeRepeatCount--;
+	}
+
+	txMessage = jausMessageCreate();
+	if(!txMessage)
+	{
+		// Error constructing message
+		// TODO: Log Error.
+		return;
+	}
+
+	txMessage->properties.expFlag = JAUS_EXPERIMENTAL_MESSAGE;
+	txMessage->commandCode = JAUS_REPORT_SYSTEM_TREE_CHANGE;
+	jausAddressCopy(txMessage->source, cmpt->address);
+	txMessage->destination->subsystem = cmpt->address->subsystem;
+	txMessage->destination->node = cmpt->address->node;
+	txMessage->destination->component = JAUS_BROADCAST_COMPONENT_ID;
+	txMessage->destination->instance = JAUS_BROADCAST_INSTANCE_ID;
+
+	txMessage->dataSize = JAUS_UNSIGNED_INTEGER_SIZE_BYTES;
+	txMessage->data = (JausByte *) malloc(txMessage->dataSize);
+	if(!txMessage->data || !jausUnsignedIntegerToBuffer(changeCount, txMessage->data, txMessage->dataSize))
+	{
+		jausMessageDestroy(txMessage);
+		return;
+	}
+
+	((JausComponentCommunicationManager *)this->commMngr)->sendToOpenJausComponents(txMessage);
+
+	noticedTreeChangeCount = changeCount;
+	nextTreeNoticeTime = ojGetTimeSec() + TREE_NOTICE_TIME_SEC;
+}
+
 bool NodeManagerComponent::sendQueryNodeIdentification(JausAddress address)
 {
 	QueryIdentificationMessage queryId = NULL;
@@ -2261,6 +2315,7 @@ bool NodeManagerComponent::setupJausServices()
 void NodeManagerComponent::handleEvent(NodeManagerEvent *e)
 {
 	SystemTreeEvent *treeEvent;
+	int addressHash;
 
 	switch(e->getType())
 	{
@@ -2275,6 +2330,12 @@ void NodeManagerComponent::handleEvent(NodeManagerEvent *e)
 				case SystemTreeEvent::ComponentTimeout:
 					this->sendSubsystemChangedEvents();
 					this->sendNodeChangedEvents();
+					// Fall through, a timed out component has left the tree
+
+				case SystemTreeEvent::ComponentRemoved:
+					addressHash = jausAddressHash(treeEvent->getComponent()->address);
+					((JausComponentCommunicationManager *)this->commMngr)->revokeLargeFrames(addressHash);
+					((JausComponentCommunicationManager *)this->commMngr)->checkOutOpenJausComponent(addressHash);
 					break;
 
 				default:
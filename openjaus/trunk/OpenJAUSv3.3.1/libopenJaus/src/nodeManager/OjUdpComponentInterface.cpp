@@ -57,6 +57,8 @@ OjUdpComponentInterface::OjUdpComponentInterface(FileLoader *configData, EventHa
 	this->type = COMPONENT_INTERFACE;
 	this->name = "OpenJAUS UDP Component to Node Manager Interface";
 	this->portMap.empty();
+	this->directoryChangeCount = 0;
+	this->directoryValid = false;
 
 	// Open our socket
 	if(!this->openSocket())
@@ -194,15 +196,27 @@ void OjUdpComponentInterface::run()
 	int componentId = 0;
 	int commandCode = 0;
 	int serviceType = 0;
+	unsigned int largeFrameSizeBytes = 0;
+	JausFlowControlStatus flowStatus;
+	DatagramPacket replyPacket;
 
 	packet = datagramPacketCreate();
-	packet->bufferSizeBytes = OJ_UDP_INTERFACE_MESSAGE_SIZE_BYTES;
+	packet->bufferSizeBytes = OJ_UDP_INTERFACE_MAX_REQUEST_SIZE_BYTES;
 	packet->buffer = (unsigned char *) calloc(packet->bufferSizeBytes, 1);
 
+	// Replies larger than the fixed 8 byte messages are built here
+	replyPacket = datagramPacketCreate();
+	replyPacket->bufferSizeBytes = OJ_UDP_INTERFACE_MAX_REPLY_SIZE_BYTES;
+	replyPacket->buffer = (unsigned char *) calloc(replyPacket->bufferSizeBytes, 1);
+
 	while(this->running)
 	{
+		packet->bufferSizeBytes = OJ_UDP_INTERFACE_MAX_REQUEST_SIZE_BYTES;
 		bytesRecv = datagramSocketReceive(this->socket, packet);
-		if(bytesRecv == OJ_UDP_INTERFACE_MESSAGE_SIZE_BYTES)
+
+		// Every reply sent back from packet is a fixed size message
+		packet->bufferSizeBytes = OJ_UDP_INTERFACE_MESSAGE_SIZE_BYTES;
+		if(bytesRecv >= OJ_UDP_INTERFACE_MESSAGE_SIZE_BYTES)
 		{
 			// This is to ensure we are using a valid NM pointer (this occurs
 			this->nodeManager = ((JausComponentCommunicationManager *)this->commMngr)->getNodeManagerComponent();
@@ -237,6 +251,10 @@ void OjUdpComponentInterface::run()
 					packet->buffer[3] = (unsigned char)(address->node & 0xFF);
 					packet->buffer[4] = (unsigned char)(address->subsystem & 0xFF);
 
+					// A grant left behind by an earlier component at this address must not carry over
+					((JausComponentCommunicationManager *)this->commMngr)->revokeLargeFrames(jausAddressHash(address));
+					((JausComponentCommunicationManager *)this->commMngr)->checkInOpenJausComponent(jausAddressHash(address));
+
 					datagramSocketSend(this->socket, packet);
 					jausAddressDestroy(address);
 					break;
@@ -245,6 +263,27 @@ void OjUdpComponentInterface::run()
 					nodeManager->checkOutLocalComponent(packet->buffer[4], packet->buffer[3], packet->buffer[2], packet->buffer[1]);
 					break;
 
+				case REQUEST_LARGE_FRAMES:
+					// Instance, component, node, subsystem, then the largest data size the component takes (3 bytes)
+					lookupAddress = jausAddressCreate();
+					lookupAddress->instance = (packet->buffer[1] & 0xFF);
+					lookupAddress->component = (packet->buffer[2] & 0xFF);
+					lookupAddress->node = (packet->buffer[3] & 0xFF);
+					lookupAddress->subsystem = (packet->buffer[4] & 0xFF);
+					largeFrameSizeBytes = (packet->buffer[5] & 0xFF) + ((packet->buffer[6] & 0xFF) << 8) + ((packet->buffer[7] & 0xFF) << 16);
+
+					largeFrameSizeBytes = ((JausComponentCommunicationManager *)this->commMngr)->grantLargeFrames(jausAddressHash(lookupAddress), largeFrameSizeBytes);
+
+					memset(packet->buffer, 0, OJ_UDP_INTERFACE_MESSAGE_SIZE_BYTES);
+					packet->buffer[0] = LARGE_FRAMES_GRANTED;
+					packet->buffer[1] = (unsigned char) (largeFrameSizeBytes & 0xFF);
+					packet->buffer[2] = (unsigned char) ((largeFrameSizeBytes >> 8) & 0xFF);
+					packet->buffer[3] = (unsigned char) ((largeFrameSizeBytes >> 16) & 0xFF);
+					datagramSocketSend(this->socket, packet);
+
+					jausAddressDestroy(lookupAddress);
+					break;
+
 				case VERIFY_ADDRESS:
 					lookupAddress = jausAddressCreate();
 					lookupAddress->instance = (packet->buffer[1] & 0xFF);
@@ -408,12 +447,51 @@ void OjUdpComponentInterface::run()
 				//	socket.send(outPacket);
 				//	break;
 
+				case QUERY_FLOW_CONTROL:
+					lookupAddress = jausAddressCreate();
+					lookupAddress->instance = (packet->buffer[1] & 0xFF);
+					lookupAddress->component = (packet->buffer[2] & 0xFF);
+					lookupAddress->node = (packet->buffer[3] & 0xFF);
+					lookupAddress->subsystem = (packet->buffer[4] & 0xFF);
+
+					this->commMngr->getMessageRouter()->getFlowControlStatus(lookupAddress, &flowStatus);
+					if(flowStatus.freeSpace > 0xFFFF)
+					{
+						flowStatus.freeSpace = 0xFFFF;
+					}
+
+					memset(packet->buffer, 0, OJ_UDP_INTERFACE_MESSAGE_SIZE_BYTES);
+					packet->buffer[0] = REPORT_FLOW_CONTROL;
+					packet->buffer[1] = (unsigned char) (flowStatus.congested? JAUS_TRUE : JAUS_FALSE);
+					packet->buffer[2] = (unsigned char) (flowStatus.freeSpace & 0xFF);
+					packet->buffer[3] = (unsigned char) ((flowStatus.freeSpace >> 8) & 0xFF);
+					packet->buffer[4] = (unsigned char) (flowStatus.dropCount & 0xFF);
+					packet->buffer[5] = (unsigned char) ((flowStatus.dropCount >> 8) & 0xFF);
+					packet->buffer[6] = (unsigned char) ((flowStatus.dropCount >> 16) & 0xFF);
+					packet->buffer[7] = (unsigned char) ((flowStatus.dropCount >> 24) & 0xFF);
+					datagramSocketSend(this->socket, packet);
+
+					jausAddressDestroy(lookupAddress);
+					break;
+
 				case READY_CHECK:
 					memset(packet->buffer, 0, OJ_UDP_INTERFACE_MESSAGE_SIZE_BYTES);
 					packet->buffer[0] = REPORT_READY;
 					datagramSocketSend(this->socket, packet);
 					break;
 
+				case GET_SYSTEM_DIRECTORY:
+					this->sendDirectoryPage(packet, replyPacket);
+					break;
+
+				case GET_ADDRESS_LIST:
+					this->sendAddressListPage(packet, bytesRecv, replyPacket);
+					break;
+
+				case VERIFY_ADDRESS_LIST:
+					this->sendAddressListVerified(packet, bytesRecv, replyPacket);
+					break;
+
 				default:
 					sprintf(buf, "Unknown Interface Message Received. CC: 0x%02X\n", packet->buffer[0]);
 					ErrorEvent *e = new ErrorEvent(ErrorEvent::Warning, __FUNCTION__, __LINE__, buf);
@@ -423,10 +501,197 @@ void OjUdpComponentInterface::run()
 		}
 	}
 
+	free(replyPacket->buffer);
+	datagramPacketDestroy(replyPacket);
 	free(packet->buffer);
 	datagramPacketDestroy(packet);
 }
 
+// Answers one page of the serialized system tree. The response header is:
+//   SYSTEM_DIRECTORY_RESPONSE, reserved, page (2 bytes), page count (2 bytes),
+//   tree change count (4 bytes), data size (2 bytes)
+// A client reassembling several pages restarts if the change count differs between them.
+void OjUdpComponentInterface::sendDirectoryPage(DatagramPacket request, DatagramPacket reply)
+{
+	unsigned int changeCount = this->systemTree->getChangeCount();
+	unsigned int page = (request->buffer[1] & 0xFF) + ((request->buffer[2] & 0xFF) << 8);
+	unsigned int pageCount;
+	unsigned int offset;
+	unsigned int dataSize = 0;
+
+	// Only rebuild when the tree has changed, the change count is read first so
+	// a change made while serializing is picked up by the next request
+	if(!this->directoryValid || changeCount != this->directoryChangeCount)
+	{
+		this->directory.clear();
+		this->systemTree->getDirectory(this->directory);
+		this->directoryChangeCount = changeCount;
+		this->directoryValid = true;
+	}
+
+	pageCount = (unsigned int)((this->directory.size() + OJ_UDP_DIRECTORY_PAGE_SIZE_BYTES - 1) / OJ_UDP_DIRECTORY_PAGE_SIZE_BYTES);
+	if(pageCount == 0)
+	{
+		pageCount = 1;
+	}
+
+	offset = page * OJ_UDP_DIRECTORY_PAGE_SIZE_BYTES;
+	if(page < pageCount && offset < this->directory.size())
+	{
+		dataSize = (unsigned int)(this->directory.size() - offset);
+		if(dataSize > OJ_UDP_DIRECTORY_PAGE_SIZE_BYTES)
+		{
+			dataSize = OJ_UDP_DIRECTORY_PAGE_SIZE_BYTES;
+		}
+		memcpy(reply->buffer + OJ_UDP_PAGE_HEADER_SIZE_BYTES, &this->directory[offset], dataSize);
+	}
+
+	memset(reply->buffer, 0, OJ_UDP_PAGE_HEADER_SIZE_BYTES);
+	reply->buffer[0] = SYSTEM_DIRECTORY_RESPONSE;
+	reply->buffer[2] = (unsigned char)(page & 0xFF);
+	reply->buffer[3] = (unsigned char)((page >> 8) & 0xFF);
+	reply->buffer[4] = (unsigned char)(pageCount & 0xFF);
+	reply->buffer[5] = (unsigned char)((pageCount >> 8) & 0xFF);
+	reply->buffer[6] = (unsigned char)(this->directoryChangeCount & 0xFF);
+	reply->buffer[7] = (unsigned char)((this->directoryChangeCount >> 8) & 0xFF);
+	reply->buffer[8] = (unsigned char)((this->directoryChangeCount >> 16) & 0xFF);
+	reply->buffer[9] = (unsigned char)((this->directoryChangeCount >> 24) & 0xFF);
+	reply->buffer[10] = (unsigned char)(dataSize & 0xFF);
+	reply->buffer[11] = (unsigned char)((dataSize >> 8) & 0xFF);
+
+	this->sendReply(request, reply, OJ_UDP_PAGE_HEADER_SIZE_BYTES + dataSize);
+}
+
+// Answers one page of the addresses matching a GET_ADDRESS_LIST request:
+//   GET_ADDRESS_LIST, page (2 bytes), instance, component, node, subsystem,
+//   command code (2 bytes), service type (OJ_UDP_ANY_SERVICE_TYPE to match any component)
+// The response uses the SYSTEM_DIRECTORY_RESPONSE header with the address count in place
+// of the data size, followed by instance, component, node, subsystem for each address.
+void OjUdpComponentInterface::sendAddressListPage(DatagramPacket request, int requestSize, DatagramPacket reply)
+{
+	JausAddress lookupAddress;
+	JausAddress list;
+	JausAddress address;
+	unsigned int page;
+	unsigned int pageCount;
+	unsigned int matchCount = 0;
+	unsigned int count = 0;
+	unsigned int changeCount;
+	int commandCode = -1;
+	int serviceType;
+	unsigned char *data;
+
+	if(requestSize != OJ_UDP_INTERFACE_MESSAGE_SIZE_BYTES + 2)
+	{
+		return;
+	}
+
+	page = (request->buffer[1] & 0xFF) + ((request->buffer[2] & 0xFF) << 8);
+	serviceType = request->buffer[9] & 0xFF;
+	if(serviceType != OJ_UDP_ANY_SERVICE_TYPE)
+	{
+		commandCode = (request->buffer[7] & 0xFF) + ((request->buffer[8] & 0xFF) << 8);
+	}
+
+	lookupAddress = jausAddressCreate();
+	lookupAddress->instance = (request->buffer[3] & 0xFF);
+	lookupAddress->component = (request->buffer[4] & 0xFF);
+	lookupAddress->node = (request->buffer[5] & 0xFF);
+	lookupAddress->subsystem = (request->buffer[6] & 0xFF);
+
+	changeCount = this->systemTree->getChangeCount();
+	list = this->systemTree->lookUpAddressList(lookupAddress, commandCode, serviceType);
+	jausAddressDestroy(lookupAddress);
+
+	data = reply->buffer + OJ_UDP_PAGE_HEADER_SIZE_BYTES;
+	while(list)
+	{
+		address = list;
+		list = list->next;
+
+		if(matchCount / OJ_UDP_ADDRESS_LIST_PAGE_SIZE == page)
+		{
+			data[0] = (unsigned char)(address->instance & 0xFF);
+			data[1] = (unsigned char)(address->component & 0xFF);
+			data[2] = (unsigned char)(address->node & 0xFF);
+			data[3] = (unsigned char)(address->subsystem & 0xFF);
+			data += 4;
+			count++;
+		}
+		matchCount++;
+		jausAddressDestroy(address);
+	}
+
+	pageCount = (matchCount + OJ_UDP_ADDRESS_LIST_PAGE_SIZE - 1) / OJ_UDP_ADDRESS_LIST_PAGE_SIZE;
+	if(pageCount == 0)
+	{
+		pageCount = 1;
+	}
+
+	memset(reply->buffer, 0, OJ_UDP_PAGE_HEADER_SIZE_BYTES);
+	reply->buffer[0] = ADDRESS_LIST_RESPONSE;
+	reply->buffer[2] = (unsigned char)(page & 0xFF);
+	reply->buffer[3] = (unsigned char)((page >> 8) & 0xFF);
+	reply->buffer[4] = (unsigned char)(pageCount & 0xFF);
+	reply->buffer[5] = (unsigned char)((pageCount >> 8) & 0xFF);
+	reply->buffer[6] = (unsigned char)(changeCount & 0xFF);
+	reply->buffer[7] = (unsigned char)((changeCount >> 8) & 0xFF);
+	reply->buffer[8] = (unsigned char)((changeCount >> 16) & 0xFF);
+	reply->buffer[9] = (unsigned char)((changeCount >> 24) & 0xFF);
+	reply->buffer[10] = (unsigned char)(count & 0xFF);
+	reply->buffer[11] = (unsigned char)((count >> 8) & 0xFF);
+
+	this->sendReply(request, reply, OJ_UDP_PAGE_HEADER_SIZE_BYTES + 4 * count);
+}
+
+// Answers a VERIFY_ADDRESS_LIST request:
+//   VERIFY_ADDRESS_LIST, reserved, count (2 bytes), count * [instance, component, node, subsystem]
+// with ADDRESS_LIST_VERIFIED, reserved, count (2 bytes), count * [JAUS_TRUE / JAUS_FALSE]
+void OjUdpComponentInterface::sendAddressListVerified(DatagramPacket request, int requestSize, DatagramPacket reply)
+{
+	JausAddress address;
+	unsigned char *data;
+	unsigned int count;
+	unsigned int i;
+
+	count = (request->buffer[2] & 0xFF) + ((request->buffer[3] & 0xFF) << 8);
+	if(count > OJ_UDP_VERIFY_LIST_MAX_ADDRESSES || requestSize != (int)(OJ_UDP_VERIFY_LIST_HEADER_SIZE_BYTES + 4 * count))
+	{
+		return;
+	}
+
+	address = jausAddressCreate();
+	data = request->buffer + OJ_UDP_VERIFY_LIST_HEADER_SIZE_BYTES;
+	for(i = 0; i < count; i++)
+	{
+		address->instance = (data[0] & 0xFF);
+		address->component = (data[1] & 0xFF);
+		address->node = (data[2] & 0xFF);
+		address->subsystem = (data[3] & 0xFF);
+		data += 4;
+
+		reply->buffer[OJ_UDP_VERIFY_LIST_HEADER_SIZE_BYTES + i] = (unsigned char)(this->systemTree->hasComponent(address)? JAUS_TRUE : JAUS_FALSE);
+	}
+	jausAddressDestroy(address);
+
+	reply->buffer[0] = ADDRESS_LIST_VERIFIED;
+	reply->buffer[1] = 0;
+	reply->buffer[2] = (unsigned char)(count & 0xFF);
+	reply->buffer[3] = (unsigned char)((count >> 8) & 0xFF);
+
+	this->sendReply(request, reply, OJ_UDP_VERIFY_LIST_HEADER_SIZE_BYTES + count);
+}
+
+// Sends the first replySize bytes of reply back to whoever sent request
+void OjUdpComponentInterface::sendReply(DatagramPacket request, DatagramPacket reply, unsigned int replySize)
+{
+	reply->bufferSizeBytes = replySize;
+	reply->port = request->port;
+	reply->address->value = request->address->value;
+	datagramSocketSend(this->socket, reply);
+	reply->bufferSizeBytes = OJ_UDP_INTERFACE_MAX_REPLY_SIZE_BYTES;
+}
+
 bool OjUdpComponentInterface::processOjNodemanagerInterfaceMessage(char *buffer)
 {
 	return true;
@@ -56,6 +56,9 @@ SystemTree::SystemTree(FileLoader *configData, EventHandler *handler)
 
 	memset(system, 0, sizeof(system));
 	subsystemCount = 0;
+	changeCount = 0;
+	pthread_rwlock_init(&treeLock, NULL);
+	pthread_mutex_init(&eventMutex, NULL);
 }
 
 SystemTree::~SystemTree(void)
@@ -68,53 +71,51 @@ SystemTree::~SystemTree(void)
 		}
 	}
 	// TODO: Delete all the memory I own (system)
+
+	pthread_mutex_destroy(&eventMutex);
+	pthread_rwlock_destroy(&treeLock);
 }
 
 bool SystemTree::updateComponentTimestamp(JausAddress address)
 {
+	pthread_rwlock_wrlock(&treeLock);
 	JausComponent cmpt = findComponent(address);
 	if(cmpt)
 	{
 		jausComponentUpdateTimestamp(cmpt);
-		return true;
-	}
-	else
-	{
-		return false;
 	}
+	pthread_rwlock_unlock(&treeLock);
+	return cmpt != NULL;
 }
 
 bool SystemTree::updateNodeTimestamp(JausAddress address)
 {
+	pthread_rwlock_wrlock(&treeLock);
 	JausNode node = findNode(address);
 	if(node)
 	{
 		jausNodeUpdateTimestamp(node);
-		return true;
-	}
-	else
-	{
-		return false;
 	}
+	pthread_rwlock_unlock(&treeLock);
+	return node != NULL;
 }
 
 bool SystemTree::updateSubsystemTimestamp(JausAddress address)
 {
+	pthread_rwlock_wrlock(&treeLock);
 	JausSubsystem subs = system[address->subsystem];
 	if(subs)
 	{
 		jausSubsystemUpdateTimestamp(subs);
-		return true;
-	}
-	else
-	{
-		return false;
 	}
+	pthread_rwlock_unlock(&treeLock);
+	return subs != NULL;
 }
 
 unsigned char SystemTree::getNextInstanceId(JausAddress address)
 {
 	bool instanceAvailable[JAUS_MAXIMUM_INSTANCE_ID] = {true};
+	unsigned char instanceId = JAUS_INVALID_INSTANCE_ID;
 	int i = 0;
 	
 	for(i=0; i < JAUS_MAXIMUM_INSTANCE_ID; i++)
@@ -123,6 +124,7 @@ unsigned char SystemTree::getNextInstanceId(JausAddress address)
 	}
 
 	// Get this node
+	pthread_rwlock_rdlock(&treeLock);
 	JausNode node = findNode(address->subsystem, address->node);
 
 	if(node)
@@ -145,13 +147,14 @@ unsigned char SystemTree::getNextInstanceId(JausAddress address)
 		{
 			if(instanceAvailable[i])
 			{
-				return i;
+				instanceId = i;
+				break;
 			}
 			i++;
 		}
-		return JAUS_INVALID_INSTANCE_ID;
 	}
-	return JAUS_INVALID_INSTANCE_ID;
+	pthread_rwlock_unlock(&treeLock);
+	return instanceId;
 }
 
 bool SystemTree::hasComponent(JausComponent cmpt)
@@ -167,15 +170,10 @@ bool SystemTree::hasComponent(JausAddress address)
 
 bool SystemTree::hasComponent(int subsystemId, int nodeId, int componentId, int instanceId)
 {
-	JausComponent cmpt = findComponent(subsystemId, nodeId, componentId, instanceId);
-	if(cmpt)
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	pthread_rwlock_rdlock(&treeLock);
+	bool found = findComponent(subsystemId, nodeId, componentId, instanceId) != NULL;
+	pthread_rwlock_unlock(&treeLock);
+	return found;
 }
 
 bool SystemTree::hasNode(JausNode node)
@@ -190,15 +188,10 @@ bool SystemTree::hasNode(JausAddress address)
 
 bool SystemTree::hasNode(int subsystemId, int nodeId)
 {
-	JausNode node = findNode(subsystemId, nodeId);
-	if(node)
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	pthread_rwlock_rdlock(&treeLock);
+	bool found = findNode(subsystemId, nodeId) != NULL;
+	pthread_rwlock_unlock(&treeLock);
+	return found;
 }
 
 bool SystemTree::hasSubsystem(JausSubsystem subsystem)
@@ -213,14 +206,10 @@ bool SystemTree::hasSubsystem(JausAddress address)
 
 bool SystemTree::hasSubsystem(int subsystemId)
 {
-	if(system[subsystemId])
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	pthread_rwlock_rdlock(&treeLock);
+	bool found = system[subsystemId] != NULL;
+	pthread_rwlock_unlock(&treeLock);
+	return found;
 }
 
 bool SystemTree::hasSubsystemConfiguration(JausSubsystem subsystem)
@@ -236,22 +225,11 @@ bool SystemTree::hasSubsystemConfiguration(JausAddress address)
 
 bool SystemTree::hasSubsystemConfiguration(int subsId)
 {
-	if(system[subsId])
-	{
-		JausSubsystem subs = system[subsId];
-		if(subs->nodes->elementCount > 0)
-		{
-			return true;
-		}
-		else
-		{
-			return false;
-		}
-	}
-	else
-	{
-		return false;
-	}
+	pthread_rwlock_rdlock(&treeLock);
+	JausSubsystem subs = system[subsId];
+	bool found = subs && subs->nodes->elementCount > 0;
+	pthread_rwlock_unlock(&treeLock);
+	return found;
 }
 
 bool SystemTree::hasSubsystemIdentification(JausSubsystem subsystem)
@@ -266,15 +244,11 @@ bool SystemTree::hasSubsystemIdentification(JausAddress address)
 
 bool SystemTree::hasSubsystemIdentification(int subsId)
 {
+	pthread_rwlock_rdlock(&treeLock);
 	JausSubsystem subs = system[subsId];
-	if(subs && subs->identification)
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	bool found = subs && subs->identification;
+	pthread_rwlock_unlock(&treeLock);
+	return found;
 }
 
 bool SystemTree::hasNodeIdentification(JausNode node)
@@ -289,28 +263,20 @@ bool SystemTree::hasNodeIdentification(JausAddress address)
 
 bool SystemTree::hasNodeIdentification(int subsystemId, int nodeId)
 {
+	pthread_rwlock_rdlock(&treeLock);
 	JausNode node = findNode(subsystemId, nodeId);
-	if(node && node->identification)
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	bool found = node && node->identification;
+	pthread_rwlock_unlock(&treeLock);
+	return found;
 }
 
 bool SystemTree::hasNodeConfiguration(JausAddress address)
 {
+	pthread_rwlock_rdlock(&treeLock);
 	JausNode node = findNode(address);
-	if(node && node->components->elementCount > 0)
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	bool found = node && node->components->elementCount > 0;
+	pthread_rwlock_unlock(&treeLock);
+	return found;
 }
 
 bool SystemTree::hasComponentIdentification(JausAddress address)
@@ -320,15 +286,11 @@ bool SystemTree::hasComponentIdentification(JausAddress address)
 
 bool SystemTree::hasComponentIdentification(int subsystemId, int nodeId, int componentId, int instanceId)
 {
+	pthread_rwlock_rdlock(&treeLock);
 	JausComponent cmpt = findComponent(subsystemId, nodeId, componentId, instanceId);
-	if(cmpt && cmpt->identification)
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	bool found = cmpt && cmpt->identification;
+	pthread_rwlock_unlock(&treeLock);
+	return found;
 }
 
 bool SystemTree::hasComponentServices(JausAddress address)
@@ -338,15 +300,11 @@ bool SystemTree::hasComponentServices(JausAddress address)
 
 bool SystemTree::hasComponentServices(int subsystemId, int nodeId, int componentId, int instanceId)
 {
+	pthread_rwlock_rdlock(&treeLock);
 	JausComponent cmpt = findComponent(subsystemId, nodeId, componentId, instanceId);
-	if(cmpt && cmpt->services->elementCount > 0)
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	bool found = cmpt && cmpt->services->elementCount > 0;
+	pthread_rwlock_unlock(&treeLock);
+	return found;
 }
 
 JausAddress SystemTree::lookUpAddress(JausAddress address)
@@ -354,7 +312,7 @@ JausAddress SystemTree::lookUpAddress(JausAddress address)
 	return lookUpAddress(address->subsystem, address->node, address->component, address->instance);
 }
 
-JausAddress SystemTree::lookUpAddressInNode(JausNode node, int lookupCmpt, int lookupInst)
+JausAddress SystemTree::findAddressInNode(JausNode node, int lookupCmpt, int lookupInst)
 {
 	if(node)
 	{
@@ -397,7 +355,7 @@ JausAddress SystemTree::lookUpAddressInNode(JausNode node, int lookupCmpt, int l
 	return NULL;
 }
 
-JausAddress SystemTree::lookUpAddressInSubsystem(JausSubsystem subs, int lookupNode, int lookupCmpt, int lookupInst)
+JausAddress SystemTree::findAddressInSubsystem(JausSubsystem subs, int lookupNode, int lookupCmpt, int lookupInst)
 {
 	if(subs)
 	{
@@ -406,7 +364,7 @@ JausAddress SystemTree::lookUpAddressInSubsystem(JausSubsystem subs, int lookupN
 			for(int i = 0; i < subs->nodes->elementCount; i++)
 			{
 				JausNode node = (JausNode)subs->nodes->elementData[i];
-				JausAddress address = lookUpAddressInNode(node, lookupCmpt, lookupInst);
+				JausAddress address = findAddressInNode(node, lookupCmpt, lookupInst);
 				if(address)
 				{
 					return address;
@@ -415,7 +373,7 @@ JausAddress SystemTree::lookUpAddressInSubsystem(JausSubsystem subs, int lookupN
 		}
 		else
 		{
-			return lookUpAddressInNode(findNode(subs->id, lookupNode), lookupCmpt, lookupInst);
+			return findAddressInNode(findNode(subs->id, lookupNode), lookupCmpt, lookupInst);
 		}
 	}
 	return NULL;
@@ -423,25 +381,33 @@ JausAddress SystemTree::lookUpAddressInSubsystem(JausSubsystem subs, int lookupN
 
 JausAddress SystemTree::lookUpAddress2(int lookupSubs, int lookupNode, int lookupCmpt, int lookupInst)
 {
+	JausAddress address = NULL;
+
+	pthread_rwlock_rdlock(&treeLock);
 	if(lookupSubs == JAUS_ADDRESS_WILDCARD_OCTET)
 	{
-		for(int i = JAUS_MINIMUM_SUBSYSTEM_ID; i < JAUS_MAXIMUM_SUBSYSTEM_ID; i++)
+		for(int i = JAUS_MINIMUM_SUBSYSTEM_ID; i < JAUS_MAXIMUM_SUBSYSTEM_ID && !address; i++)
 		{
-			JausAddress address = lookUpAddressInSubsystem(system[i], lookupNode, lookupCmpt, lookupInst);
-			if(address)
-			{
-				return address;
-			}
+			address = findAddressInSubsystem(system[i], lookupNode, lookupCmpt, lookupInst);
 		}
 	}
 	else
 	{
-		return lookUpAddressInSubsystem(system[lookupSubs], lookupNode, lookupCmpt, lookupInst);
+		address = findAddressInSubsystem(system[lookupSubs], lookupNode, lookupCmpt, lookupInst);
 	}
-	return NULL;
+	pthread_rwlock_unlock(&treeLock);
+	return address;
 }
 
 JausAddress SystemTree::lookUpAddress(int lookupSubs, int lookupNode, int lookupCmpt, int lookupInst)
+{
+	pthread_rwlock_rdlock(&treeLock);
+	JausAddress address = findAddress(lookupSubs, lookupNode, lookupCmpt, lookupInst);
+	pthread_rwlock_unlock(&treeLock);
+	return address;
+}
+
+JausAddress SystemTree::findAddress(int lookupSubs, int lookupNode, int lookupCmpt, int lookupInst)
 {
 	JausSubsystem subs = NULL;
 	JausNode node = NULL;
@@ -929,6 +895,7 @@ JausAddress SystemTree::lookUpServiceInSystem(int commandCode, int serviceType)
 		return NULL;
 	}
 
+	pthread_rwlock_rdlock(&treeLock);
 	for(int i = JAUS_MINIMUM_SUBSYSTEM_ID; i < JAUS_MAXIMUM_SUBSYSTEM_ID; i++)
 	{
 		JausSubsystem subs = system[i];
@@ -962,6 +929,7 @@ JausAddress SystemTree::lookUpServiceInSystem(int commandCode, int serviceType)
 						default:
 							// ERROR: Unknown service type
 							// SHOULD NEVER GET HERE, CHECKED ABOVE
+							pthread_rwlock_unlock(&treeLock);
 							return list;
 					}
 
@@ -998,6 +966,7 @@ JausAddress SystemTree::lookUpServiceInSystem(int commandCode, int serviceType)
 			}
 		}
 	}
+	pthread_rwlock_unlock(&treeLock);
 
 	return list;
 
@@ -1005,15 +974,16 @@ JausAddress SystemTree::lookUpServiceInSystem(int commandCode, int serviceType)
 
 JausSubsystem *SystemTree::getSystem(void)
 {
-	if(subsystemCount == 0)
+	JausSubsystem *systemClone = NULL;
+	int systemCloneIndex = 0;
+
+	pthread_rwlock_rdlock(&treeLock);
+	if(subsystemCount > 0)
 	{
-		return NULL;
+		systemClone = (JausSubsystem *)malloc(subsystemCount*sizeof(JausSubsystem));
 	}
-
-	JausSubsystem *systemClone = (JausSubsystem *)malloc(subsystemCount*sizeof(JausSubsystem));
-	int systemCloneIndex = 0;
 	
-	for(int i = JAUS_MINIMUM_SUBSYSTEM_ID; i < JAUS_MAXIMUM_SUBSYSTEM_ID; i++)
+	for(int i = JAUS_MINIMUM_SUBSYSTEM_ID; systemClone && i < JAUS_MAXIMUM_SUBSYSTEM_ID; i++)
 	{
 		if(system[i])
 		{
@@ -1021,6 +991,7 @@ JausSubsystem *SystemTree::getSystem(void)
 			systemCloneIndex++;
 		}
 	}
+	pthread_rwlock_unlock(&treeLock);
 	return systemClone;
 }
 
@@ -1036,12 +1007,14 @@ JausSubsystem SystemTree::getSubsystem(JausAddress address)
 
 JausSubsystem SystemTree::getSubsystem(int subsystemId)
 {
+	pthread_rwlock_rdlock(&treeLock);
 	JausSubsystem subs = system[subsystemId];
 	if(subs)
 	{
-		return jausSubsystemClone(subs);
+		subs = jausSubsystemClone(subs);
 	}
-	return NULL;
+	pthread_rwlock_unlock(&treeLock);
+	return subs;
 }
 
 JausNode SystemTree::getNode(JausNode node)
@@ -1056,12 +1029,14 @@ JausNode SystemTree::getNode(JausAddress address)
 
 JausNode SystemTree::getNode(int subsystemId, int nodeId)
 {
+	pthread_rwlock_rdlock(&treeLock);
 	JausNode node = findNode(subsystemId, nodeId);
 	if(node)
 	{
-		return jausNodeClone(node);
+		node = jausNodeClone(node);
 	}
-	return NULL;
+	pthread_rwlock_unlock(&treeLock);
+	return node;
 }
 
 JausComponent SystemTree::getComponent(JausComponent cmpt)
@@ -1076,12 +1051,14 @@ JausComponent SystemTree::getComponent(JausAddress address)
 
 JausComponent SystemTree::getComponent(int subsystemId, int nodeId, int componentId, int instanceId)
 {
+	pthread_rwlock_rdlock(&treeLock);
 	JausComponent cmpt = findComponent(subsystemId, nodeId, componentId, instanceId);
 	if(cmpt)
 	{
-		return jausComponentClone(cmpt);
+		cmpt = jausComponentClone(cmpt);
 	}
-	return NULL;
+	pthread_rwlock_unlock(&treeLock);
+	return cmpt;
 }
 
 JausNode SystemTree::findNode(JausNode node)
@@ -1158,7 +1135,16 @@ bool SystemTree::addComponent(JausAddress address, JausComponent cmpt)
 
 bool SystemTree::addComponent(int subsystemId, int nodeId, int componentId, int instanceId, JausComponent cmpt)
 {
-	if(!this->hasComponent(subsystemId, nodeId, componentId, instanceId))
+	pthread_rwlock_wrlock(&treeLock);
+	bool added = insertComponent(subsystemId, nodeId, componentId, instanceId, cmpt);
+	pthread_rwlock_unlock(&treeLock);
+	sendEvents();
+	return added;
+}
+
+bool SystemTree::insertComponent(int subsystemId, int nodeId, int componentId, int instanceId, JausComponent cmpt)
+{
+	if(!findComponent(subsystemId, nodeId, componentId, instanceId))
 	{
 		JausNode node = findNode(subsystemId, nodeId);
 		if(node && componentId >= JAUS_MINIMUM_COMPONENT_ID && componentId <= JAUS_MAXIMUM_COMPONENT_ID
@@ -1201,7 +1187,16 @@ bool SystemTree::addNode(JausAddress address, JausNode node)
 
 bool SystemTree::addNode(int subsystemId, int nodeId, JausNode node)
 {
-	if(!this->hasNode(subsystemId, nodeId))
+	pthread_rwlock_wrlock(&treeLock);
+	bool added = insertNode(subsystemId, nodeId, node);
+	pthread_rwlock_unlock(&treeLock);
+	sendEvents();
+	return added;
+}
+
+bool SystemTree::insertNode(int subsystemId, int nodeId, JausNode node)
+{
+	if(!findNode(subsystemId, nodeId))
 	{
 		JausSubsystem subs = system[subsystemId];
 		if(subs && nodeId >= JAUS_MINIMUM_NODE_ID && nodeId <= JAUS_MAXIMUM_NODE_ID)
@@ -1241,7 +1236,16 @@ bool SystemTree::addSubsystem(JausAddress address, JausSubsystem subs)
 
 bool SystemTree::addSubsystem(int subsystemId, JausSubsystem subs)
 {
-	if(!this->hasSubsystem(subsystemId))
+	pthread_rwlock_wrlock(&treeLock);
+	bool added = insertSubsystem(subsystemId, subs);
+	pthread_rwlock_unlock(&treeLock);
+	sendEvents();
+	return added;
+}
+
+bool SystemTree::insertSubsystem(int subsystemId, JausSubsystem subs)
+{
+	if(!system[subsystemId])
 	{
 		// Test for valid ID
 		if(subsystemId >= JAUS_MINIMUM_SUBSYSTEM_ID && subsystemId <= JAUS_MAXIMUM_SUBSYSTEM_ID)
@@ -1279,6 +1283,15 @@ bool SystemTree::removeNode(JausAddress address)
 }
 
 bool SystemTree::removeNode(int subsystemId, int nodeId)
+{
+	pthread_rwlock_wrlock(&treeLock);
+	bool removed = eraseNode(subsystemId, nodeId);
+	pthread_rwlock_unlock(&treeLock);
+	sendEvents();
+	return removed;
+}
+
+bool SystemTree::eraseNode(int subsystemId, int nodeId)
 {
 	JausSubsystem subs = system[subsystemId];
 	if(subs)
@@ -1312,6 +1325,15 @@ bool SystemTree::removeSubsystem(JausAddress address)
 }
 
 bool SystemTree::removeSubsystem(int subsystemId)
+{
+	pthread_rwlock_wrlock(&treeLock);
+	bool removed = eraseSubsystem(subsystemId);
+	pthread_rwlock_unlock(&treeLock);
+	sendEvents();
+	return removed;
+}
+
+bool SystemTree::eraseSubsystem(int subsystemId)
 {
 	JausSubsystem subs = system[subsystemId];
 	if(subs)
@@ -1339,6 +1361,15 @@ bool SystemTree::removeComponent(JausAddress address)
 }
 
 bool SystemTree::removeComponent(int subsystemId, int nodeId, int componentId, int instanceId)
+{
+	pthread_rwlock_wrlock(&treeLock);
+	bool removed = eraseComponent(subsystemId, nodeId, componentId, instanceId);
+	pthread_rwlock_unlock(&treeLock);
+	sendEvents();
+	return removed;
+}
+
+bool SystemTree::eraseComponent(int subsystemId, int nodeId, int componentId, int instanceId)
 {
 	JausNode node = findNode(subsystemId, nodeId);
 	if(node)
@@ -1367,11 +1398,20 @@ bool SystemTree::replaceSubsystem(JausAddress address, JausSubsystem newSubs)
 }
 
 bool SystemTree::replaceSubsystem(int subsystemId, JausSubsystem newSubs)
+{
+	pthread_rwlock_wrlock(&treeLock);
+	bool replaced = exchangeSubsystem(subsystemId, newSubs);
+	pthread_rwlock_unlock(&treeLock);
+	sendEvents();
+	return replaced;
+}
+
+bool SystemTree::exchangeSubsystem(int subsystemId, JausSubsystem newSubs)
 {
 	JausSubsystem currentSubs = system[subsystemId];
 	if(!currentSubs)
 	{
-		addSubsystem(subsystemId, newSubs); // No subsystem to replace, so add the newSubs
+		insertSubsystem(subsystemId, newSubs); // No subsystem to replace, so add the newSubs
 		return true;
 	}
 
@@ -1409,7 +1449,7 @@ bool SystemTree::replaceSubsystem(int subsystemId, JausSubsystem newSubs)
 				{
 					size_t stringLength = strlen(currentCmpt->identification) + 1;
 					cloneCmpt->identification = (char *) realloc(cloneCmpt->identification, stringLength);
-					sprintf(cloneCmpt->identification, "%s", currentNode->identification);
+					sprintf(cloneCmpt->identification, "%s", currentCmpt->identification);
 				}
 			}
 		}
@@ -1418,6 +1458,7 @@ bool SystemTree::replaceSubsystem(int subsystemId, JausSubsystem newSubs)
 
 	system[subsystemId] = cloneSubs;
 	subsystemCount++;
+	changeCount++;
 
 	//char string[1024] = {0};
 	//jausSubsystemTableToString(cloneSubs, string);
@@ -1432,12 +1473,21 @@ bool SystemTree::replaceNode(JausAddress address, JausNode newNode)
 }
 
 bool SystemTree::replaceNode(int subsystemId, int nodeId, JausNode newNode)
+{
+	pthread_rwlock_wrlock(&treeLock);
+	bool replaced = exchangeNode(subsystemId, nodeId, newNode);
+	pthread_rwlock_unlock(&treeLock);
+	sendEvents();
+	return replaced;
+}
+
+bool SystemTree::exchangeNode(int subsystemId, int nodeId, JausNode newNode)
 {
 	JausNode currentNode = findNode(subsystemId, nodeId);
 	if(!currentNode)
 	{
 		// No node to replace, so add the newNode
-		addNode(subsystemId, nodeId, newNode);
+		insertNode(subsystemId, nodeId, newNode);
 		return true;
 	}
 
@@ -1447,9 +1497,12 @@ bool SystemTree::replaceNode(int subsystemId, int nodeId, JausNode newNode)
 		return false;
 	}
 	cloneNode->id = currentNode->id;
-	size_t stringLength = strlen(currentNode->identification) + 1;
-	cloneNode->identification = (char *) realloc(cloneNode->identification, stringLength);
-	sprintf(cloneNode->identification, "%s", currentNode->identification);
+	if(currentNode->identification)
+	{
+		size_t stringLength = strlen(currentNode->identification) + 1;
+		cloneNode->identification = (char *) realloc(cloneNode->identification, stringLength);
+		sprintf(cloneNode->identification, "%s", currentNode->identification);
+	}
 	cloneNode->subsystem = currentNode->subsystem;
 	
 	for(int i = 0; i < newNode->components->elementCount; i++)
@@ -1485,11 +1538,15 @@ bool SystemTree::replaceNode(int subsystemId, int nodeId, JausNode newNode)
 	
 	cloneNode->subsystem = system[subsystemId];
 	jausArrayAdd(system[subsystemId]->nodes, cloneNode);
+	changeCount++;
 	return true;
 }
 
 bool SystemTree::setSubsystemIdentification(JausAddress address, char *identification)
 {
+	bool set = false;
+
+	pthread_rwlock_wrlock(&treeLock);
 	JausSubsystem subs = system[address->subsystem];
 	if(subs)
 	{
@@ -1498,14 +1555,18 @@ bool SystemTree::setSubsystemIdentification(JausAddress address, char *identific
 		if(subs->identification)
 		{
 			sprintf(subs->identification, "%s", identification);
-			return true;
+			set = true;
 		}
 	}
-	return false;
+	pthread_rwlock_unlock(&treeLock);
+	return set;
 }
 
 bool SystemTree::setNodeIdentification(JausAddress address, char *identification)
 {
+	bool set = false;
+
+	pthread_rwlock_wrlock(&treeLock);
 	JausNode node = findNode(address);
 	if(node)
 	{
@@ -1514,14 +1575,18 @@ bool SystemTree::setNodeIdentification(JausAddress address, char *identification
 		if(node->identification)
 		{
 			sprintf(node->identification, "%s", identification);
-			return true;
+			set = true;
 		}
 	}
-	return false;
+	pthread_rwlock_unlock(&treeLock);
+	return set;
 }
 
 bool SystemTree::setComponentIdentification(JausAddress address, char *identification)
 {
+	bool set = false;
+
+	pthread_rwlock_wrlock(&treeLock);
 	JausComponent cmpt = findComponent(address);
 	if(cmpt)
 	{
@@ -1530,23 +1595,26 @@ bool SystemTree::setComponentIdentification(JausAddress address, char *identific
 		if(cmpt->identification)
 		{
 			sprintf(cmpt->identification, "%s", identification);
-			return true;
+			set = true;
 		}
 	}
-	return false;
+	pthread_rwlock_unlock(&treeLock);
+	return set;
 }
 
 bool SystemTree::setComponentServices(JausAddress address, JausArray inputServices)
 {
+	pthread_rwlock_wrlock(&treeLock);
 	JausComponent cmpt = findComponent(address);
 	if(cmpt)
 	{
 		// Remove current service set
 		if(cmpt->services) jausServicesDestroy(cmpt->services);
 		cmpt->services = jausServicesClone(inputServices);
-		return true;
+		changeCount++;
 	}
-	return false;
+	pthread_rwlock_unlock(&treeLock);
+	return cmpt != NULL;
 }
 
 char *SystemTree::getSubsystemIdentification(JausSubsystem subsystem)
@@ -1563,17 +1631,15 @@ char *SystemTree::getSubsystemIdentification(int subsId)
 {
 	char *string = NULL;
 
+	pthread_rwlock_rdlock(&treeLock);
 	JausSubsystem subs = system[subsId];
 	if(subs)
 	{
 		string = (char *)calloc(strlen(subs->identification)+1, sizeof(char));
 		strcpy(string, subs->identification);
-		return string;
-	}
-	else
-	{
-		return NULL;
 	}
+	pthread_rwlock_unlock(&treeLock);
+	return string;
 }
 
 char *SystemTree::getNodeIdentification(JausNode node)
@@ -1590,17 +1656,15 @@ char *SystemTree::getNodeIdentification(int subsId, int nodeId)
 {
 	char *string = NULL;
 
+	pthread_rwlock_rdlock(&treeLock);
 	JausNode node = findNode(subsId, nodeId);
 	if(node)
 	{
 		string = (char *)calloc(strlen(node->identification)+1, sizeof(char));
 		strcpy(string, node->identification);
-		return string;
-	}
-	else
-	{
-		return NULL;
 	}
+	pthread_rwlock_unlock(&treeLock);
+	return string;
 }
 
 std::string SystemTree::toString()
@@ -1608,9 +1672,10 @@ std::string SystemTree::toString()
 	string output = string();
 	char buffer[4096] = {0};
 
+	pthread_rwlock_rdlock(&treeLock);
 	if(subsystemCount == 0)
 	{
-		return "System Tree Empty\n";
+		output = "System Tree Empty\n";
 	}
 
 	for(int i = JAUS_MINIMUM_SUBSYSTEM_ID; i < JAUS_MAXIMUM_SUBSYSTEM_ID; i++)
@@ -1622,6 +1687,7 @@ std::string SystemTree::toString()
 			output += "\n";
 		}
 	}
+	pthread_rwlock_unlock(&treeLock);
 
 	return output;
 }
@@ -1631,9 +1697,10 @@ std::string SystemTree::toDetailedString()
 	string output = string();
 	char buffer[20480] = {0};
 
+	pthread_rwlock_rdlock(&treeLock);
 	if(subsystemCount == 0)
 	{
-		return "System Tree Empty\n";
+		output = "System Tree Empty\n";
 	}
 
 	for(int i = JAUS_MINIMUM_SUBSYSTEM_ID; i < JAUS_MAXIMUM_SUBSYSTEM_ID; i++)
@@ -1645,16 +1712,177 @@ std::string SystemTree::toDetailedString()
 			output += "\n";
 		}
 	}
+	pthread_rwlock_unlock(&treeLock);
 
 	return output;
 }
 
+// Returns every component matching address, where a wildcard octet matches any value, in tree order.
+// If commandCode is negative no service is required, otherwise the component must list commandCode
+// as a command of serviceType. The result is a list linked through next, or NULL.
+JausAddress SystemTree::lookUpAddressList(JausAddress address, int commandCode, int serviceType)
+{
+	pthread_rwlock_rdlock(&treeLock);
+	JausAddress list = findAddressList(address, commandCode, serviceType);
+	pthread_rwlock_unlock(&treeLock);
+	return list;
+}
+
+JausAddress SystemTree::findAddressList(JausAddress address, int commandCode, int serviceType)
+{
+	JausAddress list = NULL;
+	JausAddress last = NULL;
+
+	for(int i = JAUS_MINIMUM_SUBSYSTEM_ID; i < JAUS_MAXIMUM_SUBSYSTEM_ID; i++)
+	{
+		JausSubsystem subs = system[i];
+		if(!subs || (address->subsystem != JAUS_ADDRESS_WILDCARD_OCTET && address->subsystem != subs->id))
+		{
+			continue;
+		}
+
+		for(int j = 0; j < subs->nodes->elementCount; j++)
+		{
+			JausNode node = (JausNode) subs->nodes->elementData[j];
+			if(address->node != JAUS_ADDRESS_WILDCARD_OCTET && address->node != node->id)
+			{
+				continue;
+			}
+
+			for(int k = 0; k < node->components->elementCount; k++)
+			{
+				JausComponent cmpt = (JausComponent) node->components->elementData[k];
+				if(	(address->component != JAUS_ADDRESS_WILDCARD_OCTET && address->component != cmpt->address->component) ||
+					(address->instance != JAUS_ADDRESS_WILDCARD_OCTET && address->instance != cmpt->address->instance))
+				{
+					continue;
+				}
+
+				if(commandCode >= 0 && !componentHasCommand(cmpt, commandCode, serviceType))
+				{
+					continue;
+				}
+
+				JausAddress match = jausAddressClone(cmpt->address);
+				if(!match)
+				{
+					return list;
+				}
+				match->next = NULL;
+
+				if(last)
+				{
+					last->next = match;
+				}
+				else
+				{
+					list = match;
+				}
+				last = match;
+			}
+		}
+	}
+
+	return list;
+}
+
+bool SystemTree::componentHasCommand(JausComponent cmpt, int commandCode, int serviceType)
+{
+	for(int i = 0; cmpt->services && i < cmpt->services->elementCount; i++)
+	{
+		JausService service = (JausService) cmpt->services->elementData[i];
+		JausCommand command = (serviceType == JAUS_SERVICE_INPUT_COMMAND)? service->inputCommandList : service->outputCommandList;
+
+		for(; command; command = command->next)
+		{
+			if(command->commandCode == commandCode)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+unsigned int SystemTree::getChangeCount(void)
+{
+	pthread_rwlock_rdlock(&treeLock);
+	unsigned int count = changeCount;
+	pthread_rwlock_unlock(&treeLock);
+	return count;
+}
+
+// Appends one record per known component, in the same order the lookUp functions search the tree:
+//   instance, component, node, subsystem (1 byte each)
+//   command count (2 bytes, LE)
+//   command count * [command code (2 bytes, LE), service type (1 byte)]
+void SystemTree::getDirectory(std::vector <unsigned char> &directory)
+{
+	pthread_rwlock_rdlock(&treeLock);
+	for(int i = JAUS_MINIMUM_SUBSYSTEM_ID; i < JAUS_MAXIMUM_SUBSYSTEM_ID; i++)
+	{
+		JausSubsystem subs = system[i];
+		if(!subs)
+		{
+			continue;
+		}
+
+		for(int j = 0; j < subs->nodes->elementCount; j++)
+		{
+			JausNode node = (JausNode) subs->nodes->elementData[j];
+
+			for(int k = 0; k < node->components->elementCount; k++)
+			{
+				JausComponent cmpt = (JausComponent) node->components->elementData[k];
+
+				directory.push_back((unsigned char)(cmpt->address->instance & 0xFF));
+				directory.push_back((unsigned char)(cmpt->address->component & 0xFF));
+				directory.push_back((unsigned char)(cmpt->address->node & 0xFF));
+				directory.push_back((unsigned char)(cmpt->address->subsystem & 0xFF));
+
+				// Reserve the command count, it is filled in once the services are walked
+				size_t countIndex = directory.size();
+				unsigned short commandCount = 0;
+				directory.push_back(0);
+				directory.push_back(0);
+
+				for(int m = 0; cmpt->services && m < cmpt->services->elementCount; m++)
+				{
+					JausService service = (JausService) cmpt->services->elementData[m];
+					JausCommand command;
+
+					for(command = service->inputCommandList; command; command = command->next)
+					{
+						directory.push_back((unsigned char)(command->commandCode & 0xFF));
+						directory.push_back((unsigned char)((command->commandCode >> 8) & 0xFF));
+						directory.push_back((unsigned char) JAUS_SERVICE_INPUT_COMMAND);
+						commandCount++;
+					}
+
+					for(command = service->outputCommandList; command; command = command->next)
+					{
+						directory.push_back((unsigned char)(command->commandCode & 0xFF));
+						directory.push_back((unsigned char)((command->commandCode >> 8) & 0xFF));
+						directory.push_back((unsigned char) JAUS_SERVICE_OUTPUT_COMMAND);
+						commandCount++;
+					}
+				}
+
+				directory[countIndex] = (unsigned char)(commandCount & 0xFF);
+				directory[countIndex + 1] = (unsigned char)((commandCount >> 8) & 0xFF);
+			}
+		}
+	}
+	pthread_rwlock_unlock(&treeLock);
+}
+
 void SystemTree::refresh()
 {
 	int i = 0;
 	int j = 0;
 	int k = 0;
 
+	pthread_rwlock_wrlock(&treeLock);
 	for(i = JAUS_MINIMUM_SUBSYSTEM_ID; i < JAUS_MAXIMUM_SUBSYSTEM_ID; i++)
 	{
 		if(system[i])
@@ -1700,7 +1928,7 @@ void SystemTree::refresh()
 							SystemTreeEvent *e = new SystemTreeEvent(SystemTreeEvent::NodeTimeout, node);
 							
 							// Remove the Node
-							removeNode(node);
+							eraseNode(node->subsystem->id, node->id);
 
 							// Handle the event 
 							this->handleEvent(e);
@@ -1719,7 +1947,7 @@ void SystemTree::refresh()
 					SystemTreeEvent *e = new SystemTreeEvent(SystemTreeEvent::SubsystemTimeout, system[i]);
 					
 					// Remove the dead subsystem
-					removeSubsystem(system[i]->id);
+					eraseSubsystem(system[i]->id);
 
 					// Handle the event
 					this->handleEvent(e);
@@ -1727,7 +1955,9 @@ void SystemTree::refresh()
 			}
 		}
 	}
+	pthread_rwlock_unlock(&treeLock);
 
+	sendEvents();
 }
 
 bool SystemTree::registerEventHandler(EventHandler *handler)
@@ -1742,13 +1972,33 @@ bool SystemTree::registerEventHandler(EventHandler *handler)
 
 void SystemTree::handleEvent(NodeManagerEvent *e)
 {
-	// Send to all registered handlers
+	// Every add, remove and timeout is reported through here
+	changeCount++;
+
+	pthread_mutex_lock(&eventMutex);
+	pendingEvents.push_back(e);
+	pthread_mutex_unlock(&eventMutex);
+}
+
+void SystemTree::sendEvents(void)
+{
+	std::list <NodeManagerEvent *> events;
+	std::list <NodeManagerEvent *>::iterator event;
 	std::list <EventHandler *>::iterator iter;
-	for(iter = eventHandlers.begin(); iter != eventHandlers.end(); iter++)
+
+	pthread_mutex_lock(&eventMutex);
+	events.swap(pendingEvents);
+	pthread_mutex_unlock(&eventMutex);
+
+	// Send to all registered handlers
+	for(event = events.begin(); event != events.end(); event++)
 	{
-		(*iter)->handleEvent(e->cloneEvent());
+		for(iter = eventHandlers.begin(); iter != eventHandlers.end(); iter++)
+		{
+			(*iter)->handleEvent((*event)->cloneEvent());
+		}
+		delete *event;
 	}
-	delete e;
 }
 
 
@@ -65,6 +65,9 @@ void defaultJausMessageProcessorNoDestroy(JausMessage message, NodeManagerInterf
 	ActivateServiceConnectionMessage activateServiceConnection;
 	SuspendServiceConnectionMessage suspendServiceConnection;
 	TerminateServiceConnectionMessage terminateServiceConnection;
+	CreateEventMessage createEvent;
+	UpdateEventMessage updateEvent;
+	CancelEventMessage cancelEvent;
 	QueryServicesMessage queryServices;
 	ReportServicesMessage reportServices;
 	
@@ -308,6 +311,45 @@ void defaultJausMessageProcessorNoDestroy(JausMessage message, NodeManagerInterf
 				//cError("DefaultMessageProcessor: Error unpacking %s message.\n", jausMessageCommandCodeString(message));
 			}
 			break;
+
+		case JAUS_CREATE_EVENT:
+			createEvent = createEventMessageFromJausMessage(message);
+			if(createEvent)
+			{
+				eventManagerProcessCreateEventMessage(nmi, createEvent);
+				createEventMessageDestroy(createEvent);
+			}
+			else
+			{
+				//cError("DefaultMessageProcessor: Error unpacking %s message.\n", jausMessageCommandCodeString(message));
+			}
+			break;
+
+		case JAUS_UPDATE_EVENT:
+			updateEvent = updateEventMessageFromJausMessage(message);
+			if(updateEvent)
+			{
+				eventManagerProcessUpdateEventMessage(nmi, updateEvent);
+				updateEventMessageDestroy(updateEvent);
+			}
+			else
+			{
+				//cError("DefaultMessageProcessor: Error unpacking %s message.\n", jausMessageCommandCodeString(message));
+			}
+			break;
+
+		case JAUS_CANCEL_EVENT:
+			cancelEvent = cancelEventMessageFromJausMessage(message);
+			if(cancelEvent)
+			{
+				eventManagerProcessCancelEventMessage(nmi, cancelEvent);
+				cancelEventMessageDestroy(cancelEvent);
+			}
+			else
+			{
+				//cError("DefaultMessageProcessor: Error unpacking %s message.\n", jausMessageCommandCodeString(message));
+			}
+			break;
 					
 		case JAUS_QUERY_COMPONENT_AUTHORITY:
 			reportComponentAuthority = reportComponentAuthorityMessageCreate();
@@ -364,6 +406,7 @@ void defaultJausMessageProcessorNoDestroy(JausMessage message, NodeManagerInterf
 				cmpt->node->subsystem = jausSubsystemClone(reportConfMsg->subsystem);
 				reportConfigurationMessageDestroy(reportConfMsg);
 				scManagerProcessUpdatedSubystem(nmi, cmpt->node->subsystem);
+				eventManagerProcessUpdatedSubsystem(nmi);
 				
 				// Check for Controlleer
 				if(	cmpt->controller.active == JAUS_TRUE && !nodeManagerVerifyAddress(nmi, cmpt->controller.address) )
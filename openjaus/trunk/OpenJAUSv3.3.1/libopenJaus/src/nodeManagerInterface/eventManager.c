@@ -0,0 +1,870 @@
+/*****************************************************************************
+ *  Copyright (c) 2008, University of Florida
+ *  All rights reserved.
+ *
+ *  This file is part of OpenJAUS.  OpenJAUS is distributed under the BSD
+ *  license.  See the LICENSE file for details.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of the University of Florida nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+// File Name: eventManager.c
+//
+// Version: 3.3.0
+//
+// Date: 07/09/08
+//
+// Description:	Provides the JAUS event routines for components, the producer side of
+//				Create, Update and Cancel Event. Events are kept by report message and
+//				evaluated each time the component publishes that report.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "nodeManagerInterface/nodeManagerInterface.h"
+
+#define EVENT_PUBLISH_STACK_TARGETS		16		// Events a publish collects before it allocates its target list
+#define EVENT_FIELD_COUNT				256		// Report field numbers are a byte
+#define EVENT_DATA_EVENT_ID_INDEX		0		// Offsets into the body of an encoded Event message
+#define EVENT_DATA_SEQUENCE_NUMBER_INDEX	3
+
+#define EVENT_FIELD_NOT_FETCHED			0
+#define EVENT_FIELD_AVAILABLE			1
+#define EVENT_FIELD_UNAVAILABLE			2
+
+// What a publish needs from one event which fired, taken while the manager is locked
+typedef struct
+{
+	struct JausAddressStruct address;
+	JausUnsignedInteger presenceVector;
+	JausByte eventId;
+	JausByte sequenceNumber;
+	JausMessage message;		// Encoded Event message, shared with earlier targets of the same presence vector
+	int ownsMessage;
+}EventPublishTarget;
+
+SupportedEventMessage eventFindSupportedEventMsg(EventManager, unsigned short);
+int eventConfigure(Event, SupportedEventMessage, JausByte, JausByte, JausByte, JausByte, JausEventLimit, JausEventLimit, JausEventLimit, double, JausMessage);
+void eventRemove(EventManager, SupportedEventMessage, Event);
+void eventSendConfirm(NodeManagerInterface, JausAddress, JausByte, JausUnsignedShort, JausByte, double, JausByte);
+
+EventManager eventManagerCreate(void)
+{
+	EventManager evm = (EventManager)malloc(sizeof(EventManagerStruct));
+	if(evm == NULL)
+	{
+		return NULL;
+	}
+
+	evm->supportedEventMsgList = NULL;
+	memset(evm->supportedEventMsgIndex, 0, sizeof(evm->supportedEventMsgIndex));
+	memset(evm->events, 0, sizeof(evm->events));
+	evm->eventCount = 0;
+	pthread_mutex_init(&evm->mutex, NULL);
+
+	return evm;
+}
+
+void eventManagerDestroy(EventManager evm)
+{
+	SupportedEventMessage supportedEventMsg;
+	int i;
+
+	for(i = 0; i < EVENT_MANAGER_MAX_EVENTS; i++)
+	{
+		if(evm->events[i])
+		{
+			jausAddressDestroy(evm->events[i]->address);
+			free(evm->events[i]);
+		}
+	}
+
+	while(evm->supportedEventMsgList)
+	{
+		supportedEventMsg = evm->supportedEventMsgList;
+		evm->supportedEventMsgList = supportedEventMsg->nextSupportedEventMsg;
+		free(supportedEventMsg);
+	}
+
+	pthread_mutex_destroy(&evm->mutex);
+	free(evm);
+}
+
+void eventManagerAddSupportedMessage(NodeManagerInterface nmi, unsigned short commandCode, JausBoolean (*fieldValue)(void *, JausByte, double *))
+{
+	SupportedEventMessage supportedEventMsg;
+	int bucket = commandCode % EVENT_MANAGER_HASH_BUCKETS;
+
+	pthread_mutex_lock(&nmi->evm->mutex);
+
+	supportedEventMsg = eventFindSupportedEventMsg(nmi->evm, commandCode);
+	if(supportedEventMsg)
+	{
+		supportedEventMsg->fieldValue = fieldValue;
+		pthread_mutex_unlock(&nmi->evm->mutex);
+		return;
+	}
+
+	supportedEventMsg = (SupportedEventMessage)malloc(sizeof(SupportedEventMessageStruct));
+	if(supportedEventMsg == NULL)
+	{
+		pthread_mutex_unlock(&nmi->evm->mutex);
+		return;
+	}
+
+	supportedEventMsg->commandCode = commandCode;
+	supportedEventMsg->fieldValue = fieldValue;
+	supportedEventMsg->eventList = NULL;
+	supportedEventMsg->nextSupportedEventMsg = nmi->evm->supportedEventMsgList;
+	supportedEventMsg->nextIndexedEventMsg = nmi->evm->supportedEventMsgIndex[bucket];
+	nmi->evm->supportedEventMsgList = supportedEventMsg;
+	nmi->evm->supportedEventMsgIndex[bucket] = supportedEventMsg;
+
+	pthread_mutex_unlock(&nmi->evm->mutex);
+}
+
+void eventManagerRemoveSupportedMessage(NodeManagerInterface nmi, unsigned short commandCode)
+{
+	SupportedEventMessage supportedEventMsg;
+	SupportedEventMessage *link;
+
+	pthread_mutex_lock(&nmi->evm->mutex);
+
+	supportedEventMsg = eventFindSupportedEventMsg(nmi->evm, commandCode);
+	if(supportedEventMsg == NULL)
+	{
+		pthread_mutex_unlock(&nmi->evm->mutex);
+		return;
+	}
+
+	while(supportedEventMsg->eventList)
+	{
+		eventRemove(nmi->evm, supportedEventMsg, supportedEventMsg->eventList);
+	}
+
+	for(link = &nmi->evm->supportedEventMsgList; *link != supportedEventMsg; link = &(*link)->nextSupportedEventMsg);
+	*link = supportedEventMsg->nextSupportedEventMsg;
+
+	for(link = &nmi->evm->supportedEventMsgIndex[commandCode % EVENT_MANAGER_HASH_BUCKETS]; *link != supportedEventMsg; link = &(*link)->nextIndexedEventMsg);
+	*link = supportedEventMsg->nextIndexedEventMsg;
+
+	free(supportedEventMsg);
+
+	pthread_mutex_unlock(&nmi->evm->mutex);
+}
+
+void eventManagerProcessCreateEventMessage(NodeManagerInterface nmi, CreateEventMessage message)
+{
+	SupportedEventMessage supportedEventMsg;
+	Event event;
+	int eventId;
+	int responseCode;
+	double confirmedUpdateRate;
+
+	pthread_mutex_lock(&nmi->evm->mutex);
+
+	supportedEventMsg = eventFindSupportedEventMsg(nmi->evm, message->reportMessageCode);
+	if(supportedEventMsg == NULL)
+	{
+		pthread_mutex_unlock(&nmi->evm->mutex);
+		eventSendConfirm(nmi, message->source, message->requestId, message->reportMessageCode, 0, 0, MESSAGE_UNSUPPORTED_RESPONSE);
+		return;
+	}
+
+	for(eventId = 0; eventId < EVENT_MANAGER_MAX_EVENTS && nmi->evm->events[eventId]; eventId++);
+	if(eventId == EVENT_MANAGER_MAX_EVENTS)
+	{
+		pthread_mutex_unlock(&nmi->evm->mutex);
+		eventSendConfirm(nmi, message->source, message->requestId, message->reportMessageCode, 0, 0, CONNECTION_REFUSED_RESPONSE);
+		return;
+	}
+
+	event = (Event)malloc(sizeof(EventStruct));
+	if(event == NULL)
+	{
+		pthread_mutex_unlock(&nmi->evm->mutex);
+		eventSendConfirm(nmi, message->source, message->requestId, message->reportMessageCode, 0, 0, CONNECTION_REFUSED_RESPONSE);
+		return;
+	}
+
+	responseCode = eventConfigure(event, supportedEventMsg, message->presenceVector, message->eventType, message->eventBoundary, message->limitDataField,
+									message->lowerLimit, message->upperLimit, message->stateLimit, message->requestedUpdateRate, message->queryMessage);
+	if(responseCode != SUCCESSFUL_RESPONSE)
+	{
+		free(event);
+		pthread_mutex_unlock(&nmi->evm->mutex);
+		eventSendConfirm(nmi, message->source, message->requestId, message->reportMessageCode, 0, 0, (JausByte)responseCode);
+		return;
+	}
+
+	event->address = jausAddressClone(message->source);
+	event->commandCode = message->reportMessageCode;
+	event->eventId = (JausByte)eventId;
+	event->sequenceNumber = 0;
+
+	// Add the event to the front of its report's list
+	event->prevEvent = NULL;
+	event->nextEvent = supportedEventMsg->eventList;
+	if(event->nextEvent)
+	{
+		event->nextEvent->prevEvent = event;
+	}
+	supportedEventMsg->eventList = event;
+	nmi->evm->events[eventId] = event;
+	nmi->evm->eventCount++;
+	confirmedUpdateRate = event->periodSec > 0? 1.0 / event->periodSec : 0;
+
+	pthread_mutex_unlock(&nmi->evm->mutex);
+
+	// Confirms are sent unlocked, so a congested link does not hold up publishing
+	eventSendConfirm(nmi, message->source, message->requestId, message->reportMessageCode, (JausByte)eventId, confirmedUpdateRate, SUCCESSFUL_RESPONSE);
+}
+
+void eventManagerProcessUpdateEventMessage(NodeManagerInterface nmi, UpdateEventMessage message)
+{
+	SupportedEventMessage supportedEventMsg;
+	Event event;
+	int responseCode;
+	double confirmedUpdateRate;
+
+	pthread_mutex_lock(&nmi->evm->mutex);
+
+	event = nmi->evm->events[message->eventId];
+	if(event == NULL || event->commandCode != message->reportMessageCode || !jausAddressEqual(event->address, message->source))
+	{
+		pthread_mutex_unlock(&nmi->evm->mutex);
+		eventSendConfirm(nmi, message->source, message->requestId, message->reportMessageCode, message->eventId, 0, INVALID_EVENT_RESPONSE);
+		return;
+	}
+
+	// A refused update leaves the event as it was
+	supportedEventMsg = eventFindSupportedEventMsg(nmi->evm, event->commandCode);
+	responseCode = eventConfigure(event, supportedEventMsg, message->presenceVector, message->eventType, message->eventBoundary, message->limitDataField,
+									message->lowerLimit, message->upperLimit, message->stateLimit, message->requestedUpdateRate, message->queryMessage);
+
+	confirmedUpdateRate = event->periodSec > 0? 1.0 / event->periodSec : 0;
+
+	pthread_mutex_unlock(&nmi->evm->mutex);
+
+	eventSendConfirm(nmi, message->source, message->requestId, message->reportMessageCode, message->eventId, confirmedUpdateRate, (JausByte)responseCode);
+}
+
+void eventManagerProcessCancelEventMessage(NodeManagerInterface nmi, CancelEventMessage message)
+{
+	SupportedEventMessage supportedEventMsg;
+	Event event;
+	JausBoolean hasMessageCode = jausByteIsBitSet(message->presenceVector, CANCEL_EVENT_PV_MESSAGE_CODE_BIT);
+	JausBoolean hasEventId = jausByteIsBitSet(message->presenceVector, CANCEL_EVENT_PV_EVENT_ID_BIT);
+	int cancelCount = 0;
+	int i;
+
+	pthread_mutex_lock(&nmi->evm->mutex);
+
+	// Without an event id every event of the client is cancelled, or every one on the message code.
+	// The message code may name the report or the query the client sent with it
+	for(i = hasEventId? message->eventId : 0; i < (hasEventId? message->eventId + 1 : EVENT_MANAGER_MAX_EVENTS); i++)
+	{
+		event = nmi->evm->events[i];
+		if(	event == NULL ||
+			!jausAddressEqual(event->address, message->source) ||
+			(hasMessageCode && event->commandCode != message->messageCode && event->commandCode != jausMessageGetComplementaryCommandCode(message->messageCode)))
+		{
+			continue;
+		}
+
+		supportedEventMsg = eventFindSupportedEventMsg(nmi->evm, event->commandCode);
+		eventRemove(nmi->evm, supportedEventMsg, event);
+		cancelCount++;
+	}
+
+	pthread_mutex_unlock(&nmi->evm->mutex);
+
+	eventSendConfirm(nmi, message->source, message->requestId, message->messageCode, message->eventId, 0, cancelCount? SUCCESSFUL_RESPONSE : INVALID_EVENT_RESPONSE);
+}
+
+// The clients are verified with the manager unlocked, then the events of those gone are removed
+// unless they were cancelled or replaced in the meantime
+void eventManagerProcessUpdatedSubsystem(NodeManagerInterface nmi)
+{
+	Event events[EVENT_MANAGER_MAX_EVENTS];
+	struct JausAddressStruct addressStructs[EVENT_MANAGER_MAX_EVENTS];
+	JausAddress addresses[EVENT_MANAGER_MAX_EVENTS];
+	JausBoolean verified[EVENT_MANAGER_MAX_EVENTS];
+	int eventIds[EVENT_MANAGER_MAX_EVENTS];
+	int count = 0;
+	int i;
+
+	pthread_mutex_lock(&nmi->evm->mutex);
+	for(i = 0; i < EVENT_MANAGER_MAX_EVENTS; i++)
+	{
+		if(nmi->evm->events[i])
+		{
+			events[count] = nmi->evm->events[i];
+			eventIds[count] = i;
+			addresses[count] = &addressStructs[count];
+			jausAddressCopy(addresses[count], events[count]->address);
+			count++;
+		}
+	}
+	pthread_mutex_unlock(&nmi->evm->mutex);
+
+	// Events are kept when the Node Manager cannot be asked
+	if(count == 0 || nodeManagerVerifyAddressList(nmi, addresses, count, verified) < 0)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&nmi->evm->mutex);
+	for(i = 0; i < count; i++)
+	{
+		if(!verified[i] && nmi->evm->events[eventIds[i]] == events[i] && jausAddressEqual(events[i]->address, addresses[i]))
+		{
+			eventRemove(nmi->evm, eventFindSupportedEventMsg(nmi->evm, events[i]->commandCode), events[i]);
+		}
+	}
+	pthread_mutex_unlock(&nmi->evm->mutex);
+}
+
+// Tests one field value against the boundary of an event
+static JausBoolean eventBoundaryTest(Event event, double value)
+{
+	switch(event->eventBoundary)
+	{
+		case EQUAL_BOUNDARY:
+			return value == event->stateLimit;
+
+		case NOT_EQUAL_BOUNDARY:
+			return value != event->stateLimit;
+
+		case INSIDE_INCLUSIVE_BOUNDARY:
+			return value >= event->lowerLimit && value <= event->upperLimit;
+
+		case INSIDE_EXCLUSIVE_BOUNDARY:
+			return value > event->lowerLimit && value < event->upperLimit;
+
+		case OUTSIDE_INCLUSIVE_BOUNDARY:
+			return value <= event->lowerLimit || value >= event->upperLimit;
+
+		case OUTSIDE_EXCLUSIVE_BOUNDARY:
+			return value < event->lowerLimit || value > event->upperLimit;
+
+		case GREATER_THAN_OR_EQUAL_BOUNDARY:
+			return value >= event->lowerLimit;
+
+		case GREATER_THAN_BOUNDARY:
+			return value > event->lowerLimit;
+
+		case LESS_THAN_OR_EQUAL_BOUNDARY:
+			return value <= event->upperLimit;
+
+		case LESS_THAN_BOUNDARY:
+			return value < event->upperLimit;
+
+		default:
+			return JAUS_FALSE;
+	}
+}
+
+// Several events usually test the same field, it is fetched from the component once per publish
+static JausBoolean eventGetFieldValue(SupportedEventMessage supportedEventMsg, void *data, JausByte field, unsigned char *fieldState, double *fieldValues, double *value)
+{
+	if(fieldState[field] == EVENT_FIELD_NOT_FETCHED)
+	{
+		if(supportedEventMsg->fieldValue && supportedEventMsg->fieldValue(data, field, &fieldValues[field]))
+		{
+			fieldState[field] = EVENT_FIELD_AVAILABLE;
+		}
+		else
+		{
+			fieldState[field] = EVENT_FIELD_UNAVAILABLE;
+		}
+	}
+
+	*value = fieldValues[field];
+	return fieldState[field] == EVENT_FIELD_AVAILABLE;
+}
+
+int eventManagerPublish(NodeManagerInterface nmi, unsigned short commandCode, JausMessage (*encode)(void *, JausUnsignedInteger), void *data)
+{
+	SupportedEventMessage supportedEventMsg;
+	Event event;
+	Event nextEvent;
+	EventPublishTarget stackTargets[EVENT_PUBLISH_STACK_TARGETS];
+	EventPublishTarget *targets = stackTargets;
+	EventPublishTarget *grownTargets;
+	EventMessage eventMessage;
+	unsigned char fieldState[EVENT_FIELD_COUNT];
+	double fieldValues[EVENT_FIELD_COUNT];
+	double value = 0;
+	JausBoolean hasValue;
+	JausBoolean inside;
+	JausBoolean changed;
+	JausBoolean fire;
+	int targetCapacity = EVENT_PUBLISH_STACK_TARGETS;
+	int targetCount = 0;
+	int sentCount = 0;
+	int i, j;
+	double currentTime;
+
+	pthread_mutex_lock(&nmi->evm->mutex);
+
+	supportedEventMsg = eventFindSupportedEventMsg(nmi->evm, commandCode);
+	if(supportedEventMsg == NULL || supportedEventMsg->eventList == NULL)
+	{
+		pthread_mutex_unlock(&nmi->evm->mutex);
+		return 0;
+	}
+
+	currentTime = ojGetTimeSec();
+	memset(fieldState, EVENT_FIELD_NOT_FETCHED, sizeof(fieldState));
+
+	for(event = supportedEventMsg->eventList; event; event = nextEvent)
+	{
+		nextEvent = event->nextEvent;
+
+		hasValue = JAUS_FALSE;
+		if(event->hasDataField)
+		{
+			hasValue = eventGetFieldValue(supportedEventMsg, data, event->limitDataField, fieldState, fieldValues, &value);
+			if(!hasValue)
+			{
+				continue; // Not in this report, the event keeps its state
+			}
+		}
+
+		// Without a field every publish is a change
+		changed = !hasValue || !event->hasSentValue || fabs(value - event->sentValue) > event->changeThreshold;
+
+		if(event->hasBoundary)
+		{
+			inside = eventBoundaryTest(event, value);
+		}
+		else if(hasValue && (event->eventType == EVENT_FIRST_CHANGE_TYPE || event->eventType == EVENT_FIRST_CHANGE_IN_AND_OUT_TYPE))
+		{
+			// Without a boundary the first change types trigger on the field starting or stopping to change
+			inside = event->hasLastValue && fabs(value - event->lastValue) > event->changeThreshold;
+		}
+		else
+		{
+			inside = JAUS_TRUE;
+		}
+
+		switch(event->eventType)
+		{
+			case EVENT_PERIODIC_TYPE:
+				fire = inside && currentTime >= event->nextSendTime;
+				break;
+
+			case EVENT_PERIODIC_NO_REPEAT_TYPE:
+				fire = inside && changed && currentTime >= event->nextSendTime;
+				break;
+
+			case EVENT_EVERY_CHANGE_TYPE:
+				fire = inside && changed;
+				break;
+
+			case EVENT_FIRST_CHANGE_TYPE:
+				fire = inside && !event->wasInside;
+				break;
+
+			case EVENT_FIRST_CHANGE_IN_AND_OUT_TYPE:
+				fire = inside != event->wasInside;
+				break;
+
+			case EVENT_ONE_TIME_ON_DEMAND_TYPE:
+				fire = inside;
+				break;
+
+			default:
+				fire = JAUS_FALSE;
+				break;
+		}
+
+		event->wasInside = inside;
+		if(hasValue)
+		{
+			event->lastValue = value;
+			event->hasLastValue = JAUS_TRUE;
+		}
+
+		if(!fire)
+		{
+			continue;
+		}
+
+		if(targetCount == targetCapacity)
+		{
+			if(targets == stackTargets)
+			{
+				grownTargets = (EventPublishTarget *)malloc(2 * targetCapacity * sizeof(EventPublishTarget));
+				if(grownTargets)
+				{
+					memcpy(grownTargets, stackTargets, targetCount * sizeof(EventPublishTarget));
+				}
+			}
+			else
+			{
+				grownTargets = (EventPublishTarget *)realloc(targets, 2 * targetCapacity * sizeof(EventPublishTarget));
+			}
+
+			if(grownTargets == NULL)
+			{
+				event->wasInside = JAUS_FALSE; // Fires again next time
+				continue;
+			}
+			targets = grownTargets;
+			targetCapacity *= 2;
+		}
+
+		if(hasValue)
+		{
+			event->sentValue = value;
+			event->hasSentValue = JAUS_TRUE;
+		}
+		if(event->periodSec > 0)
+		{
+			// Keeps the period, unless publishing fell more than a period behind
+			event->nextSendTime += event->periodSec;
+			if(event->nextSendTime < currentTime)
+			{
+				event->nextSendTime = currentTime + event->periodSec;
+			}
+		}
+
+		targets[targetCount].address = *event->address;
+		targets[targetCount].address.next = NULL;
+		targets[targetCount].presenceVector = event->presenceVector;
+		targets[targetCount].eventId = event->eventId;
+		targets[targetCount].sequenceNumber = event->sequenceNumber++;
+		targetCount++;
+
+		if(event->eventType == EVENT_ONE_TIME_ON_DEMAND_TYPE)
+		{
+			eventRemove(nmi->evm, supportedEventMsg, event);
+		}
+	}
+
+	pthread_mutex_unlock(&nmi->evm->mutex);
+
+	// The report is encoded once per presence vector, only the event id and sequence number differ between clients
+	for(i = 0; i < targetCount; i++)
+	{
+		targets[i].message = NULL;
+		targets[i].ownsMessage = JAUS_FALSE;
+
+		for(j = 0; j < i; j++)
+		{
+			if(targets[j].ownsMessage && targets[j].presenceVector == targets[i].presenceVector)
+			{
+				targets[i].message = targets[j].message;
+				break;
+			}
+		}
+
+		if(targets[i].message == NULL)
+		{
+			eventMessage = eventMessageCreate();
+			if(eventMessage == NULL)
+			{
+				continue;
+			}
+
+			eventMessage->reportMessage = encode(data, targets[i].presenceVector);
+			if(eventMessage->reportMessage)
+			{
+				jausAddressCopy(eventMessage->source, nmi->cmpt->address);
+				targets[i].message = eventMessageToJausMessage(eventMessage);
+			}
+			eventMessageDestroy(eventMessage);
+
+			if(targets[i].message == NULL)
+			{
+				continue;
+			}
+			targets[i].ownsMessage = JAUS_TRUE;
+		}
+
+		jausAddressCopy(targets[i].message->destination, &targets[i].address);
+		jausByteToBuffer(targets[i].eventId, targets[i].message->data + EVENT_DATA_EVENT_ID_INDEX, JAUS_BYTE_SIZE_BYTES);
+		jausByteToBuffer(targets[i].sequenceNumber, targets[i].message->data + EVENT_DATA_SEQUENCE_NUMBER_INDEX, JAUS_BYTE_SIZE_BYTES);
+		if(nodeManagerSend(nmi, targets[i].message) >= 0)
+		{
+			sentCount++;
+		}
+	}
+
+	for(i = 0; i < targetCount; i++)
+	{
+		if(targets[i].ownsMessage)
+		{
+			jausMessageDestroy(targets[i].message);
+		}
+	}
+
+	if(targets != stackTargets)
+	{
+		free(targets);
+	}
+
+	return sentCount;
+}
+
+// The lookups and list changes below are called with evm->mutex held
+SupportedEventMessage eventFindSupportedEventMsg(EventManager evm, unsigned short commandCode)
+{
+	SupportedEventMessage supportedEventMsg = evm->supportedEventMsgIndex[commandCode % EVENT_MANAGER_HASH_BUCKETS];
+
+	while(supportedEventMsg && supportedEventMsg->commandCode != commandCode)
+	{
+		supportedEventMsg = supportedEventMsg->nextIndexedEventMsg;
+	}
+
+	return supportedEventMsg;
+}
+
+static double eventLimitValue(JausEventLimit limit)
+{
+	switch(limit->dataType)
+	{
+		case EVENT_LIMIT_BYTE_TYPE:
+			return limit->value.byteValue;
+
+		case EVENT_LIMIT_SHORT_TYPE:
+			return limit->value.shortValue;
+
+		case EVENT_LIMIT_INTEGER_TYPE:
+			return limit->value.integerValue;
+
+		case EVENT_LIMIT_LONG_TYPE:
+			return (double)limit->value.longValue;
+
+		case EVENT_LIMIT_UNSIGNED_SHORT_TYPE:
+			return limit->value.unsignedShortValue;
+
+		case EVENT_LIMIT_UNSIGNED_INTEGER_TYPE:
+			return limit->value.unsignedIntegerValue;
+
+		case EVENT_LIMIT_UNSIGNED_LONG_TYPE:
+			return (double)limit->value.unsignedLongValue;
+
+		case EVENT_LIMIT_FLOAT_TYPE:
+			return limit->value.floatValue;
+
+		case EVENT_LIMIT_DOUBLE_TYPE:
+			return limit->value.doubleValue;
+
+		case EVENT_LIMIT_RGB_TYPE:
+			return (limit->value.rgb.redValue << 16) | (limit->value.rgb.greenValue << 8) | limit->value.rgb.blueValue;
+
+		default:
+			return 0;
+	}
+}
+
+// The leading presence vector of a query message body, its width follows from the body size
+static JausUnsignedInteger eventQueryPresenceVector(JausMessage queryMessage)
+{
+	JausByte byteValue;
+	JausUnsignedShort unsignedShortValue;
+	JausUnsignedInteger unsignedIntegerValue;
+
+	if(queryMessage == NULL || queryMessage->data == NULL || queryMessage->dataSize == 0)
+	{
+		return JAUS_INTEGER_PRESENCE_VECTOR_ALL_ON;
+	}
+
+	if(queryMessage->dataSize < JAUS_UNSIGNED_SHORT_SIZE_BYTES)
+	{
+		jausByteFromBuffer(&byteValue, queryMessage->data, queryMessage->dataSize);
+		return byteValue;
+	}
+
+	if(queryMessage->dataSize < JAUS_UNSIGNED_INTEGER_SIZE_BYTES)
+	{
+		jausUnsignedShortFromBuffer(&unsignedShortValue, queryMessage->data, queryMessage->dataSize);
+		return unsignedShortValue;
+	}
+
+	jausUnsignedIntegerFromBuffer(&unsignedIntegerValue, queryMessage->data, queryMessage->dataSize);
+	return unsignedIntegerValue;
+}
+
+// Applies the fields of a Create or Update Event, which share their presence vector bits.
+// Returns the confirm response code, the event is only changed when it is SUCCESSFUL_RESPONSE
+int eventConfigure(Event event, SupportedEventMessage supportedEventMsg, JausByte presenceVector, JausByte eventType, JausByte eventBoundary, JausByte limitDataField,
+					JausEventLimit lowerLimit, JausEventLimit upperLimit, JausEventLimit stateLimit, double requestedUpdateRate, JausMessage queryMessage)
+{
+	JausBoolean hasBoundary = jausByteIsBitSet(presenceVector, CREATE_EVENT_PV_BOUNDARY_BIT);
+	JausBoolean hasDataField = jausByteIsBitSet(presenceVector, CREATE_EVENT_PV_DATA_FIELD_BIT);
+	JausBoolean isPeriodic = eventType == EVENT_PERIODIC_TYPE || eventType == EVENT_PERIODIC_NO_REPEAT_TYPE;
+
+	if(!jausByteIsBitSet(presenceVector, CREATE_EVENT_PV_LOWER_LIMIT_BIT))
+	{
+		lowerLimit = NULL;
+	}
+	if(!jausByteIsBitSet(presenceVector, CREATE_EVENT_PV_UPPER_LIMIT_BIT))
+	{
+		upperLimit = NULL;
+	}
+	if(!jausByteIsBitSet(presenceVector, CREATE_EVENT_PV_STATE_LIMIT_BIT))
+	{
+		stateLimit = NULL;
+	}
+
+	if(eventType > EVENT_ONE_TIME_ON_DEMAND_TYPE)
+	{
+		return INVALID_EVENT_RESPONSE;
+	}
+
+	if(isPeriodic && (!jausByteIsBitSet(presenceVector, CREATE_EVENT_PV_REQUESTED_RATE_BIT) || requestedUpdateRate <= 0))
+	{
+		return INVALID_EVENT_RESPONSE;
+	}
+
+	if(hasDataField && supportedEventMsg->fieldValue == NULL)
+	{
+		return CHANGE_BASED_UNSUPPORTED_RESPONSE;
+	}
+
+	if(hasBoundary)
+	{
+		// A boundary is tested on a field, with the limits it names
+		if(!hasDataField)
+		{
+			return INVALID_EVENT_RESPONSE;
+		}
+
+		switch(eventBoundary)
+		{
+			case EQUAL_BOUNDARY:
+			case NOT_EQUAL_BOUNDARY:
+				if(stateLimit == NULL) return INVALID_EVENT_RESPONSE;
+				break;
+
+			case INSIDE_INCLUSIVE_BOUNDARY:
+			case INSIDE_EXCLUSIVE_BOUNDARY:
+			case OUTSIDE_INCLUSIVE_BOUNDARY:
+			case OUTSIDE_EXCLUSIVE_BOUNDARY:
+				if(lowerLimit == NULL || upperLimit == NULL) return INVALID_EVENT_RESPONSE;
+				break;
+
+			case GREATER_THAN_OR_EQUAL_BOUNDARY:
+			case GREATER_THAN_BOUNDARY:
+				if(lowerLimit == NULL) return INVALID_EVENT_RESPONSE;
+				break;
+
+			case LESS_THAN_OR_EQUAL_BOUNDARY:
+			case LESS_THAN_BOUNDARY:
+				if(upperLimit == NULL) return INVALID_EVENT_RESPONSE;
+				break;
+
+			default:
+				return INVALID_EVENT_RESPONSE;
+		}
+	}
+
+	event->eventType = eventType;
+	event->eventBoundary = eventBoundary;
+	event->limitDataField = limitDataField;
+	event->hasBoundary = hasBoundary;
+	event->hasDataField = hasDataField;
+	event->lowerLimit = lowerLimit? eventLimitValue(lowerLimit) : 0;
+	event->upperLimit = upperLimit? eventLimitValue(upperLimit) : 0;
+	event->stateLimit = stateLimit? eventLimitValue(stateLimit) : 0;
+	event->changeThreshold = (!hasBoundary && lowerLimit)? fabs(event->lowerLimit) : 0;
+	event->periodSec = isPeriodic? 1.0 / requestedUpdateRate : 0;
+	event->nextSendTime = 0;
+	event->presenceVector = eventQueryPresenceVector(jausByteIsBitSet(presenceVector, CREATE_EVENT_PV_QUERY_MESSAGE_BIT)? queryMessage : NULL);
+
+	// Evaluation starts over from the next publish
+	event->wasInside = JAUS_FALSE;
+	event->hasLastValue = JAUS_FALSE;
+	event->lastValue = 0;
+	event->hasSentValue = JAUS_FALSE;
+	event->sentValue = 0;
+
+	return SUCCESSFUL_RESPONSE;
+}
+
+void eventRemove(EventManager evm, SupportedEventMessage supportedEventMsg, Event event)
+{
+	if(event->prevEvent)
+	{
+		event->prevEvent->nextEvent = event->nextEvent;
+	}
+	else
+	{
+		supportedEventMsg->eventList = event->nextEvent;
+	}
+
+	if(event->nextEvent)
+	{
+		event->nextEvent->prevEvent = event->prevEvent;
+	}
+
+	evm->events[event->eventId] = NULL;
+	evm->eventCount--;
+
+	jausAddressDestroy(event->address);
+	free(event);
+}
+
+void eventSendConfirm(NodeManagerInterface nmi, JausAddress destination, JausByte requestId, JausUnsignedShort messageCode, JausByte eventId, double confirmedUpdateRate, JausByte responseCode)
+{
+	ConfirmEventRequestMessage confirmEventRequest;
+	JausMessage txMessage;
+
+	confirmEventRequest = confirmEventRequestMessageCreate();
+	if(confirmEventRequest == NULL)
+	{
+		return;
+	}
+
+	jausAddressCopy(confirmEventRequest->source, nmi->cmpt->address);
+	jausAddressCopy(confirmEventRequest->destination, destination);
+	confirmEventRequest->requestId = requestId;
+	confirmEventRequest->messageCode = messageCode;
+	confirmEventRequest->eventId = eventId;
+	confirmEventRequest->responseCode = responseCode;
+	if(confirmedUpdateRate > 0)
+	{
+		confirmEventRequest->confirmedUpdateRate = confirmedUpdateRate;
+	}
+	else
+	{
+		jausByteClearBit(&confirmEventRequest->presenceVector, CONFIRM_EVENT_REQUEST_PV_PERIODIC_RATE_BIT);
+	}
+
+	txMessage = confirmEventRequestMessageToJausMessage(confirmEventRequest);
+	if(txMessage)
+	{
+		nodeManagerSend(nmi, txMessage);
+		jausMessageDestroy(txMessage);
+	}
+
+	confirmEventRequestMessageDestroy(confirmEventRequest);
+}
@@ -37,17 +37,1075 @@
 // Date:		04/15/08
 // Description:	LargeMessageHandler handles the queueing of large sets of Jaus Messages for 
 //				use by the system. It will queue sets of messages until an end message is
-//				recieved and then create a single Jaus Message from that collection
+//				recieved and then create a single Jaus Message from that collection.
+//				Sets start at sequence number 0 as the standard has them. Components which
+//				announce it to each other with a NAK hello number their sets on from the last
+//				one instead, so a packet sent again can not be taken for a later set. Only
+//				numbered sets ask for missing packets with NAKs, which the sender answers from
+//				a bounded buffer of recently sent messages until the receiver reports the set
+//				complete. Sets are indexed by source, command code and first sequence number.
+//				Packets are copied straight into a contiguous buffer at their offset, and
+//				partial sets are bounded by an inactivity timeout and a memory budget shared by
+//				the whole handler. Sending is paced by a token bucket.
 
 #include <stdlib.h>
+#include <string.h>
 #include "nodeManagerInterface/nodeManagerInterface.h"
 
+static unsigned int lmHandlerBucket(JausAddress source, JausUnsignedShort commandCode)
+{
+	return ((unsigned int)jausAddressHash(source) ^ commandCode) % LM_HANDLER_HASH_BUCKETS;
+}
+
+static void lmHandlerAddList(LargeMessageHandler lmh, LargeMessageList msgList)
+{
+	unsigned int bucket = lmHandlerBucket(msgList->source, msgList->commandCode);
+
+	msgList->nextInBucket = lmh->buckets[bucket];
+	lmh->buckets[bucket] = msgList;
+
+	msgList->older = lmh->newest;
+	msgList->newer = NULL;
+	if(lmh->newest)
+	{
+		lmh->newest->newer = msgList;
+	}
+	else
+	{
+		lmh->oldest = msgList;
+	}
+	lmh->newest = msgList;
+}
+
+static void lmHandlerRemoveList(LargeMessageHandler lmh, LargeMessageList msgList)
+{
+	LargeMessageList *link = &lmh->buckets[lmHandlerBucket(msgList->source, msgList->commandCode)];
+
+	while(*link && *link != msgList)
+	{
+		link = &(*link)->nextInBucket;
+	}
+	if(*link)
+	{
+		*link = msgList->nextInBucket;
+	}
+
+	if(msgList->older)
+	{
+		msgList->older->newer = msgList->newer;
+	}
+	else
+	{
+		lmh->oldest = msgList->newer;
+	}
+	if(msgList->newer)
+	{
+		msgList->newer->older = msgList->older;
+	}
+	else
+	{
+		lmh->newest = msgList->older;
+	}
+
+	lmh->stats.memoryBytes -= msgList->packetCapacity * msgList->packetSizeBytes;
+}
+
+static void lmHandlerTouchList(LargeMessageHandler lmh, LargeMessageList msgList)
+{
+	double now = ojGetTimeSec();
+
+	msgList->timeoutTime = now + lmh->timeoutSec;
+	msgList->nakTime = now + LM_HANDLER_NAK_INTERVAL_SEC;
+	msgList->nakRetries = 0;
+	if(lmh->newest == msgList)
+	{
+		return;
+	}
+
+	// Move to the newest end of the activity list
+	if(msgList->older)
+	{
+		msgList->older->newer = msgList->newer;
+	}
+	else
+	{
+		lmh->oldest = msgList->newer;
+	}
+	msgList->newer->older = msgList->older;
+
+	msgList->older = lmh->newest;
+	msgList->newer = NULL;
+	lmh->newest->newer = msgList;
+	lmh->newest = msgList;
+}
+
+// Makes room for packetCount more slots in msgList, evicting older sets if the budget requires it
+static JausBoolean lmHandlerGrowList(LargeMessageHandler lmh, LargeMessageList msgList, unsigned int packetCount)
+{
+	unsigned int capacity = msgList->packetCapacity? msgList->packetCapacity : 1;
+	unsigned int growthBytes;
+	JausByte *data;
+	JausByte *received;
+
+	while(capacity < packetCount)
+	{
+		capacity *= 2;
+	}
+	growthBytes = (capacity - msgList->packetCapacity) * msgList->packetSizeBytes;
+
+	while(lmh->stats.memoryBytes + growthBytes > lmh->memoryBudgetBytes && lmh->oldest && lmh->oldest != msgList)
+	{
+		LargeMessageList evictList = lmh->oldest;
+		lmHandlerRemoveList(lmh, evictList);
+		lmListDestroy(evictList);
+		lmh->stats.evictedCount++;
+	}
+	if(lmh->stats.memoryBytes + growthBytes > lmh->memoryBudgetBytes)
+	{
+		return JAUS_FALSE;
+	}
+
+	data = (JausByte *)realloc(msgList->data, capacity * msgList->packetSizeBytes);
+	if(!data)
+	{
+		return JAUS_FALSE;
+	}
+	msgList->data = data;
+
+	received = (JausByte *)realloc(msgList->received, capacity);
+	if(!received)
+	{
+		return JAUS_FALSE;
+	}
+	memset(received + msgList->packetCapacity, 0, capacity - msgList->packetCapacity);
+	msgList->received = received;
+
+	msgList->packetCapacity = capacity;
+	lmh->stats.memoryBytes += growthBytes;
+	return JAUS_TRUE;
+}
+
+static LargeMessageList lmHandlerStartList(LargeMessageHandler lmh, JausMessage message)
+{
+	LargeMessageList msgList = lmListCreate();
+
+	msgList->commandCode = message->commandCode;
+	jausAddressCopy(msgList->source, message->source);
+	msgList->firstSequenceNumber = message->sequenceNumber;
+	msgList->isFirstKnown = message->dataFlag == JAUS_FIRST_DATA_PACKET? JAUS_TRUE : JAUS_FALSE;
+	msgList->packetSizeBytes = message->dataSize;
+	lmHandlerAddList(lmh, msgList);
+	return msgList;
+}
+
+// Finds the set a packet continues, the one whose first packet it follows most closely.
+// Sets whose last packet has arrived only take packets up to it.
+static LargeMessageList lmHandlerFindList(LargeMessageHandler lmh, JausMessage message, unsigned int *foundIndex)
+{
+	LargeMessageList msgList;
+	LargeMessageList found = NULL;
+	unsigned int index;
+
+	for(msgList = lmh->buckets[lmHandlerBucket(message->source, message->commandCode)]; msgList; msgList = msgList->nextInBucket)
+	{
+		if(msgList->commandCode != message->commandCode || !jausAddressEqual(msgList->source, message->source))
+		{
+			continue;
+		}
+
+		index = (JausUnsignedShort)(message->sequenceNumber - msgList->firstSequenceNumber);
+		if(index >= LM_HANDLER_MAX_PACKETS || (msgList->lastPacket >= 0 && (int)index > msgList->lastPacket))
+		{
+			continue;
+		}
+
+		if(!found || index < *foundIndex)
+		{
+			found = msgList;
+			*foundIndex = index;
+		}
+	}
+	return found;
+}
+
+// Finds a set still missing its first packet which a packet comes shortly before
+static LargeMessageList lmHandlerFindLaterList(LargeMessageHandler lmh, JausMessage message)
+{
+	LargeMessageList msgList;
+	LargeMessageList found = NULL;
+	unsigned int distance;
+	unsigned int foundDistance = 0;
+
+	for(msgList = lmh->buckets[lmHandlerBucket(message->source, message->commandCode)]; msgList; msgList = msgList->nextInBucket)
+	{
+		if(	msgList->isFirstKnown ||
+			message->dataFlag == JAUS_LAST_DATA_PACKET ||
+			msgList->commandCode != message->commandCode ||
+			!jausAddressEqual(msgList->source, message->source))
+		{
+			continue;
+		}
+
+		distance = (JausUnsignedShort)(msgList->firstSequenceNumber - message->sequenceNumber);
+		if(distance && distance < LM_HANDLER_MAX_PACKETS && (!found || distance < foundDistance))
+		{
+			found = msgList;
+			foundDistance = distance;
+		}
+	}
+	return found;
+}
+
+// Moves the start of a set missing its first packet back to firstSequenceNumber
+static JausBoolean lmHandlerRebaseList(LargeMessageHandler lmh, LargeMessageList msgList, JausUnsignedShort firstSequenceNumber)
+{
+	unsigned int shift = (JausUnsignedShort)(msgList->firstSequenceNumber - firstSequenceNumber);
+
+	if(msgList->highestPacket + shift >= LM_HANDLER_MAX_PACKETS || !lmHandlerGrowList(lmh, msgList, msgList->highestPacket + shift + 1))
+	{
+		return JAUS_FALSE;
+	}
+
+	memmove(msgList->data + shift * msgList->packetSizeBytes, msgList->data, (msgList->highestPacket + 1) * msgList->packetSizeBytes);
+	memmove(msgList->received + shift, msgList->received, msgList->highestPacket + 1);
+	memset(msgList->received, 0, shift);
+
+	msgList->firstSequenceNumber = firstSequenceNumber;
+	msgList->highestPacket += shift;
+	if(msgList->lastPacket >= 0)
+	{
+		msgList->lastPacket += shift;
+	}
+	return JAUS_TRUE;
+}
+
+// Packets placed after the last one belong to a later set whose first packet was lost
+static void lmHandlerTrimList(LargeMessageList msgList)
+{
+	unsigned int i;
+
+	for(i = msgList->lastPacket + 1; i <= msgList->highestPacket; i++)
+	{
+		if(msgList->received[i])
+		{
+			msgList->received[i] = JAUS_FALSE;
+			msgList->receivedCount--;
+		}
+	}
+	msgList->highestPacket = msgList->lastPacket;
+}
+
+static void *lmHandlerNakThread(void *threadData);
+
+// Called with nakMutex held, the NAK thread is started on first use
+static void lmHandlerStartNakThread(NodeManagerInterface nmi)
+{
+	LargeMessageHandler lmh = nmi->lmh;
+
+	if(!lmh->isNakThreadStarted && !lmh->isNakThreadStopping)
+	{
+		lmh->isNakThreadStarted = pthread_create(&lmh->nakThread, NULL, lmHandlerNakThread, nmi)? JAUS_FALSE : JAUS_TRUE;
+	}
+}
+
+// Hands a NAK to the NAK thread
+static void lmHandlerQueueNak(NodeManagerInterface nmi, JausMessage nak, JausBoolean isReceived)
+{
+	LargeMessageHandler lmh = nmi->lmh;
+	LargeMessageNak entry;
+
+	pthread_mutex_lock(&lmh->nakMutex);
+	lmHandlerStartNakThread(nmi);
+
+	if(!lmh->isNakThreadStarted || lmh->isNakThreadStopping || lmh->nakCount >= LM_HANDLER_MAX_QUEUED_NAKS)
+	{
+		lmh->nakDropCount++;
+		pthread_mutex_unlock(&lmh->nakMutex);
+		jausMessageDestroy(nak);
+		return;
+	}
+
+	entry = (LargeMessageNak)malloc(sizeof(LargeMessageNakStruct));
+	entry->nak = nak;
+	entry->isReceived = isReceived;
+	entry->next = NULL;
+	if(lmh->nakLast)
+	{
+		lmh->nakLast->next = entry;
+	}
+	else
+	{
+		lmh->nakFirst = entry;
+	}
+	lmh->nakLast = entry;
+	lmh->nakCount++;
+
+	pthread_cond_signal(&lmh->nakCondition);
+	pthread_mutex_unlock(&lmh->nakMutex);
+}
+
+// Called with peerMutex held, an address not known yet is added when isAdded is set
+static LargeMessagePeerStruct *lmHandlerFindPeer(LargeMessageHandler lmh, JausAddress address, JausBoolean isAdded)
+{
+	int addressHash = jausAddressHash(address);
+	LargeMessagePeerStruct *peer;
+	unsigned int i;
+
+	for(i = 0; i < LM_HANDLER_MAX_PEERS; i++)
+	{
+		if(lmh->peers[i].isUsed && lmh->peers[i].addressHash == addressHash)
+		{
+			return &lmh->peers[i];
+		}
+	}
+	if(!isAdded)
+	{
+		return NULL;
+	}
+
+	peer = &lmh->peers[lmh->peerNext];
+	lmh->peerNext = (lmh->peerNext + 1) % LM_HANDLER_MAX_PEERS;
+	memset(peer, 0, sizeof(LargeMessagePeerStruct));
+	peer->isUsed = JAUS_TRUE;
+	peer->addressHash = addressHash;
+	return peer;
+}
+
+static JausBoolean lmHandlerIsNumberedPeer(LargeMessageHandler lmh, JausAddress address)
+{
+	LargeMessagePeerStruct *peer;
+	JausBoolean isNumbered;
+
+	pthread_mutex_lock(&lmh->peerMutex);
+	peer = lmHandlerFindPeer(lmh, address, JAUS_FALSE);
+	isNumbered = (peer && peer->isNumbered)? JAUS_TRUE : JAUS_FALSE;
+	pthread_mutex_unlock(&lmh->peerMutex);
+	return isNumbered;
+}
+
+static JausMessage lmHandlerNakCreate(NodeManagerInterface nmi, JausAddress destination, JausUnsignedShort commandCode, JausByte flags, JausUnsignedShort headSequenceNumber, JausUnsignedShort tailSequenceNumber)
+{
+	JausMessage nak = jausMessageCreate();
+
+	nak->properties.expFlag = JAUS_EXPERIMENTAL_MESSAGE;
+	nak->commandCode = JAUS_LARGE_MESSAGE_NAK;
+	jausAddressCopy(nak->source, nmi->cmpt->address);
+	jausAddressCopy(nak->destination, destination);
+	nak->data = (JausByte *)malloc(LM_HANDLER_NAK_HEADER_SIZE_BYTES + LM_HANDLER_MAX_NAK_PACKETS * JAUS_UNSIGNED_SHORT_SIZE_BYTES);
+	nak->dataSize = LM_HANDLER_NAK_HEADER_SIZE_BYTES;
+
+	jausUnsignedShortToBuffer(commandCode, nak->data, JAUS_UNSIGNED_SHORT_SIZE_BYTES);
+	jausByteToBuffer(flags, nak->data + 2, JAUS_BYTE_SIZE_BYTES);
+	jausUnsignedShortToBuffer(headSequenceNumber, nak->data + 3, JAUS_UNSIGNED_SHORT_SIZE_BYTES);
+	jausUnsignedShortToBuffer(tailSequenceNumber, nak->data + 5, JAUS_UNSIGNED_SHORT_SIZE_BYTES);
+	jausUnsignedShortToBuffer(0, nak->data + 7, JAUS_UNSIGNED_SHORT_SIZE_BYTES);
+	return nak;
+}
+
+// Tells the sender of msgList what it is missing: the packets not received up to the highest one,
+// with the flags asking for the packets before the lowest one and after the highest one as well
+static void lmHandlerSendNak(NodeManagerInterface nmi, LargeMessageList msgList)
+{
+	JausMessage nak;
+	unsigned int end = msgList->lastPacket >= 0? (unsigned int)msgList->lastPacket : msgList->highestPacket;
+	JausByte flags = 0;
+	JausUnsignedShort count = 0;
+	unsigned int i;
+
+	if(!msgList->isFirstKnown)
+	{
+		flags |= LM_HANDLER_NAK_RESEND_HEAD;
+	}
+	if(msgList->lastPacket < 0)
+	{
+		flags |= LM_HANDLER_NAK_RESEND_TAIL;
+	}
+	nak = lmHandlerNakCreate(nmi, msgList->source, msgList->commandCode, flags, msgList->firstSequenceNumber, (JausUnsignedShort)(msgList->firstSequenceNumber + msgList->highestPacket));
+
+	for(i = 0; i < end && count < LM_HANDLER_MAX_NAK_PACKETS; i++)
+	{
+		if(!msgList->received[i])
+		{
+			jausUnsignedShortToBuffer((JausUnsignedShort)(msgList->firstSequenceNumber + i), nak->data + LM_HANDLER_NAK_HEADER_SIZE_BYTES + count * JAUS_UNSIGNED_SHORT_SIZE_BYTES, JAUS_UNSIGNED_SHORT_SIZE_BYTES);
+			count++;
+		}
+	}
+	jausUnsignedShortToBuffer(count, nak->data + 7, JAUS_UNSIGNED_SHORT_SIZE_BYTES);
+	nak->dataSize += count * JAUS_UNSIGNED_SHORT_SIZE_BYTES;
+
+	msgList->nakTime = ojGetTimeSec() + LM_HANDLER_NAK_INTERVAL_SEC;
+	msgList->nakRetries++;
+	nmi->lmh->stats.nakSentCount++;
+
+	lmHandlerQueueNak(nmi, nak, JAUS_FALSE);
+}
+
+// Lets the sender of a delivered set release its copy
+static void lmHandlerSendComplete(NodeManagerInterface nmi, JausAddress source, JausUnsignedShort commandCode, JausUnsignedShort firstSequenceNumber)
+{
+	lmHandlerQueueNak(nmi, lmHandlerNakCreate(nmi, source, commandCode, LM_HANDLER_NAK_COMPLETE, firstSequenceNumber, firstSequenceNumber), JAUS_FALSE);
+}
+
+// Only numbered sets are remembered, every standard one starts at 0
+static JausBoolean lmHandlerIsCompleted(LargeMessageHandler lmh, JausMessage message)
+{
+	int sourceHash = jausAddressHash(message->source);
+	unsigned int i;
+
+	if(!message->sequenceNumber || !lmHandlerIsNumberedPeer(lmh, message->source))
+	{
+		return JAUS_FALSE;
+	}
+
+	for(i = 0; i < LM_HANDLER_COMPLETED_HISTORY; i++)
+	{
+		if(	lmh->completed[i].sourceHash == sourceHash &&
+			lmh->completed[i].commandCode == message->commandCode &&
+			lmh->completed[i].firstSequenceNumber == message->sequenceNumber)
+		{
+			return JAUS_TRUE;
+		}
+	}
+	return JAUS_FALSE;
+}
+
+static void lmHandlerDeliverList(NodeManagerInterface nmi, LargeMessageList msgList)
+{
+	LargeMessageHandler lmh = nmi->lmh;
+	JausMessage outMessage;
+
+	if(msgList->firstSequenceNumber && lmHandlerIsNumberedPeer(lmh, msgList->source))
+	{
+		lmh->completed[lmh->completedNext].sourceHash = jausAddressHash(msgList->source);
+		lmh->completed[lmh->completedNext].commandCode = msgList->commandCode;
+		lmh->completed[lmh->completedNext].firstSequenceNumber = msgList->firstSequenceNumber;
+		lmh->completedNext = (lmh->completedNext + 1) % LM_HANDLER_COMPLETED_HISTORY;
+		lmHandlerSendComplete(nmi, msgList->source, msgList->commandCode, msgList->firstSequenceNumber);
+	}
+
+	lmHandlerRemoveList(lmh, msgList);
+
+	// The set buffer already holds the packets in order, hand it over to the first packet's header
+	outMessage = msgList->header;
+	outMessage->data = msgList->data;
+	outMessage->dataSize = msgList->lastPacket * msgList->packetSizeBytes + msgList->lastPacketSizeBytes;
+	outMessage->dataFlag = JAUS_SINGLE_DATA_PACKET;
+	outMessage->sequenceNumber = 0;
+	msgList->header = NULL;
+	msgList->data = NULL;
+	lmListDestroy(msgList);
+
+	nmi->lmh->stats.completedCount++;
+
+	if(outMessage->properties.scFlag)
+	{
+		scManagerReceiveMessage(nmi, outMessage);
+	}
+	else
+	{
+		if(!ringQueuePush(nmi->receiveQueue, (void *)outMessage))
+		{
+			nmi->receiveDropCount++;
+		}
+	}
+}
+
+// Places one packet of msgList, returns JAUS_FALSE if the packet was not used
+static JausBoolean lmHandlerPlacePacket(NodeManagerInterface nmi, LargeMessageList msgList, JausMessage message)
+{
+	LargeMessageHandler lmh = nmi->lmh;
+	unsigned int index = (JausUnsignedShort)(message->sequenceNumber - msgList->firstSequenceNumber);
+	JausBoolean isLast = message->dataFlag == JAUS_LAST_DATA_PACKET;
+
+	if(	message->dataSize > msgList->packetSizeBytes ||
+		(!isLast && message->dataSize != msgList->packetSizeBytes) ||
+		(msgList->lastPacket >= 0 && (int)index > msgList->lastPacket) ||
+		(message->dataFlag == JAUS_FIRST_DATA_PACKET && index != 0))
+	{
+		return JAUS_FALSE;
+	}
+
+	if(index >= msgList->packetCapacity && !lmHandlerGrowList(lmh, msgList, index + 1))
+	{
+		// Over budget with nothing older left to evict, this set cannot complete
+		lmHandlerRemoveList(lmh, msgList);
+		lmListDestroy(msgList);
+		lmh->stats.evictedCount++;
+		return JAUS_FALSE;
+	}
+
+	if(msgList->received[index] && message->dataFlag != JAUS_RETRANSMITTED_DATA_PACKET)
+	{
+		return JAUS_FALSE;
+	}
+
+	memcpy(msgList->data + index * msgList->packetSizeBytes, message->data, message->dataSize);
+	if(!msgList->received[index])
+	{
+		msgList->received[index] = JAUS_TRUE;
+		msgList->receivedCount++;
+	}
+
+	if(index > msgList->highestPacket)
+	{
+		msgList->highestPacket = index;
+	}
+	if(message->dataFlag == JAUS_FIRST_DATA_PACKET)
+	{
+		msgList->isFirstKnown = JAUS_TRUE;
+	}
+	if(isLast)
+	{
+		msgList->lastPacket = index;
+		msgList->lastPacketSizeBytes = message->dataSize;
+		lmHandlerTrimList(msgList);
+	}
+
+	if(msgList->isFirstKnown && msgList->lastPacket >= 0 && msgList->receivedCount == (unsigned int)msgList->lastPacket + 1)
+	{
+		lmHandlerDeliverList(nmi, msgList);
+	}
+	else
+	{
+		lmHandlerTouchList(lmh, msgList);
+		if(isLast && lmHandlerIsNumberedPeer(lmh, msgList->source))
+		{
+			// Everything has been sent once, what is missing now was lost
+			lmHandlerSendNak(nmi, msgList);
+		}
+	}
+	return JAUS_TRUE;
+}
+
+// Starts a set with message, whose header is kept for the reassembled message while its data goes
+// into the set buffer. Placing it can only fail on the memory budget, which also drops the new set.
+static void lmHandlerStartSet(NodeManagerInterface nmi, JausMessage message)
+{
+	LargeMessageList msgList = lmHandlerStartList(nmi->lmh, message);
+
+	if(lmHandlerPlacePacket(nmi, msgList, message))
+	{
+		messagePoolFreeData(message);
+		message->dataSize = 0;
+		msgList->header = message;
+	}
+	else
+	{
+		nmi->lmh->stats.discardedPacketCount++;
+		messagePoolRelease(nmi->messagePool, message);
+	}
+}
+
+// Waits until sizeBytes may be sent without exceeding the pacing rate
+static void lmHandlerPace(LargeMessageHandler lmh, unsigned int sizeBytes)
+{
+	double now;
+	double burstBytes;
+	double waitSec = 0;
+
+	pthread_mutex_lock(&lmh->mutex);
+	if(lmh->sendRateBytesPerSec > 0)
+	{
+		now = ojGetTimeSec();
+		burstBytes = (double)lmh->sendBurstPackets * JAUS_MAX_DATA_SIZE_BYTES;
+		lmh->sendCredit += (now - lmh->sendCreditTime) * lmh->sendRateBytesPerSec;
+		lmh->sendCreditTime = now;
+		if(lmh->sendCredit > burstBytes)
+		{
+			lmh->sendCredit = burstBytes;
+		}
+		lmh->sendCredit -= sizeBytes;
+		if(lmh->sendCredit < 0)
+		{
+			waitSec = -lmh->sendCredit / lmh->sendRateBytesPerSec;
+		}
+	}
+	pthread_mutex_unlock(&lmh->mutex);
+
+	// Shorter waits are carried in the credit until they add up
+	if(waitSec >= 0.001)
+	{
+		ojSleepMsec((int)(1000.0 * waitSec));
+	}
+}
+
+// Sends packet index of message to destination, the data is taken straight from the message buffer
+static int lmHandlerSendPacket(NodeManagerInterface nmi, JausMessage message, JausAddress destination, JausUnsignedShort firstSequenceNumber, unsigned int index, JausUnsignedInteger dataFlag)
+{
+	struct JausMessageStruct packet = *message;
+	unsigned int offset = index * JAUS_MAX_DATA_SIZE_BYTES;
+
+	packet.destination = destination;
+	packet.data = message->data + offset;
+	packet.dataSize = (message->dataSize - offset < JAUS_MAX_DATA_SIZE_BYTES)? message->dataSize - offset : JAUS_MAX_DATA_SIZE_BYTES;
+	packet.dataFlag = dataFlag;
+	packet.sequenceNumber = (JausUnsignedShort)(firstSequenceNumber + index);
+
+	lmHandlerPace(nmi->lmh, packet.dataSize);
+	return nodeManagerSendSingleMessage(nmi, &packet);
+}
+
+static void lmHandlerFreeRetransmit(LargeMessageRetransmit entry)
+{
+	jausMessageDestroy(entry->message);
+	free(entry);
+}
+
+// Copies still being answered from are freed by the NAK thread when it is done with them
+static void lmHandlerDropRetransmit(LargeMessageHandler lmh, LargeMessageRetransmit previous, LargeMessageRetransmit entry)
+{
+	if(previous)
+	{
+		previous->next = entry->next;
+	}
+	else
+	{
+		lmh->retransmitOldest = entry->next;
+	}
+	if(lmh->retransmitNewest == entry)
+	{
+		lmh->retransmitNewest = previous;
+	}
+
+	lmh->stats.retransmitBufferBytes -= entry->message->dataSize;
+	if(entry->useCount)
+	{
+		entry->isDropped = JAUS_TRUE;
+	}
+	else
+	{
+		lmHandlerFreeRetransmit(entry);
+	}
+}
+
+static JausBoolean lmHandlerIsUnicast(JausAddress address)
+{
+	return (address->subsystem != JAUS_BROADCAST_SUBSYSTEM_ID && address->subsystem != JAUS_ADDRESS_WILDCARD_OCTET &&
+			address->node != JAUS_BROADCAST_NODE_ID && address->node != JAUS_ADDRESS_WILDCARD_OCTET &&
+			address->component != JAUS_BROADCAST_COMPONENT_ID && address->component != JAUS_ADDRESS_WILDCARD_OCTET &&
+			address->instance != JAUS_BROADCAST_INSTANCE_ID && address->instance != JAUS_ADDRESS_WILDCARD_OCTET)? JAUS_TRUE : JAUS_FALSE;
+}
+
+// Announces numbering to destination when it is due. The first announcement to a component is
+// given a moment to be answered, so its first sets can be numbered as well.
+static JausBoolean lmHandlerGreetPeer(NodeManagerInterface nmi, JausAddress destination)
+{
+	LargeMessageHandler lmh = nmi->lmh;
+	LargeMessagePeerStruct *peer;
+	JausBoolean isNumbered;
+	JausBoolean isHelloDue = JAUS_FALSE;
+	JausBoolean isFirstHello = JAUS_FALSE;
+	double now = ojGetTimeSec();
+	double answerTime = now + LM_HANDLER_HELLO_WAIT_SEC;
+	struct timespec answerTimeSpec;
+
+	pthread_mutex_lock(&lmh->peerMutex);
+	peer = lmHandlerFindPeer(lmh, destination, JAUS_TRUE);
+	isNumbered = peer->isNumbered;
+	if(!isNumbered && peer->helloCount < LM_HANDLER_MAX_PROBES && peer->helloTime <= now)
+	{
+		peer->helloCount++;
+		peer->helloTime = now + LM_HANDLER_PROBE_INTERVAL_SEC;
+		isHelloDue = JAUS_TRUE;
+		isFirstHello = peer->helloCount == 1? JAUS_TRUE : JAUS_FALSE;
+	}
+	pthread_mutex_unlock(&lmh->peerMutex);
+
+	if(!isHelloDue)
+	{
+		return isNumbered;
+	}
+	lmHandlerQueueNak(nmi, lmHandlerNakCreate(nmi, destination, 0, LM_HANDLER_NAK_HELLO, 0, 0), JAUS_FALSE);
+
+	if(isFirstHello)
+	{
+		answerTimeSpec.tv_sec = (long)answerTime;
+		answerTimeSpec.tv_nsec = (long)(1e9 * (answerTime - (double)answerTimeSpec.tv_sec));
+
+		pthread_mutex_lock(&lmh->peerMutex);
+		while(1)
+		{
+			peer = lmHandlerFindPeer(lmh, destination, JAUS_FALSE);
+			isNumbered = (peer && peer->isNumbered)? JAUS_TRUE : JAUS_FALSE;
+			if(isNumbered || ojGetTimeSec() >= answerTime)
+			{
+				break;
+			}
+			pthread_cond_timedwait(&lmh->peerCondition, &lmh->peerMutex, &answerTimeSpec);
+		}
+		pthread_mutex_unlock(&lmh->peerMutex);
+	}
+	return isNumbered;
+}
+
+// Gives a large message its first sequence number. A message to a component which numbers its sets
+// takes its own range, which never starts at 0, and a copy is kept so NAKs can be answered.
+// Any other message starts at 0 and is not kept.
+static JausUnsignedShort lmHandlerKeepMessage(NodeManagerInterface nmi, JausMessage message, unsigned int packetCount)
+{
+	LargeMessageHandler lmh = nmi->lmh;
+	LargeMessageRetransmit entry;
+	LargeMessageRetransmit previous = NULL;
+	LargeMessageRetransmit next;
+	JausUnsignedShort firstSequenceNumber;
+	double now = ojGetTimeSec();
+
+	if(!lmHandlerIsUnicast(message->destination) || !lmHandlerGreetPeer(nmi, message->destination))
+	{
+		return 0;
+	}
+
+	pthread_mutex_lock(&lmh->retransmitMutex);
+
+	if(!lmh->sendSequenceNumber)
+	{
+		lmh->sendSequenceNumber++;
+	}
+	firstSequenceNumber = lmh->sendSequenceNumber;
+	lmh->sendSequenceNumber = (JausUnsignedShort)(lmh->sendSequenceNumber + packetCount);
+
+	for(entry = lmh->retransmitOldest; entry; entry = next)
+	{
+		next = entry->next;
+		if(entry->expireTime < now)
+		{
+			lmHandlerDropRetransmit(lmh, previous, entry);
+		}
+		else
+		{
+			previous = entry;
+		}
+	}
+
+	if(message->dataSize <= lmh->retransmitBudgetBytes)
+	{
+		while(lmh->stats.retransmitBufferBytes + message->dataSize > lmh->retransmitBudgetBytes)
+		{
+			lmHandlerDropRetransmit(lmh, NULL, lmh->retransmitOldest);
+		}
+
+		entry = (LargeMessageRetransmit)malloc(sizeof(LargeMessageRetransmitStruct));
+		entry->message = jausMessageClone(message);
+		entry->firstSequenceNumber = firstSequenceNumber;
+		entry->packetCount = packetCount;
+		entry->expireTime = now + LM_HANDLER_RETRANSMIT_RETENTION_SEC;
+		entry->probeTime = now + LM_HANDLER_PROBE_INTERVAL_SEC;
+		if(lmh->sendRateBytesPerSec > 0)
+		{
+			entry->probeTime += message->dataSize / lmh->sendRateBytesPerSec;
+		}
+		entry->probeCount = 0;
+		entry->useCount = 0;
+		entry->isDropped = JAUS_FALSE;
+		entry->next = NULL;
+		if(lmh->retransmitNewest)
+		{
+			lmh->retransmitNewest->next = entry;
+		}
+		else
+		{
+			lmh->retransmitOldest = entry;
+		}
+		lmh->retransmitNewest = entry;
+		lmh->stats.retransmitBufferBytes += message->dataSize;
+
+		pthread_mutex_lock(&lmh->nakMutex);
+		lmHandlerStartNakThread(nmi);
+		pthread_cond_signal(&lmh->nakCondition);
+		pthread_mutex_unlock(&lmh->nakMutex);
+	}
+
+	pthread_mutex_unlock(&lmh->retransmitMutex);
+	return firstSequenceNumber;
+}
+
+static JausBoolean lmHandlerOctetMatch(JausByte pattern, JausByte octet, JausByte broadcast)
+{
+	return (pattern == octet || pattern == broadcast || pattern == JAUS_ADDRESS_WILDCARD_OCTET)? JAUS_TRUE : JAUS_FALSE;
+}
+
+// True if a message sent to destination reached address
+static JausBoolean lmHandlerAddressMatch(JausAddress destination, JausAddress address)
+{
+	return (lmHandlerOctetMatch(destination->subsystem, address->subsystem, JAUS_BROADCAST_SUBSYSTEM_ID) &&
+			lmHandlerOctetMatch(destination->node, address->node, JAUS_BROADCAST_NODE_ID) &&
+			lmHandlerOctetMatch(destination->component, address->component, JAUS_BROADCAST_COMPONENT_ID) &&
+			lmHandlerOctetMatch(destination->instance, address->instance, JAUS_BROADCAST_INSTANCE_ID))? JAUS_TRUE : JAUS_FALSE;
+}
+
+static void lmHandlerRetransmitPacket(NodeManagerInterface nmi, LargeMessageRetransmit entry, JausAddress destination, unsigned int index)
+{
+	JausUnsignedInteger dataFlag = JAUS_RETRANSMITTED_DATA_PACKET;
+
+	// The first and last packets keep their flags so the receiver learns where the set starts and ends
+	if(index == 0)
+	{
+		dataFlag = JAUS_FIRST_DATA_PACKET;
+	}
+	else if(index == entry->packetCount - 1)
+	{
+		dataFlag = JAUS_LAST_DATA_PACKET;
+	}
+	lmHandlerSendPacket(nmi, entry->message, destination, entry->firstSequenceNumber, index, dataFlag);
+}
+
+// Marks the sender of a hello as numbering its sets, an announcement is answered with our own
+static void lmHandlerAnswerHello(NodeManagerInterface nmi, JausAddress source, JausByte flags)
+{
+	LargeMessageHandler lmh = nmi->lmh;
+
+	pthread_mutex_lock(&lmh->peerMutex);
+	lmHandlerFindPeer(lmh, source, JAUS_TRUE)->isNumbered = JAUS_TRUE;
+	pthread_cond_broadcast(&lmh->peerCondition);
+	pthread_mutex_unlock(&lmh->peerMutex);
+
+	if(!(flags & LM_HANDLER_NAK_HELLO_ANSWER))
+	{
+		lmHandlerQueueNak(nmi, lmHandlerNakCreate(nmi, source, 0, LM_HANDLER_NAK_HELLO | LM_HANDLER_NAK_HELLO_ANSWER, 0, 0), JAUS_FALSE);
+	}
+}
+
+// Answers a NAK from the retransmit buffer, called on the NAK thread
+static void lmHandlerAnswerNak(NodeManagerInterface nmi, JausMessage nak)
+{
+	LargeMessageHandler lmh = nmi->lmh;
+	LargeMessageRetransmit entry;
+	LargeMessageRetransmit previous = NULL;
+	JausUnsignedShort commandCode;
+	JausByte flags;
+	JausUnsignedShort headSequenceNumber;
+	JausUnsignedShort tailSequenceNumber;
+	JausUnsignedShort count;
+	JausUnsignedShort sequenceNumber;
+	unsigned int index;
+	unsigned int sentCount = 0;
+	unsigned int i;
+
+	if(	nak->dataSize < LM_HANDLER_NAK_HEADER_SIZE_BYTES ||
+		!jausUnsignedShortFromBuffer(&commandCode, nak->data, JAUS_UNSIGNED_SHORT_SIZE_BYTES) ||
+		!jausByteFromBuffer(&flags, nak->data + 2, JAUS_BYTE_SIZE_BYTES) ||
+		!jausUnsignedShortFromBuffer(&headSequenceNumber, nak->data + 3, JAUS_UNSIGNED_SHORT_SIZE_BYTES) ||
+		!jausUnsignedShortFromBuffer(&tailSequenceNumber, nak->data + 5, JAUS_UNSIGNED_SHORT_SIZE_BYTES) ||
+		!jausUnsignedShortFromBuffer(&count, nak->data + 7, JAUS_UNSIGNED_SHORT_SIZE_BYTES) ||
+		nak->dataSize < LM_HANDLER_NAK_HEADER_SIZE_BYTES + (unsigned int)count * JAUS_UNSIGNED_SHORT_SIZE_BYTES)
+	{
+		return;
+	}
+
+	if(flags & LM_HANDLER_NAK_HELLO)
+	{
+		lmHandlerAnswerHello(nmi, nak->source, flags);
+		return;
+	}
+
+	pthread_mutex_lock(&lmh->retransmitMutex);
+	for(entry = lmh->retransmitOldest; entry; previous = entry, entry = entry->next)
+	{
+		if(	entry->message->commandCode == commandCode &&
+			(JausUnsignedShort)(headSequenceNumber - entry->firstSequenceNumber) < entry->packetCount &&
+			lmHandlerAddressMatch(entry->message->destination, nak->source))
+		{
+			break;
+		}
+	}
+
+	if(!entry)
+	{
+		if(!(flags & LM_HANDLER_NAK_COMPLETE))
+		{
+			lmh->stats.retransmitMissCount++;
+		}
+		pthread_mutex_unlock(&lmh->retransmitMutex);
+		return;
+	}
+
+	if(flags & LM_HANDLER_NAK_COMPLETE)
+	{
+		// Broadcast copies stay until they expire, other receivers may still need them
+		if(jausAddressEqual(entry->message->destination, nak->source))
+		{
+			lmHandlerDropRetransmit(lmh, previous, entry);
+		}
+		pthread_mutex_unlock(&lmh->retransmitMutex);
+		return;
+	}
+
+	// Sent without the lock, the copy is kept until this answer is done with it
+	entry->useCount++;
+	pthread_mutex_unlock(&lmh->retransmitMutex);
+
+	// Retransmissions go to the component which asked, even if the message was broadcast
+	if(flags & LM_HANDLER_NAK_RESEND_HEAD)
+	{
+		index = (JausUnsignedShort)(headSequenceNumber - entry->firstSequenceNumber);
+		for(i = 0; i < index; i++)
+		{
+			lmHandlerRetransmitPacket(nmi, entry, nak->source, i);
+			sentCount++;
+		}
+	}
+	for(i = 0; i < count; i++)
+	{
+		jausUnsignedShortFromBuffer(&sequenceNumber, nak->data + LM_HANDLER_NAK_HEADER_SIZE_BYTES + i * JAUS_UNSIGNED_SHORT_SIZE_BYTES, JAUS_UNSIGNED_SHORT_SIZE_BYTES);
+		index = (JausUnsignedShort)(sequenceNumber - entry->firstSequenceNumber);
+		if(index < entry->packetCount)
+		{
+			lmHandlerRetransmitPacket(nmi, entry, nak->source, index);
+			sentCount++;
+		}
+	}
+	if(flags & LM_HANDLER_NAK_RESEND_TAIL)
+	{
+		index = (JausUnsignedShort)(tailSequenceNumber - entry->firstSequenceNumber);
+		for(i = index + 1; index < entry->packetCount && i < entry->packetCount; i++)
+		{
+			lmHandlerRetransmitPacket(nmi, entry, nak->source, i);
+			sentCount++;
+		}
+	}
+
+	pthread_mutex_lock(&lmh->retransmitMutex);
+	lmh->stats.retransmittedPacketCount += sentCount;
+	entry->useCount--;
+	if(entry->isDropped && entry->useCount == 0)
+	{
+		lmHandlerFreeRetransmit(entry);
+	}
+	pthread_mutex_unlock(&lmh->retransmitMutex);
+}
+
+// Sends the first packet of each message due a probe again, so a receiver which lost track of the
+// message starts over and asks for the rest. Returns when the next probe is due, 0 if none is.
+static double lmHandlerProbe(NodeManagerInterface nmi)
+{
+	LargeMessageHandler lmh = nmi->lmh;
+	LargeMessageRetransmit entry;
+	double now = ojGetTimeSec();
+	double nextProbeTime;
+
+	pthread_mutex_lock(&lmh->retransmitMutex);
+	do
+	{
+		nextProbeTime = 0;
+		for(entry = lmh->retransmitOldest; entry; entry = entry->next)
+		{
+			if(entry->probeCount >= LM_HANDLER_MAX_PROBES)
+			{
+				continue;
+			}
+			if(entry->probeTime <= now)
+			{
+				break;
+			}
+			if(nextProbeTime == 0 || entry->probeTime < nextProbeTime)
+			{
+				nextProbeTime = entry->probeTime;
+			}
+		}
+
+		if(entry)
+		{
+			entry->probeCount++;
+			entry->probeTime = now + LM_HANDLER_PROBE_INTERVAL_SEC;
+			entry->useCount++;
+			pthread_mutex_unlock(&lmh->retransmitMutex);
+
+			lmHandlerRetransmitPacket(nmi, entry, entry->message->destination, 0);
+
+			pthread_mutex_lock(&lmh->retransmitMutex);
+			lmh->stats.probeCount++;
+			entry->useCount--;
+			if(entry->isDropped && entry->useCount == 0)
+			{
+				lmHandlerFreeRetransmit(entry);
+			}
+		}
+	}while(entry);
+	pthread_mutex_unlock(&lmh->retransmitMutex);
+
+	return nextProbeTime;
+}
+
+static void *lmHandlerNakThread(void *threadData)
+{
+	NodeManagerInterface nmi = (NodeManagerInterface)threadData;
+	LargeMessageHandler lmh = nmi->lmh;
+	LargeMessageNak entry;
+	struct timespec probeTimeSpec;
+	double probeTime;
+
+	pthread_mutex_lock(&lmh->nakMutex);
+	while(!lmh->isNakThreadStopping)
+	{
+		if(!lmh->nakFirst)
+		{
+			pthread_mutex_unlock(&lmh->nakMutex);
+			probeTime = lmHandlerProbe(nmi);
+			pthread_mutex_lock(&lmh->nakMutex);
+
+			if(lmh->nakFirst || lmh->isNakThreadStopping)
+			{
+				continue;
+			}
+			if(probeTime > 0)
+			{
+				probeTimeSpec.tv_sec = (long)probeTime;
+				probeTimeSpec.tv_nsec = (long)(1e9 * (probeTime - (double)probeTimeSpec.tv_sec));
+				pthread_cond_timedwait(&lmh->nakCondition, &lmh->nakMutex, &probeTimeSpec);
+			}
+			else
+			{
+				pthread_cond_wait(&lmh->nakCondition, &lmh->nakMutex);
+			}
+			continue;
+		}
+
+		entry = lmh->nakFirst;
+		lmh->nakFirst = entry->next;
+		if(!lmh->nakFirst)
+		{
+			lmh->nakLast = NULL;
+		}
+		lmh->nakCount--;
+		pthread_mutex_unlock(&lmh->nakMutex);
+
+		if(entry->isReceived)
+		{
+			lmHandlerAnswerNak(nmi, entry->nak);
+		}
+		else
+		{
+			nodeManagerSendSingleMessage(nmi, entry->nak);
+		}
+		jausMessageDestroy(entry->nak);
+		free(entry);
+
+		pthread_mutex_lock(&lmh->nakMutex);
+	}
+	pthread_mutex_unlock(&lmh->nakMutex);
+
+	return NULL;
+}
+
 LargeMessageHandler lmHandlerCreate(void)
 {
 	LargeMessageHandler lmh = (LargeMessageHandler)malloc( sizeof(LargeMessageHandlerStruct) );
 	if(lmh)
 	{
-		lmh->messageLists = jausArrayCreate();
+		memset(lmh, 0, sizeof(LargeMessageHandlerStruct));
+		lmh->timeoutSec = LM_HANDLER_DEFAULT_TIMEOUT_SEC;
+		lmh->memoryBudgetBytes = LM_HANDLER_DEFAULT_MEMORY_BUDGET_BYTES;
+		lmh->sendRateBytesPerSec = LM_HANDLER_DEFAULT_SEND_RATE_BYTES_PER_SEC;
+		lmh->sendBurstPackets = LM_HANDLER_DEFAULT_SEND_BURST_PACKETS;
+		lmh->retransmitBudgetBytes = LM_HANDLER_DEFAULT_RETRANSMIT_BUFFER_BYTES;
+		// Half the sequence number space away from the sets sent before a peer announced numbering
+		lmh->sendSequenceNumber = LM_HANDLER_MAX_PACKETS;
+		pthread_mutex_init(&lmh->mutex, NULL);
+		pthread_mutex_init(&lmh->retransmitMutex, NULL);
+		pthread_mutex_init(&lmh->peerMutex, NULL);
+		pthread_cond_init(&lmh->peerCondition, NULL);
+		pthread_mutex_init(&lmh->nakMutex, NULL);
+		pthread_cond_init(&lmh->nakCondition, NULL);
 		return lmh;
 	}
 	else
@@ -56,211 +1114,208 @@ LargeMessageHandler lmHandlerCreate(void)
 	}
 }
 
+// The receive and heartbeat threads must be done with the interface, the NAK thread finishes
+// whatever it is sending first
 void lmHandlerDestroy(LargeMessageHandler lmh)
 {
-	jausArrayDestroy(lmh->messageLists, (void *)lmListDestroy);
+	LargeMessageList msgList;
+	LargeMessageNak entry;
+
+	pthread_mutex_lock(&lmh->nakMutex);
+	lmh->isNakThreadStopping = JAUS_TRUE;
+	pthread_cond_signal(&lmh->nakCondition);
+	pthread_mutex_unlock(&lmh->nakMutex);
+	if(lmh->isNakThreadStarted)
+	{
+		pthread_join(lmh->nakThread, NULL);
+	}
+	while(lmh->nakFirst)
+	{
+		entry = lmh->nakFirst;
+		lmh->nakFirst = entry->next;
+		jausMessageDestroy(entry->nak);
+		free(entry);
+	}
+
+	while(lmh->oldest)
+	{
+		msgList = lmh->oldest;
+		lmHandlerRemoveList(lmh, msgList);
+		lmListDestroy(msgList);
+	}
+	while(lmh->retransmitOldest)
+	{
+		lmHandlerDropRetransmit(lmh, NULL, lmh->retransmitOldest);
+	}
+	pthread_mutex_destroy(&lmh->mutex);
+	pthread_mutex_destroy(&lmh->retransmitMutex);
+	pthread_mutex_destroy(&lmh->peerMutex);
+	pthread_cond_destroy(&lmh->peerCondition);
+	pthread_mutex_destroy(&lmh->nakMutex);
+	pthread_cond_destroy(&lmh->nakCondition);
 	free(lmh);
 }
 
 LargeMessageList lmListCreate(void)
 {
 	LargeMessageList msgList = (LargeMessageList)malloc(sizeof(LargeMessageListStruct));
-	msgList->commandCode = 0;
+	memset(msgList, 0, sizeof(LargeMessageListStruct));
 	msgList->source = jausAddressCreate();
-	msgList->messages = jausArrayCreate();
+	msgList->lastPacket = -1;
 	return msgList;
 }
 
 void lmListDestroy(LargeMessageList msgList)
 {
-	jausArrayDestroy(msgList->messages, (void *)jausMessageDestroy);
+	if(msgList->header)
+	{
+		jausMessageDestroy(msgList->header);
+	}
+	free(msgList->data);
+	free(msgList->received);
 	jausAddressDestroy(msgList->source);
 	free(msgList);
 }
 
 void lmHandlerReceiveLargeMessage(NodeManagerInterface nmi, JausMessage message)
 {
+	LargeMessageHandler lmh = nmi->lmh;
 	LargeMessageList msgList;
-	JausMessage tempMessage;
-	JausMessage outMessage;
-	int i;
-	unsigned long sequenceNumber;
-	unsigned long index;
-	JausUnsignedInteger newDataSize = 0;
-	JausUnsignedInteger bufferIndex = 0;
+	unsigned int index = 0;
 	char address[128] = {0};
-	
+
+	pthread_mutex_lock(&lmh->mutex);
 	switch(message->dataFlag)
 	{
 		case JAUS_FIRST_DATA_PACKET:
-			// Check for valid SeqNumber(0), else Error
-			if(message->sequenceNumber) 
-			{
-				//cError("LargeMessageHandler: Received First Data Packet with invalid Sequence Number(%d)\n", message->sequenceNumber);
-				jausMessageDestroy(message);
-				return;
-			}
-			
-			// Check if LargeMessageList exists (same CC & Source)
-			msgList = lmHandlerGetMessageList(nmi->lmh, message);
-			if(msgList)
+		case JAUS_NORMAL_DATA_PACKET:
+		case JAUS_RETRANSMITTED_DATA_PACKET:
+		case JAUS_LAST_DATA_PACKET:
+			if(message->dataSize == 0)
 			{
-				// Destroy the list and all messages
-				jausArrayRemove(nmi->lmh->messageLists, msgList, (void *)lmHandlerMessageListEqual);
-				lmListDestroy(msgList);		
+				lmh->stats.discardedPacketCount++;
+				messagePoolRelease(nmi->messagePool, message);
+				break;
 			}
 
-			// create LargeMessageList
-			msgList = lmListCreate();
-			jausArrayAdd(nmi->lmh->messageLists, msgList);
-				
-			// add message to LargeMessageList at first position
-			msgList->commandCode = message->commandCode;
-			jausAddressCopy(msgList->source, message->source);
-			jausArrayAdd(msgList->messages, message);
-			break;
-		
-		case JAUS_NORMAL_DATA_PACKET:
-			// Check if LargeMessageList exists, error if not
-			msgList = lmHandlerGetMessageList(nmi->lmh, message);
-			if(msgList)
+			if(message->dataFlag == JAUS_FIRST_DATA_PACKET && lmHandlerIsCompleted(lmh, message))
 			{
-				// Check if item exists in LargeMessageList with seqNumber
-				if(jausArrayContains(msgList->messages, message, (void *)lmHandlerLargeMessageCheck) != -1)
-				{
-					//cError("LargeMessageHandler: Received duplicate NORMAL_DATA_PACKET\n");
-					jausMessageDestroy(message);
-				}
-				else
-				{
-					// insert to jausArray
-					jausArrayAdd(msgList->messages, message);
-				}
+				// Sent again because our report that the set was complete was lost
+				lmHandlerSendComplete(nmi, message->source, message->commandCode, message->sequenceNumber);
+				lmh->stats.discardedPacketCount++;
+				messagePoolRelease(nmi->messagePool, message);
+				break;
 			}
-			else
+
+			// A first packet only continues the set it starts
+			msgList = lmHandlerFindList(lmh, message, &index);
+			if(msgList && message->dataFlag == JAUS_FIRST_DATA_PACKET && index != 0)
 			{
-				// Destroy Message
-				//cError("LargeMessageHandler: Received NORMAL_DATA_PACKET (0x%4X) for unknown Large Message Set (never received JAUS_FIRST_DATA_PACKET)\n", message->commandCode);
-				jausMessageDestroy(message);
+				msgList = NULL;
 			}
-			break;
-			
-		case JAUS_RETRANSMITTED_DATA_PACKET:
-			// Check if LargeMessageList exists, error if not
-			msgList = lmHandlerGetMessageList(nmi->lmh, message);
-			if(msgList)
+
+			if(!msgList)
 			{
-				// Check if item exists in LargeMessageList with seqNumber
-				if(jausArrayContains(msgList->messages, message, (void *)lmHandlerLargeMessageCheck) != -1)
+				// Packets from before the start of a set which is missing its first packet extend it backwards
+				msgList = lmHandlerFindLaterList(lmh, message);
+				if(msgList && !lmHandlerRebaseList(lmh, msgList, message->sequenceNumber))
 				{
-					tempMessage = (JausMessage) jausArrayRemove(msgList->messages, message, (void *)lmHandlerLargeMessageCheck);
-					jausMessageDestroy(tempMessage);
+					msgList = NULL;
 				}
-				// insert to jausArray
-				jausArrayAdd(msgList->messages, message);
 			}
-			else
+
+			if(!msgList && (message->dataFlag == JAUS_FIRST_DATA_PACKET || message->dataFlag == JAUS_NORMAL_DATA_PACKET))
 			{
-				//cError("LargeMessageHandler: Received RETRANSMITTED_DATA_PACKET for unknown Large Message Set (never received JAUS_FIRST_DATA_PACKET)\n");
-				jausMessageDestroy(message);				
+				// A set starts with its first packet, or with the one after it if that was lost
+				lmHandlerStartSet(nmi, message);
+				break;
 			}
-			break;
-		
-		case JAUS_LAST_DATA_PACKET:
-			// Check if LargeMessageList exists, error if not
-			msgList = lmHandlerGetMessageList(nmi->lmh, message);
-			if(msgList && msgList->messages->elementCount > 0)
-			{
-				// insert message to end of list
-				jausArrayAdd(msgList->messages, message);
-
-				// Create JausMessage object
-				outMessage = jausMessageCreate();
-
-				// Calculate new message size
-				newDataSize = 0;
-				tempMessage = NULL;
-				
-				for(i = 0; i < msgList->messages->elementCount; i++)
-				{
-					tempMessage = (JausMessage)msgList->messages->elementData[i];
-					newDataSize += tempMessage->dataSize;
-				}
-
-				// Setup Header and Data Buffer
-				outMessage->properties = tempMessage->properties;
-				outMessage->commandCode = tempMessage->commandCode;
-				jausAddressCopy(outMessage->destination, tempMessage->destination);
-				jausAddressCopy(outMessage->source, tempMessage->source);
-				outMessage->dataSize = tempMessage->dataSize;
-				outMessage->dataFlag = tempMessage->dataFlag;
-				outMessage->sequenceNumber = tempMessage->sequenceNumber;
-				outMessage->data = (unsigned char *) malloc(newDataSize);
-				
-				// Populate new message
-				sequenceNumber = 0;
-				bufferIndex = 0;
-				while(sequenceNumber <= message->sequenceNumber)
-				{
-					index = 0;
-					do
-					{
-						tempMessage = (JausMessage)msgList->messages->elementData[index];
-						index++;
-						if(index > (unsigned int) msgList->messages->elementCount)
-						{
-							// Invalid set of messages
-							//TODO: Here is when you would request a retransmittal if ACK/NAK is set and ask the sending component to resend some packets
-	
-							// Received LAST_DATA_PACKET, but do not have proper sequence of messages
-							// Destroy the list and all messages
-							jausArrayRemove(nmi->lmh->messageLists, msgList, (void *)lmHandlerMessageListEqual);
-							lmListDestroy(msgList);
-						
-							//cError("LargeMessageHandler: Received LAST_DATA_PACKET, but do not have proper sequence of messages\n");						
-							jausMessageDestroy(outMessage);
-							return;
-						}
-					}
-					while(tempMessage->sequenceNumber != sequenceNumber);
-					
-					// Move data from tempMessage to outMessage
-					memcpy(outMessage->data + bufferIndex, tempMessage->data, tempMessage->dataSize);
-					bufferIndex += tempMessage->dataSize;
-					sequenceNumber++; // TOM: switched from i++
-				}
-
-				// Set DataSize
-				// Set proper header flags (dataFlag JAUS_SINGLE_DATA_PACKET)
-				outMessage->dataSize = newDataSize;
-				outMessage->dataFlag = JAUS_SINGLE_DATA_PACKET;
 
-				if(outMessage->properties.scFlag)
-				{
-					scManagerReceiveMessage(nmi, outMessage);
-				}
-				else
-				{
-					queuePush(nmi->receiveQueue, (void *)outMessage);
-				}
-				
-				// Destroy LargeMessageList
-				jausArrayRemove(nmi->lmh->messageLists, msgList, (void *)lmHandlerMessageListEqual);
-				lmListDestroy(msgList);
-			}
-			else
+			if(!msgList || !lmHandlerPlacePacket(nmi, msgList, message))
 			{
-				//cError("LargeMessageHandler: Received LAST_DATA_PACKET for unknown Large Message Set (never received JAUS_FIRST_DATA_PACKET)\n");
-				jausMessageDestroy(message);				
+				//cError("LargeMessageHandler: Received duplicate, malformed or orphaned data packet (0x%4X)\n", message->commandCode);
+				lmh->stats.discardedPacketCount++;
 			}
+			messagePoolRelease(nmi->messagePool, message);
 			break;
-		
+
 		default:
 			jausAddressToString(message->source, address);
 			//cError("lmHandler: Received (%s) with improper dataFlag (%d) from %s\n", jausMessageCommandCodeString(message), message->dataFlag, address);
-			jausMessageDestroy(message);
+			lmh->stats.discardedPacketCount++;
+			messagePoolRelease(nmi->messagePool, message);
 			break;
 	}
+	pthread_mutex_unlock(&lmh->mutex);
+}
+
+// Answered on the NAK thread from a copy, the caller keeps nak
+void lmHandlerReceiveNak(NodeManagerInterface nmi, JausMessage nak)
+{
+	lmHandlerQueueNak(nmi, jausMessageClone(nak), JAUS_TRUE);
+}
+
+void lmHandlerCheckTimeouts(NodeManagerInterface nmi)
+{
+	LargeMessageHandler lmh = nmi->lmh;
+	LargeMessageList msgList;
+	LargeMessageList nextList;
+	double now = ojGetTimeSec();
+
+	pthread_mutex_lock(&lmh->mutex);
+	if(!lmh->oldest || now < lmh->nextCheckTime)
+	{
+		pthread_mutex_unlock(&lmh->mutex);
+		return;
+	}
+
+	lmh->nextCheckTime = now + LM_HANDLER_NAK_INTERVAL_SEC / 2;
+	for(msgList = lmh->oldest; msgList; msgList = nextList)
+	{
+		nextList = msgList->newer;
+		if(msgList->timeoutTime < now)
+		{
+			lmHandlerRemoveList(lmh, msgList);
+			lmListDestroy(msgList);
+			lmh->stats.timedOutCount++;
+		}
+		else if(msgList->nakTime <= now && msgList->nakRetries < LM_HANDLER_MAX_NAK_RETRIES && lmHandlerIsNumberedPeer(lmh, msgList->source))
+		{
+			lmHandlerSendNak(nmi, msgList);
+		}
+	}
+	pthread_mutex_unlock(&lmh->mutex);
+}
+
+void lmHandlerSetLimits(NodeManagerInterface nmi, double timeoutSec, unsigned int memoryBudgetBytes)
+{
+	pthread_mutex_lock(&nmi->lmh->mutex);
+	nmi->lmh->timeoutSec = timeoutSec;
+	nmi->lmh->memoryBudgetBytes = memoryBudgetBytes;
+	pthread_mutex_unlock(&nmi->lmh->mutex);
+}
+
+void lmHandlerSetSendLimits(NodeManagerInterface nmi, double sendRateBytesPerSec, unsigned int burstPackets, unsigned int retransmitBufferBytes)
+{
+	pthread_mutex_lock(&nmi->lmh->retransmitMutex);
+	pthread_mutex_lock(&nmi->lmh->mutex);
+	nmi->lmh->sendRateBytesPerSec = sendRateBytesPerSec;
+	nmi->lmh->sendBurstPackets = burstPackets;
+	nmi->lmh->retransmitBudgetBytes = retransmitBufferBytes;
+	pthread_mutex_unlock(&nmi->lmh->mutex);
+	pthread_mutex_unlock(&nmi->lmh->retransmitMutex);
+}
+
+void lmHandlerGetStats(NodeManagerInterface nmi, LargeMessageHandlerStats *stats)
+{
+	pthread_mutex_lock(&nmi->lmh->retransmitMutex);
+	pthread_mutex_lock(&nmi->lmh->mutex);
+	*stats = nmi->lmh->stats;
+	pthread_mutex_lock(&nmi->lmh->nakMutex);
+	stats->nakDropCount = nmi->lmh->nakDropCount;
+	pthread_mutex_unlock(&nmi->lmh->nakMutex);
+	pthread_mutex_unlock(&nmi->lmh->mutex);
+	pthread_mutex_unlock(&nmi->lmh->retransmitMutex);
 }
 
 int lmHandlerMessageListEqual(LargeMessageList listOne, LargeMessageList listTwo)
@@ -277,17 +1332,16 @@ int lmHandlerMessageListEqual(LargeMessageList listOne, LargeMessageList listTwo
 
 LargeMessageList lmHandlerGetMessageList(LargeMessageHandler lmh, JausMessage message)
 {
-	int i;
-	LargeMessageList msgList;
-	
-	// Look for the matching LargeMessageList object in the jausArray array
-	for(i = 0; i < lmh->messageLists->elementCount; i++)
-	{
-		msgList = (LargeMessageList) lmh->messageLists->elementData[i];
+	LargeMessageList msgList = lmh->buckets[lmHandlerBucket(message->source, message->commandCode)];
 
-		// Command Code and Source uniquely identify a message list
+	// Command Code and Source uniquely identify a message list
+	while(msgList)
+	{
 		if(msgList->commandCode == message->commandCode && jausAddressEqual(msgList->source, message->source))
+		{
 			return msgList;
+		}
+		msgList = msgList->nextInBucket;
 	}
 	return NULL;
 }
@@ -311,71 +1365,50 @@ int lmHandlerLargeMessageCheck(JausMessage messageOne, JausMessage messageTwo)
 // Note: It is left to the user to destroy the inMessage after a call to this function
 int lmHandlerSendLargeMessage(NodeManagerInterface nmi, JausMessage inMessage)
 {
-	unsigned int bytesRemaining = inMessage->dataSize;
-	unsigned int bufferIndex = 0;
-	int messageCount = 0;
+	struct JausMessageStruct wholeMessage;
+	unsigned int packetCount;
+	unsigned int index;
+	JausUnsignedShort firstSequenceNumber;
 	int result = -1;
-	JausMessage outMessage;
-	
+
 	if(inMessage->dataSize > JAUS_MAX_DATA_SIZE_BYTES)
 	{
-		while(bytesRemaining > 	JAUS_MAX_DATA_SIZE_BYTES)
+		packetCount = (inMessage->dataSize + JAUS_MAX_DATA_SIZE_BYTES - 1) / JAUS_MAX_DATA_SIZE_BYTES;
+		if(packetCount > LM_HANDLER_MAX_PACKETS)
 		{
-			outMessage = jausMessageCreate();
-	
-			// Copy Header
-			outMessage->properties = inMessage->properties;
-			outMessage->commandCode = inMessage->commandCode;
-			jausAddressCopy(outMessage->destination, inMessage->destination);
-			jausAddressCopy(outMessage->source, inMessage->source);
-			outMessage->dataSize = inMessage->dataSize;
-			outMessage->dataFlag = inMessage->dataFlag;
-			outMessage->sequenceNumber = messageCount++;
-
-			if(messageCount == 1)
+			// More packets than a receiver can tell apart from the next message
+			return -1;
+		}
+	}
+
+	if(inMessage->dataSize > JAUS_MAX_DATA_SIZE_BYTES && inMessage->dataSize <= nmi->largeFrameSizeBytes)
+	{
+		// Passed whole to the Node Manager, which splits it where a link needs standard packets.
+		// Those packets match the ones sent below, so NAKs for them are still answered from here.
+		wholeMessage = *inMessage;
+		wholeMessage.sequenceNumber = lmHandlerKeepMessage(nmi, inMessage, packetCount);
+		lmHandlerPace(nmi->lmh, inMessage->dataSize);
+		result = nodeManagerSendSingleMessage(nmi, &wholeMessage);
+	}
+	else if(inMessage->dataSize > JAUS_MAX_DATA_SIZE_BYTES)
+	{
+		firstSequenceNumber = lmHandlerKeepMessage(nmi, inMessage, packetCount);
+
+		for(index = 0; index < packetCount; index++)
+		{
+			if(index == 0)
+			{
+				result = lmHandlerSendPacket(nmi, inMessage, inMessage->destination, firstSequenceNumber, index, JAUS_FIRST_DATA_PACKET);
+			}
+			else if(index == packetCount - 1)
 			{
-				// First Message
-				outMessage->dataFlag = JAUS_FIRST_DATA_PACKET;
+				result = lmHandlerSendPacket(nmi, inMessage, inMessage->destination, firstSequenceNumber, index, JAUS_LAST_DATA_PACKET);
 			}
 			else
 			{
-				// Normal Message
-				outMessage->dataFlag = JAUS_NORMAL_DATA_PACKET;
+				result = lmHandlerSendPacket(nmi, inMessage, inMessage->destination, firstSequenceNumber, index, JAUS_NORMAL_DATA_PACKET);
 			}
-			
-			// Copy Data to new memory location
-			outMessage->data = (JausByte *)malloc(JAUS_MAX_DATA_SIZE_BYTES);
-			outMessage->dataSize = JAUS_MAX_DATA_SIZE_BYTES;
-
-			memcpy(outMessage->data, inMessage->data + bufferIndex, JAUS_MAX_DATA_SIZE_BYTES);
-			bufferIndex += JAUS_MAX_DATA_SIZE_BYTES;
-			bytesRemaining -= JAUS_MAX_DATA_SIZE_BYTES;
-
-			result = nodeManagerSendSingleMessage(nmi, outMessage);
-			jausMessageDestroy(outMessage);
-		}
-		
-		// Last Message
-		outMessage = jausMessageCreate();
-
-		// Copy Header
-		outMessage->properties = inMessage->properties;
-		outMessage->commandCode = inMessage->commandCode;
-		jausAddressCopy(outMessage->destination, inMessage->destination);
-		jausAddressCopy(outMessage->source, inMessage->source);
-		outMessage->dataSize = inMessage->dataSize;
-		outMessage->dataFlag = inMessage->dataFlag;
-		outMessage->sequenceNumber = messageCount++;
-		
-		outMessage->dataFlag = JAUS_LAST_DATA_PACKET;
-		outMessage->dataSize = bytesRemaining;
-		
-		// Copy data to new memory location
-		outMessage->data = (JausByte *)malloc(bytesRemaining);
-		memcpy(outMessage->data, inMessage->data + bufferIndex, bytesRemaining);
-		
-		result = nodeManagerSendSingleMessage(nmi, outMessage);
-		jausMessageDestroy(outMessage);
+		}
 	}
 	else
 	{
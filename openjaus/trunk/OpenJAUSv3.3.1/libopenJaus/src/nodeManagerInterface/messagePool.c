@@ -0,0 +1,257 @@
+/*****************************************************************************
+ *  Copyright (c) 2008, University of Florida
+ *  All rights reserved.
+ *
+ *  This file is part of OpenJAUS.  OpenJAUS is distributed under the BSD
+ *  license.  See the LICENSE file for details.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of the University of Florida nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+// File Name: messagePool.c
+//
+// Version: 3.3.0
+//
+// Date: 07/09/08
+//
+// Description:	Provides the pool received messages are decoded into. A pooled message is
+//				an ordinary JausMessage followed by a data buffer which holds any small
+//				frame, so once the pool has grown to the number of messages in flight the
+//				receive path no longer allocates. Pooled messages carry their pool in
+//				message->owner, any other message given back is simply destroyed.
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "nodeManagerInterface/nodeManagerInterface.h"
+
+#define MESSAGE_POOL_DATA_SIZE_BYTES	0x1000		// Holds any data size the 12 bit header field can give
+
+typedef struct
+{
+	struct JausMessageStruct message;	// First, so jausMessageDestroy frees a pooled message like any other
+	JausByte *buffer;					// message->data unless the data did not fit, NULL once freed
+}PooledMessageStruct;
+
+typedef PooledMessageStruct *PooledMessage;
+
+JausMessage messagePoolAllocate(MessagePool pool);
+void messagePoolCopyData(JausMessage, unsigned char *);
+
+MessagePool messagePoolCreate(int capacity, int preallocatedCount)
+{
+	MessagePool pool;
+	JausMessage message;
+
+	pool = (MessagePool)malloc(sizeof(MessagePoolStruct));
+	if(pool == NULL)
+	{
+		return NULL;
+	}
+
+	pool->idle = (JausMessage *)malloc(capacity * sizeof(JausMessage));
+	if(pool->idle == NULL)
+	{
+		free(pool);
+		return NULL;
+	}
+	pool->idleCount = 0;
+	pool->capacity = capacity;
+	pool->allocatedCount = 0;
+	pthread_mutex_init(&pool->mutex, NULL);
+
+	while(pool->idleCount < preallocatedCount && pool->idleCount < capacity)
+	{
+		message = messagePoolAllocate(pool);
+		if(message == NULL)
+		{
+			break;
+		}
+		pool->idle[pool->idleCount++] = message;
+	}
+
+	return pool;
+}
+
+void messagePoolDestroy(MessagePool pool)
+{
+	while(pool->idleCount)
+	{
+		jausMessageDestroy(pool->idle[--pool->idleCount]);
+	}
+	free(pool->idle);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool);
+}
+
+// Returns a message to decode into, its header is filled by the decode
+JausMessage messagePoolGet(MessagePool pool)
+{
+	JausMessage message = NULL;
+
+	pthread_mutex_lock(&pool->mutex);
+	if(pool->idleCount)
+	{
+		message = pool->idle[--pool->idleCount];
+	}
+	else
+	{
+		pool->allocatedCount++;
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	if(message == NULL)
+	{
+		message = messagePoolAllocate(pool);
+		if(message == NULL)
+		{
+			return NULL;
+		}
+	}
+
+	message->properties.priority = JAUS_DEFAULT_PRIORITY;
+	message->properties.ackNak = JAUS_ACK_NAK_NOT_REQUIRED;
+	message->properties.scFlag = JAUS_NOT_SERVICE_CONNECTION_MESSAGE;
+	message->properties.expFlag = JAUS_NOT_EXPERIMENTAL_MESSAGE;
+	message->properties.version = JAUS_VERSION_3_3;
+	message->properties.reserved = 0;
+	message->commandCode = 0;
+	message->dataFlag = JAUS_SINGLE_DATA_PACKET;
+	message->dataSize = 0;
+	message->sequenceNumber = 0;
+	return message;
+}
+
+void messagePoolRelease(MessagePool pool, JausMessage message)
+{
+	PooledMessage pooled = (PooledMessage)message;
+
+	if(message->owner != pool)
+	{
+		jausMessageDestroy(message);
+		return;
+	}
+
+	if(message->data != pooled->buffer)
+	{
+		free(message->data);
+		message->data = pooled->buffer;
+	}
+
+	if(pooled->buffer)
+	{
+		pthread_mutex_lock(&pool->mutex);
+		if(pool->idleCount < pool->capacity)
+		{
+			pool->idle[pool->idleCount++] = message;
+			pthread_mutex_unlock(&pool->mutex);
+			return;
+		}
+		pthread_mutex_unlock(&pool->mutex);
+	}
+
+	jausMessageDestroy(message);
+}
+
+JausBoolean messagePoolMessageFromBuffer(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes)
+{
+	if(!jausMessageHeaderFromBuffer(message, buffer, bufferSizeBytes) || bufferSizeBytes - JAUS_HEADER_SIZE_BYTES < message->dataSize)
+	{
+		return JAUS_FALSE;
+	}
+
+	messagePoolCopyData(message, buffer + JAUS_HEADER_SIZE_BYTES);
+	return JAUS_TRUE;
+}
+
+JausBoolean messagePoolMessageFromLargeFrame(JausMessage message, unsigned char *buffer, unsigned int bufferSizeBytes)
+{
+	if(!jausMessageIsLargeFrame(buffer, bufferSizeBytes) ||
+	   !jausMessageHeaderFromBuffer(message, buffer + JAUS_LARGE_FRAME_HEADER_SIZE_BYTES, bufferSizeBytes - JAUS_LARGE_FRAME_HEADER_SIZE_BYTES))
+	{
+		return JAUS_FALSE;
+	}
+
+	message->dataSize = bufferSizeBytes - JAUS_LARGE_FRAME_HEADER_SIZE_BYTES - JAUS_HEADER_SIZE_BYTES;
+	message->dataFlag = JAUS_SINGLE_DATA_PACKET;
+	messagePoolCopyData(message, buffer + JAUS_LARGE_FRAME_HEADER_SIZE_BYTES + JAUS_HEADER_SIZE_BYTES);
+	return JAUS_TRUE;
+}
+
+// Frees the data of a pooled message, for code which takes the data over or replaces it
+void messagePoolFreeData(JausMessage message)
+{
+	PooledMessage pooled = (PooledMessage)message;
+
+	if(message->owner && message->data == pooled->buffer)
+	{
+		pooled->buffer = NULL;
+	}
+	free(message->data);
+	message->data = NULL;
+}
+
+JausMessage messagePoolAllocate(MessagePool pool)
+{
+	PooledMessage pooled;
+
+	pooled = (PooledMessage)malloc(sizeof(PooledMessageStruct));
+	if(pooled == NULL)
+	{
+		return NULL;
+	}
+
+	pooled->buffer = (JausByte *)malloc(MESSAGE_POOL_DATA_SIZE_BYTES);
+	if(pooled->buffer == NULL)
+	{
+		free(pooled);
+		return NULL;
+	}
+
+	pooled->message.destination = jausAddressCreate();
+	pooled->message.source = jausAddressCreate();
+	pooled->message.data = pooled->buffer;
+	pooled->message.next = NULL;
+	pooled->message.owner = pool;
+	return &pooled->message;
+}
+
+// Copies message->dataSize bytes of data into the message's buffer, or into one of their own if they do not fit
+void messagePoolCopyData(JausMessage message, unsigned char *data)
+{
+	PooledMessage pooled = (PooledMessage)message;
+
+	if(message->dataSize > MESSAGE_POOL_DATA_SIZE_BYTES || message->owner == NULL || pooled->buffer == NULL)
+	{
+		messagePoolFreeData(message);
+		message->data = (JausByte *)malloc(message->dataSize? message->dataSize : 1);
+	}
+	else
+	{
+		message->data = pooled->buffer;
+	}
+	memcpy(message->data, data, message->dataSize);
+}
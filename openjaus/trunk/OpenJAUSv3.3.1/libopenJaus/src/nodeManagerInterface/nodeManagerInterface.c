@@ -63,7 +63,8 @@
 
 #define INTERFACE_THREAD_TIMEOUT_SEC	3.0
 #define INTERFACE_SOCKET_TIMEOUT_SEC	1.0
-#define MESSAGE_SOCKET_TIMEOUT_SEC		0.5
+#define MESSAGE_SOCKET_TIMEOUT_SEC		LM_HANDLER_NAK_INTERVAL_SEC	// Wakes the receive thread often enough to send NAKs
+#define SERVICE_HEARTBEAT_PERIOD_SEC	1.0
 
 #define INTERFACE_MESSAGE_SIZE_BYTES 							8
 #define INTERFACE_MESSAGE_CHECK_IN								0x01
@@ -81,11 +82,89 @@
 #define INTERFACE_MESSAGE_LOOKUP_SERVICE_ADDRESS_LIST_RESPONSE	0x0D
 #define INTERFACE_MESSAGE_READY_CHECK							0x0E
 #define INTERFACE_MESSAGE_REPORT_READY							0x0F
+#define INTERFACE_MESSAGE_QUERY_FLOW_CONTROL					0x10
+#define INTERFACE_MESSAGE_REPORT_FLOW_CONTROL					0x11
+#define INTERFACE_MESSAGE_GET_SYSTEM_DIRECTORY					0x12
+#define INTERFACE_MESSAGE_SYSTEM_DIRECTORY_RESPONSE				0x13
+#define INTERFACE_MESSAGE_GET_ADDRESS_LIST						0x14
+#define INTERFACE_MESSAGE_ADDRESS_LIST_RESPONSE					0x15
+#define INTERFACE_MESSAGE_VERIFY_ADDRESS_LIST					0x16
+#define INTERFACE_MESSAGE_ADDRESS_LIST_VERIFIED					0x17
+#define INTERFACE_MESSAGE_REQUEST_LARGE_FRAMES					0x18
+#define INTERFACE_MESSAGE_LARGE_FRAMES_GRANTED					0x19
+
+// Sizes must match the Node Manager, see OjUdpComponentInterface.h
+#define PAGE_HEADER_SIZE_BYTES			12
+#define DIRECTORY_PAGE_SIZE_BYTES		4096
+#define ADDRESS_LIST_REQUEST_SIZE_BYTES	10
+#define ADDRESS_LIST_PAGE_SIZE			1024	// Addresses per ADDRESS_LIST_RESPONSE
+#define ADDRESS_LIST_ANY_SERVICE_TYPE	0xFF
+#define VERIFY_LIST_HEADER_SIZE_BYTES	4
+#define VERIFY_LIST_MAX_ADDRESSES		256		// Addresses per VERIFY_ADDRESS_LIST
+#define DIRECTORY_RECORD_SIZE_BYTES		6		// Address and command count, followed by the commands
+#define DIRECTORY_COMMAND_SIZE_BYTES	3
+#define DIRECTORY_FETCH_ATTEMPTS		3		// Restarts allowed when the tree changes during a multi-page fetch
+#define DIRECTORY_UNAVAILABLE			-1
+#define ADDRESS_LIST_MAX_FAILURES		3		// Unanswered list requests in a row before the single address ones are used alone
+#define ADDRESS_LIST_RETRY_SEC			60.0	// How long they are then used alone before the list ones are tried again
+
+#define FLOW_CONTROL_CREDIT_LIFETIME_SEC	0.1		// Credits are re-queried from the NM after this time
+#define FLOW_CONTROL_POLL_MSEC				5		// Poll interval while blocked on a congested link
+
+// Sends are encoded into a packet kept by each sending thread, large enough for a large frame
+#define SEND_PACKET_SIZE_BYTES		(JAUS_LARGE_FRAME_HEADER_SIZE_BYTES + JAUS_HEADER_SIZE_BYTES + JAUS_LARGE_FRAME_MAX_DATA_SIZE_BYTES)
 
 static int checkIntoNodeManager(NodeManagerInterface);
 static int checkOutOfNodeManager(NodeManagerInterface);
-void *heartbeatThread(void *);
-void *receiveThread(void *);
+static InetAddress nodeManagerAddressCreate(char *);
+static unsigned short defaultPort(const char *, unsigned short);
+static int interfaceTransaction(NodeManagerInterface, DatagramPacket);
+static int interfaceRequest(NodeManagerInterface, DatagramPacket, DatagramPacket);
+static NodeManagerDirectory directoryCreate(unsigned char *, unsigned int, unsigned int);
+static void directoryDestroy(NodeManagerDirectory);
+static NodeManagerDirectory directoryFetch(NodeManagerInterface);
+static void directoryRefresh(NodeManagerInterface);
+static void directoryProcessNotice(NodeManagerInterface, JausMessage);
+static int directoryFind(NodeManagerDirectory, JausAddress, int, int, int);
+static int directoryLookupAddress(NodeManagerInterface, JausAddress, int, int);
+static int directoryLookupAddressList(NodeManagerInterface, JausAddress, int, int, JausAddressList **);
+static int directoryVerifyAddressList(NodeManagerInterface, JausAddress *, int, JausBoolean *);
+static JausAddressList *addressListAdd(JausAddressList **, JausAddressList *);
+static int addressListFetch(NodeManagerInterface, JausAddress, int, int, int, JausAddressList **);
+static int addressLookup(NodeManagerInterface, JausAddress, int, int);
+static int addressVerify(NodeManagerInterface, JausAddress);
+static JausBoolean addressFind(NodeManagerInterface, JausAddress, int, int);
+static int flowControlAcquireCredits(NodeManagerInterface, JausMessage);
+static void requestLargeFrames(NodeManagerInterface);
+static JausMessage heartbeatMessageCreate(NodeManagerInterface);
+static void *serviceHeartbeatThread(void *);
+static void *serviceReceiveThread(void *);
+static void *serviceDirectoryThread(void *);
+static void serviceReceive(NodeManagerInterface, DatagramPacket);
+static NodeManagerInterface *serviceAcquireInterfaces(NodeManagerInterface *, int *);
+static void serviceReleaseInterfaces(NodeManagerInterface *, int);
+static int serviceAddInterface(NodeManagerInterface);
+static void serviceRemoveInterface(NodeManagerInterface);
+static DatagramPacket sendPacketGet(void);
+static void sendPacketCreateKey(void);
+static void sendPacketDestroy(void *);
+
+// Shared by every interface opened in this process, see serviceAddInterface
+static pthread_mutex_t serviceStartMutex = PTHREAD_MUTEX_INITIALIZER;	// Held while the threads are started or stopped
+static pthread_mutex_t serviceMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t serviceWakeCondition = PTHREAD_COND_INITIALIZER;	// Wakes the heartbeat thread
+static pthread_cond_t serviceDirectoryCondition = PTHREAD_COND_INITIALIZER;	// Wakes the directory thread
+static pthread_cond_t serviceIdleCondition = PTHREAD_COND_INITIALIZER;	// Signalled as the threads put interfaces down
+static NodeManagerInterface *serviceInterfaces = NULL;
+static int serviceInterfaceCount = 0;
+static int serviceRunning = JAUS_FALSE;
+static int serviceDirectoryStale = JAUS_FALSE;
+static pthread_t serviceHeartbeatThreadId;
+static pthread_t serviceReceiveThreadId;
+static pthread_t serviceDirectoryThreadId;
+
+static pthread_once_t sendPacketOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t sendPacketKey;		// Each thread's send packet, freed as the thread exits
 
 JausBoolean checkNodeManagerReady(double timeout)
 {
@@ -103,7 +182,7 @@ JausBoolean checkNodeManagerReady(double timeout)
 	int bytesRecv = 0;
 	double stopTime = 0.0;
 
-	ipAddress = inetAddressGetLocalHost();
+	ipAddress = nodeManagerAddressCreate(NULL);
 	if(ipAddress == NULL)
 	{
 		// Could not get Localhost???
@@ -130,7 +209,7 @@ JausBoolean checkNodeManagerReady(double timeout)
 	packet->buffer = (unsigned char *) malloc(packet->bufferSizeBytes);
 	memset(packet->buffer, 0, packet->bufferSizeBytes);
 	packet->buffer[0]= INTERFACE_MESSAGE_READY_CHECK;
-	packet->port = NODE_MANAGER_INTERFACE_PORT;
+	packet->port = defaultPort("OJ_NODE_MANAGER_INTERFACE_PORT", NODE_MANAGER_INTERFACE_PORT);
 	packet->address->value = ipAddress->value;
 
 	if(timeout != 0)
@@ -167,7 +246,43 @@ JausBoolean checkNodeManagerReady(double timeout)
 	return JAUS_FALSE;
 }
 
+// The Node Manager is reached on the loopback device at the ports of the OJ Nodemanager Interface
+// Document unless the environment overrides them (OJ_NODE_MANAGER_IP_ADDRESS, OJ_NODE_MANAGER_INTERFACE_PORT
+// and OJ_NODE_MANAGER_MESSAGE_PORT), which allows several Node Managers to run on one host
+static InetAddress nodeManagerAddressCreate(char *ipAddressString)
+{
+	if(ipAddressString == NULL)
+	{
+		ipAddressString = getenv("OJ_NODE_MANAGER_IP_ADDRESS");
+	}
+
+	if(ipAddressString == NULL || ipAddressString[0] == 0)
+	{
+		return inetAddressGetLocalHost();
+	}
+	else
+	{
+		return inetAddressGetByString(ipAddressString);
+	}
+}
+
+static unsigned short defaultPort(const char *environmentName, unsigned short port)
+{
+	char *portString = getenv(environmentName);
+
+	if(portString && atoi(portString) > 0)
+	{
+		return (unsigned short)atoi(portString);
+	}
+	return port;
+}
+
 NodeManagerInterface nodeManagerOpen(JausComponent cmpt)
+{
+	return nodeManagerOpenAt(cmpt, NULL, 0, 0);
+}
+
+NodeManagerInterface nodeManagerOpenAt(JausComponent cmpt, char *ipAddressString, unsigned short interfacePort, unsigned short messagePort)
 {
 	NodeManagerInterface nmi = NULL;
 
@@ -185,9 +300,29 @@ NodeManagerInterface nodeManagerOpen(JausComponent cmpt)
 	nmi->cmpt = cmpt;
 	nmi->timestamp = ojGetTimeSec();
 	pthread_cond_init(&nmi->recvCondition, NULL);
-	pthread_cond_init(&nmi->hbWakeCondition, NULL);
-
-	nmi->ipAddress = inetAddressGetLocalHost();
+	pthread_mutex_init(&nmi->recvMutex, NULL);
+	pthread_mutex_init(&nmi->interfaceMutex, NULL);
+	pthread_mutex_init(&nmi->flowControlMutex, NULL);
+	pthread_rwlock_init(&nmi->directoryLock, NULL);
+
+	nmi->directory = NULL;
+	nmi->directoryStale = JAUS_FALSE;
+	nmi->directoryRefreshCount = 0;
+	nmi->addressListFailureCount = 0;
+	nmi->addressListRetryTime = 0;
+	nmi->largeFrameSizeBytes = 0;
+
+	nmi->flowControlMode = NMI_FLOW_CONTROL_OFF;
+	nmi->flowControlTimeoutSec = 0.0;
+	memset(nmi->flowControlCredits, 0, sizeof(nmi->flowControlCredits));
+	nmi->sendCongestedCount = 0;
+	nmi->sendDropCount = 0;
+	nmi->receiveDropCount = 0;
+
+	nmi->interfacePort = interfacePort? interfacePort : defaultPort("OJ_NODE_MANAGER_INTERFACE_PORT", NODE_MANAGER_INTERFACE_PORT);
+	nmi->messagePort = messagePort? messagePort : defaultPort("OJ_NODE_MANAGER_MESSAGE_PORT", NODE_MANAGER_MESSAGE_PORT);
+
+	nmi->ipAddress = nodeManagerAddressCreate(ipAddressString);
 	if(nmi->ipAddress == NULL)
 	{
 		free(nmi);
@@ -212,7 +347,8 @@ NodeManagerInterface nodeManagerOpen(JausComponent cmpt)
 		free(nmi);
 		return NULL;
 	}
-	datagramSocketSetTimeout(nmi->messageSocket, MESSAGE_SOCKET_TIMEOUT_SEC);
+	// Only read once the shared receive thread has found it readable
+	datagramSocketSetTimeout(nmi->messageSocket, 0.0);
 
 	if(checkIntoNodeManager(nmi))
 	{
@@ -223,12 +359,34 @@ NodeManagerInterface nodeManagerOpen(JausComponent cmpt)
 		return NULL;
 	}
 
-	nmi->receiveQueue = queueCreate();
+	nmi->receiveQueue = ringQueueCreate(NMI_RECEIVE_QUEUE_CAPACITY, RING_QUEUE_DROP_NEWEST, nodeManagerReleaseQueuedMessage, nmi);
+	if(nmi->receiveQueue == NULL)
+	{
+		checkOutOfNodeManager(nmi);
+		datagramSocketDestroy(nmi->messageSocket);
+		datagramSocketDestroy(nmi->interfaceSocket);
+		inetAddressDestroy(nmi->ipAddress);
+		free(nmi);
+		return NULL;
+	}
+
+	nmi->messagePool = messagePoolCreate(NMI_MESSAGE_POOL_CAPACITY, NMI_MESSAGE_POOL_PREALLOCATED);
+	if(nmi->messagePool == NULL)
+	{
+		ringQueueDestroy(nmi->receiveQueue);
+		checkOutOfNodeManager(nmi);
+		datagramSocketDestroy(nmi->messageSocket);
+		datagramSocketDestroy(nmi->interfaceSocket);
+		inetAddressDestroy(nmi->ipAddress);
+		free(nmi);
+		return NULL;
+	}
 
 	nmi->scm = scManagerCreate();
 	if(nmi->scm == NULL)
 	{
-		queueDestroy(nmi->receiveQueue, NULL);
+		messagePoolDestroy(nmi->messagePool);
+		ringQueueDestroy(nmi->receiveQueue);
 		checkOutOfNodeManager(nmi);
 		datagramSocketDestroy(nmi->messageSocket);
 		datagramSocketDestroy(nmi->interfaceSocket);
@@ -237,11 +395,12 @@ NodeManagerInterface nodeManagerOpen(JausComponent cmpt)
 		return NULL;
 	}
 
-	nmi->lmh = lmHandlerCreate();
-	if(nmi->lmh == NULL)
+	nmi->evm = eventManagerCreate();
+	if(nmi->evm == NULL)
 	{
 		scManagerDestroy(nmi->scm);
-		queueDestroy(nmi->receiveQueue, NULL);
+		ringQueueDestroy(nmi->receiveQueue);
+		messagePoolDestroy(nmi->messagePool);
 		checkOutOfNodeManager(nmi);
 		datagramSocketDestroy(nmi->messageSocket);
 		datagramSocketDestroy(nmi->interfaceSocket);
@@ -250,13 +409,13 @@ NodeManagerInterface nodeManagerOpen(JausComponent cmpt)
 		return NULL;
 	}
 
-	nmi->isOpen = JAUS_TRUE;
-
-	if(pthread_create(&nmi->heartbeatThreadId, NULL, heartbeatThread, (void *)nmi))
+	nmi->lmh = lmHandlerCreate();
+	if(nmi->lmh == NULL)
 	{
-		lmHandlerDestroy(nmi->lmh);
+		eventManagerDestroy(nmi->evm);
 		scManagerDestroy(nmi->scm);
-		queueDestroy(nmi->receiveQueue, NULL);
+		ringQueueDestroy(nmi->receiveQueue);
+		messagePoolDestroy(nmi->messagePool);
 		checkOutOfNodeManager(nmi);
 		datagramSocketDestroy(nmi->messageSocket);
 		datagramSocketDestroy(nmi->interfaceSocket);
@@ -265,12 +424,34 @@ NodeManagerInterface nodeManagerOpen(JausComponent cmpt)
 		return NULL;
 	}
 
-	if(pthread_create(&nmi->receiveThreadId, NULL, receiveThread, (void *)nmi))
+	// Take our first copy of the system tree, if the Node Manager does not
+	// provide one every lookup is made with a round trip to it instead
+	directoryRefresh(nmi);
+
+	// Only Node Managers which serve the directory know about large frames, older ones are not asked
+	if(nmi->directory)
+	{
+		requestLargeFrames(nmi);
+	}
+
+	nmi->heartbeatMessage = heartbeatMessageCreate(nmi);
+	nmi->heartbeatCount = 0;
+	nmi->nextHeartbeatTime = 0;
+	nmi->nodeManagerTimedOut = JAUS_FALSE;
+	nmi->receiveCount = 0;
+	nmi->serviceUsers = 0;
+	nmi->receiveCallback = NULL;
+	nmi->receiveCallbackData = NULL;
+	nmi->isOpen = JAUS_TRUE;
+
+	if(serviceAddInterface(nmi))
 	{
-		pthread_cancel(nmi->heartbeatThreadId);
+		jausMessageDestroy(nmi->heartbeatMessage);
 		lmHandlerDestroy(nmi->lmh);
+		eventManagerDestroy(nmi->evm);
 		scManagerDestroy(nmi->scm);
-		queueDestroy(nmi->receiveQueue, NULL);
+		ringQueueDestroy(nmi->receiveQueue);
+		messagePoolDestroy(nmi->messagePool);
 		checkOutOfNodeManager(nmi);
 		datagramSocketDestroy(nmi->messageSocket);
 		datagramSocketDestroy(nmi->interfaceSocket);
@@ -301,21 +482,24 @@ int nodeManagerClose(NodeManagerInterface nmi)
 
 		nmi->isOpen = 0;
 
-		pthread_cond_signal(&nmi->hbWakeCondition);
-		pthread_join(nmi->heartbeatThreadId, NULL);
-
-		CLOSE_SOCKET(nmi->messageSocket->descriptor);
-		pthread_join(nmi->receiveThreadId, NULL);
+		serviceRemoveInterface(nmi);
+		jausMessageDestroy(nmi->heartbeatMessage);
 
 		lmHandlerDestroy(nmi->lmh);
+		eventManagerDestroy(nmi->evm);
 		scManagerDestroy(nmi->scm);
-		queueDestroy(nmi->receiveQueue, (void*)jausMessageDestroy);
+		ringQueueDestroy(nmi->receiveQueue);
+		messagePoolDestroy(nmi->messagePool);
 		checkOutOfNodeManager(nmi);
 		datagramSocketDestroy(nmi->messageSocket);
 		datagramSocketDestroy(nmi->interfaceSocket);
 		inetAddressDestroy(nmi->ipAddress);
 		pthread_cond_destroy(&nmi->recvCondition);
-		pthread_cond_destroy(&nmi->hbWakeCondition);
+		pthread_mutex_destroy(&nmi->recvMutex);
+		pthread_mutex_destroy(&nmi->interfaceMutex);
+		pthread_mutex_destroy(&nmi->flowControlMutex);
+		directoryDestroy(nmi->directory);
+		pthread_rwlock_destroy(&nmi->directoryLock);
 		free(nmi);
 	}
 	else
@@ -340,11 +524,10 @@ static int checkIntoNodeManager(NodeManagerInterface nmi)
 	packet->buffer[2] = (unsigned char)(nmi->messageSocket->port & 0xFF);
 	packet->buffer[3] = (unsigned char)((nmi->messageSocket->port & 0xFF00) >> 8);
 
-	packet->port = NODE_MANAGER_INTERFACE_PORT;
+	packet->port = nmi->interfacePort;
 	packet->address->value = nmi->ipAddress->value;
 
-	datagramSocketSend(nmi->interfaceSocket, packet);
-	datagramSocketReceive(nmi->interfaceSocket, packet);
+	interfaceTransaction(nmi, packet);
 
 	if(packet->buffer[0] == INTERFACE_MESSAGE_REPORT_ADDRESS)
 	{
@@ -379,7 +562,7 @@ static int checkOutOfNodeManager(NodeManagerInterface nmi)
 	packet->buffer[2] = nmi->cmpt->address->component;
 	packet->buffer[3] = nmi->cmpt->address->node;
 	packet->buffer[4] = nmi->cmpt->address->subsystem;
-	packet->port = NODE_MANAGER_INTERFACE_PORT;
+	packet->port = nmi->interfacePort;
 	packet->address->value = nmi->ipAddress->value;
 
 	datagramSocketSend(nmi->interfaceSocket, packet);
@@ -391,19 +574,45 @@ static int checkOutOfNodeManager(NodeManagerInterface nmi)
 	return 1;
 }
 
-void *heartbeatThread(void *threadArgument)
+// Asks the Node Manager to pass messages larger than one JAUS packet whole between it and this component.
+// It answers with the largest data size it agrees to, 0 keeps both sides on standard packets.
+static void requestLargeFrames(NodeManagerInterface nmi)
+{
+	DatagramPacket packet;
+	unsigned int sizeBytes = JAUS_LARGE_FRAME_MAX_DATA_SIZE_BYTES;
+
+	packet = datagramPacketCreate();
+	packet->bufferSizeBytes = INTERFACE_MESSAGE_SIZE_BYTES;
+	packet->buffer = (unsigned char *)malloc(packet->bufferSizeBytes);
+	memset(packet->buffer, 0, packet->bufferSizeBytes);
+
+	packet->buffer[0] = INTERFACE_MESSAGE_REQUEST_LARGE_FRAMES;
+	packet->buffer[1] = (unsigned char)(nmi->cmpt->address->instance & 0xFF);
+	packet->buffer[2] = (unsigned char)(nmi->cmpt->address->component & 0xFF);
+	packet->buffer[3] = (unsigned char)(nmi->cmpt->address->node & 0xFF);
+	packet->buffer[4] = (unsigned char)(nmi->cmpt->address->subsystem & 0xFF);
+	packet->buffer[5] = (unsigned char)(sizeBytes & 0xFF);
+	packet->buffer[6] = (unsigned char)((sizeBytes >> 8) & 0xFF);
+	packet->buffer[7] = (unsigned char)((sizeBytes >> 16) & 0xFF);
+
+	if(interfaceTransaction(nmi, packet) >= INTERFACE_MESSAGE_SIZE_BYTES && packet->buffer[0] == INTERFACE_MESSAGE_LARGE_FRAMES_GRANTED)
+	{
+		sizeBytes = (packet->buffer[1] & 0xFF) + ((packet->buffer[2] & 0xFF) << 8) + ((packet->buffer[3] & 0xFF) << 16);
+		if(sizeBytes > JAUS_MAX_DATA_SIZE_BYTES && sizeBytes <= JAUS_LARGE_FRAME_MAX_DATA_SIZE_BYTES)
+		{
+			nmi->largeFrameSizeBytes = sizeBytes;
+		}
+	}
+
+	free(packet->buffer);
+	datagramPacketDestroy(packet);
+}
+
+static JausMessage heartbeatMessageCreate(NodeManagerInterface nmi)
 {
-	pthread_mutex_t hbMutex = PTHREAD_MUTEX_INITIALIZER;
-	int condition = -1;
-	struct timespec timeLimitSpec;
-	double timeLimitSec = 0;
-	NodeManagerInterface nmi = (NodeManagerInterface)threadArgument;
 	JausMessage txMessage;
 	ReportHeartbeatPulseMessage heartbeat = reportHeartbeatPulseMessageCreate();
 
-	nmi->heartbeatThreadRunning = 1;
-	nmi->heartbeatCount = 0;
-
 	jausAddressCopy(heartbeat->source, nmi->cmpt->address);
 	heartbeat->destination->subsystem = nmi->cmpt->address->subsystem;
 	heartbeat->destination->node = nmi->cmpt->address->node;
@@ -411,558 +620,1724 @@ void *heartbeatThread(void *threadArgument)
 	heartbeat->destination->instance = 1;
 
 	txMessage = reportHeartbeatPulseMessageToJausMessage(heartbeat);
+	reportHeartbeatPulseMessageDestroy(heartbeat);
+	return txMessage;
+}
 
-	while(nmi->isOpen)
-	{
-		nodeManagerSend(nmi, txMessage);
-		nmi->heartbeatCount++;
-		if( (ojGetTimeSec() - NODE_MANAGER_TIMEOUT_SEC) > nmi->timestamp)
-		{
-			// TODO: Capture Error
-			//printf("libNodeManager: Node Manager Has Timed Out\n");
-			//nmi->cmpt->state = JAUS_FAILURE_STATE;
-			break;
-		}
+static int interfaceTransaction(NodeManagerInterface nmi, DatagramPacket packet)
+{
+	return interfaceRequest(nmi, packet, packet);
+}
 
-		timeLimitSec = ojGetTimeSec() + 1.0;
-		timeLimitSpec.tv_sec = (long)timeLimitSec;
-		timeLimitSpec.tv_nsec = (long)(1e9 * (timeLimitSec - (double)timeLimitSpec.tv_sec));
+static int interfaceRequest(NodeManagerInterface nmi, DatagramPacket request, DatagramPacket reply)
+{
+	int bytesRecv;
 
-		pthread_mutex_lock(&hbMutex);
-		condition = pthread_cond_timedwait(&nmi->hbWakeCondition, &hbMutex, &timeLimitSpec);
-		pthread_mutex_unlock(&hbMutex);
-	}
+	// The interface socket is shared by every thread using this nmi, serialize the
+	// request / reply pairs so one thread cannot consume the reply meant for another
+	request->port = nmi->interfacePort;
+	request->address->value = nmi->ipAddress->value;
 
-	jausMessageDestroy(txMessage);
-	reportHeartbeatPulseMessageDestroy(heartbeat);
-	nmi->heartbeatThreadRunning = 0;
+	pthread_mutex_lock(&nmi->interfaceMutex);
+	datagramSocketSend(nmi->interfaceSocket, request);
+	bytesRecv = datagramSocketReceive(nmi->interfaceSocket, reply);
+	pthread_mutex_unlock(&nmi->interfaceMutex);
 
-	return NULL;
+	return bytesRecv;
 }
 
-void *receiveThread(void *threadArgument)
+// Builds a directory from the records sent by the Node Manager (see SystemTree::getDirectory)
+static NodeManagerDirectory directoryCreate(unsigned char *data, unsigned int dataSize, unsigned int changeCount)
 {
-	int index;
+	NodeManagerDirectory directory;
+	NodeManagerDirectoryEntry *entry;
+	unsigned int index = 0;
+	unsigned short count;
+	int entryCount = 0;
+	int commandCount = 0;
+	int i;
+
+	// Count first, so each table is allocated once
+	while(index + DIRECTORY_RECORD_SIZE_BYTES <= dataSize)
+	{
+		count = (unsigned short)(data[index + 4] + (data[index + 5] << 8));
+		index += DIRECTORY_RECORD_SIZE_BYTES + count * DIRECTORY_COMMAND_SIZE_BYTES;
+		entryCount++;
+		commandCount += count;
+	}
 
-	NodeManagerInterface nmi = (NodeManagerInterface)threadArgument;
-	DatagramPacket packet;
+	if(index != dataSize)
+	{
+		// Truncated record
+		return NULL;
+	}
 
-	JausMessage message;
+	directory = (NodeManagerDirectory)malloc(sizeof(NodeManagerDirectoryStruct));
+	if(directory == NULL)
+	{
+		return NULL;
+	}
 
-	nmi->receiveThreadRunning = 1;
+	directory->changeCount = changeCount;
+	directory->entryCount = entryCount;
+	directory->commandCount = commandCount;
+	directory->entries = (NodeManagerDirectoryEntry *)malloc((entryCount + 1) * sizeof(NodeManagerDirectoryEntry));
+	directory->commands = (NodeManagerDirectoryCommand *)malloc((commandCount + 1) * sizeof(NodeManagerDirectoryCommand));
+	if(directory->entries == NULL || directory->commands == NULL)
+	{
+		directoryDestroy(directory);
+		return NULL;
+	}
 
-	nmi->receiveCount = 0;
+	index = 0;
+	commandCount = 0;
+	for(entry = directory->entries; entry < directory->entries + entryCount; entry++)
+	{
+		entry->instance = data[index];
+		entry->component = data[index + 1];
+		entry->node = data[index + 2];
+		entry->subsystem = data[index + 3];
+		entry->commandCount = (unsigned short)(data[index + 4] + (data[index + 5] << 8));
+		entry->commandIndex = commandCount;
+		index += DIRECTORY_RECORD_SIZE_BYTES;
+
+		for(i = 0; i < entry->commandCount; i++)
+		{
+			directory->commands[commandCount].commandCode = (unsigned short)(data[index] + (data[index + 1] << 8));
+			directory->commands[commandCount].serviceType = data[index + 2];
+			index += DIRECTORY_COMMAND_SIZE_BYTES;
+			commandCount++;
+		}
+	}
 
-	packet = datagramPacketCreate();
+	return directory;
+}
 
-	packet->bufferSizeBytes = JAUS_HEADER_SIZE_BYTES + JAUS_MAX_DATA_SIZE_BYTES;
-	packet->buffer = (unsigned char*)malloc(packet->bufferSizeBytes);
-	memset(packet->buffer, 0, packet->bufferSizeBytes);
+static void directoryDestroy(NodeManagerDirectory directory)
+{
+	if(directory)
+	{
+		free(directory->entries);
+		free(directory->commands);
+		free(directory);
+	}
+}
+
+// Pulls every page of the Node Manager's directory. Returns NULL if the Node Manager
+// does not answer, or keeps changing its tree while the pages are being collected.
+static NodeManagerDirectory directoryFetch(NodeManagerInterface nmi)
+{
+	NodeManagerDirectory directory = NULL;
+	DatagramPacket request;
+	DatagramPacket reply;
+	unsigned char *data = NULL;
+	unsigned char *grownData;
+	unsigned int dataSize;
+	unsigned int pageSize;
+	unsigned int page;
+	unsigned int pageCount;
+	unsigned int changeCount = 0;
+	unsigned int pageChangeCount;
+	int bytesRecv = 0;
+	int attempt;
+
+	request = datagramPacketCreate();
+	request->bufferSizeBytes = INTERFACE_MESSAGE_SIZE_BYTES;
+	request->buffer = (unsigned char *)malloc(request->bufferSizeBytes);
+
+	reply = datagramPacketCreate();
+	reply->bufferSizeBytes = PAGE_HEADER_SIZE_BYTES + DIRECTORY_PAGE_SIZE_BYTES;
+	reply->buffer = (unsigned char *)malloc(reply->bufferSizeBytes);
 
-	while(nmi->isOpen)
+	for(attempt = 0; attempt < DIRECTORY_FETCH_ATTEMPTS && directory == NULL; attempt++)
 	{
-		if(datagramSocketReceive(nmi->messageSocket, packet) > 0)
+		dataSize = 0;
+		pageCount = 1;
+
+		for(page = 0; page < pageCount; page++)
 		{
-			index = 0;
-			if(!strncmp((char *)packet->buffer, JAUS_OPC_UDP_HEADER, JAUS_OPC_UDP_HEADER_SIZE_BYTES)) // equals 1 if same
+			memset(request->buffer, 0, request->bufferSizeBytes);
+			request->buffer[0] = INTERFACE_MESSAGE_GET_SYSTEM_DIRECTORY;
+			request->buffer[1] = (unsigned char)(page & 0xFF);
+			request->buffer[2] = (unsigned char)((page >> 8) & 0xFF);
+
+			bytesRecv = interfaceRequest(nmi, request, reply);
+			if(	bytesRecv < PAGE_HEADER_SIZE_BYTES ||
+				reply->buffer[0] != INTERFACE_MESSAGE_SYSTEM_DIRECTORY_RESPONSE ||
+				(unsigned int)(reply->buffer[2] + (reply->buffer[3] << 8)) != page)
 			{
-				index += JAUS_OPC_UDP_HEADER_SIZE_BYTES;
+				break;
 			}
 
-			message = jausMessageCreate();
-			if(jausMessageFromBuffer(message, packet->buffer + index, packet->bufferSizeBytes - index))
+			pageChangeCount =	reply->buffer[6] + (reply->buffer[7] << 8) +
+								(reply->buffer[8] << 16) + ((unsigned int)reply->buffer[9] << 24);
+			pageSize = reply->buffer[10] + (reply->buffer[11] << 8);
+			if((unsigned int)bytesRecv < PAGE_HEADER_SIZE_BYTES + pageSize)
 			{
-				if(message->dataFlag)
-				{
-					lmHandlerReceiveLargeMessage(nmi, message);
-				}
-				else
-				{
-					if(message->properties.scFlag)
-					{
-						if(	(message->commandCode >= JAUS_CREATE_SERVICE_CONNECTION &&
-							message->commandCode <= JAUS_TERMINATE_SERVICE_CONNECTION) ||
-							message->commandCode == JAUS_CREATE_EVENT ||
-							message->commandCode == JAUS_CONFIRM_EVENT_REQUEST ||
-							message->commandCode == JAUS_CANCEL_EVENT)
-						{
-							// This is to take Service Connection Control messages and send them on through
-							// to the regular receiveQueue. JAUS 3.2 RA says to set the properties.scFlag bit if it is
-							// a Service Connection Control message, but logically they do not need to go
-							// to the scManager and instead to the component
-							queuePush(nmi->receiveQueue, (void *)message);
-						}
-						else
-						{
-							scManagerReceiveMessage(nmi, message);
-						}
-					}
-					else
-					{
-						queuePush(nmi->receiveQueue, (void *)message);
-					}
-				}
-				pthread_cond_signal(&nmi->recvCondition);
-				nmi->receiveCount++;
+				break;
 			}
-			else
+
+			if(page == 0)
+			{
+				changeCount = pageChangeCount;
+				pageCount = reply->buffer[4] + (reply->buffer[5] << 8);
+			}
+			else if(pageChangeCount != changeCount)
+			{
+				// The tree changed between pages, start over
+				break;
+			}
+
+			grownData = (unsigned char *)realloc(data, dataSize + pageSize + 1);
+			if(grownData == NULL)
 			{
-				jausMessageDestroy(message);
+				break;
 			}
+			data = grownData;
+			memcpy(data + dataSize, reply->buffer + PAGE_HEADER_SIZE_BYTES, pageSize);
+			dataSize += pageSize;
+		}
+
+		if(page == pageCount)
+		{
+			directory = directoryCreate(data, dataSize, changeCount);
+		}
+		else if(bytesRecv <= 0)
+		{
+			// No answer, this Node Manager does not serve its directory
+			break;
 		}
 	}
 
-	free(packet->buffer);
+	free(data);
+	free(request->buffer);
+	datagramPacketDestroy(request);
+	free(reply->buffer);
+	datagramPacketDestroy(reply);
 
-	datagramPacketDestroy(packet);
+	return directory;
+}
 
-	nmi->receiveThreadRunning = 0;
+static void directoryRefresh(NodeManagerInterface nmi)
+{
+	NodeManagerDirectory directory;
+	NodeManagerDirectory oldDirectory;
 
-	return NULL;
+	pthread_rwlock_wrlock(&nmi->directoryLock);
+	nmi->directoryStale = JAUS_FALSE;
+	pthread_rwlock_unlock(&nmi->directoryLock);
+
+	directory = directoryFetch(nmi);
+	if(directory == NULL)
+	{
+		// Keep answering from the copy we have, the next notice will retry
+		return;
+	}
+
+	pthread_rwlock_wrlock(&nmi->directoryLock);
+	oldDirectory = nmi->directory;
+	nmi->directory = directory;
+	pthread_rwlock_unlock(&nmi->directoryLock);
+
+	directoryDestroy(oldDirectory);
+	nmi->directoryRefreshCount++;
 }
 
-JausAddressList *nodeManagerGetComponentAddressList(NodeManagerInterface nmi, unsigned char componentId)
+// Called from the receive thread, the fetch itself is left to the directory thread
+static void directoryProcessNotice(NodeManagerInterface nmi, JausMessage message)
 {
-	JausAddressList *addressList = NULL;
-	JausAddressList *currentAddress = NULL;
-	DatagramPacket packet;
+	JausUnsignedInteger changeCount;
+	int stale;
 
-	if(!nmi || !nmi->isOpen || !componentId)
+	if(!jausUnsignedIntegerFromBuffer(&changeCount, message->data, message->dataSize))
 	{
-		return NULL;
+		nmi->receiveDropCount++;
+		return;
 	}
 
-	packet = datagramPacketCreate();
+	pthread_rwlock_wrlock(&nmi->directoryLock);
+	stale = nmi->directory == NULL || nmi->directory->changeCount != changeCount;
+	if(stale)
+	{
+		nmi->directoryStale = JAUS_TRUE;
+	}
+	pthread_rwlock_unlock(&nmi->directoryLock);
 
-	packet->bufferSizeBytes = INTERFACE_MESSAGE_SIZE_BYTES;
-	packet->buffer = (unsigned char *)malloc(packet->bufferSizeBytes);
-	memset(packet->buffer, 0, packet->bufferSizeBytes);
-	packet->buffer[0] = INTERFACE_MESSAGE_GET_COMPONENT_ADDRESS_LIST;
-	packet->buffer[1] = componentId;
-	packet->buffer[2] = 0;
-	packet->buffer[3] = 0;
-	packet->buffer[4] = 0;
+	if(stale)
+	{
+		pthread_mutex_lock(&serviceMutex);
+		serviceDirectoryStale = JAUS_TRUE;
+		pthread_cond_signal(&serviceDirectoryCondition);
+		pthread_mutex_unlock(&serviceMutex);
+	}
+}
 
-	packet->port = NODE_MANAGER_INTERFACE_PORT;
-	packet->address->value = nmi->ipAddress->value;
+static int directoryEntryMatches(NodeManagerDirectoryEntry *entry, JausAddress address)
+{
+	return	(address->subsystem == JAUS_ADDRESS_WILDCARD_OCTET || address->subsystem == entry->subsystem) &&
+			(address->node == JAUS_ADDRESS_WILDCARD_OCTET || address->node == entry->node) &&
+			(address->component == JAUS_ADDRESS_WILDCARD_OCTET || address->component == entry->component) &&
+			(address->instance == JAUS_ADDRESS_WILDCARD_OCTET || address->instance == entry->instance);
+}
 
-	datagramSocketSend(nmi->interfaceSocket, packet);
-	datagramSocketReceive(nmi->interfaceSocket, packet);
+static void directoryEntryToAddress(NodeManagerDirectoryEntry *entry, JausAddress address)
+{
+	address->subsystem = entry->subsystem;
+	address->node = entry->node;
+	address->component = entry->component;
+	address->instance = entry->instance;
+}
+
+// Returns the index of the first entry at or after startIndex which matches lookupAddress and, unless
+// commandCode is negative, lists commandCode as a command of serviceCommandType. Returns -1 if none does.
+static int directoryFind(NodeManagerDirectory directory, JausAddress lookupAddress, int commandCode, int serviceCommandType, int startIndex)
+{
+	NodeManagerDirectoryEntry *entry;
+	NodeManagerDirectoryCommand *command;
+	int i;
+	int j;
 
-	while(packet->buffer[0] == INTERFACE_MESSAGE_COMPONENT_ADDRESS_LIST_RESPONSE && packet->buffer[4])
+	for(i = startIndex; i < directory->entryCount; i++)
 	{
-		if(currentAddress)
+		entry = &directory->entries[i];
+		if(!directoryEntryMatches(entry, lookupAddress))
 		{
-			currentAddress->nextAddress = (JausAddressList *)malloc(sizeof(JausAddressList));
-			currentAddress = currentAddress->nextAddress;
-			currentAddress->address = jausAddressCreate();
-			currentAddress->address->instance = packet->buffer[1];
-			currentAddress->address->component = packet->buffer[2];
-			currentAddress->address->node = packet->buffer[3];
-			currentAddress->address->subsystem = packet->buffer[4];
-			currentAddress->nextAddress = NULL;
+			continue;
 		}
-		else
+
+		if(commandCode < 0)
 		{
-			addressList = (JausAddressList *)malloc(sizeof(JausAddressList));
-			currentAddress = addressList;
-			currentAddress->address = jausAddressCreate();
-			currentAddress->address->instance = packet->buffer[1];
-			currentAddress->address->component = packet->buffer[2];
-			currentAddress->address->node = packet->buffer[3];
-			currentAddress->address->subsystem = packet->buffer[4];
-			currentAddress->nextAddress = NULL;
+			return i;
 		}
 
-		packet->buffer[0] = INTERFACE_MESSAGE_GET_COMPONENT_ADDRESS_LIST;
-		packet->buffer[1] = 0;
-		packet->buffer[2] = 0;
-		packet->buffer[3] = 0;
-		packet->buffer[4] = 0;
-
-		datagramSocketSend(nmi->interfaceSocket, packet);
-		datagramSocketReceive(nmi->interfaceSocket, packet);
+		command = &directory->commands[entry->commandIndex];
+		for(j = 0; j < entry->commandCount; j++, command++)
+		{
+			if(command->commandCode == commandCode && command->serviceType == serviceCommandType)
+			{
+				return i;
+			}
+		}
 	}
+	return -1;
+}
 
-	free(packet->buffer);
-	datagramPacketDestroy(packet);
+// Returns DIRECTORY_UNAVAILABLE if there is no local copy of the tree, otherwise the answer
+static int directoryLookupAddress(NodeManagerInterface nmi, JausAddress lookupAddress, int commandCode, int serviceCommandType)
+{
+	int result = DIRECTORY_UNAVAILABLE;
+	int index;
 
-	return addressList;
+	pthread_rwlock_rdlock(&nmi->directoryLock);
+	if(nmi->directory)
+	{
+		result = JAUS_FALSE;
+		index = directoryFind(nmi->directory, lookupAddress, commandCode, serviceCommandType, 0);
+		if(index >= 0)
+		{
+			directoryEntryToAddress(&nmi->directory->entries[index], lookupAddress);
+			result = JAUS_TRUE;
+		}
+	}
+	pthread_rwlock_unlock(&nmi->directoryLock);
+
+	return result;
 }
 
-JausBoolean nodeManagerLookupAddress(NodeManagerInterface nmi, JausAddress lookupAddress)
+// As directoryLookupAddress, collecting every match into list. Returns the number found.
+static int directoryLookupAddressList(NodeManagerInterface nmi, JausAddress lookupAddress, int commandCode, int serviceCommandType, JausAddressList **list)
 {
-	DatagramPacket packet;
+	JausAddressList *last = NULL;
+	int result = DIRECTORY_UNAVAILABLE;
+	int index;
 
-	if(!nmi || !nmi->isOpen)
+	pthread_rwlock_rdlock(&nmi->directoryLock);
+	if(nmi->directory)
 	{
-		return JAUS_FALSE;
+		result = 0;
+		index = directoryFind(nmi->directory, lookupAddress, commandCode, serviceCommandType, 0);
+		while(index >= 0)
+		{
+			last = addressListAdd(list, last);
+			if(last == NULL)
+			{
+				break;
+			}
+			directoryEntryToAddress(&nmi->directory->entries[index], last->address);
+			result++;
+
+			index = directoryFind(nmi->directory, lookupAddress, commandCode, serviceCommandType, index + 1);
+		}
 	}
+	pthread_rwlock_unlock(&nmi->directoryLock);
 
-	packet = datagramPacketCreate();
+	return result;
+}
 
-	packet->bufferSizeBytes = INTERFACE_MESSAGE_SIZE_BYTES;
-	packet->buffer = (unsigned char *)malloc(packet->bufferSizeBytes);
-	memset(packet->buffer, 0, packet->bufferSizeBytes);
-	packet->buffer[0] = INTERFACE_MESSAGE_LOOKUP_ADDRESS;
-	packet->buffer[1] = lookupAddress->instance;
-	packet->buffer[2] = lookupAddress->component;
-	packet->buffer[3] = lookupAddress->node;
-	packet->buffer[4] = lookupAddress->subsystem;
+static int directoryVerifyAddressList(NodeManagerInterface nmi, JausAddress *addresses, int addressCount, JausBoolean *verified)
+{
+	NodeManagerDirectoryEntry *entry;
+	int result = DIRECTORY_UNAVAILABLE;
+	int i;
+	int j;
 
-	packet->port = NODE_MANAGER_INTERFACE_PORT;
-	packet->address->value = nmi->ipAddress->value;
+	pthread_rwlock_rdlock(&nmi->directoryLock);
+	if(nmi->directory)
+	{
+		result = 0;
+		for(i = 0; i < addressCount; i++)
+		{
+			verified[i] = JAUS_FALSE;
+			for(j = 0; j < nmi->directory->entryCount; j++)
+			{
+				entry = &nmi->directory->entries[j];
+				if(	entry->subsystem == addresses[i]->subsystem && entry->node == addresses[i]->node &&
+					entry->component == addresses[i]->component && entry->instance == addresses[i]->instance)
+				{
+					verified[i] = JAUS_TRUE;
+					result++;
+					break;
+				}
+			}
+		}
+	}
+	pthread_rwlock_unlock(&nmi->directoryLock);
 
-	datagramSocketSend(nmi->interfaceSocket, packet);
-	datagramSocketReceive(nmi->interfaceSocket, packet);
+	return result;
+}
+
+// Appends an empty entry to the list, returns it (the new tail) or NULL if out of memory
+static JausAddressList *addressListAdd(JausAddressList **list, JausAddressList *last)
+{
+	JausAddressList *entry;
 
-	if(	packet->buffer[0] == INTERFACE_MESSAGE_LOOKUP_ADDRESS_RESPONSE && packet->buffer[5])
+	entry = (JausAddressList *)malloc(sizeof(JausAddressList));
+	if(entry == NULL)
 	{
-		lookupAddress->instance = packet->buffer[1];
-		lookupAddress->component = packet->buffer[2];
-		lookupAddress->node = packet->buffer[3];
-		lookupAddress->subsystem = packet->buffer[4];
+		return NULL;
+	}
 
-		free(packet->buffer);
-		datagramPacketDestroy(packet);
-		return JAUS_TRUE;
+	entry->address = jausAddressCreate();
+	entry->nextAddress = NULL;
+	if(entry->address == NULL)
+	{
+		free(entry);
+		return NULL;
+	}
+
+	if(last)
+	{
+		last->nextAddress = entry;
 	}
 	else
 	{
-		free(packet->buffer);
-		datagramPacketDestroy(packet);
-		return JAUS_FALSE;
+		*list = entry;
 	}
+	return entry;
 }
 
-JausAddressList *nodeManagerLookupServiceAddressList(NodeManagerInterface nmi, JausAddress lookupAddress, unsigned short commandCode, int serviceCommandType)
+// Asks the Node Manager for the addresses matching lookupAddress (and commandCode, see directoryFind)
+// with GET_ADDRESS_LIST, one page per request. Stops after the first page holding maxCount addresses
+// if maxCount is not zero. Returns the number of addresses put in list, or -1 if the Node Manager
+// did not answer.
+static int addressListFetch(NodeManagerInterface nmi, JausAddress lookupAddress, int commandCode, int serviceCommandType, int maxCount, JausAddressList **list)
 {
-	JausAddressList *addressList = NULL;
-	JausAddressList *currentAddress = NULL;
-	DatagramPacket packet;
+	DatagramPacket request;
+	DatagramPacket reply;
+	JausAddressList *last = NULL;
+	unsigned char *data;
+	unsigned int page;
+	unsigned int pageCount;
+	unsigned int changeCount = 0;
+	unsigned int pageChangeCount;
+	unsigned int count;
+	unsigned int i;
+	int result = -1;
+	int bytesRecv = 0;
+	int attempt;
 
-	if(!nmi || !nmi->isOpen || !commandCode)
-	{
-		return NULL;
-	}
+	request = datagramPacketCreate();
+	request->bufferSizeBytes = ADDRESS_LIST_REQUEST_SIZE_BYTES;
+	request->buffer = (unsigned char *)malloc(request->bufferSizeBytes);
 
-	packet = datagramPacketCreate();
+	reply = datagramPacketCreate();
+	reply->bufferSizeBytes = PAGE_HEADER_SIZE_BYTES + 4 * ADDRESS_LIST_PAGE_SIZE;
+	reply->buffer = (unsigned char *)malloc(reply->bufferSizeBytes);
 
-	packet->bufferSizeBytes = INTERFACE_MESSAGE_SIZE_BYTES;
-	packet->buffer = (unsigned char *)malloc(packet->bufferSizeBytes);
-	memset(packet->buffer, 0, packet->bufferSizeBytes);
-	packet->buffer[0] = INTERFACE_MESSAGE_LOOKUP_SERVICE_ADDRESS_LIST;
-	packet->buffer[1] = lookupAddress->instance;
+	for(attempt = 0; attempt < DIRECTORY_FETCH_ATTEMPTS && result < 0; attempt++)
+	{
+		nodeManagerDestroyAddressList(*list);
+		*list = NULL;
+		last = NULL;
+		result = 0;
+		pageCount = 1;
+
+		for(page = 0; page < pageCount; page++)
+		{
+			memset(request->buffer, 0, request->bufferSizeBytes);
+			request->buffer[0] = INTERFACE_MESSAGE_GET_ADDRESS_LIST;
+			request->buffer[1] = (unsigned char)(page & 0xFF);
+			request->buffer[2] = (unsigned char)((page >> 8) & 0xFF);
+			request->buffer[3] = lookupAddress->instance;
+			request->buffer[4] = lookupAddress->component;
+			request->buffer[5] = lookupAddress->node;
+			request->buffer[6] = lookupAddress->subsystem;
+			if(commandCode < 0)
+			{
+				request->buffer[9] = ADDRESS_LIST_ANY_SERVICE_TYPE;
+			}
+			else
+			{
+				request->buffer[7] = (unsigned char)(commandCode & 0xFF);
+				request->buffer[8] = (unsigned char)((commandCode >> 8) & 0xFF);
+				request->buffer[9] = (unsigned char)(serviceCommandType & 0xFF);
+			}
+
+			bytesRecv = interfaceRequest(nmi, request, reply);
+			if(	bytesRecv < PAGE_HEADER_SIZE_BYTES ||
+				reply->buffer[0] != INTERFACE_MESSAGE_ADDRESS_LIST_RESPONSE ||
+				(unsigned int)(reply->buffer[2] + (reply->buffer[3] << 8)) != page)
+			{
+				result = -1;
+				break;
+			}
+
+			pageChangeCount =	reply->buffer[6] + (reply->buffer[7] << 8) +
+								(reply->buffer[8] << 16) + ((unsigned int)reply->buffer[9] << 24);
+			count = reply->buffer[10] + (reply->buffer[11] << 8);
+			if((unsigned int)bytesRecv < PAGE_HEADER_SIZE_BYTES + 4 * count)
+			{
+				result = -1;
+				break;
+			}
+
+			if(page == 0)
+			{
+				changeCount = pageChangeCount;
+				pageCount = reply->buffer[4] + (reply->buffer[5] << 8);
+			}
+			else if(pageChangeCount != changeCount)
+			{
+				// The tree changed between pages, start over
+				result = -1;
+				break;
+			}
+
+			data = reply->buffer + PAGE_HEADER_SIZE_BYTES;
+			for(i = 0; i < count; i++, data += 4)
+			{
+				last = addressListAdd(list, last);
+				if(last == NULL)
+				{
+					break;
+				}
+				last->address->instance = data[0];
+				last->address->component = data[1];
+				last->address->node = data[2];
+				last->address->subsystem = data[3];
+				result++;
+			}
+
+			if(maxCount && result >= maxCount)
+			{
+				break;
+			}
+		}
+
+		if(result < 0 && bytesRecv <= 0)
+		{
+			// No answer, do not keep the caller waiting on more attempts
+			break;
+		}
+	}
+
+	if(result < 0)
+	{
+		nodeManagerDestroyAddressList(*list);
+		*list = NULL;
+	}
+
+	free(request->buffer);
+	datagramPacketDestroy(request);
+	free(reply->buffer);
+	datagramPacketDestroy(reply);
+
+	return result;
+}
+
+// Asks the Node Manager for one address matching lookupAddress with LOOKUP_ADDRESS, or LOOKUP_SERVICE_ADDRESS
+// if commandCode is not negative, which every Node Manager answers. Returns 1 and fills in lookupAddress if
+// one was found, 0 if none was, or -1 if the Node Manager did not answer.
+static int addressLookup(NodeManagerInterface nmi, JausAddress lookupAddress, int commandCode, int serviceCommandType)
+{
+	DatagramPacket packet;
+	unsigned char responseType;
+	int result = -1;
+
+	packet = datagramPacketCreate();
+	packet->bufferSizeBytes = INTERFACE_MESSAGE_SIZE_BYTES;
+	packet->buffer = (unsigned char *)malloc(packet->bufferSizeBytes);
+	memset(packet->buffer, 0, packet->bufferSizeBytes);
+
+	if(commandCode < 0)
+	{
+		packet->buffer[0] = INTERFACE_MESSAGE_LOOKUP_ADDRESS;
+		responseType = INTERFACE_MESSAGE_LOOKUP_ADDRESS_RESPONSE;
+	}
+	else
+	{
+		packet->buffer[0] = INTERFACE_MESSAGE_LOOKUP_SERVICE_ADDRESS;
+		packet->buffer[5] = (unsigned char)(commandCode & 0xFF);
+		packet->buffer[6] = (unsigned char)((commandCode >> 8) & 0xFF);
+		packet->buffer[7] = (unsigned char)(serviceCommandType & 0xFF);
+		responseType = INTERFACE_MESSAGE_LOOKUP_SERVICE_ADDRESS_RESPONSE;
+	}
+	packet->buffer[1] = lookupAddress->instance;
 	packet->buffer[2] = lookupAddress->component;
 	packet->buffer[3] = lookupAddress->node;
 	packet->buffer[4] = lookupAddress->subsystem;
-	packet->buffer[5] = (unsigned char)(commandCode & 0xFF);
-	packet->buffer[6] = (unsigned char)((commandCode & 0xFF00) >> 8);
-	packet->buffer[7] = (unsigned char)(serviceCommandType & 0xFF);
 
-	packet->port = NODE_MANAGER_INTERFACE_PORT;
-	packet->address->value = nmi->ipAddress->value;
+	if(interfaceTransaction(nmi, packet) >= INTERFACE_MESSAGE_SIZE_BYTES && packet->buffer[0] == responseType)
+	{
+		result = 0;
+		if(packet->buffer[5])
+		{
+			lookupAddress->instance = packet->buffer[1];
+			lookupAddress->component = packet->buffer[2];
+			lookupAddress->node = packet->buffer[3];
+			lookupAddress->subsystem = packet->buffer[4];
+			result = 1;
+		}
+	}
+
+	free(packet->buffer);
+	datagramPacketDestroy(packet);
+
+	return result;
+}
+
+// Asks the Node Manager whether it knows address with VERIFY_ADDRESS. Returns JAUS_TRUE or JAUS_FALSE,
+// or -1 if the Node Manager did not answer.
+static int addressVerify(NodeManagerInterface nmi, JausAddress address)
+{
+	DatagramPacket packet;
+	int result = -1;
+
+	packet = datagramPacketCreate();
+	packet->bufferSizeBytes = INTERFACE_MESSAGE_SIZE_BYTES;
+	packet->buffer = (unsigned char *)malloc(packet->bufferSizeBytes);
+	memset(packet->buffer, 0, packet->bufferSizeBytes);
+	packet->buffer[0] = INTERFACE_MESSAGE_VERIFY_ADDRESS;
+	packet->buffer[1] = (unsigned char)address->instance;
+	packet->buffer[2] = (unsigned char)address->component;
+	packet->buffer[3] = (unsigned char)address->node;
+	packet->buffer[4] = (unsigned char)address->subsystem;
+
+	if(interfaceTransaction(nmi, packet) >= INTERFACE_MESSAGE_SIZE_BYTES && packet->buffer[0] == INTERFACE_MESSAGE_ADDRESS_VERIFIED)
+	{
+		result = packet->buffer[1]? JAUS_TRUE : JAUS_FALSE;
+	}
+
+	free(packet->buffer);
+	datagramPacketDestroy(packet);
+
+	return result;
+}
+
+// Node Managers from before the list requests drop them, and a lost reply looks the same. Only after
+// ADDRESS_LIST_MAX_FAILURES in a row are they left alone, and then only for ADDRESS_LIST_RETRY_SEC.
+static JausBoolean addressListIsUsable(NodeManagerInterface nmi)
+{
+	return (JausBoolean)(nmi->addressListFailureCount < ADDRESS_LIST_MAX_FAILURES || ojGetTimeSec() >= nmi->addressListRetryTime);
+}
+
+static void addressListAnswered(NodeManagerInterface nmi, JausBoolean answered)
+{
+	if(answered)
+	{
+		nmi->addressListFailureCount = 0;
+	}
+	else if(++nmi->addressListFailureCount >= ADDRESS_LIST_MAX_FAILURES)
+	{
+		nmi->addressListRetryTime = ojGetTimeSec() + ADDRESS_LIST_RETRY_SEC;
+	}
+}
+
+// Finds one address with GET_ADDRESS_LIST, or with the single address request when the Node Manager
+// does not answer that
+static JausBoolean addressFind(NodeManagerInterface nmi, JausAddress lookupAddress, int commandCode, int serviceCommandType)
+{
+	JausAddressList *addressList = NULL;
+	JausBoolean listTried = JAUS_FALSE;
+	int result = -1;
+
+	if(addressListIsUsable(nmi))
+	{
+		listTried = JAUS_TRUE;
+		result = addressListFetch(nmi, lookupAddress, commandCode, serviceCommandType, 1, &addressList);
+		if(result >= 0)
+		{
+			addressListAnswered(nmi, JAUS_TRUE);
+		}
+		if(result > 0)
+		{
+			jausAddressCopy(lookupAddress, addressList->address);
+			nodeManagerDestroyAddressList(addressList);
+			return JAUS_TRUE;
+		}
+	}
+
+	if(result < 0)
+	{
+		result = addressLookup(nmi, lookupAddress, commandCode, serviceCommandType);
+		if(result >= 0 && listTried)
+		{
+			addressListAnswered(nmi, JAUS_FALSE);
+		}
+	}
+	return result > 0? JAUS_TRUE : JAUS_FALSE;
+}
+
+// One heartbeat thread, one receive thread and one directory thread serve every open interface of the
+// process, so a slow directory fetch never holds up heartbeats or receives. A thread
+// working on an interface counts itself in serviceUsers, nodeManagerClose waits for it to leave.
+static void *serviceHeartbeatThread(void *threadArgument)
+{
+	NodeManagerInterface *interfaces = NULL;
+	int interfaceCount = 0;
+	struct timespec timeLimitSpec;
+	double timeLimitSec;
+	double now;
+	int i;
+
+	pthread_mutex_lock(&serviceMutex);
+	while(serviceRunning)
+	{
+		interfaces = serviceAcquireInterfaces(interfaces, &interfaceCount);
+		pthread_mutex_unlock(&serviceMutex);
+
+		timeLimitSec = ojGetTimeSec() + SERVICE_HEARTBEAT_PERIOD_SEC;
+		for(i = 0; i < interfaceCount; i++)
+		{
+			NodeManagerInterface nmi = interfaces[i];
+
+			now = ojGetTimeSec();
+			if(!nmi->nodeManagerTimedOut && now >= nmi->nextHeartbeatTime)
+			{
+				// Straight to the socket, a congested link must not hold up the other components
+				nodeManagerSendSingleMessage(nmi, nmi->heartbeatMessage);
+				nmi->heartbeatCount++;
+				if((now - NODE_MANAGER_TIMEOUT_SEC) > nmi->timestamp)
+				{
+					// TODO: Capture Error
+					//printf("libNodeManager: Node Manager Has Timed Out\n");
+					//nmi->cmpt->state = JAUS_FAILURE_STATE;
+					nmi->nodeManagerTimedOut = JAUS_TRUE;
+				}
+				nmi->nextHeartbeatTime = now + SERVICE_HEARTBEAT_PERIOD_SEC;
+			}
+
+			if(!nmi->nodeManagerTimedOut && nmi->nextHeartbeatTime < timeLimitSec)
+			{
+				timeLimitSec = nmi->nextHeartbeatTime;
+			}
+		}
+
+		pthread_mutex_lock(&serviceMutex);
+		serviceReleaseInterfaces(interfaces, interfaceCount);
+		if(serviceRunning)
+		{
+			timeLimitSpec.tv_sec = (long)timeLimitSec;
+			timeLimitSpec.tv_nsec = (long)(1e9 * (timeLimitSec - (double)timeLimitSpec.tv_sec));
+			pthread_cond_timedwait(&serviceWakeCondition, &serviceMutex, &timeLimitSpec);
+		}
+	}
+	pthread_mutex_unlock(&serviceMutex);
+
+	free(interfaces);
+	return NULL;
+}
+
+// Fetches the directories the Node Managers announced as changed, woken by the receive thread
+static void *serviceDirectoryThread(void *threadArgument)
+{
+	NodeManagerInterface *interfaces = NULL;
+	int interfaceCount = 0;
+	int directoryStale;
+	int i;
+
+	pthread_mutex_lock(&serviceMutex);
+	while(serviceRunning)
+	{
+		if(!serviceDirectoryStale)
+		{
+			pthread_cond_wait(&serviceDirectoryCondition, &serviceMutex);
+			continue;
+		}
+		serviceDirectoryStale = JAUS_FALSE;
+		interfaces = serviceAcquireInterfaces(interfaces, &interfaceCount);
+		pthread_mutex_unlock(&serviceMutex);
+
+		for(i = 0; i < interfaceCount; i++)
+		{
+			pthread_rwlock_rdlock(&interfaces[i]->directoryLock);
+			directoryStale = interfaces[i]->directoryStale;
+			pthread_rwlock_unlock(&interfaces[i]->directoryLock);
+			if(directoryStale)
+			{
+				directoryRefresh(interfaces[i]);
+			}
+		}
+
+		pthread_mutex_lock(&serviceMutex);
+		serviceReleaseInterfaces(interfaces, interfaceCount);
+	}
+	pthread_mutex_unlock(&serviceMutex);
+
+	free(interfaces);
+	return NULL;
+}
+
+static void *serviceReceiveThread(void *threadArgument)
+{
+	NodeManagerInterface *interfaces = NULL;
+	int interfaceCount = 0;
+	DatagramPacket packet;
+	struct timeval timeout;
+	fd_set readSet;
+	int maxDescriptor;
+	int i;
+
+	packet = datagramPacketCreate();
+
+	// Large enough for a large frame, whether or not the Node Manager agrees to send them
+	packet->bufferSizeBytes = JAUS_LARGE_FRAME_HEADER_SIZE_BYTES + JAUS_HEADER_SIZE_BYTES + JAUS_LARGE_FRAME_MAX_DATA_SIZE_BYTES;
+	packet->buffer = (unsigned char*)malloc(packet->bufferSizeBytes);
+	memset(packet->buffer, 0, packet->bufferSizeBytes);
+
+	pthread_mutex_lock(&serviceMutex);
+	while(serviceRunning)
+	{
+		interfaces = serviceAcquireInterfaces(interfaces, &interfaceCount);
+		pthread_mutex_unlock(&serviceMutex);
+
+		FD_ZERO(&readSet);
+		maxDescriptor = -1;
+		for(i = 0; i < interfaceCount; i++)
+		{
+			lmHandlerCheckTimeouts(interfaces[i]);
+
+			FD_SET(interfaces[i]->messageSocket->descriptor, &readSet);
+			if(interfaces[i]->messageSocket->descriptor > maxDescriptor)
+			{
+				maxDescriptor = interfaces[i]->messageSocket->descriptor;
+			}
+		}
+
+		// Interfaces opened meanwhile are picked up on the next pass
+		timeout.tv_sec = 0;
+		timeout.tv_usec = (long)(1.0e6 * MESSAGE_SOCKET_TIMEOUT_SEC);
+		if(select(maxDescriptor + 1, &readSet, NULL, NULL, &timeout) > 0)
+		{
+			for(i = 0; i < interfaceCount; i++)
+			{
+				if(FD_ISSET(interfaces[i]->messageSocket->descriptor, &readSet))
+				{
+					serviceReceive(interfaces[i], packet);
+				}
+			}
+		}
+
+		pthread_mutex_lock(&serviceMutex);
+		serviceReleaseInterfaces(interfaces, interfaceCount);
+	}
+	pthread_mutex_unlock(&serviceMutex);
+
+	free(interfaces);
+	free(packet->buffer);
+	datagramPacketDestroy(packet);
+	return NULL;
+}
+
+// Takes one datagram off the message socket of nmi, which select found readable
+static void serviceReceive(NodeManagerInterface nmi, DatagramPacket packet)
+{
+	int index;
+	int bytesRecv;
+	JausBoolean decoded;
+	JausMessage message;
+
+	bytesRecv = datagramSocketReceive(nmi->messageSocket, packet);
+	if(bytesRecv <= 0)
+	{
+		return;
+	}
+
+	message = messagePoolGet(nmi->messagePool);
+	if(message == NULL)
+	{
+		nmi->receiveDropCount++;
+		return;
+	}
+
+	if(jausMessageIsLargeFrame(packet->buffer, bytesRecv))
+	{
+		decoded = messagePoolMessageFromLargeFrame(message, packet->buffer, bytesRecv);
+	}
+	else
+	{
+		index = 0;
+		if(!strncmp((char *)packet->buffer, JAUS_OPC_UDP_HEADER, JAUS_OPC_UDP_HEADER_SIZE_BYTES)) // equals 1 if same
+		{
+			index += JAUS_OPC_UDP_HEADER_SIZE_BYTES;
+		}
+		decoded = messagePoolMessageFromBuffer(message, packet->buffer + index, packet->bufferSizeBytes - index);
+	}
+
+	if(decoded)
+	{
+		if(message->dataFlag)
+		{
+			lmHandlerReceiveLargeMessage(nmi, message);
+		}
+		else if(message->commandCode == JAUS_REPORT_SYSTEM_TREE_CHANGE && message->source->component == JAUS_NODE_MANAGER_COMPONENT)
+		{
+			// Consumed here, components never see these, so there is nothing to wake a receiver for
+			directoryProcessNotice(nmi, message);
+			messagePoolRelease(nmi->messagePool, message);
+			nmi->receiveCount++;
+			return;
+		}
+		else if(message->commandCode == JAUS_LARGE_MESSAGE_NAK)
+		{
+			// Answered from the retransmit buffer, components never see these either
+			lmHandlerReceiveNak(nmi, message);
+			messagePoolRelease(nmi->messagePool, message);
+			nmi->receiveCount++;
+			return;
+		}
+		else
+		{
+			if(message->properties.scFlag)
+			{
+				if(	(message->commandCode >= JAUS_CREATE_SERVICE_CONNECTION &&
+					message->commandCode <= JAUS_TERMINATE_SERVICE_CONNECTION) ||
+					message->commandCode == JAUS_CREATE_EVENT ||
+					message->commandCode == JAUS_CONFIRM_EVENT_REQUEST ||
+					message->commandCode == JAUS_CANCEL_EVENT)
+				{
+					// This is to take Service Connection Control messages and send them on through
+					// to the regular receiveQueue. JAUS 3.2 RA says to set the properties.scFlag bit if it is
+					// a Service Connection Control message, but logically they do not need to go
+					// to the scManager and instead to the component
+					if(!ringQueuePush(nmi->receiveQueue, (void *)message))
+					{
+						nmi->receiveDropCount++;
+					}
+				}
+				else
+				{
+					scManagerReceiveMessage(nmi, message);
+				}
+			}
+			else if(!ringQueuePush(nmi->receiveQueue, (void *)message))
+			{
+				nmi->receiveDropCount++;
+			}
+		}
+		pthread_mutex_lock(&nmi->recvMutex);
+		pthread_cond_signal(&nmi->recvCondition);
+		if(nmi->receiveCallback)
+		{
+			nmi->receiveCallback(nmi->receiveCallbackData);
+		}
+		pthread_mutex_unlock(&nmi->recvMutex);
+		nmi->receiveCount++;
+	}
+	else
+	{
+		nmi->receiveDropCount++;
+		messagePoolRelease(nmi->messagePool, message);
+	}
+}
+
+// Snapshot of the open interfaces, each marked as in use. Called with serviceMutex held.
+static NodeManagerInterface *serviceAcquireInterfaces(NodeManagerInterface *interfaces, int *interfaceCount)
+{
+	NodeManagerInterface *newInterfaces;
+	int i;
+
+	newInterfaces = (NodeManagerInterface *)realloc(interfaces, (serviceInterfaceCount + 1) * sizeof(NodeManagerInterface));
+	if(newInterfaces == NULL)
+	{
+		// Nothing is served this pass, the next one tries again
+		*interfaceCount = 0;
+		return interfaces;
+	}
+	interfaces = newInterfaces;
+	for(i = 0; i < serviceInterfaceCount; i++)
+	{
+		interfaces[i] = serviceInterfaces[i];
+		interfaces[i]->serviceUsers++;
+	}
+	*interfaceCount = serviceInterfaceCount;
+	return interfaces;
+}
+
+// Called with serviceMutex held
+static void serviceReleaseInterfaces(NodeManagerInterface *interfaces, int interfaceCount)
+{
+	int i;
+
+	for(i = 0; i < interfaceCount; i++)
+	{
+		interfaces[i]->serviceUsers--;
+	}
+	if(interfaceCount)
+	{
+		pthread_cond_broadcast(&serviceIdleCondition);
+	}
+}
+
+// Hands nmi to the shared threads, starting them for the first interface of the process
+static int serviceAddInterface(NodeManagerInterface nmi)
+{
+	NodeManagerInterface *newInterfaces;
+	int result = 0;
+
+	pthread_mutex_lock(&serviceStartMutex);
+	pthread_mutex_lock(&serviceMutex);
+	newInterfaces = (NodeManagerInterface *)realloc(serviceInterfaces, (serviceInterfaceCount + 1) * sizeof(NodeManagerInterface));
+	if(newInterfaces == NULL)
+	{
+		pthread_mutex_unlock(&serviceMutex);
+		pthread_mutex_unlock(&serviceStartMutex);
+		return -1;
+	}
+	serviceInterfaces = newInterfaces;
+	serviceInterfaces[serviceInterfaceCount++] = nmi;
+
+	if(!serviceRunning)
+	{
+		serviceRunning = JAUS_TRUE;
+		if(pthread_create(&serviceHeartbeatThreadId, NULL, serviceHeartbeatThread, NULL))
+		{
+			serviceRunning = JAUS_FALSE;
+			result = -1;
+		}
+		else if(pthread_create(&serviceReceiveThreadId, NULL, serviceReceiveThread, NULL))
+		{
+			serviceRunning = JAUS_FALSE;
+			pthread_cond_broadcast(&serviceWakeCondition);
+			pthread_mutex_unlock(&serviceMutex);
+			pthread_join(serviceHeartbeatThreadId, NULL);
+			pthread_mutex_lock(&serviceMutex);
+			result = -1;
+		}
+		else if(pthread_create(&serviceDirectoryThreadId, NULL, serviceDirectoryThread, NULL))
+		{
+			serviceRunning = JAUS_FALSE;
+			pthread_cond_broadcast(&serviceWakeCondition);
+			pthread_mutex_unlock(&serviceMutex);
+			pthread_join(serviceHeartbeatThreadId, NULL);
+			pthread_join(serviceReceiveThreadId, NULL);
+			pthread_mutex_lock(&serviceMutex);
+			result = -1;
+		}
+
+		if(result)
+		{
+			serviceInterfaceCount--;
+		}
+	}
+	else
+	{
+		// Its first heartbeat goes out now
+		pthread_cond_broadcast(&serviceWakeCondition);
+	}
+	pthread_mutex_unlock(&serviceMutex);
+	pthread_mutex_unlock(&serviceStartMutex);
+
+	return result;
+}
+
+// Takes nmi back from the shared threads, which stop with the last interface of the process
+static void serviceRemoveInterface(NodeManagerInterface nmi)
+{
+	int i;
+
+	pthread_mutex_lock(&serviceStartMutex);
+	pthread_mutex_lock(&serviceMutex);
+	for(i = 0; i < serviceInterfaceCount; i++)
+	{
+		if(serviceInterfaces[i] == nmi)
+		{
+			serviceInterfaces[i] = serviceInterfaces[--serviceInterfaceCount];
+			break;
+		}
+	}
+
+	while(nmi->serviceUsers > 0)
+	{
+		pthread_cond_wait(&serviceIdleCondition, &serviceMutex);
+	}
+
+	if(serviceInterfaceCount == 0 && serviceRunning)
+	{
+		serviceRunning = JAUS_FALSE;
+		pthread_cond_broadcast(&serviceWakeCondition);
+		pthread_cond_broadcast(&serviceDirectoryCondition);
+		pthread_mutex_unlock(&serviceMutex);
+
+		pthread_join(serviceHeartbeatThreadId, NULL);
+		pthread_join(serviceReceiveThreadId, NULL);
+		pthread_join(serviceDirectoryThreadId, NULL);
+
+		pthread_mutex_lock(&serviceMutex);
+		free(serviceInterfaces);
+		serviceInterfaces = NULL;
+	}
+	pthread_mutex_unlock(&serviceMutex);
+	pthread_mutex_unlock(&serviceStartMutex);
+}
+
+JausAddressList *nodeManagerGetComponentAddressList(NodeManagerInterface nmi, unsigned char componentId)
+{
+	JausAddressList *addressList;
+	JausAddress lookupAddress;
+
+	if(!nmi || !nmi->isOpen || !componentId)
+	{
+		return NULL;
+	}
+
+	lookupAddress = jausAddressCreate();
+	lookupAddress->subsystem = JAUS_ADDRESS_WILDCARD_OCTET;
+	lookupAddress->node = JAUS_ADDRESS_WILDCARD_OCTET;
+	lookupAddress->component = componentId;
+	lookupAddress->instance = JAUS_ADDRESS_WILDCARD_OCTET;
+
+	addressList = nodeManagerLookupAddressList(nmi, lookupAddress);
+
+	jausAddressDestroy(lookupAddress);
+	return addressList;
+}
+
+JausAddressList *nodeManagerLookupAddressList(NodeManagerInterface nmi, JausAddress lookupAddress)
+{
+	JausAddressList *addressList = NULL;
+
+	if(!nmi || !nmi->isOpen)
+	{
+		return NULL;
+	}
+
+	if(directoryLookupAddressList(nmi, lookupAddress, -1, 0, &addressList) == DIRECTORY_UNAVAILABLE)
+	{
+		addressListFetch(nmi, lookupAddress, -1, 0, 0, &addressList);
+	}
+	return addressList;
+}
+
+JausBoolean nodeManagerLookupAddress(NodeManagerInterface nmi, JausAddress lookupAddress)
+{
+	int result;
+
+	if(!nmi || !nmi->isOpen)
+	{
+		return JAUS_FALSE;
+	}
+
+	result = directoryLookupAddress(nmi, lookupAddress, -1, 0);
+	if(result != DIRECTORY_UNAVAILABLE)
+	{
+		return (JausBoolean)result;
+	}
+	return addressFind(nmi, lookupAddress, -1, 0);
+}
+
+JausAddressList *nodeManagerLookupServiceAddressList(NodeManagerInterface nmi, JausAddress lookupAddress, unsigned short commandCode, int serviceCommandType)
+{
+	JausAddressList *addressList = NULL;
+
+	if(!nmi || !nmi->isOpen || !commandCode)
+	{
+		return NULL;
+	}
+
+	if(directoryLookupAddressList(nmi, lookupAddress, commandCode, serviceCommandType, &addressList) == DIRECTORY_UNAVAILABLE)
+	{
+		addressListFetch(nmi, lookupAddress, commandCode, serviceCommandType, 0, &addressList);
+	}
+	return addressList;
+}
+
+JausBoolean nodeManagerLookupServiceAddress(NodeManagerInterface nmi, JausAddress lookupAddress, unsigned short commandCode, int serviceCommandType)
+{
+	int result;
+
+	if(!nmi || !nmi->isOpen)
+	{
+		return JAUS_FALSE;
+	}
+
+	result = directoryLookupAddress(nmi, lookupAddress, commandCode, serviceCommandType);
+	if(result != DIRECTORY_UNAVAILABLE)
+	{
+		return (JausBoolean)result;
+	}
+	return addressFind(nmi, lookupAddress, commandCode, serviceCommandType);
+}
+
+void nodeManagerDestroyAddressList(JausAddressList *addressList)
+{
+	JausAddressList *deadAddressList;
+
+	while(addressList)
+	{
+		deadAddressList = addressList;
+		addressList = addressList->nextAddress;
+
+		jausAddressDestroy(deadAddressList->address);
+		free(deadAddressList);
+	}
+}
 
-	datagramSocketSend(nmi->interfaceSocket, packet);
-	datagramSocketReceive(nmi->interfaceSocket, packet);
+int nodeManagerVerifyAddress(NodeManagerInterface nmi, JausAddress address)
+{
+	JausBoolean verified = JAUS_FALSE;
+
+	if(nodeManagerVerifyAddressList(nmi, &address, 1, &verified) < 0)
+	{
+		return JAUS_FALSE;
+	}
+	return verified;
+}
+
+// Fills verified[i] with whether the Node Manager knows addresses[i], asking for up to
+// VERIFY_LIST_MAX_ADDRESSES per request, or one at a time when the Node Manager does not
+// answer those. Returns how many are known, or -1 on error.
+int nodeManagerVerifyAddressList(NodeManagerInterface nmi, JausAddress *addresses, int addressCount, JausBoolean *verified)
+{
+	DatagramPacket request;
+	DatagramPacket reply;
+	unsigned char *data;
+	int result;
+	int count;
+	int bytesRecv;
+	int known;
+	JausBoolean listTried;
+	int i;
+	int j;
+
+	if(!nmi || !nmi->isOpen || addressCount < 0)
+	{
+		return -1;
+	}
+
+	// The Node Manager drops a request this short rather than answering it
+	if(addressCount == 0)
+	{
+		return 0;
+	}
+
+	result = directoryVerifyAddressList(nmi, addresses, addressCount, verified);
+	if(result != DIRECTORY_UNAVAILABLE)
+	{
+		return result;
+	}
+
+	request = datagramPacketCreate();
+	request->buffer = (unsigned char *)malloc(VERIFY_LIST_HEADER_SIZE_BYTES + 4 * VERIFY_LIST_MAX_ADDRESSES);
 
-	while(packet->buffer[0] == INTERFACE_MESSAGE_COMPONENT_ADDRESS_LIST_RESPONSE && packet->buffer[5])
+	reply = datagramPacketCreate();
+	reply->bufferSizeBytes = VERIFY_LIST_HEADER_SIZE_BYTES + VERIFY_LIST_MAX_ADDRESSES;
+	reply->buffer = (unsigned char *)malloc(reply->bufferSizeBytes);
+
+	result = 0;
+	for(i = 0; i < addressCount && result >= 0; i += count)
 	{
-		if(currentAddress)
+		count = addressCount - i;
+		if(count > VERIFY_LIST_MAX_ADDRESSES)
+		{
+			count = VERIFY_LIST_MAX_ADDRESSES;
+		}
+
+		request->buffer[0] = INTERFACE_MESSAGE_VERIFY_ADDRESS_LIST;
+		request->buffer[1] = 0;
+		request->buffer[2] = (unsigned char)(count & 0xFF);
+		request->buffer[3] = (unsigned char)((count >> 8) & 0xFF);
+		data = request->buffer + VERIFY_LIST_HEADER_SIZE_BYTES;
+		for(j = 0; j < count; j++, data += 4)
+		{
+			data[0] = addresses[i + j]->instance;
+			data[1] = addresses[i + j]->component;
+			data[2] = addresses[i + j]->node;
+			data[3] = addresses[i + j]->subsystem;
+		}
+		request->bufferSizeBytes = VERIFY_LIST_HEADER_SIZE_BYTES + 4 * count;
+
+		listTried = addressListIsUsable(nmi);
+		bytesRecv = listTried? interfaceRequest(nmi, request, reply) : 0;
+		if(	bytesRecv == VERIFY_LIST_HEADER_SIZE_BYTES + count &&
+			reply->buffer[0] == INTERFACE_MESSAGE_ADDRESS_LIST_VERIFIED &&
+			reply->buffer[2] + (reply->buffer[3] << 8) == count)
 		{
-			currentAddress->nextAddress = (JausAddressList *)malloc(sizeof(JausAddressList));
-			currentAddress = currentAddress->nextAddress;
-			currentAddress->address = jausAddressCreate();
-			currentAddress->address->instance = packet->buffer[1];
-			currentAddress->address->component = packet->buffer[2];
-			currentAddress->address->node = packet->buffer[3];
-			currentAddress->address->subsystem = packet->buffer[4];
-			currentAddress->nextAddress = NULL;
+			addressListAnswered(nmi, JAUS_TRUE);
+			for(j = 0; j < count; j++)
+			{
+				verified[i + j] = reply->buffer[VERIFY_LIST_HEADER_SIZE_BYTES + j]? JAUS_TRUE : JAUS_FALSE;
+			}
 		}
 		else
 		{
-			addressList = (JausAddressList *)malloc(sizeof(JausAddressList));
-			currentAddress = addressList;
-			currentAddress->address = jausAddressCreate();
-			currentAddress->address->instance = packet->buffer[1];
-			currentAddress->address->component = packet->buffer[2];
-			currentAddress->address->node = packet->buffer[3];
-			currentAddress->address->subsystem = packet->buffer[4];
-			currentAddress->nextAddress = NULL;
-		}
-
-		packet->buffer[0] = INTERFACE_MESSAGE_GET_COMPONENT_ADDRESS_LIST;
-		packet->buffer[1] = lookupAddress->instance;
-		packet->buffer[2] = lookupAddress->component;
-		packet->buffer[3] = lookupAddress->node;
-		packet->buffer[4] = lookupAddress->subsystem;
-		packet->buffer[5] = 0;
-		packet->buffer[6] = 0;
-		packet->buffer[7] = (unsigned char)(serviceCommandType & 0xFF);
+			for(j = 0; j < count; j++)
+			{
+				verified[i + j] = JAUS_FALSE;
+				known = addressVerify(nmi, addresses[i + j]);
+				if(known < 0)
+				{
+					break;
+				}
+				verified[i + j] = (JausBoolean)known;
+			}
+			if(j > 0 && listTried)
+			{
+				addressListAnswered(nmi, JAUS_FALSE);
+			}
+			if(j < count)
+			{
+				result = -1;
+				break;
+			}
+		}
 
-		datagramSocketSend(nmi->interfaceSocket, packet);
-		datagramSocketReceive(nmi->interfaceSocket, packet);
+		for(j = 0; j < count; j++)
+		{
+			if(verified[i + j])
+			{
+				result++;
+			}
+		}
 	}
 
-	free(packet->buffer);
-	datagramPacketDestroy(packet);
+	free(request->buffer);
+	datagramPacketDestroy(request);
+	free(reply->buffer);
+	datagramPacketDestroy(reply);
 
-	return addressList;
+	return result;
 }
 
-JausBoolean nodeManagerLookupServiceAddress(NodeManagerInterface nmi, JausAddress lookupAddress, unsigned short commandCode, int serviceCommandType)
+int nodeManagerReceive(NodeManagerInterface nmi, JausMessage *message)
 {
-	DatagramPacket packet;
+	if(nmi->isOpen && (*message = (JausMessage)ringQueuePop(nmi->receiveQueue)) != NULL)
+	{
+		return 1;
+	}
+	else
+	{
+		return 0;
+	}
+}
 
-	if(!nmi || !nmi->isOpen)
+int nodeManagerTimedReceive(NodeManagerInterface nmi, JausMessage *message, double timeLimitSec)
+{
+	int messageCount = 0;
+	int result;
+
+	*message = NULL;
+	result = nodeManagerTimedReceiveBatch(nmi, message, 1, &messageCount, timeLimitSec);
+
+	// Woken without a queued message, this call has always reported that as a timeout
+	if(result == NMI_MESSAGE_RECEIVED && messageCount == 0)
 	{
-		return JAUS_FALSE;
+		return NMI_RECEIVE_TIMED_OUT;
 	}
+	return result;
+}
 
-	packet = datagramPacketCreate();
+// Takes up to maxCount queued messages without waiting, returns how many were taken
+int nodeManagerReceiveBatch(NodeManagerInterface nmi, JausMessage *messages, int maxCount)
+{
+	if(nmi->isOpen)
+	{
+		return ringQueuePopMany(nmi->receiveQueue, (void **)messages, maxCount);
+	}
+	else
+	{
+		return 0;
+	}
+}
 
-	packet->bufferSizeBytes = INTERFACE_MESSAGE_SIZE_BYTES;
-	packet->buffer = (unsigned char *)malloc(packet->bufferSizeBytes);
-	memset(packet->buffer, 0, packet->bufferSizeBytes);
-	packet->buffer[0] = INTERFACE_MESSAGE_LOOKUP_SERVICE_ADDRESS;
-	packet->buffer[1] = lookupAddress->instance;
-	packet->buffer[2] = lookupAddress->component;
-	packet->buffer[3] = lookupAddress->node;
-	packet->buffer[4] = lookupAddress->subsystem;
-	packet->buffer[5] = (unsigned char)(commandCode & 0xFF);
-	packet->buffer[6] = (unsigned char)((commandCode & 0xFF00) >> 8);
-	packet->buffer[7] = (unsigned char)(serviceCommandType & 0xFF);
+// Takes up to maxCount queued messages in one operation, waiting until timeLimitSec if none are queued.
+// Returns NMI_MESSAGE_RECEIVED with *messageCount possibly 0 when woken by traffic which was not queued,
+// large message packets and service connection messages, or straight away while service connection
+// messages are ready, so the caller can take them with scManagerReceiveReadyMessages.
+int nodeManagerTimedReceiveBatch(NodeManagerInterface nmi, JausMessage *messages, int maxCount, int *messageCount, double timeLimitSec)
+{
+	int condition = 0;
+	struct timespec timeLimitSpec;
 
-	packet->port = NODE_MANAGER_INTERFACE_PORT;
-	packet->address->value = nmi->ipAddress->value;
+	*messageCount = 0;
 
-	datagramSocketSend(nmi->interfaceSocket, packet);
-	datagramSocketReceive(nmi->interfaceSocket, packet);
+	if(!nmi->isOpen)
+	{
+		return NMI_CLOSED_ERROR;
+	}
 
-	if(	packet->buffer[0] == INTERFACE_MESSAGE_LOOKUP_SERVICE_ADDRESS_RESPONSE && packet->buffer[5])
+	if(ojGetTimeSec() > timeLimitSec)
 	{
-		lookupAddress->instance = packet->buffer[1];
-		lookupAddress->component = packet->buffer[2];
-		lookupAddress->node = packet->buffer[3];
-		lookupAddress->subsystem = packet->buffer[4];
+		return NMI_RECEIVE_TIMED_OUT;
+	}
 
-		free(packet->buffer);
-		datagramPacketDestroy(packet);
-		return JAUS_TRUE;
+	*messageCount = ringQueuePopMany(nmi->receiveQueue, (void **)messages, maxCount);
+	if(*messageCount)
+	{
+		return NMI_MESSAGE_RECEIVED;
 	}
-	else
+
+	timeLimitSpec.tv_sec = (long)timeLimitSec;
+	timeLimitSpec.tv_nsec = (long)(1e9 * (timeLimitSec - (double)timeLimitSpec.tv_sec));
+
+	// Both are checked under recvMutex, which the receive thread takes to signal after queueing either
+	pthread_mutex_lock(&nmi->recvMutex);
+	if(ringQueueSize(nmi->receiveQueue) == 0 && !scManagerHasReadyMessages(nmi))
 	{
-		free(packet->buffer);
-		datagramPacketDestroy(packet);
-		return JAUS_FALSE;
+		condition = pthread_cond_timedwait(&nmi->recvCondition, &nmi->recvMutex, &timeLimitSpec);
+	}
+	pthread_mutex_unlock(&nmi->recvMutex);
+
+	switch(condition)
+	{
+		case 0: // Conditional Signaled
+			*messageCount = ringQueuePopMany(nmi->receiveQueue, (void **)messages, maxCount);
+			return NMI_MESSAGE_RECEIVED;
+
+		case ETIMEDOUT: // our time is up
+			return NMI_RECEIVE_TIMED_OUT;
+
+		default: // Some other error occured
+			return NMI_CONDITIONAL_WAIT_ERROR;
 	}
 }
 
-void nodeManagerDestroyAddressList(JausAddressList *addressList)
+void nodeManagerReleaseMessage(NodeManagerInterface nmi, JausMessage message)
+{
+	if(message)
+	{
+		messagePoolRelease(nmi->messagePool, message);
+	}
+}
+
+void nodeManagerReleaseQueuedMessage(void *message, void *nmi)
+{
+	nodeManagerReleaseMessage((NodeManagerInterface)nmi, (JausMessage)message);
+}
+
+// Lets a component which does not block in nodeManagerTimedReceive learn that messages are waiting.
+// The callback runs on the shared receive thread with recvMutex held and must not block. Both are set
+// under recvMutex, so once this returns the previous callback has returned and is not called again.
+void nodeManagerSetReceiveCallback(NodeManagerInterface nmi, void (*receiveCallback)(void *), void *callbackData)
 {
-	JausAddressList *deadAddressList;
+	pthread_mutex_lock(&nmi->recvMutex);
+	nmi->receiveCallback = receiveCallback;
+	nmi->receiveCallbackData = callbackData;
+	pthread_mutex_unlock(&nmi->recvMutex);
+}
 
-	while(addressList)
+int nodeManagerSend(NodeManagerInterface nmi, JausMessage message)
+{
+	int result = -1;
+
+	if(nmi->isOpen)
 	{
-		deadAddressList = addressList;
-		addressList = addressList->nextAddress;
+		if(nmi->flowControlMode != NMI_FLOW_CONTROL_OFF && !flowControlAcquireCredits(nmi, message))
+		{
+			nmi->sendCongestedCount++;
+			return NMI_SEND_CONGESTED_ERROR;
+		}
 
-		jausAddressDestroy(deadAddressList->address);
-		free(deadAddressList);
+		result = lmHandlerSendLargeMessage(nmi, message);
 	}
+
+	return result;
 }
 
-int nodeManagerVerifyAddress(NodeManagerInterface nmi, JausAddress address)
+void nodeManagerSetFlowControl(NodeManagerInterface nmi, int mode, double timeoutSec)
+{
+	pthread_mutex_lock(&nmi->flowControlMutex);
+	nmi->flowControlMode = mode;
+	nmi->flowControlTimeoutSec = timeoutSec;
+	memset(nmi->flowControlCredits, 0, sizeof(nmi->flowControlCredits));
+	pthread_mutex_unlock(&nmi->flowControlMutex);
+}
+
+JausBoolean nodeManagerQueryFlowControl(NodeManagerInterface nmi, JausAddress destination, NodeManagerFlowControl *flowControl)
 {
 	DatagramPacket packet;
-	int response = 0;
+	int bytesRecv;
+
+	if(!nmi || !nmi->isOpen || !destination || !flowControl)
+	{
+		return JAUS_FALSE;
+	}
 
 	packet = datagramPacketCreate();
 
 	packet->bufferSizeBytes = INTERFACE_MESSAGE_SIZE_BYTES;
 	packet->buffer = (unsigned char *)malloc(packet->bufferSizeBytes);
 	memset(packet->buffer, 0, packet->bufferSizeBytes);
-	packet->buffer[0] = INTERFACE_MESSAGE_VERIFY_ADDRESS;
-	packet->buffer[1] = (unsigned char)address->instance;
-	packet->buffer[2] = (unsigned char)address->component;
-	packet->buffer[3] = (unsigned char)address->node;
-	packet->buffer[4] = (unsigned char)address->subsystem;
-
-	packet->port = NODE_MANAGER_INTERFACE_PORT;
-	packet->address->value = nmi->ipAddress->value;
+	packet->buffer[0] = INTERFACE_MESSAGE_QUERY_FLOW_CONTROL;
+	packet->buffer[1] = (unsigned char)destination->instance;
+	packet->buffer[2] = (unsigned char)destination->component;
+	packet->buffer[3] = (unsigned char)destination->node;
+	packet->buffer[4] = (unsigned char)destination->subsystem;
 
-	datagramSocketSend(nmi->interfaceSocket, packet);
-	datagramSocketReceive(nmi->interfaceSocket, packet);
+	bytesRecv = interfaceTransaction(nmi, packet);
 
-	if(packet->buffer[0] == INTERFACE_MESSAGE_ADDRESS_VERIFIED)
+	if(bytesRecv == INTERFACE_MESSAGE_SIZE_BYTES && packet->buffer[0] == INTERFACE_MESSAGE_REPORT_FLOW_CONTROL)
 	{
-		response = packet->buffer[1];
+		flowControl->congested = packet->buffer[1]? JAUS_TRUE : JAUS_FALSE;
+		flowControl->credits = packet->buffer[2] + (packet->buffer[3] << 8);
+		flowControl->linkDropCount = packet->buffer[4] + (packet->buffer[5] << 8) + (packet->buffer[6] << 16) + ((unsigned int)packet->buffer[7] << 24);
 
 		free(packet->buffer);
 		datagramPacketDestroy(packet);
-		return response;
+		return JAUS_TRUE;
 	}
 	else
 	{
+		// Node Manager does not support flow control or did not answer
 		free(packet->buffer);
 		datagramPacketDestroy(packet);
-		return 0;
+		return JAUS_FALSE;
 	}
-
 }
 
-int nodeManagerReceive(NodeManagerInterface nmi, JausMessage *message)
+JausBoolean nodeManagerCanSend(NodeManagerInterface nmi, JausAddress destination)
 {
-	if(nmi->isOpen && nmi->receiveQueue->size)
-	{
-		*message = (JausMessage)queuePop(nmi->receiveQueue);
-		return 1;
-	}
-	else
+	NodeManagerFlowControl flowControl;
+
+	if(!nodeManagerQueryFlowControl(nmi, destination, &flowControl))
 	{
-		return 0;
+		// Without an answer from the NM we cannot claim the link is congested
+		return nmi && nmi->isOpen? JAUS_TRUE : JAUS_FALSE;
 	}
+
+	return (!flowControl.congested && flowControl.credits > 0)? JAUS_TRUE : JAUS_FALSE;
 }
 
-int nodeManagerTimedReceive(NodeManagerInterface nmi, JausMessage *message, double timeLimitSec)
+// Returns 1 if there is room on the destination link for the message, 0 if the link stayed congested
+static int flowControlAcquireCredits(NodeManagerInterface nmi, JausMessage message)
 {
-	pthread_mutex_t recvMutex = PTHREAD_MUTEX_INITIALIZER;
-	int condition = -1;
-	struct timespec timeLimitSpec;
+	NodeManagerFlowControl flowControl;
+	NodeManagerFlowControlCredit *credit;
+	JausBoolean isAnswered;
+	int hash;
+	int packetCount;
+	int reportedCredits;
+	double stopTime;
+	double now;
+
+	// Large messages are sent as several packets, each one uses a slot in the NM queue, unless they fit a granted large frame
+	packetCount = 1;
+	if(message->dataSize > JAUS_MAX_DATA_SIZE_BYTES && message->dataSize > nmi->largeFrameSizeBytes)
+	{
+		packetCount = (message->dataSize + JAUS_MAX_DATA_SIZE_BYTES - 1) / JAUS_MAX_DATA_SIZE_BYTES;
+	}
 
-	if(nmi->isOpen)
+	hash = jausAddressHash(message->destination);
+	credit = &nmi->flowControlCredits[(unsigned int)hash % NMI_FLOW_CONTROL_CREDIT_CACHE_SIZE];
+	stopTime = ojGetTimeSec() + nmi->flowControlTimeoutSec;
+
+	pthread_mutex_lock(&nmi->flowControlMutex);
+	while(1)
 	{
-		if(ojGetTimeSec() > timeLimitSec)
+		if(credit->addressHash != hash || credit->expireTimeSec < ojGetTimeSec() || credit->credits < packetCount)
 		{
-			return NMI_RECEIVE_TIMED_OUT;
+			// The query waits on the Node Manager, other senders keep using the cache meanwhile
+			pthread_mutex_unlock(&nmi->flowControlMutex);
+			isAnswered = nodeManagerQueryFlowControl(nmi, message->destination, &flowControl);
+			pthread_mutex_lock(&nmi->flowControlMutex);
+
+			if(isAnswered)
+			{
+				now = ojGetTimeSec();
+				reportedCredits = flowControl.congested? 0 : flowControl.credits;
+				if(credit->addressHash != hash)
+				{
+					credit->addressHash = hash;
+					credit->reportedCredits = -1;
+					credit->maxCredits = 0;
+					credit->reportTimeSec = 0;
+				}
+				if(reportedCredits > credit->maxCredits)
+				{
+					credit->maxCredits = reportedCredits;
+				}
+				// Credits which stay at their most while the link keeps draining mean there is nothing queued
+				if(now - credit->reportTimeSec >= FLOW_CONTROL_POLL_MSEC / 1000.0)
+				{
+					credit->isIdle = (reportedCredits == credit->maxCredits && reportedCredits == credit->reportedCredits)? JAUS_TRUE : JAUS_FALSE;
+					credit->reportedCredits = reportedCredits;
+					credit->reportTimeSec = now;
+				}
+				credit->credits = reportedCredits;
+				credit->expireTimeSec = now + FLOW_CONTROL_CREDIT_LIFETIME_SEC;
+			}
+			else
+			{
+				// Node Manager did not answer, do not hold back the send
+				pthread_mutex_unlock(&nmi->flowControlMutex);
+				return 1;
+			}
 		}
-		else if(nmi->receiveQueue->size)
+
+		if(credit->credits >= packetCount)
 		{
-			*message = (JausMessage)queuePop(nmi->receiveQueue);
-			return NMI_MESSAGE_RECEIVED;
+			credit->credits -= packetCount;
+			pthread_mutex_unlock(&nmi->flowControlMutex);
+			return 1;
 		}
-		else
-		{
-			timeLimitSpec.tv_sec = (long)timeLimitSec;
-			timeLimitSpec.tv_nsec = (long)(1e9 * (timeLimitSec - (double)timeLimitSpec.tv_sec));
-
-			pthread_mutex_lock(&recvMutex);
-			condition = pthread_cond_timedwait(&nmi->recvCondition, &recvMutex, &timeLimitSpec);
-			pthread_mutex_unlock(&recvMutex);
-
-			switch(condition)
-			{
-				case 0: // Conditional Signaled
-					*message = (JausMessage)queuePop(nmi->receiveQueue);
-					return NMI_MESSAGE_RECEIVED;
 
-				case ETIMEDOUT: // our time is up
-					return NMI_RECEIVE_TIMED_OUT;
+		// No amount of waiting gives more than the whole credit, so such a message only waits for the link to empty
+		if(packetCount > credit->maxCredits && credit->isIdle && credit->credits == credit->maxCredits)
+		{
+			credit->credits = 0;
+			credit->isIdle = JAUS_FALSE;
+			pthread_mutex_unlock(&nmi->flowControlMutex);
+			return 1;
+		}
 
-				default: // Some other error occured
-					return NMI_CONDITIONAL_WAIT_ERROR;
-			}
+		if(nmi->flowControlMode != NMI_FLOW_CONTROL_BLOCK || !nmi->isOpen || ojGetTimeSec() > stopTime)
+		{
+			pthread_mutex_unlock(&nmi->flowControlMutex);
+			return 0;
 		}
-	}
-	else
-	{
-		return NMI_CLOSED_ERROR;
+
+		pthread_mutex_unlock(&nmi->flowControlMutex);
+		ojSleepMsec(FLOW_CONTROL_POLL_MSEC);
+		pthread_mutex_lock(&nmi->flowControlMutex);
 	}
 }
 
-int nodeManagerSend(NodeManagerInterface nmi, JausMessage message)
+int nodeManagerSendSingleMessage(NodeManagerInterface nmi, JausMessage message)
 {
+	DatagramPacket packet;
 	int result = -1;
 
 	if(nmi->isOpen)
 	{
-		result = lmHandlerSendLargeMessage(nmi, message);
+		packet = sendPacketGet();
+		if(packet == NULL)
+		{
+			nmi->sendDropCount++;
+			return result;
+		}
+		packet->port = nmi->messagePort;
+		packet->address->value = nmi->ipAddress->value;
+
+		if(message->dataSize > JAUS_MAX_DATA_SIZE_BYTES)
+		{
+			// Only sent once the Node Manager has agreed to large frames, see lmHandlerSendLargeMessage
+			packet->bufferSizeBytes = (int)jausMessageLargeFrameSize(message);
+			if(packet->bufferSizeBytes <= SEND_PACKET_SIZE_BYTES && jausMessageToLargeFrame(message, packet->buffer, packet->bufferSizeBytes))
+			{
+				result = datagramSocketSend(nmi->messageSocket, packet);
+			}
+		}
+		else
+		{
+			packet->bufferSizeBytes = (int)jausMessageSize(message);
+			if(jausMessageToBuffer(message, packet->buffer, packet->bufferSizeBytes))
+			{
+				result = datagramSocketSend(nmi->messageSocket, packet);
+			}
+		}
+
+		if(result < 0)
+		{
+			nmi->sendDropCount++;
+		}
 	}
 
 	return result;
 }
 
-int nodeManagerSendSingleMessage(NodeManagerInterface nmi, JausMessage message)
+// The calling thread's send packet, allocated by its first send
+static DatagramPacket sendPacketGet(void)
 {
 	DatagramPacket packet;
-	int result = -1;
 
-	if(nmi->isOpen)
+	pthread_once(&sendPacketOnce, sendPacketCreateKey);
+
+	packet = (DatagramPacket)pthread_getspecific(sendPacketKey);
+	if(packet == NULL)
 	{
 		packet = datagramPacketCreate();
-		packet->bufferSizeBytes = (int)jausMessageSize(message);
-		packet->buffer = (unsigned char*)malloc(packet->bufferSizeBytes);
-		packet->port = NODE_MANAGER_MESSAGE_PORT;
-		packet->address->value = nmi->ipAddress->value;
-		memset(packet->buffer, 0, packet->bufferSizeBytes);
+		if(packet == NULL)
+		{
+			return NULL;
+		}
 
-		if(jausMessageToBuffer(message, packet->buffer, packet->bufferSizeBytes))
+		packet->buffer = (unsigned char *)malloc(SEND_PACKET_SIZE_BYTES);
+		if(packet->buffer == NULL)
 		{
-			result = datagramSocketSend(nmi->messageSocket, packet);
+			datagramPacketDestroy(packet);
+			return NULL;
 		}
-		free(packet->buffer);
-		datagramPacketDestroy(packet);
+		pthread_setspecific(sendPacketKey, packet);
 	}
 
-	return result;
+	return packet;
 }
 
-void nodeManagerSendCoreServiceConnections(NodeManagerInterface nmi)
+static void sendPacketCreateKey(void)
 {
-	JausMessage message = NULL;
-	ServiceConnection scList = NULL;
-	ServiceConnection sc;
-	ReportComponentStatusMessage reportStatus;
-	ReportComponentAuthorityMessage reportAuthority;
+	pthread_key_create(&sendPacketKey, sendPacketDestroy);
+}
 
-	// Respond to a ReportComponentStatus Service Connection
-	scList = scManagerGetSendList(nmi, JAUS_REPORT_COMPONENT_STATUS);
-	if(scList)
-	{
-		reportStatus = reportComponentStatusMessageCreate();
-		jausAddressCopy(reportStatus->source, nmi->cmpt->address);
-		reportStatus->properties.scFlag = JAUS_SERVICE_CONNECTION_MESSAGE;
-		reportStatus->primaryStatusCode = nmi->cmpt->state;
+static void sendPacketDestroy(void *threadPacket)
+{
+	DatagramPacket packet = (DatagramPacket)threadPacket;
 
-		sc = scList;
-		while(sc)
-		{
-				jausAddressCopy(reportStatus->destination, sc->address);
-				reportStatus->sequenceNumber = sc->sequenceNumber;
+	free(packet->buffer);
+	datagramPacketDestroy(packet);
+}
+
+// Encoders for scManagerPublish, called only when a core service connection is due
+static JausMessage encodeComponentStatus(void *data, JausUnsignedInteger presenceVector)
+{
+	NodeManagerInterface nmi = (NodeManagerInterface)data;
+	ReportComponentStatusMessage reportStatus;
+	JausMessage message;
 
-				message = reportComponentStatusMessageToJausMessage(reportStatus);
-				nodeManagerSend(nmi, message);
-				jausMessageDestroy(message);
+	reportStatus = reportComponentStatusMessageCreate();
+	reportStatus->primaryStatusCode = nmi->cmpt->state;
+	message = reportComponentStatusMessageToJausMessage(reportStatus);
+	reportComponentStatusMessageDestroy(reportStatus);
 
-				sc = sc->nextSc;
-		}
-		reportComponentStatusMessageDestroy(reportStatus);
-	}
-	scManagerDestroySendList(scList);
+	return message;
+}
 
-	scList = NULL;
-	// Respond to a ReportComponentAuthorityMessage Service Connection
-	scList = scManagerGetSendList(nmi, JAUS_REPORT_COMPONENT_AUTHORITY);
-	if(scList)
-	{
-		reportAuthority = reportComponentAuthorityMessageCreate();
-		jausAddressCopy(reportAuthority->source, nmi->cmpt->address);
-		reportAuthority->properties.scFlag = JAUS_SERVICE_CONNECTION_MESSAGE;
-		reportAuthority->authorityCode = nmi->cmpt->authority;
+static JausMessage encodeComponentAuthority(void *data, JausUnsignedInteger presenceVector)
+{
+	NodeManagerInterface nmi = (NodeManagerInterface)data;
+	ReportComponentAuthorityMessage reportAuthority;
+	JausMessage message;
 
-		sc = scList;
-		while(sc)
-		{
-				jausAddressCopy(reportAuthority->destination, sc->address);
-				reportAuthority->sequenceNumber = sc->sequenceNumber;
+	reportAuthority = reportComponentAuthorityMessageCreate();
+	reportAuthority->authorityCode = nmi->cmpt->authority;
+	message = reportComponentAuthorityMessageToJausMessage(reportAuthority);
+	reportComponentAuthorityMessageDestroy(reportAuthority);
 
-				message = reportComponentAuthorityMessageToJausMessage(reportAuthority);
-				nodeManagerSend(nmi, message);
-				jausMessageDestroy(message);
+	return message;
+}
 
-				sc = sc->nextSc;
-		}
-		reportComponentAuthorityMessageDestroy(reportAuthority);
-	}
-	scManagerDestroySendList(scList);
+void nodeManagerSendCoreServiceConnections(NodeManagerInterface nmi)
+{
+	// Respond to ReportComponentStatus and ReportComponentAuthority Service Connections
+	scManagerPublish(nmi, JAUS_REPORT_COMPONENT_STATUS, encodeComponentStatus, nmi);
+	scManagerPublish(nmi, JAUS_REPORT_COMPONENT_AUTHORITY, encodeComponentAuthority, nmi);
 }
@@ -38,14 +38,49 @@
 // Date:		04/15/08
 // Description:	Provides the core service connection management routines
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 #include "nodeManagerInterface/nodeManagerInterface.h"
 
-SupportedScMessage scFindSupportedScMsgInList(SupportedScMessage, unsigned short);
-ServiceConnection scFindScInList(ServiceConnection, ServiceConnection);
-int scGetAvailableInstanceId(ServiceConnection, ServiceConnection);
+#define SC_ADMISSION_MINIMUM_RATE_HZ	(1092.0 / 65535.0)	// Resolution of the confirmed rate field
+#define SC_PUBLISH_STACK_TARGETS		16		// Subscribers a publish collects before it allocates its target list
+#define SC_STATS_FILTER_GAIN			(1.0 / 16.0)
+#define SC_STATS_MAXIMUM_GAP			0x8000	// Sequence gaps from here on are behind the last message
+#define SC_STATS_REORDER_WINDOW			32		// Messages behind the last that count as reordered, not a restart
+#define SC_STATS_LINE_SIZE				256
+
+// What a publish needs from one due subscriber, taken while the manager is locked
+typedef struct
+{
+	struct JausAddressStruct address;
+	JausUnsignedInteger presenceVector;
+	JausUnsignedShort sequenceNumber;
+	JausMessage message;		// Encoded body, shared with earlier targets of the same presence vector
+	int ownsMessage;
+}ScPublishTarget;
+
+unsigned int scIndexHash(unsigned short, JausAddress);
+SupportedScMessage scFindSupportedScMsg(ServiceConnectionManager, unsigned short);
+ServiceConnection scFindOutgoingSc(ServiceConnectionManager, unsigned short, JausAddress, int);
+ServiceConnection scFindIncomingSc(ServiceConnectionManager, unsigned short, JausAddress);
+int scGetAvailableInstanceId(ServiceConnectionManager, unsigned short, JausAddress, JausUnsignedInteger);
+void scAddOutgoingSc(ServiceConnectionManager, SupportedScMessage, ServiceConnection);
+void scRemoveOutgoingSc(ServiceConnectionManager, SupportedScMessage, ServiceConnection);
+void scAddIncomingSc(ServiceConnectionManager, ServiceConnection);
+JausBoolean scRemoveIncomingSc(ServiceConnectionManager, ServiceConnection);
+void scAddReadySc(ServiceConnectionManager, ServiceConnection);
+void scRemoveReadySc(ServiceConnectionManager, ServiceConnection);
+void scUpdateStats(ServiceConnection, double);
+int scStatsToString(ServiceConnection, const char *, double, char *);
+int scManagerUpdateServiceConnection(ServiceConnection, unsigned short);
 void serviceConnectionDestroyNoMutex(ServiceConnection sc);
+double scAdmitRate(ServiceConnectionManager, SupportedScMessage, ServiceConnection, JausAddress, double);
+JausBoolean scAdmit(ServiceConnectionManager, SupportedScMessage, ServiceConnection, JausAddress, double, double *);
+ScClient scFindClient(ServiceConnectionManager, JausAddress, JausBoolean);
+void scAdmissionUpdate(ServiceConnectionManager, SupportedScMessage, ServiceConnection, JausBoolean);
+void scSendConfirm(NodeManagerInterface, CreateServiceConnectionMessage, int, double, int);
 
 ServiceConnection serviceConnectionCreate(void)
 {
@@ -66,8 +101,18 @@ ServiceConnection serviceConnectionCreate(void)
 
 		sc->instanceId = -1;
 		sc->isActive = JAUS_FALSE;
+		sc->isReady = JAUS_FALSE;
+		sc->isSequenced = JAUS_FALSE;
+		memset(&sc->stats, 0, sizeof(ServiceConnectionStats));
+		sc->intervalSec = 0;
 		sc->queueSize = 0;
+		sc->isAdmitted = JAUS_FALSE;
+		sc->admittedRateHz = 0;
+		sc->admittedBandwidth = 0;
 		sc->nextSc = NULL;
+		sc->prevSc = NULL;
+		sc->nextIndexedSc = NULL;
+		sc->nextReadySc = NULL;
 
 		sc->address = jausAddressCreate();
 		if(!sc->address)
@@ -77,14 +122,8 @@ ServiceConnection serviceConnectionCreate(void)
 			return NULL;
 		}
 
-		sc->queue = queueCreate();
-		if(!sc->queue)
-		{
-			// Failed to init queue
-			jausAddressDestroy(sc->address);
-			free(sc);
-			return NULL;
-		}
+		// The queue is sized from queueSize when the sc is requested
+		sc->queue = NULL;
 
 		return sc;
 	}
@@ -96,34 +135,10 @@ ServiceConnection serviceConnectionCreate(void)
 
 void serviceConnectionDestroy(ServiceConnection sc, ServiceConnectionManager scm)
 {
-	ServiceConnection testSc = NULL;
-	ServiceConnection prevSc = NULL;
-
 	pthread_mutex_lock(&scm->mutex);
 
-	// Check if this sc is in the scm->incomingSc list
-	testSc = scm->incomingSc;
-	while(testSc)
-	{
-		if(sc == testSc)
-		{
-			if(prevSc)
-			{
-				prevSc->nextSc = testSc->nextSc;
-			}
-			else
-			{
-		        scm->incomingSc = testSc->nextSc;
-			}
-			testSc = testSc->nextSc;
-			scm->incomingScCount--;
-		}
-		else
-		{
-			prevSc = testSc;
-			testSc = testSc->nextSc;
-		}
-	}
+	// Take this sc off the incoming list if it is there
+	scRemoveIncomingSc(scm, sc);
 
 	serviceConnectionDestroyNoMutex(sc); sc = NULL;
 
@@ -133,7 +148,10 @@ void serviceConnectionDestroy(ServiceConnection sc, ServiceConnectionManager scm
 void serviceConnectionDestroyNoMutex(ServiceConnection sc)
 {
 	jausAddressDestroy(sc->address);
-	queueDestroy(sc->queue, (void *)jausMessageDestroy);
+	if(sc->queue)
+	{
+		ringQueueDestroy(sc->queue);
+	}
 	free(sc);
 }
 
@@ -153,6 +171,15 @@ ServiceConnectionManager scManagerCreate(void)
 	scm->supportedScMsgCount = 0;
 	scm->outgoingScCount = 0;
 	scm->incomingScCount = 0;
+	memset(&scm->limits, 0, sizeof(ServiceConnectionLimits));
+	memset(&scm->admissionStats, 0, sizeof(ServiceConnectionAdmissionStats));
+	memset(scm->supportedScMsgIndex, 0, sizeof(scm->supportedScMsgIndex));
+	memset(scm->outgoingScIndex, 0, sizeof(scm->outgoingScIndex));
+	memset(scm->incomingScIndex, 0, sizeof(scm->incomingScIndex));
+	scm->admittedScCount = 0;
+	memset(scm->clientIndex, 0, sizeof(scm->clientIndex));
+	scm->readyScHead = NULL;
+	scm->readyScTail = NULL;
 
 	retVal = pthread_mutex_init(&scm->mutex, NULL);
 	if(retVal != 0)
@@ -169,6 +196,8 @@ void scManagerDestroy(ServiceConnectionManager scm)
 {
 	SupportedScMessage supportedScMsg;
 	ServiceConnection sc;
+	ScClient client;
+	int i;
 
 	// Only attempt to destroy the scm if it is a non-NULL pointer
 	if(scm == NULL)
@@ -195,6 +224,17 @@ void scManagerDestroy(ServiceConnectionManager scm)
 		free(supportedScMsg);
 	}
 
+	for(i = 0; i < SC_MANAGER_HASH_BUCKETS; i++)
+	{
+		while(scm->clientIndex[i])
+		{
+			client = scm->clientIndex[i];
+			scm->clientIndex[i] = client->nextClient;
+			jausAddressDestroy(client->address);
+			free(client);
+		}
+	}
+
 	pthread_mutex_unlock(&scm->mutex);
 	pthread_mutex_destroy(&scm->mutex);
 	free(scm);
@@ -202,51 +242,35 @@ void scManagerDestroy(ServiceConnectionManager scm)
 
 void scManagerProcessConfirmScMessage(NodeManagerInterface nmi, ConfirmServiceConnectionMessage message)
 {
-	ServiceConnection prevSc = NULL;
 	ServiceConnection sc;
 	TerminateServiceConnectionMessage terminateSc;
 	JausMessage txMessage;
 
 	pthread_mutex_lock(&nmi->scm->mutex);
 
-	sc = nmi->scm->incomingSc;
-
-	while(sc)
+	sc = scFindIncomingSc(nmi->scm, message->serviceConnectionCommandCode, message->source);
+	if(sc)
 	{
-		if(	sc->commandCode == message->serviceConnectionCommandCode && jausAddressEqual(sc->address, message->source) )
+		if( message->responseCode == JAUS_SC_SUCCESSFUL )
 		{
-			if( message->responseCode == JAUS_SC_SUCCESSFUL )
-			{
-				sc->confirmedUpdateRateHz = message->confirmedPeriodicUpdateRateHertz;
-				sc->instanceId = message->instanceId;
-				sc->isActive = JAUS_TRUE;
-				sc->sequenceNumber = 65535;
-				sc->lastSentTime = ojGetTimeSec();
-			}
-			else
-			{
-				// Set SC Inactive
-				sc->isActive = JAUS_FALSE;
-
-				// Remove Service Connection
-				if(prevSc)
-				{
-					prevSc->nextSc = sc->nextSc;
-					sc->nextSc = NULL;
-				}
-				else
-				{
-					nmi->scm->incomingSc = sc->nextSc;
-					sc->nextSc = NULL;
-				}
-				nmi->scm->incomingScCount--;
-			}
+			sc->confirmedUpdateRateHz = message->confirmedPeriodicUpdateRateHertz;
+			sc->instanceId = message->instanceId;
+			sc->isActive = JAUS_TRUE;
+			sc->sequenceNumber = 65535;
+			sc->isSequenced = JAUS_FALSE;
+			sc->lastSentTime = ojGetTimeSec();
+		}
+		else
+		{
+			// Set SC Inactive
+			sc->isActive = JAUS_FALSE;
 
-			pthread_mutex_unlock(&nmi->scm->mutex);
-			return;
+			// Remove Service Connection
+			scRemoveIncomingSc(nmi->scm, sc);
 		}
-		prevSc = sc;
-		sc = sc->nextSc;
+
+		pthread_mutex_unlock(&nmi->scm->mutex);
+		return;
 	}
 
 	// The SC was not found, so send a terminate to prevent streaming
@@ -273,28 +297,14 @@ void scManagerProcessCreateScMessage(NodeManagerInterface nmi, CreateServiceConn
 	SupportedScMessage supportedScMsg;
 	ServiceConnection sc;
 	ServiceConnection newSc;
-	JausMessage txMessage;
-	ConfirmServiceConnectionMessage confScMsg;
+	double confirmedRateHz;
 
 	pthread_mutex_lock(&nmi->scm->mutex);
 
-	supportedScMsg = scFindSupportedScMsgInList(nmi->scm->supportedScMsgList, message->serviceConnectionCommandCode);
+	supportedScMsg = scFindSupportedScMsg(nmi->scm, message->serviceConnectionCommandCode);
 	if(supportedScMsg == NULL)
 	{
-		confScMsg = confirmServiceConnectionMessageCreate();
-		jausAddressCopy(confScMsg->source, nmi->cmpt->address);
-		jausAddressCopy(confScMsg->destination, message->source);
-		confScMsg->serviceConnectionCommandCode = message->serviceConnectionCommandCode;
-		confScMsg->instanceId = 0;
-		confScMsg->confirmedPeriodicUpdateRateHertz = 0;
-		confScMsg->responseCode = JAUS_SC_COMPONENT_NOT_CAPABLE;
-
-		txMessage = confirmServiceConnectionMessageToJausMessage(confScMsg);
-		nodeManagerSend(nmi, txMessage);
-		jausMessageDestroy(txMessage);
-
-		confirmServiceConnectionMessageDestroy(confScMsg);
-
+		scSendConfirm(nmi, message, 0, 0, JAUS_SC_COMPONENT_NOT_CAPABLE);
 		pthread_mutex_unlock(&nmi->scm->mutex);
 		return;
 	}
@@ -303,19 +313,7 @@ void scManagerProcessCreateScMessage(NodeManagerInterface nmi, CreateServiceConn
 	if(newSc == NULL)
 	{
 		// Send negative conf (could not create sc)
-		confScMsg = confirmServiceConnectionMessageCreate();
-		jausAddressCopy(confScMsg->source, nmi->cmpt->address);
-		jausAddressCopy(confScMsg->destination, message->source);
-		confScMsg->serviceConnectionCommandCode = message->serviceConnectionCommandCode;
-		confScMsg->instanceId = 0;
-		confScMsg->confirmedPeriodicUpdateRateHertz = 0;
-		confScMsg->responseCode = JAUS_SC_CONNECTION_REFUSED;
-
-		txMessage = confirmServiceConnectionMessageToJausMessage(confScMsg);
-		nodeManagerSend(nmi, txMessage);
-		jausMessageDestroy(txMessage);
-
-		confirmServiceConnectionMessageDestroy(confScMsg);
+		scSendConfirm(nmi, message, 0, 0, JAUS_SC_CONNECTION_REFUSED);
 		pthread_mutex_unlock(&nmi->scm->mutex);
 		return;
 	}
@@ -324,24 +322,11 @@ void scManagerProcessCreateScMessage(NodeManagerInterface nmi, CreateServiceConn
 	newSc->presenceVector = message->presenceVector;
 	newSc->address = jausAddressCreate();
 	jausAddressCopy(newSc->address, message->source);
-	newSc->instanceId = scGetAvailableInstanceId(supportedScMsg->scList, newSc);
+	newSc->instanceId = scGetAvailableInstanceId(nmi->scm, newSc->commandCode, newSc->address, newSc->presenceVector);
 	if(newSc->instanceId == -1)
 	{
 		// Send negative conf (could not create sc)
-		confScMsg = confirmServiceConnectionMessageCreate();
-		jausAddressCopy(confScMsg->source, nmi->cmpt->address);
-		jausAddressCopy(confScMsg->destination, message->source);
-		confScMsg->serviceConnectionCommandCode = message->serviceConnectionCommandCode;
-		confScMsg->instanceId = 0;
-		confScMsg->confirmedPeriodicUpdateRateHertz = 0;
-		confScMsg->responseCode = JAUS_SC_CONNECTION_REFUSED;
-
-		txMessage = confirmServiceConnectionMessageToJausMessage(confScMsg);
-		nodeManagerSend(nmi, txMessage);
-		jausMessageDestroy(txMessage);
-
-		confirmServiceConnectionMessageDestroy(confScMsg);
-
+		scSendConfirm(nmi, message, 0, 0, JAUS_SC_CONNECTION_REFUSED);
 		jausAddressDestroy(newSc->address);
 		free(newSc);
 		pthread_mutex_unlock(&nmi->scm->mutex);
@@ -349,16 +334,35 @@ void scManagerProcessCreateScMessage(NodeManagerInterface nmi, CreateServiceConn
 	}
 	newSc->queue = NULL;
 	newSc->queueSize = 0;
+	newSc->isAdmitted = JAUS_FALSE;
+	newSc->admittedRateHz = 0;
+	newSc->admittedBandwidth = 0;
+	newSc->isReady = JAUS_FALSE;
+	newSc->isSequenced = JAUS_FALSE;
+	memset(&newSc->stats, 0, sizeof(ServiceConnectionStats));
+	newSc->intervalSec = 0;
 	newSc->nextSc = NULL;
+	newSc->prevSc = NULL;
+	newSc->nextIndexedSc = NULL;
+	newSc->nextReadySc = NULL;
+
+	// Admission control, a re-requested sc does not count against its own budget
+	sc = scFindOutgoingSc(nmi->scm, newSc->commandCode, newSc->address, newSc->instanceId);
+	if(!scAdmit(nmi->scm, supportedScMsg, sc, message->source, message->requestedPeriodicUpdateRateHertz, &confirmedRateHz))
+	{
+		// Send negative conf (no budget left), an existing sc keeps its previous rate
+		scSendConfirm(nmi, message, 0, 0, JAUS_SC_CONNECTION_REFUSED);
+		jausAddressDestroy(newSc->address);
+		free(newSc);
+		pthread_mutex_unlock(&nmi->scm->mutex);
+		return;
+	}
 
-	sc = scFindScInList(supportedScMsg->scList, newSc);
 	if(sc == NULL) // Test to see if the sc does not already exist
 	{
 		// The sc doesent exist, so we insert the new one into the list
 		sc = newSc;
-		sc->nextSc = supportedScMsg->scList;
-		supportedScMsg->scList = sc;
-		nmi->scm->outgoingScCount++;
+		scAddOutgoingSc(nmi->scm, supportedScMsg, sc);
 	}
 	else
 	{
@@ -370,151 +374,247 @@ void scManagerProcessCreateScMessage(NodeManagerInterface nmi, CreateServiceConn
 	sc->lastSentTime = 0.0;
 	sc->sequenceNumber = 0;
 	sc->isActive = JAUS_TRUE;
-	sc->confirmedUpdateRateHz = message->requestedPeriodicUpdateRateHertz;	// TODO: calculate confirmedUpdateRateHz
+	sc->confirmedUpdateRateHz = confirmedRateHz;
+	scAdmissionUpdate(nmi->scm, supportedScMsg, sc, JAUS_TRUE);
+
+	scSendConfirm(nmi, message, sc->instanceId, sc->confirmedUpdateRateHz, JAUS_SC_SUCCESSFUL);
+
+	pthread_mutex_unlock(&nmi->scm->mutex);
+}
+
+void scSendConfirm(NodeManagerInterface nmi, CreateServiceConnectionMessage message, int instanceId, double confirmedRateHz, int responseCode)
+{
+	ConfirmServiceConnectionMessage confScMsg;
+	JausMessage txMessage;
 
 	confScMsg = confirmServiceConnectionMessageCreate();
 	jausAddressCopy(confScMsg->source, nmi->cmpt->address);
 	jausAddressCopy(confScMsg->destination, message->source);
-	confScMsg->serviceConnectionCommandCode = sc->commandCode;
-	confScMsg->instanceId = (JausByte)sc->instanceId;
-	confScMsg->confirmedPeriodicUpdateRateHertz = sc->confirmedUpdateRateHz;
-	confScMsg->responseCode = JAUS_SC_SUCCESSFUL;
+	confScMsg->serviceConnectionCommandCode = message->serviceConnectionCommandCode;
+	confScMsg->instanceId = (JausByte)instanceId;
+	confScMsg->confirmedPeriodicUpdateRateHertz = confirmedRateHz;
+	confScMsg->responseCode = responseCode;
 
 	txMessage = confirmServiceConnectionMessageToJausMessage(confScMsg);
 	nodeManagerSend(nmi, txMessage);
 	jausMessageDestroy(txMessage);
 
 	confirmServiceConnectionMessageDestroy(confScMsg);
-
-	pthread_mutex_unlock(&nmi->scm->mutex);
 }
 
-void scManagerProcessActivateScMessage(NodeManagerInterface nmi, ActivateServiceConnectionMessage message)
+// Admission control for a create or activate request, counted in the admission stats. Returns JAUS_FALSE if
+// the budgets leave less than SC_ADMISSION_MINIMUM_RATE_HZ, otherwise the rate to confirm in confirmedRateHz.
+// An existing sc does not count against its own budget. Called with scm->mutex held.
+JausBoolean scAdmit(ServiceConnectionManager scm, SupportedScMessage supportedScMsg, ServiceConnection existingSc, JausAddress client, double requestedRateHz, double *confirmedRateHz)
+{
+	*confirmedRateHz = scAdmitRate(scm, supportedScMsg, existingSc, client, requestedRateHz);
+	if(*confirmedRateHz < requestedRateHz && *confirmedRateHz < SC_ADMISSION_MINIMUM_RATE_HZ)
+	{
+		scm->admissionStats.deniedCount++;
+		return JAUS_FALSE;
+	}
+	else if(*confirmedRateHz < requestedRateHz)
+	{
+		scm->admissionStats.downgradedCount++;
+	}
+	else
+	{
+		scm->admissionStats.grantedCount++;
+	}
+	return JAUS_TRUE;
+}
+
+// Returns the highest rate up to requestedRateHz which fits in the producer and client budgets.
+// The sums are the admission totals of the active outgoing scs, leaving out excludeSc. Called with scm->mutex held.
+double scAdmitRate(ServiceConnectionManager scm, SupportedScMessage requestedScMsg, ServiceConnection excludeSc, JausAddress client, double requestedRateHz)
 {
-	SupportedScMessage supportedScMsg;
-	ServiceConnection sc;
-	ServiceConnection messageSc;
-
-	pthread_mutex_lock(&nmi->scm->mutex);
+	ScClient scClient;
+	double producerRateHz = scm->admissionStats.grantedRateHz;
+	double producerBandwidth = scm->admissionStats.grantedBandwidthBytesPerSec;
+	double clientRateHz = 0, clientBandwidth = 0;
+	double rateHz = requestedRateHz;
+
+	scClient = scFindClient(scm, client, JAUS_FALSE);
+	if(scClient)
+	{
+		clientRateHz = scClient->rateHz;
+		clientBandwidth = scClient->bandwidth;
+	}
 
-	supportedScMsg = scFindSupportedScMsgInList(nmi->scm->supportedScMsgList, message->serviceConnectionCommandCode);
-	if(supportedScMsg == NULL)
+	if(excludeSc && excludeSc->isAdmitted)
 	{
-		pthread_mutex_unlock(&nmi->scm->mutex);
-		return;
+		producerRateHz -= excludeSc->admittedRateHz;
+		producerBandwidth -= excludeSc->admittedBandwidth;
+		if(jausAddressEqual(excludeSc->address, client))
+		{
+			clientRateHz -= excludeSc->admittedRateHz;
+			clientBandwidth -= excludeSc->admittedBandwidth;
+		}
 	}
 
-	messageSc = (ServiceConnection)malloc( sizeof(ServiceConnectionStruct) );
-	if(messageSc == NULL)
+	if(scm->limits.producerRateHz > 0 && rateHz > scm->limits.producerRateHz - producerRateHz)
 	{
-		pthread_mutex_unlock(&nmi->scm->mutex);
-		return;
+		rateHz = scm->limits.producerRateHz - producerRateHz;
 	}
 
-	messageSc->address = jausAddressCreate();
-	jausAddressCopy(messageSc->address, message->source);
-	messageSc->instanceId = message->instanceId;
+	if(scm->limits.clientRateHz > 0 && rateHz > scm->limits.clientRateHz - clientRateHz)
+	{
+		rateHz = scm->limits.clientRateHz - clientRateHz;
+	}
 
-	sc = scFindScInList(supportedScMsg->scList, messageSc);
-	if(sc != NULL)
+	if(requestedScMsg->messageSizeBytes)
 	{
-		sc->isActive = JAUS_TRUE;
+		if(scm->limits.producerBandwidthBytesPerSec > 0 && rateHz * requestedScMsg->messageSizeBytes > scm->limits.producerBandwidthBytesPerSec - producerBandwidth)
+		{
+			rateHz = (scm->limits.producerBandwidthBytesPerSec - producerBandwidth) / requestedScMsg->messageSizeBytes;
+		}
+
+		if(scm->limits.clientBandwidthBytesPerSec > 0 && rateHz * requestedScMsg->messageSizeBytes > scm->limits.clientBandwidthBytesPerSec - clientBandwidth)
+		{
+			rateHz = (scm->limits.clientBandwidthBytesPerSec - clientBandwidth) / requestedScMsg->messageSizeBytes;
+		}
 	}
 
-	jausAddressDestroy(messageSc->address);
-	free(messageSc);
-	pthread_mutex_unlock(&nmi->scm->mutex);
+	return rateHz > 0? rateHz : 0;
 }
 
-void scManagerProcessSuspendScMessage(NodeManagerInterface nmi, SuspendServiceConnectionMessage message)
+// Returns the admission totals of client, adding them if isCreated and there are none. Called with scm->mutex held.
+ScClient scFindClient(ServiceConnectionManager scm, JausAddress address, JausBoolean isCreated)
 {
-	SupportedScMessage supportedScMsg;
-	ServiceConnection sc;
-	ServiceConnection messageSc;
+	ScClient *bucket = &scm->clientIndex[(unsigned int)jausAddressHash(address) % SC_MANAGER_HASH_BUCKETS];
+	ScClient client;
 
-	pthread_mutex_lock(&nmi->scm->mutex);
+	for(client = *bucket; client; client = client->nextClient)
+	{
+		if(jausAddressEqual(client->address, address))
+		{
+			return client;
+		}
+	}
 
-	supportedScMsg = scFindSupportedScMsgInList(nmi->scm->supportedScMsgList, message->serviceConnectionCommandCode);
-	if(supportedScMsg == NULL)
+	if(!isCreated)
+	{
+		return NULL;
+	}
+
+	client = (ScClient)malloc(sizeof(ScClientStruct));
+	if(client == NULL)
+	{
+		return NULL;
+	}
+	client->address = jausAddressCreate();
+	jausAddressCopy(client->address, address);
+	client->scCount = 0;
+	client->rateHz = 0;
+	client->bandwidth = 0;
+	client->nextClient = *bucket;
+	*bucket = client;
+	return client;
+}
+
+// Moves the admission totals from what sc added to them before to what it adds now, nothing unless it is
+// active and isCounted. Called with scm->mutex held whenever an outgoing sc's rate, activity or size changes.
+void scAdmissionUpdate(ServiceConnectionManager scm, SupportedScMessage supportedScMsg, ServiceConnection sc, JausBoolean isCounted)
+{
+	ScClient client;
+	ScClient *bucket;
+	JausBoolean isAdmitted = (isCounted && sc->isActive)? JAUS_TRUE : JAUS_FALSE;
+	double rateHz = isAdmitted? sc->confirmedUpdateRateHz : 0;
+	double bandwidth = isAdmitted? sc->confirmedUpdateRateHz * supportedScMsg->messageSizeBytes : 0;
+
+	if(!isAdmitted && !sc->isAdmitted)
 	{
-		pthread_mutex_unlock(&nmi->scm->mutex);
 		return;
 	}
 
-	messageSc = (ServiceConnection)malloc( sizeof(ServiceConnectionStruct) );
-	if(messageSc == NULL)
+	client = scFindClient(scm, sc->address, JAUS_TRUE);
+	if(client == NULL)
 	{
-		pthread_mutex_unlock(&nmi->scm->mutex);
 		return;
 	}
 
-	messageSc->address = jausAddressCreate();
-	jausAddressCopy(messageSc->address, message->source);
-	messageSc->instanceId = message->instanceId;
+	client->scCount += (isAdmitted? 1 : 0) - (sc->isAdmitted? 1 : 0);
+	client->rateHz += rateHz - sc->admittedRateHz;
+	client->bandwidth += bandwidth - sc->admittedBandwidth;
+	scm->admittedScCount += (isAdmitted? 1 : 0) - (sc->isAdmitted? 1 : 0);
+	scm->admissionStats.grantedRateHz += rateHz - sc->admittedRateHz;
+	scm->admissionStats.grantedBandwidthBytesPerSec += bandwidth - sc->admittedBandwidth;
 
-	sc = scFindScInList(supportedScMsg->scList, messageSc);
-	if(sc != NULL)
+	sc->isAdmitted = isAdmitted;
+	sc->admittedRateHz = rateHz;
+	sc->admittedBandwidth = bandwidth;
+
+	// Restart sums which are back to nothing, so rounding does not build up
+	if(scm->admittedScCount == 0)
 	{
-		sc->isActive = JAUS_FALSE;
+		scm->admissionStats.grantedRateHz = 0;
+		scm->admissionStats.grantedBandwidthBytesPerSec = 0;
+	}
+	if(client->scCount == 0)
+	{
+		bucket = &scm->clientIndex[(unsigned int)jausAddressHash(client->address) % SC_MANAGER_HASH_BUCKETS];
+		while(*bucket != client)
+		{
+			bucket = &(*bucket)->nextClient;
+		}
+		*bucket = client->nextClient;
+		jausAddressDestroy(client->address);
+		free(client);
 	}
-
-	jausAddressDestroy(messageSc->address);
-	free(messageSc);
-	pthread_mutex_unlock(&nmi->scm->mutex);
 }
 
-void scManagerProcessTerminateScMessage(NodeManagerInterface nmi, TerminateServiceConnectionMessage message)
+void scManagerProcessActivateScMessage(NodeManagerInterface nmi, ActivateServiceConnectionMessage message)
 {
 	SupportedScMessage supportedScMsg;
 	ServiceConnection sc;
-	ServiceConnection prevSc;
+	double confirmedRateHz;
 
 	pthread_mutex_lock(&nmi->scm->mutex);
 
-	supportedScMsg = scFindSupportedScMsgInList(nmi->scm->supportedScMsgList, message->serviceConnectionCommandCode);
-	if(supportedScMsg == NULL)
+	sc = scFindOutgoingSc(nmi->scm, message->serviceConnectionCommandCode, message->source, message->instanceId);
+	if(sc != NULL && !sc->isActive)
 	{
-		pthread_mutex_unlock(&nmi->scm->mutex);
-		return;
+		// A suspended sc is admitted again, at most at its confirmed rate, or stays suspended
+		supportedScMsg = scFindSupportedScMsg(nmi->scm, sc->commandCode);
+		if(scAdmit(nmi->scm, supportedScMsg, sc, sc->address, sc->confirmedUpdateRateHz, &confirmedRateHz))
+		{
+			sc->confirmedUpdateRateHz = confirmedRateHz;
+			sc->isActive = JAUS_TRUE;
+			scAdmissionUpdate(nmi->scm, supportedScMsg, sc, JAUS_TRUE);
+		}
 	}
 
-	if( supportedScMsg->scList == NULL )
+	pthread_mutex_unlock(&nmi->scm->mutex);
+}
+
+void scManagerProcessSuspendScMessage(NodeManagerInterface nmi, SuspendServiceConnectionMessage message)
+{
+	ServiceConnection sc;
+
+	pthread_mutex_lock(&nmi->scm->mutex);
+
+	sc = scFindOutgoingSc(nmi->scm, message->serviceConnectionCommandCode, message->source, message->instanceId);
+	if(sc != NULL)
 	{
-		pthread_mutex_unlock(&nmi->scm->mutex);
-		return;
+		sc->isActive = JAUS_FALSE;
+		scAdmissionUpdate(nmi->scm, scFindSupportedScMsg(nmi->scm, sc->commandCode), sc, JAUS_TRUE);
 	}
 
-	sc = supportedScMsg->scList;
+	pthread_mutex_unlock(&nmi->scm->mutex);
+}
+
+void scManagerProcessTerminateScMessage(NodeManagerInterface nmi, TerminateServiceConnectionMessage message)
+{
+	ServiceConnection sc;
+
+	pthread_mutex_lock(&nmi->scm->mutex);
 
-	if(	jausAddressEqual(sc->address, message->source) &&
-		sc->commandCode == message->serviceConnectionCommandCode &&
-		sc->instanceId == message->instanceId )
+	sc = scFindOutgoingSc(nmi->scm, message->serviceConnectionCommandCode, message->source, message->instanceId);
+	if(sc != NULL)
 	{
 		// Remove sc from list
-		supportedScMsg->scList = sc->nextSc;
+		scRemoveOutgoingSc(nmi->scm, scFindSupportedScMsg(nmi->scm, sc->commandCode), sc);
 		serviceConnectionDestroyNoMutex(sc); sc = NULL;
-		nmi->scm->outgoingScCount--;
-		pthread_mutex_unlock(&nmi->scm->mutex);
-		return;
-	}
-
-	prevSc = sc;
-	sc = prevSc->nextSc;
-	while(sc)
-	{
-		if(	jausAddressEqual(sc->address, message->source) &&
-			sc->commandCode == message->serviceConnectionCommandCode &&
-			sc->instanceId == message->instanceId )
-		{
-			// Remove sc from list
-			prevSc->nextSc = sc->nextSc;
-			serviceConnectionDestroyNoMutex(sc); sc = NULL;
-			nmi->scm->outgoingScCount--;
-			pthread_mutex_unlock(&nmi->scm->mutex);
-			return;
-		}
-		prevSc = sc;
-		sc = sc->nextSc;
 	}
 
 	pthread_mutex_unlock(&nmi->scm->mutex);
@@ -524,74 +624,43 @@ void scManagerProcessUpdatedSubystem(NodeManagerInterface nmi, JausSubsystem sub
 {
 	SupportedScMessage supportedScMsg;
 	ServiceConnection sc;
-	ServiceConnection prevSc;
+	ServiceConnection nextSc;
 
 	pthread_mutex_lock(&nmi->scm->mutex);
 
 	supportedScMsg = nmi->scm->supportedScMsgList;
 	while(supportedScMsg)
 	{
-		prevSc = NULL;
 		sc = supportedScMsg->scList;
 		while(sc)
 		{
+			nextSc = sc->nextSc;
 			if(	!nodeManagerVerifyAddress(nmi, sc->address) )
 			{
 				// Remove sc from list
-				if(prevSc)
-				{
-					prevSc->nextSc = sc->nextSc;
-					serviceConnectionDestroyNoMutex(sc); sc = NULL;
-					sc = prevSc->nextSc;
-				}
-				else
-				{
-					supportedScMsg->scList = sc->nextSc;
-					serviceConnectionDestroyNoMutex(sc); sc = NULL;
-					sc = supportedScMsg->scList;
-				}
-				nmi->scm->outgoingScCount--;
-			}
-			else
-			{
-				prevSc = sc;
-				sc = sc->nextSc;
+				scRemoveOutgoingSc(nmi->scm, supportedScMsg, sc);
+				serviceConnectionDestroyNoMutex(sc); sc = NULL;
 			}
+			sc = nextSc;
 		}
 		supportedScMsg = supportedScMsg->nextSupportedScMsg;
 	}
 
-	prevSc = NULL;
 	sc = nmi->scm->incomingSc;
 	while(sc)
 	{
+		nextSc = sc->nextSc;
 		if( !nodeManagerVerifyAddress(nmi, sc->address) )
 		{
 			// Remove sc from list
 			sc->isActive = JAUS_FALSE;
 
 			// Clear out Inbound Queue
-			queueEmpty(sc->queue, (void *)jausMessageDestroy);
+			ringQueueEmpty(sc->queue);
 
-			if(prevSc)
-			{
-				prevSc->nextSc = sc->nextSc;
-				sc->nextSc = NULL;
-				sc = prevSc->nextSc;
-			}
-			else
-			{
-				nmi->scm->incomingSc = sc->nextSc;
-				sc->nextSc = NULL;
-				sc = nmi->scm->incomingSc;
-			}
-			nmi->scm->incomingScCount--;
-		}
-		else
-		{
-			prevSc = sc;
-			sc = sc->nextSc;
+			scRemoveIncomingSc(nmi->scm, sc);
 		}
+		sc = nextSc;
 	}
 
 	pthread_mutex_unlock(&nmi->scm->mutex);
@@ -603,7 +672,7 @@ void scManagerAddSupportedMessage(NodeManagerInterface nmi, unsigned short comma
 
 	pthread_mutex_lock(&nmi->scm->mutex);
 
-	supportedScMsg = scFindSupportedScMsgInList(nmi->scm->supportedScMsgList, commandCode);
+	supportedScMsg = scFindSupportedScMsg(nmi->scm, commandCode);
 	if(supportedScMsg == NULL)
 	{
 		supportedScMsg = (SupportedScMessage)malloc(sizeof(struct SupportedScMessageStruct));
@@ -615,10 +684,13 @@ void scManagerAddSupportedMessage(NodeManagerInterface nmi, unsigned short comma
 		}
 
 		supportedScMsg->commandCode = commandCode;
+		supportedScMsg->messageSizeBytes = JAUS_HEADER_SIZE_BYTES;
 		supportedScMsg->scList = NULL;
 
 		supportedScMsg->nextSupportedScMsg = nmi->scm->supportedScMsgList;
 		nmi->scm->supportedScMsgList = supportedScMsg;
+		supportedScMsg->nextIndexedScMsg = nmi->scm->supportedScMsgIndex[commandCode % SC_MANAGER_HASH_BUCKETS];
+		nmi->scm->supportedScMsgIndex[commandCode % SC_MANAGER_HASH_BUCKETS] = supportedScMsg;
 		nmi->scm->supportedScMsgCount++;
 	}
 
@@ -627,86 +699,121 @@ void scManagerAddSupportedMessage(NodeManagerInterface nmi, unsigned short comma
 
 void scManagerRemoveSupportedMessage(NodeManagerInterface nmi, unsigned short commandCode)
 {
-	SupportedScMessage prevSupportedScMsg = NULL;
 	SupportedScMessage supportedScMsg;
+	SupportedScMessage *listScMsg;
 	ServiceConnection sc;
 	TerminateServiceConnectionMessage terminateSc;
 	JausMessage txMessage;
 
 	pthread_mutex_lock(&nmi->scm->mutex);
 
-	supportedScMsg = nmi->scm->supportedScMsgList;
+	supportedScMsg = scFindSupportedScMsg(nmi->scm, commandCode);
+	if(supportedScMsg == NULL)
+	{
+		pthread_mutex_unlock(&nmi->scm->mutex);
+		return;
+	}
 
-	while(supportedScMsg)
+	// Remove the supported message from its index bucket and from the list
+	listScMsg = &nmi->scm->supportedScMsgIndex[commandCode % SC_MANAGER_HASH_BUCKETS];
+	while(*listScMsg != supportedScMsg)
 	{
-		if(supportedScMsg->commandCode == commandCode)
-		{
-			// Remove Service Connection
-			if(prevSupportedScMsg)
-			{
-				prevSupportedScMsg->nextSupportedScMsg = supportedScMsg->nextSupportedScMsg;
-			}
-			else
-			{
-				nmi->scm->supportedScMsgList = supportedScMsg->nextSupportedScMsg;
-			}
+		listScMsg = &(*listScMsg)->nextIndexedScMsg;
+	}
+	*listScMsg = supportedScMsg->nextIndexedScMsg;
 
-			// Terminate and free all the service connections
-			while(supportedScMsg->scList)
-			{
-				sc = supportedScMsg->scList;
-				supportedScMsg->scList = sc->nextSc;
+	listScMsg = &nmi->scm->supportedScMsgList;
+	while(*listScMsg != supportedScMsg)
+	{
+		listScMsg = &(*listScMsg)->nextSupportedScMsg;
+	}
+	*listScMsg = supportedScMsg->nextSupportedScMsg;
+
+	// Terminate and free all the service connections
+	while(supportedScMsg->scList)
+	{
+		sc = supportedScMsg->scList;
+		scRemoveOutgoingSc(nmi->scm, supportedScMsg, sc);
 
-				terminateSc = terminateServiceConnectionMessageCreate();
-				jausAddressCopy(terminateSc->source, nmi->cmpt->address);
-				jausAddressCopy(terminateSc->destination, sc->address);
-				terminateSc->serviceConnectionCommandCode = sc->commandCode;
-				terminateSc->instanceId = sc->instanceId;
+		terminateSc = terminateServiceConnectionMessageCreate();
+		jausAddressCopy(terminateSc->source, nmi->cmpt->address);
+		jausAddressCopy(terminateSc->destination, sc->address);
+		terminateSc->serviceConnectionCommandCode = sc->commandCode;
+		terminateSc->instanceId = sc->instanceId;
 
-				txMessage = terminateServiceConnectionMessageToJausMessage(terminateSc);
-				nodeManagerSend(nmi, txMessage);
-				jausMessageDestroy(txMessage);
+		txMessage = terminateServiceConnectionMessageToJausMessage(terminateSc);
+		nodeManagerSend(nmi, txMessage);
+		jausMessageDestroy(txMessage);
 
-				terminateServiceConnectionMessageDestroy(terminateSc);
+		terminateServiceConnectionMessageDestroy(terminateSc);
 
-				serviceConnectionDestroyNoMutex(sc); sc = NULL;
-			}
-			free(supportedScMsg);
-			nmi->scm->supportedScMsgCount--;
-			pthread_mutex_unlock(&nmi->scm->mutex);
-			return;
-		}
-		prevSupportedScMsg = supportedScMsg;
-		supportedScMsg = supportedScMsg->nextSupportedScMsg;
+		serviceConnectionDestroyNoMutex(sc); sc = NULL;
 	}
+	free(supportedScMsg);
+	nmi->scm->supportedScMsgCount--;
 
 	pthread_mutex_unlock(&nmi->scm->mutex);
 }
 
-JausBoolean scManagerQueryActiveMessage(NodeManagerInterface nmi, unsigned short commandCode)
+void scManagerSetSupportedMessageSize(NodeManagerInterface nmi, unsigned short commandCode, unsigned int sizeBytes)
 {
 	SupportedScMessage supportedScMsg;
+	ServiceConnection sc;
 
 	pthread_mutex_lock(&nmi->scm->mutex);
 
-	supportedScMsg = scFindSupportedScMsgInList(nmi->scm->supportedScMsgList, commandCode);
+	supportedScMsg = scFindSupportedScMsg(nmi->scm, commandCode);
+	if(supportedScMsg)
+	{
+		supportedScMsg->messageSizeBytes = sizeBytes;
+		for(sc = supportedScMsg->scList; sc; sc = sc->nextSc)
+		{
+			scAdmissionUpdate(nmi->scm, supportedScMsg, sc, JAUS_TRUE);
+		}
+	}
 
 	pthread_mutex_unlock(&nmi->scm->mutex);
+}
 
-	if(supportedScMsg != NULL && supportedScMsg->scList != NULL)
-	{
-		return JAUS_TRUE;
-	}
-	else
-	{
-		return JAUS_FALSE;
-	}
+// New limits apply to create requests received afterwards, established scs keep their confirmed rate
+void scManagerSetLimits(NodeManagerInterface nmi, ServiceConnectionLimits *limits)
+{
+	pthread_mutex_lock(&nmi->scm->mutex);
+	nmi->scm->limits = *limits;
+	pthread_mutex_unlock(&nmi->scm->mutex);
 }
 
-ServiceConnection scManagerGetSendList(NodeManagerInterface nmi, unsigned short commandCode)
+void scManagerGetAdmissionStats(NodeManagerInterface nmi, ServiceConnectionAdmissionStats *stats)
 {
-	SupportedScMessage supportedScMsg;
-	ServiceConnection sc;
+	pthread_mutex_lock(&nmi->scm->mutex);
+	*stats = nmi->scm->admissionStats;
+	pthread_mutex_unlock(&nmi->scm->mutex);
+}
+
+JausBoolean scManagerQueryActiveMessage(NodeManagerInterface nmi, unsigned short commandCode)
+{
+	SupportedScMessage supportedScMsg;
+
+	pthread_mutex_lock(&nmi->scm->mutex);
+
+	supportedScMsg = scFindSupportedScMsg(nmi->scm, commandCode);
+
+	pthread_mutex_unlock(&nmi->scm->mutex);
+
+	if(supportedScMsg != NULL && supportedScMsg->scList != NULL)
+	{
+		return JAUS_TRUE;
+	}
+	else
+	{
+		return JAUS_FALSE;
+	}
+}
+
+ServiceConnection scManagerGetSendList(NodeManagerInterface nmi, unsigned short commandCode)
+{
+	SupportedScMessage supportedScMsg;
+	ServiceConnection sc;
 	ServiceConnection newSc = NULL;
 	ServiceConnection firstSc = NULL;
 	double currentTime = ojGetTimeSec();
@@ -714,7 +821,7 @@ ServiceConnection scManagerGetSendList(NodeManagerInterface nmi, unsigned short
 	pthread_mutex_lock(&nmi->scm->mutex);
 
 	// find the SC object associated with this command code
-	supportedScMsg = scFindSupportedScMsgInList(nmi->scm->supportedScMsgList, commandCode);
+	supportedScMsg = scFindSupportedScMsg(nmi->scm, commandCode);
 	if(supportedScMsg)
 	{
 		sc = supportedScMsg->scList;
@@ -731,6 +838,7 @@ ServiceConnection scManagerGetSendList(NodeManagerInterface nmi, unsigned short
 		if(sc->isActive && sc->lastSentTime < (currentTime - 1.0/sc->confirmedUpdateRateHz))
 		{
 			sc->lastSentTime = currentTime;
+			scUpdateStats(sc, currentTime);
 			if(newSc == NULL)
 			{
 				newSc = (ServiceConnection)malloc(sizeof(ServiceConnectionStruct));
@@ -754,6 +862,118 @@ ServiceConnection scManagerGetSendList(NodeManagerInterface nmi, unsigned short
 	return firstSc;
 }
 
+// Sends one message to every service connection of commandCode that is due. encode is called once per
+// distinct presence vector among those subscribers; each send patches only the destination and sequence
+// number into the header. Returns the number of subscribers the message was sent to.
+int scManagerPublish(NodeManagerInterface nmi, unsigned short commandCode, JausMessage (*encode)(void *, JausUnsignedInteger), void *data)
+{
+	SupportedScMessage supportedScMsg;
+	ServiceConnection sc;
+	ScPublishTarget stackTargets[SC_PUBLISH_STACK_TARGETS];
+	ScPublishTarget *targets = stackTargets;
+	ScPublishTarget *grownTargets;
+	int targetCapacity = SC_PUBLISH_STACK_TARGETS;
+	int targetCount = 0;
+	int sentCount = 0;
+	int i, j;
+	double currentTime = ojGetTimeSec();
+
+	pthread_mutex_lock(&nmi->scm->mutex);
+
+	supportedScMsg = scFindSupportedScMsg(nmi->scm, commandCode);
+	for(sc = supportedScMsg? supportedScMsg->scList : NULL; sc; sc = sc->nextSc)
+	{
+		// Check for update rate
+		if(!sc->isActive || sc->lastSentTime >= (currentTime - 1.0/sc->confirmedUpdateRateHz))
+		{
+			continue;
+		}
+
+		if(targetCount == targetCapacity)
+		{
+			if(targets == stackTargets)
+			{
+				grownTargets = (ScPublishTarget *)malloc(2 * targetCapacity * sizeof(ScPublishTarget));
+				if(grownTargets)
+				{
+					memcpy(grownTargets, stackTargets, targetCount * sizeof(ScPublishTarget));
+				}
+			}
+			else
+			{
+				grownTargets = (ScPublishTarget *)realloc(targets, 2 * targetCapacity * sizeof(ScPublishTarget));
+			}
+
+			if(grownTargets == NULL)
+			{
+				break; // The rest are served next time
+			}
+			targets = grownTargets;
+			targetCapacity *= 2;
+		}
+
+		sc->lastSentTime = currentTime;
+		scUpdateStats(sc, currentTime);
+		targets[targetCount].address = *sc->address;
+		targets[targetCount].address.next = NULL;
+		targets[targetCount].presenceVector = sc->presenceVector;
+		targets[targetCount].sequenceNumber = sc->sequenceNumber++;
+		targetCount++;
+	}
+
+	pthread_mutex_unlock(&nmi->scm->mutex);
+
+	// Sent unlocked, a blocking flow controlled send must not hold up the receive thread
+	for(i = 0; i < targetCount; i++)
+	{
+		targets[i].message = NULL;
+		targets[i].ownsMessage = JAUS_FALSE;
+
+		for(j = 0; j < i; j++)
+		{
+			if(targets[j].ownsMessage && targets[j].presenceVector == targets[i].presenceVector)
+			{
+				targets[i].message = targets[j].message;
+				break;
+			}
+		}
+
+		if(targets[i].message == NULL)
+		{
+			targets[i].message = encode(data, targets[i].presenceVector);
+			if(targets[i].message == NULL)
+			{
+				continue;
+			}
+			targets[i].ownsMessage = JAUS_TRUE;
+			targets[i].message->properties.scFlag = JAUS_SERVICE_CONNECTION_MESSAGE;
+			jausAddressCopy(targets[i].message->source, nmi->cmpt->address);
+		}
+
+		jausAddressCopy(targets[i].message->destination, &targets[i].address);
+		targets[i].message->sequenceNumber = targets[i].sequenceNumber;
+		if(nodeManagerSend(nmi, targets[i].message) >= 0)
+		{
+			sentCount++;
+		}
+	}
+
+	for(i = 0; i < targetCount; i++)
+	{
+		if(targets[i].ownsMessage)
+		{
+			jausMessageDestroy(targets[i].message);
+		}
+	}
+
+	if(targets != stackTargets)
+	{
+		free(targets);
+	}
+
+	return sentCount;
+}
+
 void scManagerDestroySendList(ServiceConnection sc)
 {
 	ServiceConnection deadSc;
@@ -766,49 +986,76 @@ void scManagerDestroySendList(ServiceConnection sc)
 	}
 }
 
-SupportedScMessage scFindSupportedScMsgInList(SupportedScMessage supportedScMsg, unsigned short commandCode)
+// Index bucket of an sc. The address octets are folded together first, so each of them spreads the scs
+unsigned int scIndexHash(unsigned short commandCode, JausAddress address)
 {
-	while(supportedScMsg)
+	unsigned int hash = (unsigned int)jausAddressHash(address);
+
+	hash ^= hash >> 16;
+	hash ^= hash >> 8;
+	return ((hash & 0xFF) * 31 + commandCode) % SC_MANAGER_HASH_BUCKETS;
+}
+
+// The lookups and list changes below are called with scm->mutex held
+SupportedScMessage scFindSupportedScMsg(ServiceConnectionManager scm, unsigned short commandCode)
+{
+	SupportedScMessage supportedScMsg = scm->supportedScMsgIndex[commandCode % SC_MANAGER_HASH_BUCKETS];
+
+	while(supportedScMsg && supportedScMsg->commandCode != commandCode)
 	{
-		if(supportedScMsg->commandCode == commandCode)
+		supportedScMsg = supportedScMsg->nextIndexedScMsg;
+	}
+
+	return supportedScMsg;
+}
+
+ServiceConnection scFindOutgoingSc(ServiceConnectionManager scm, unsigned short commandCode, JausAddress address, int instanceId)
+{
+	ServiceConnection sc = scm->outgoingScIndex[scIndexHash(commandCode, address)];
+
+	while(sc)
+	{
+		if(sc->commandCode == commandCode && sc->instanceId == instanceId && jausAddressEqual(sc->address, address))
 		{
-			return supportedScMsg;
+			return sc;
 		}
-		supportedScMsg = supportedScMsg->nextSupportedScMsg;
+		sc = sc->nextIndexedSc;
 	}
 
 	return NULL;
 }
 
-ServiceConnection scFindScInList(ServiceConnection sc, ServiceConnection newSc)
+ServiceConnection scFindIncomingSc(ServiceConnectionManager scm, unsigned short commandCode, JausAddress address)
 {
-	// NOTE: destination, commandCode and presenceVector define the sc equals (==) functionality
-	//		 the updateRate is not included
+	ServiceConnection sc = scm->incomingScIndex[scIndexHash(commandCode, address)];
 
 	while(sc)
 	{
-		if(	jausAddressEqual(sc->address, newSc->address) && sc->instanceId == newSc->instanceId )
+		if(sc->commandCode == commandCode && jausAddressEqual(sc->address, address))
 		{
 			return sc;
 		}
-		sc = sc->nextSc;
+		sc = sc->nextIndexedSc;
 	}
 
 	return NULL;
 }
 
-int scGetAvailableInstanceId(ServiceConnection sc, ServiceConnection newSc)
+// A subscriber asking again with the same presence vector gets its existing instance back
+int scGetAvailableInstanceId(ServiceConnectionManager scm, unsigned short commandCode, JausAddress address, JausUnsignedInteger presenceVector)
 {
 	int i;
 	unsigned char instanceAvailable[256];
+	ServiceConnection sc;
 
 	memset(instanceAvailable, 1, 256);
 
-	while(sc)
+	// All instances of one subscriber share an index bucket
+	for(sc = scm->outgoingScIndex[scIndexHash(commandCode, address)]; sc; sc = sc->nextIndexedSc)
 	{
-		if(jausAddressEqual(sc->address, newSc->address))
+		if(sc->commandCode == commandCode && jausAddressEqual(sc->address, address))
 		{
-			if(sc->presenceVector == newSc->presenceVector)
+			if(sc->presenceVector == presenceVector)
 			{
 				return sc->instanceId;
 			}
@@ -817,7 +1064,6 @@ int scGetAvailableInstanceId(ServiceConnection sc, ServiceConnection newSc)
 				instanceAvailable[sc->instanceId] = 0;
 			}
 		}
-		sc = sc->nextSc;
 	}
 
 	for(i = 0; i<256; i++)
@@ -831,14 +1077,166 @@ int scGetAvailableInstanceId(ServiceConnection sc, ServiceConnection newSc)
 	return -1;
 }
 
+void scAddOutgoingSc(ServiceConnectionManager scm, SupportedScMessage supportedScMsg, ServiceConnection sc)
+{
+	unsigned int bucket = scIndexHash(sc->commandCode, sc->address);
+
+	sc->prevSc = NULL;
+	sc->nextSc = supportedScMsg->scList;
+	if(sc->nextSc)
+	{
+		sc->nextSc->prevSc = sc;
+	}
+	supportedScMsg->scList = sc;
+
+	sc->nextIndexedSc = scm->outgoingScIndex[bucket];
+	scm->outgoingScIndex[bucket] = sc;
+	scm->outgoingScCount++;
+}
+
+void scRemoveOutgoingSc(ServiceConnectionManager scm, SupportedScMessage supportedScMsg, ServiceConnection sc)
+{
+	ServiceConnection *indexedSc = &scm->outgoingScIndex[scIndexHash(sc->commandCode, sc->address)];
+
+	scAdmissionUpdate(scm, supportedScMsg, sc, JAUS_FALSE);
+
+	while(*indexedSc && *indexedSc != sc)
+	{
+		indexedSc = &(*indexedSc)->nextIndexedSc;
+	}
+	if(*indexedSc)
+	{
+		*indexedSc = sc->nextIndexedSc;
+	}
+
+	if(sc->prevSc)
+	{
+		sc->prevSc->nextSc = sc->nextSc;
+	}
+	else
+	{
+		supportedScMsg->scList = sc->nextSc;
+	}
+	if(sc->nextSc)
+	{
+		sc->nextSc->prevSc = sc->prevSc;
+	}
+
+	sc->nextSc = NULL;
+	sc->prevSc = NULL;
+	sc->nextIndexedSc = NULL;
+	scm->outgoingScCount--;
+}
+
+void scAddIncomingSc(ServiceConnectionManager scm, ServiceConnection sc)
+{
+	unsigned int bucket = scIndexHash(sc->commandCode, sc->address);
+
+	// Add the service connection to the front of the incoming service connection list
+	sc->prevSc = NULL;
+	sc->nextSc = scm->incomingSc;
+	if(sc->nextSc)
+	{
+		sc->nextSc->prevSc = sc;
+	}
+	scm->incomingSc = sc;
+
+	sc->nextIndexedSc = scm->incomingScIndex[bucket];
+	scm->incomingScIndex[bucket] = sc;
+	scm->incomingScCount++;
+}
+
+// Returns JAUS_FALSE if sc was not on the incoming list
+JausBoolean scRemoveIncomingSc(ServiceConnectionManager scm, ServiceConnection sc)
+{
+	ServiceConnection *indexedSc = &scm->incomingScIndex[scIndexHash(sc->commandCode, sc->address)];
+
+	while(*indexedSc && *indexedSc != sc)
+	{
+		indexedSc = &(*indexedSc)->nextIndexedSc;
+	}
+	if(*indexedSc == NULL)
+	{
+		return JAUS_FALSE;
+	}
+	*indexedSc = sc->nextIndexedSc;
+	scRemoveReadySc(scm, sc);
+
+	if(sc->prevSc)
+	{
+		sc->prevSc->nextSc = sc->nextSc;
+	}
+	else
+	{
+		scm->incomingSc = sc->nextSc;
+	}
+	if(sc->nextSc)
+	{
+		sc->nextSc->prevSc = sc->prevSc;
+	}
+
+	sc->nextSc = NULL;
+	sc->prevSc = NULL;
+	sc->nextIndexedSc = NULL;
+	scm->incomingScCount--;
+	return JAUS_TRUE;
+}
+
+// Appends sc to the ready list, if it is not already there
+void scAddReadySc(ServiceConnectionManager scm, ServiceConnection sc)
+{
+	if(sc->isReady)
+	{
+		return;
+	}
+
+	sc->nextReadySc = NULL;
+	if(scm->readyScTail)
+	{
+		scm->readyScTail->nextReadySc = sc;
+	}
+	else
+	{
+		scm->readyScHead = sc;
+	}
+	scm->readyScTail = sc;
+	sc->isReady = JAUS_TRUE;
+}
+
+void scRemoveReadySc(ServiceConnectionManager scm, ServiceConnection sc)
+{
+	ServiceConnection *readySc = &scm->readyScHead;
+	ServiceConnection prevSc = NULL;
+
+	if(!sc->isReady)
+	{
+		return;
+	}
+
+	while(*readySc && *readySc != sc)
+	{
+		prevSc = *readySc;
+		readySc = &(*readySc)->nextReadySc;
+	}
+	if(*readySc)
+	{
+		*readySc = sc->nextReadySc;
+		if(scm->readyScTail == sc)
+		{
+			scm->readyScTail = prevSc;
+		}
+	}
+
+	sc->nextReadySc = NULL;
+	sc->isReady = JAUS_FALSE;
+}
+
 JausBoolean scManagerCreateServiceConnection(NodeManagerInterface nmi, ServiceConnection sc)
 {
 	CreateServiceConnectionMessage createSc;
 	JausMessage txMessage;
 	JausAddress localAddress;
-
-	ServiceConnection prevSc = NULL;
-	ServiceConnection testSc = NULL;
+	unsigned int capacity;
 
 	if(!sc)
 	{
@@ -848,36 +1246,30 @@ JausBoolean scManagerCreateServiceConnection(NodeManagerInterface nmi, ServiceCo
 	pthread_mutex_lock(&nmi->scm->mutex);
 
 	// Check: Is this SC already on the incomingSc list? If so, remove it (otherwise it ends up on the list twice == bad)
-	// Remove this service connection from the list of incoming service connections
-	testSc = nmi->scm->incomingSc;
-	while(testSc)
-	{
-		if(sc == testSc)
-		{
-			if(prevSc)
-			{
-				prevSc->nextSc = testSc->nextSc;
-			}
-			else
-			{
-		        nmi->scm->incomingSc = testSc->nextSc;
-			}
-			testSc = testSc->nextSc;
-			nmi->scm->incomingScCount--;
-		}
-		else
-		{
-			prevSc = testSc;
-			testSc = testSc->nextSc;
-		}
-	}
+	scRemoveIncomingSc(nmi->scm, sc);
 
 	sc->confirmedUpdateRateHz = 0;
 	sc->lastSentTime = 0;
 	sc->sequenceNumber = 65535;
 	sc->instanceId = -1;
 	sc->isActive = JAUS_FALSE;
-	sc->nextSc = NULL;
+
+	// (Re)size the inbound queue, once full the oldest message is dropped for the newest
+	capacity = sc->queueSize? sc->queueSize : SC_DEFAULT_QUEUE_SIZE;
+	if(sc->queue && sc->queue->capacity != capacity)
+	{
+		ringQueueDestroy(sc->queue);
+		sc->queue = NULL;
+	}
+	if(!sc->queue)
+	{
+		sc->queue = ringQueueCreate(capacity, RING_QUEUE_DROP_OLDEST, nodeManagerReleaseQueuedMessage, nmi);
+		if(!sc->queue)
+		{
+			pthread_mutex_unlock(&nmi->scm->mutex);
+			return JAUS_FALSE;
+		}
+	}
 
 	createSc = createServiceConnectionMessageCreate();
 	jausAddressCopy(createSc->source, nmi->cmpt->address);
@@ -896,9 +1288,7 @@ JausBoolean scManagerCreateServiceConnection(NodeManagerInterface nmi, ServiceCo
 		createServiceConnectionMessageDestroy(createSc);
 
 		// Add the service connection to the front of the incoming service connection list
-		sc->nextSc = nmi->scm->incomingSc;
-		nmi->scm->incomingSc = sc;
-		nmi->scm->incomingScCount++;
+		scAddIncomingSc(nmi->scm, sc);
 
 		pthread_mutex_unlock(&nmi->scm->mutex);
 		return JAUS_TRUE;
@@ -927,9 +1317,7 @@ JausBoolean scManagerCreateServiceConnection(NodeManagerInterface nmi, ServiceCo
 			createServiceConnectionMessageDestroy(createSc);
 
 			// Add the service connection to the front of the incoming service connection list
-			sc->nextSc = nmi->scm->incomingSc;
-			nmi->scm->incomingSc = sc;
-			nmi->scm->incomingScCount++;
+			scAddIncomingSc(nmi->scm, sc);
 
 			pthread_mutex_unlock(&nmi->scm->mutex);
 			return JAUS_TRUE;
@@ -952,187 +1340,370 @@ JausBoolean scManagerTerminateServiceConnection(NodeManagerInterface nmi, Servic
 {
 	TerminateServiceConnectionMessage terminateSc;
 	JausMessage txMessage;
-	ServiceConnection prevSc = NULL;
 	ServiceConnection sc = NULL;
 
 	pthread_mutex_lock(&nmi->scm->mutex);
 
-	sc = nmi->scm->incomingSc;
-	while(sc)
+	sc = scFindIncomingSc(nmi->scm, deadSc->commandCode, deadSc->address);
+	if(sc == NULL)
 	{
-		if(sc->commandCode == deadSc->commandCode && jausAddressEqual(sc->address, deadSc->address) )
-		{
-			if(sc->instanceId > -1)
-			{
-				terminateSc = terminateServiceConnectionMessageCreate();
-				jausAddressCopy(terminateSc->source, nmi->cmpt->address);
-				jausAddressCopy(terminateSc->destination, deadSc->address);
-				terminateSc->serviceConnectionCommandCode = deadSc->commandCode;
-				terminateSc->instanceId = deadSc->instanceId;
+		pthread_mutex_unlock(&nmi->scm->mutex);
+		return JAUS_FALSE;
+	}
 
-				txMessage = terminateServiceConnectionMessageToJausMessage(terminateSc);
-				nodeManagerSend(nmi, txMessage);
-				jausMessageDestroy(txMessage);
+	if(sc->instanceId > -1)
+	{
+		terminateSc = terminateServiceConnectionMessageCreate();
+		jausAddressCopy(terminateSc->source, nmi->cmpt->address);
+		jausAddressCopy(terminateSc->destination, deadSc->address);
+		terminateSc->serviceConnectionCommandCode = deadSc->commandCode;
+		terminateSc->instanceId = deadSc->instanceId;
 
-				terminateServiceConnectionMessageDestroy(terminateSc);
-			}
+		txMessage = terminateServiceConnectionMessageToJausMessage(terminateSc);
+		nodeManagerSend(nmi, txMessage);
+		jausMessageDestroy(txMessage);
 
-			// Set SC to inactive
-			sc->isActive = JAUS_FALSE;
+		terminateServiceConnectionMessageDestroy(terminateSc);
+	}
 
-			// Empty any Remaining Queue
-			queueEmpty(sc->queue, (void *)jausMessageDestroy);
+	// Set SC to inactive
+	sc->isActive = JAUS_FALSE;
 
-			// Remove Service Connection
-			if(prevSc)
-			{
-				prevSc->nextSc = sc->nextSc;
-				sc->nextSc = NULL;
-			}
-			else
-			{
-				nmi->scm->incomingSc = sc->nextSc;
-				sc->nextSc = NULL;
-			}
+	// Empty any Remaining Queue
+	ringQueueEmpty(sc->queue);
 
-			nmi->scm->incomingScCount--;
-			pthread_mutex_unlock(&nmi->scm->mutex);
-			return JAUS_TRUE;
-		}
-		else
+	// Remove Service Connection
+	scRemoveIncomingSc(nmi->scm, sc);
+
+	pthread_mutex_unlock(&nmi->scm->mutex);
+	return JAUS_TRUE;
+}
+
+JausBoolean scManagerReceiveServiceConnection(NodeManagerInterface nmi, ServiceConnection requestSc, JausMessage *message)
+{
+	ServiceConnection sc;
+
+	pthread_mutex_lock(&nmi->scm->mutex);
+
+	sc = scFindIncomingSc(nmi->scm, requestSc->commandCode, requestSc->address);
+	if(sc == NULL)
+	{
+		pthread_mutex_unlock(&nmi->scm->mutex);
+		return JAUS_FALSE;
+	}
+
+	if(ojGetTimeSec() > (sc->lastSentTime + sc->timeoutSec))
+	{
+		// Connection has Timed Out
+		sc->isActive = JAUS_FALSE;
+		ringQueueEmpty(sc->queue);
+
+		// Remove Service Connection
+		scRemoveIncomingSc(nmi->scm, sc);
+		pthread_mutex_unlock(&nmi->scm->mutex);
+		return JAUS_FALSE;
+	}
+
+	*message = (JausMessage)ringQueuePop(sc->queue);
+	pthread_mutex_unlock(&nmi->scm->mutex);
+	return *message? JAUS_TRUE : JAUS_FALSE;
+}
+
+void scManagerReceiveMessage(NodeManagerInterface nmi, JausMessage message)
+{
+	ServiceConnection sc;
+
+	pthread_mutex_lock(&nmi->scm->mutex);
+
+	sc = scFindIncomingSc(nmi->scm, message->commandCode, message->source);
+	if(sc == NULL)
+	{
+		jausMessageDestroy(message);
+		pthread_mutex_unlock(&nmi->scm->mutex);
+		return;
+	}
+
+	if(sc->isActive)
+	{
+		// Updates lastSentTime and the stats
+		scManagerUpdateServiceConnection(sc, message->sequenceNumber);
+
+		if(!ringQueuePush(sc->queue, (void *)message))
 		{
-			prevSc = sc;
-			sc = sc->nextSc;
+			nmi->receiveDropCount++;
+			sc->stats.overflowCount++;
 		}
+		scAddReadySc(nmi->scm, sc);
+	}
+	else
+	{
+		// TODO: Error? received a message for inactive SC
+		jausMessageDestroy(message);
 	}
 	pthread_mutex_unlock(&nmi->scm->mutex);
-	return JAUS_FALSE;
 }
 
-JausBoolean scManagerReceiveServiceConnection(NodeManagerInterface nmi, ServiceConnection requestSc, JausMessage *message)
+int scManagerReceiveReadyMessages(NodeManagerInterface nmi, JausMessage *messages, int maxCount)
 {
-	ServiceConnection prevSc;
 	ServiceConnection sc;
+	int count = 0;
+
+	pthread_mutex_lock(&nmi->scm->mutex);
+
+	while(count < maxCount && nmi->scm->readyScHead)
+	{
+		sc = nmi->scm->readyScHead;
+		scRemoveReadySc(nmi->scm, sc);
+
+		messages[count] = (JausMessage)ringQueuePop(sc->queue);
+		if(messages[count])
+		{
+			count++;
+
+			// One message per sc in turn, so a fast producer does not hold back the others
+			if(ringQueueSize(sc->queue))
+			{
+				scAddReadySc(nmi->scm, sc);
+			}
+		}
+	}
 
+	pthread_mutex_unlock(&nmi->scm->mutex);
+	return count;
+}
+
+JausBoolean scManagerHasReadyMessages(NodeManagerInterface nmi)
+{
+	JausBoolean hasReady;
+
+	pthread_mutex_lock(&nmi->scm->mutex);
+	hasReady = nmi->scm->readyScHead? JAUS_TRUE : JAUS_FALSE;
 	pthread_mutex_unlock(&nmi->scm->mutex);
 
+	return hasReady;
+}
+
+void scManagerTimeoutServiceConnections(NodeManagerInterface nmi)
+{
+	ServiceConnection sc;
+	ServiceConnection nextSc;
+	double time = ojGetTimeSec();
+
+	pthread_mutex_lock(&nmi->scm->mutex);
+
 	sc = nmi->scm->incomingSc;
-	prevSc = NULL;
 	while(sc)
 	{
-		if(sc->commandCode == requestSc->commandCode && jausAddressEqual(sc->address, requestSc->address) )
+		nextSc = sc->nextSc;
+		if(sc->isActive && time > (sc->lastSentTime + sc->timeoutSec))
 		{
-			if(ojGetTimeSec() > (sc->lastSentTime + sc->timeoutSec))
-			{
-				// Connection has Timed Out
-				sc->isActive = JAUS_FALSE;
-				queueEmpty(sc->queue, (void *)jausMessageDestroy);
+			// Connection has Timed Out
+			sc->isActive = JAUS_FALSE;
+			ringQueueEmpty(sc->queue);
 
-				// Remove Service Connection
-				if(prevSc)
-				{
-					prevSc->nextSc = sc->nextSc;
-					sc->nextSc = NULL;
-				}
-				else
-				{
-					nmi->scm->incomingSc = sc->nextSc;
-					sc->nextSc = NULL;
-				}
-				nmi->scm->incomingScCount--;
-				pthread_mutex_unlock(&nmi->scm->mutex);
-				return JAUS_FALSE;
-			}
+			// Remove Service Connection
+			scRemoveIncomingSc(nmi->scm, sc);
+		}
+		sc = nextSc;
+	}
 
-			if(sc->queue->size)
-			{
-				*message = (JausMessage)queuePop(sc->queue);
-				pthread_mutex_unlock(&nmi->scm->mutex);
-				return JAUS_TRUE;
-			}
-			else
-			{
-				pthread_mutex_unlock(&nmi->scm->mutex);
-				return JAUS_FALSE;
-			}
+	pthread_mutex_unlock(&nmi->scm->mutex);
+}
+
+JausBoolean scManagerGetServiceConnectionStats(NodeManagerInterface nmi, ServiceConnection sc, ServiceConnectionStats *stats)
+{
+	if(!sc || !stats)
+	{
+		return JAUS_FALSE;
+	}
+
+	pthread_mutex_lock(&nmi->scm->mutex);
+	*stats = sc->stats;
+	pthread_mutex_unlock(&nmi->scm->mutex);
+
+	stats->ageSec = stats->lastMessageTime > 0? ojGetTimeSec() - stats->lastMessageTime : 0;
+	return JAUS_TRUE;
+}
+
+ServiceConnection scManagerGetOutgoingList(NodeManagerInterface nmi, unsigned short commandCode)
+{
+	SupportedScMessage supportedScMsg;
+	ServiceConnection sc;
+	ServiceConnection newSc = NULL;
+	ServiceConnection firstSc = NULL;
+	double currentTime = ojGetTimeSec();
+
+	pthread_mutex_lock(&nmi->scm->mutex);
+
+	supportedScMsg = scFindSupportedScMsg(nmi->scm, commandCode);
+	sc = supportedScMsg? supportedScMsg->scList : NULL;
+	while(sc)
+	{
+		if(newSc == NULL)
+		{
+			newSc = (ServiceConnection)malloc(sizeof(ServiceConnectionStruct));
+			firstSc = newSc;
 		}
 		else
 		{
-			prevSc = sc;
-			sc = sc->nextSc;
+			newSc->nextSc = (ServiceConnection)malloc(sizeof(ServiceConnectionStruct));
+			newSc = newSc->nextSc;
 		}
+
+		*newSc = *sc;
+		newSc->nextSc = NULL;
+		newSc->stats.ageSec = sc->stats.lastMessageTime > 0? currentTime - sc->stats.lastMessageTime : 0;
+		sc = sc->nextSc;
 	}
 
 	pthread_mutex_unlock(&nmi->scm->mutex);
-	return JAUS_FALSE;
+	return firstSc;
 }
 
-void scManagerReceiveMessage(NodeManagerInterface nmi, JausMessage message)
+int scManagerReportToString(NodeManagerInterface nmi, char *buffer, int bufferSize)
 {
+	SupportedScMessage supportedScMsg;
 	ServiceConnection sc;
-	char string[32] = {0};
+	char line[SC_STATS_LINE_SIZE];
+	int lineLength;
+	int length = 0;
+	double currentTime = ojGetTimeSec();
+
+	if(!buffer || bufferSize < 1)
+	{
+		return 0;
+	}
+	buffer[0] = 0;
 
 	pthread_mutex_lock(&nmi->scm->mutex);
 
 	sc = nmi->scm->incomingSc;
 	while(sc)
 	{
-		if(sc->commandCode == message->commandCode && jausAddressEqual(sc->address, message->source) )
+		lineLength = scStatsToString(sc, "In ", currentTime, line);
+		if(length + lineLength >= bufferSize)
 		{
-			if(sc->isActive)
-			{
-				sc->lastSentTime = ojGetTimeSec();
+			break;
+		}
+		memcpy(buffer + length, line, lineLength + 1);
+		length += lineLength;
+		sc = sc->nextSc;
+	}
 
-				if(sc->queueSize && sc->queueSize == sc->queue->size)
-				{
-					jausMessageDestroy(queuePop(sc->queue));
-					queuePush(sc->queue, (void *)message);
-				}
-				else
-				{
-					queuePush(sc->queue, (void *)message);
-				}
-			}
-			else
+	// sc is left set where the buffer filled up
+	supportedScMsg = nmi->scm->supportedScMsgList;
+	while(supportedScMsg && !sc)
+	{
+		sc = supportedScMsg->scList;
+		while(sc)
+		{
+			lineLength = scStatsToString(sc, "Out", currentTime, line);
+			if(length + lineLength >= bufferSize)
 			{
-				// TODO: Error? received a message for inactive SC
-				jausMessageDestroy(message);
+				break;
 			}
-			pthread_mutex_unlock(&nmi->scm->mutex);
-			return;
+			memcpy(buffer + length, line, lineLength + 1);
+			length += lineLength;
+			sc = sc->nextSc;
 		}
-		sc = sc->nextSc;
+		supportedScMsg = supportedScMsg->nextSupportedScMsg;
 	}
 
-	jausAddressToString(message->source, string);
-	jausMessageDestroy(message);
 	pthread_mutex_unlock(&nmi->scm->mutex);
+	return length;
+}
+
+// Counts a message into the rate and jitter of sc, called with scm->mutex held
+void scUpdateStats(ServiceConnection sc, double time)
+{
+	double intervalSec;
+	double deviationSec;
+
+	if(sc->stats.lastMessageTime > 0)
+	{
+		intervalSec = time - sc->stats.lastMessageTime;
+		if(sc->stats.messageCount == 1)
+		{
+			sc->intervalSec = intervalSec;
+		}
+		else
+		{
+			deviationSec = intervalSec > sc->intervalSec? intervalSec - sc->intervalSec : sc->intervalSec - intervalSec;
+			sc->stats.jitterSec += SC_STATS_FILTER_GAIN * (deviationSec - sc->stats.jitterSec);
+			sc->intervalSec += SC_STATS_FILTER_GAIN * (intervalSec - sc->intervalSec);
+		}
+		if(sc->intervalSec > 0)
+		{
+			sc->stats.rateHz = 1.0 / sc->intervalSec;
+		}
+	}
+	sc->stats.messageCount++;
+	sc->stats.lastMessageTime = time;
 }
 
+// Writes one report line for sc into line, which holds SC_STATS_LINE_SIZE characters
+int scStatsToString(ServiceConnection sc, const char *direction, double currentTime, char *line)
+{
+	char addressString[80] = {0};
+
+	jausAddressToString(sc->address, addressString);
+	return sprintf(line, "%s %-15s 0x%04X %-5s rate %8.2f/%8.2f Hz jitter %8.3f ms age %8.3f s messages %u lost %u reordered %u duplicate %u overflow %u\n",
+		direction,
+		addressString,
+		sc->commandCode,
+		sc->isActive? "up" : "down",
+		sc->stats.rateHz,
+		sc->confirmedUpdateRateHz,
+		sc->stats.jitterSec * 1000.0,
+		sc->stats.lastMessageTime > 0? currentTime - sc->stats.lastMessageTime : 0,
+		sc->stats.messageCount,
+		sc->stats.lostCount,
+		sc->stats.reorderedCount,
+		sc->stats.duplicateCount,
+		sc->stats.overflowCount);
+}
+
+// Checks the sequence number of a message received on sc and counts it into the stats. Returns JAUS_TRUE
+// for the next message in sequence, otherwise one of the SC_ERROR_SEQUENCE codes.
 int scManagerUpdateServiceConnection(ServiceConnection sc, unsigned short sequenceNumber)
 {
-	int returnValue = JAUS_FALSE;
+	JausUnsignedShort gap = (JausUnsignedShort)(sequenceNumber - sc->sequenceNumber);
+	int returnValue;
 
 	sc->lastSentTime = ojGetTimeSec();
+	scUpdateStats(sc, sc->lastSentTime);
 
-	if(sequenceNumber == sc->sequenceNumber)
+	if(!sc->isSequenced)
 	{
-		returnValue =  SC_ERROR_SEQUENCE_NUMBERS_EQUAL;
+		returnValue = (sequenceNumber == 0 && sc->sequenceNumber == 65535)? JAUS_TRUE : SC_ERROR_SEQUENCE_NUMBER_OUT_OF_SYNC;
+		sc->isSequenced = JAUS_TRUE;
 	}
-	else if(sequenceNumber == 0 && sc->sequenceNumber != 65535)
+	else if(gap == 0)
 	{
-		returnValue = SC_ERROR_SEQUENCE_NUMBER_OUT_OF_SYNC;
+		sc->stats.duplicateCount++;
+		return SC_ERROR_SEQUENCE_NUMBERS_EQUAL;
 	}
-	else if(sequenceNumber - sc->sequenceNumber != 1 && sequenceNumber !=0)
+	else if(gap < SC_STATS_MAXIMUM_GAP)
 	{
-		returnValue = SC_ERROR_SEQUENCE_NUMBER_OUT_OF_SYNC;
+		sc->stats.lostCount += gap - 1;
+		returnValue = gap == 1? JAUS_TRUE : SC_ERROR_SEQUENCE_NUMBER_OUT_OF_SYNC;
+	}
+	else if((JausUnsignedShort)(-gap) <= SC_STATS_REORDER_WINDOW)
+	{
+		// Behind the last one, it was counted lost when that arrived
+		sc->stats.reorderedCount++;
+		if(sc->stats.lostCount)
+		{
+			sc->stats.lostCount--;
+		}
+		return SC_ERROR_SEQUENCE_NUMBER_OUT_OF_SYNC;
 	}
 	else
 	{
-		returnValue = JAUS_TRUE;
+		// Too far out to be loss or reordering, the producer has started counting again
+		returnValue = SC_ERROR_SEQUENCE_NUMBER_OUT_OF_SYNC;
 	}
 
 	sc->sequenceNumber = sequenceNumber;
-
 	return returnValue;
 }
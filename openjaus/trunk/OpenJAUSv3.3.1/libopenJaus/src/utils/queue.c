@@ -140,6 +140,22 @@ void *queuePop(Queue queue)
 	return object;	
 }
 
+int queuePopMany(Queue queue, void **objects, int maxCount)
+{
+	int count = 0;
+
+	pthread_mutex_lock(&queue->mutex);
+
+	while(count < maxCount && queue->size)
+	{
+		objects[count++] = queuePopNoLock(queue);
+	}
+
+	pthread_mutex_unlock(&queue->mutex);
+
+	return count;
+}
+
 void queuePush(Queue queue, void *object)
 {
 	QueueObject *queueObject;
@@ -0,0 +1,299 @@
+/*****************************************************************************
+ *  Copyright (c) 2008, University of Florida
+ *  All rights reserved.
+ *  
+ *  This file is part of OpenJAUS.  OpenJAUS is distributed under the BSD 
+ *  license.  See the LICENSE file for details.
+ * 
+ *  Redistribution and use in source and binary forms, with or without 
+ *  modification, are permitted provided that the following conditions 
+ *  are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of the University of Florida nor the names of its 
+ *       contributors may be used to endorse or promote products derived from 
+ *       this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+// File Name: ringQueue.c
+//
+// Version: 3.3.0
+//
+// Date: 07/09/08
+//
+// Description:	This file describes the functionality associated with the bounded RingQueue object.
+//				Each slot carries a sequence number which tells a producer whether the slot is free for
+//				its position and the consumer whether the slot holds the object for its position.
+
+#include <stdlib.h>
+#include "utils/ringQueue.h"
+
+#ifdef WIN32
+#include <windows.h>
+
+static unsigned int ringQueueLoad(volatile unsigned int *value)
+{
+	unsigned int result = *value;
+	MemoryBarrier();
+	return result;
+}
+
+static void ringQueueStore(volatile unsigned int *value, unsigned int newValue)
+{
+	MemoryBarrier();
+	*value = newValue;
+}
+
+static int ringQueueCompareAndSwap(volatile unsigned int *value, unsigned int expected, unsigned int newValue)
+{
+	return InterlockedCompareExchange((volatile LONG *)value, (LONG)newValue, (LONG)expected) == (LONG)expected;
+}
+
+static void ringQueueIncrement(volatile unsigned int *value)
+{
+	InterlockedIncrement((volatile LONG *)value);
+}
+
+static void ringQueueRaise(volatile unsigned int *value, unsigned int newValue)
+{
+	LONG current = *value;
+
+	while((unsigned int)current < newValue)
+	{
+		LONG previous = InterlockedCompareExchange((volatile LONG *)value, (LONG)newValue, current);
+		if(previous == current)
+		{
+			break;
+		}
+		current = previous;
+	}
+}
+#else
+static unsigned int ringQueueLoad(volatile unsigned int *value)
+{
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static void ringQueueStore(volatile unsigned int *value, unsigned int newValue)
+{
+	__atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+}
+
+static int ringQueueCompareAndSwap(volatile unsigned int *value, unsigned int expected, unsigned int newValue)
+{
+	return __atomic_compare_exchange_n(value, &expected, newValue, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+static void ringQueueIncrement(volatile unsigned int *value)
+{
+	__atomic_fetch_add(value, 1, __ATOMIC_RELAXED);
+}
+
+static void ringQueueRaise(volatile unsigned int *value, unsigned int newValue)
+{
+	unsigned int current = __atomic_load_n(value, __ATOMIC_RELAXED);
+
+	// A failed exchange reloads current, so this stops once value is at least newValue
+	while(current < newValue && !__atomic_compare_exchange_n(value, &current, newValue, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+	{
+	}
+}
+#endif
+
+RingQueue ringQueueCreate(unsigned int capacity, int overflowPolicy, void (*objectDestroy)(void *, void *), void *objectDestroyData)
+{
+	RingQueue queue = NULL;
+	unsigned int slotCount = 2;
+	unsigned int i;
+
+	if(capacity == 0)
+	{
+		return NULL;
+	}
+
+	// A power of two, so positions map to slots with a mask and keep doing so when they wrap
+	while(slotCount < capacity)
+	{
+		slotCount <<= 1;
+	}
+
+	queue = (RingQueue)malloc( sizeof(RingQueueStruct) );
+	if(queue == NULL)
+	{
+		return NULL;
+	}
+
+	queue->slots = (RingQueueSlot *)malloc(slotCount * sizeof(RingQueueSlot));
+	if(queue->slots == NULL)
+	{
+		free(queue);
+		return NULL;
+	}
+
+	for(i = 0; i < slotCount; i++)
+	{
+		queue->slots[i].sequence = i;
+		queue->slots[i].object = NULL;
+	}
+
+	queue->mask = slotCount - 1;
+	queue->capacity = capacity;
+	queue->overflowPolicy = overflowPolicy;
+	queue->objectDestroy = objectDestroy;
+	queue->objectDestroyData = objectDestroyData;
+	queue->tail = 0;
+	queue->head = 0;
+	queue->highWaterMark = 0;
+	queue->dropCount = 0;
+
+	return queue;
+}
+
+void ringQueueDestroy(RingQueue queue)
+{
+	if(queue == NULL)
+	{
+		return;
+	}
+
+	ringQueueEmpty(queue);
+
+	free(queue->slots);
+	free(queue);
+}
+
+static void ringQueueDrop(RingQueue queue, void *object)
+{
+	ringQueueIncrement(&queue->dropCount);
+	if(queue->objectDestroy)
+	{
+		queue->objectDestroy(object, queue->objectDestroyData);
+	}
+}
+
+int ringQueuePush(RingQueue queue, void *object)
+{
+	RingQueueSlot *slot;
+	unsigned int position;
+	unsigned int sequence;
+	int size;
+	int result = 1;
+	void *oldest;
+
+	position = ringQueueLoad(&queue->tail);
+	for(;;)
+	{
+		slot = &queue->slots[position & queue->mask];
+		sequence = ringQueueLoad(&slot->sequence);
+		size = (int)(position - ringQueueLoad(&queue->head));
+
+		if(sequence == position && size < (int)queue->capacity)
+		{
+			if(ringQueueCompareAndSwap(&queue->tail, position, position + 1))
+			{
+				break;
+			}
+			position = ringQueueLoad(&queue->tail);
+		}
+		else if((int)(sequence - position) > 0)
+		{
+			// Another producer took this position first
+			position = ringQueueLoad(&queue->tail);
+		}
+		else if(queue->overflowPolicy == RING_QUEUE_DROP_OLDEST)
+		{
+			oldest = ringQueuePop(queue);
+			if(oldest)
+			{
+				ringQueueDrop(queue, oldest);
+				result = 0;
+			}
+			position = ringQueueLoad(&queue->tail);
+		}
+		else
+		{
+			ringQueueDrop(queue, object);
+			return 0;
+		}
+	}
+
+	slot->object = object;
+	ringQueueStore(&slot->sequence, position + 1);
+
+	// Producers race here, so the mark only ever moves up by compare and swap
+	ringQueueRaise(&queue->highWaterMark, (unsigned int)size + 1);
+
+	return result;
+}
+
+void *ringQueuePop(RingQueue queue)
+{
+	RingQueueSlot *slot;
+	unsigned int position = queue->head;
+	void *object;
+
+	slot = &queue->slots[position & queue->mask];
+	if(ringQueueLoad(&slot->sequence) != position + 1)
+	{
+		return NULL;
+	}
+
+	object = slot->object;
+	slot->object = NULL;
+
+	// Free the slot for the push one lap later
+	ringQueueStore(&slot->sequence, position + queue->mask + 1);
+	ringQueueStore(&queue->head, position + 1);
+
+	return object;
+}
+
+int ringQueuePopMany(RingQueue queue, void **objects, int maxCount)
+{
+	int count = 0;
+
+	while(count < maxCount && (objects[count] = ringQueuePop(queue)) != NULL)
+	{
+		count++;
+	}
+
+	return count;
+}
+
+void ringQueueEmpty(RingQueue queue)
+{
+	void *object;
+
+	if(queue)
+	{
+		while((object = ringQueuePop(queue)) != NULL)
+		{
+			if(queue->objectDestroy)
+			{
+				queue->objectDestroy(object, queue->objectDestroyData);
+			}
+		}
+	}
+}
+
+// Pushes still being completed are counted, so a pop right after may find nothing
+unsigned int ringQueueSize(RingQueue queue)
+{
+	return ringQueueLoad(&queue->tail) - ringQueueLoad(&queue->head);
+}
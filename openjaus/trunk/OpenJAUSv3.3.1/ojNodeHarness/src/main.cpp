@@ -0,0 +1,922 @@
+/*****************************************************************************
+ *  Copyright (c) 2008, University of Florida
+ *  All rights reserved.
+ *
+ *  This file is part of OpenJAUS.  OpenJAUS is distributed under the BSD
+ *  license.  See the LICENSE file for details.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of the University of Florida nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+// File Name: main.cpp
+//
+// Version: 3.3.0
+//
+// Date: 07/09/08
+//
+// Description: Runs several Node Managers and their components in one process over the loopback
+// device. The topology is read from a script (see harness.script.template). Every link between
+// two nodes is a UDP proxy which can drop and delay datagrams, so routing and discovery can be
+// measured repeatably without separate machines.
+
+#include <jaus.h>
+#include <openJaus.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#define HARNESS_IP_ADDRESS				"127.0.0.1"
+#define HARNESS_DEFAULT_PROXY_PORT		31000
+#define HARNESS_PROXY_TIMEOUT_SEC		0.1
+#define HARNESS_PING_TIMEOUT_SEC		1.0
+#define HARNESS_SERVICE_TIMEOUT_SEC		0.1
+#define HARNESS_DATAGRAM_SIZE_BYTES		4096
+#define HARNESS_TRANSFER_COMMAND_CODE	0xD100	// Experimental code carrying the payload of a transfer
+#define HARNESS_TRANSFER_TIMEOUT_SEC	5.0
+
+// Port offsets from a node's base port
+#define HARNESS_INTERFACE_PORT_OFFSET	0	// OJ Nodemanager Interface
+#define HARNESS_MESSAGE_PORT_OFFSET		1	// Component JAUS OPC UDP
+#define HARNESS_NODE_PORT_OFFSET		2	// Node JUDP
+#define HARNESS_SUBSYSTEM_PORT_OFFSET	3	// Subsystem JUDP
+
+typedef struct
+{
+	std::string name;
+	int subsystemId;
+	int nodeId;
+	unsigned short basePort;
+	std::vector<std::string> nodePeers;
+	std::vector<std::string> subsystemPeers;
+	FileLoader *configData;
+	NodeManager *nm;
+}HarnessNode;
+
+typedef struct
+{
+	double releaseTime;
+	int side;
+	int length;
+	unsigned char buffer[HARNESS_DATAGRAM_SIZE_BYTES];
+}HarnessDatagram;
+
+struct HarnessLink;
+
+typedef struct
+{
+	struct HarnessLink *link;
+	int side;
+}HarnessLinkSide;
+
+// A link owns one socket per side. Datagrams from node 0 arrive on side 0 and leave through side 1
+// towards node 1 (and vice versa), so each node learns the proxy as the address of its peer.
+typedef struct HarnessLink
+{
+	DatagramSocket socket[2];
+	unsigned short targetPort[2];
+	double lossPercent;
+	double latencySec;
+	bool running;
+	unsigned long forwardCount;
+	unsigned long dropCount;
+	std::multimap<double, HarnessDatagram *> pending;
+	pthread_mutex_t mutex;
+	pthread_t receiveThread[2];
+	pthread_t deliveryThread;
+	HarnessLinkSide sides[2];
+}HarnessLink;
+
+// Each component services its own receive queue, otherwise its Node Manager heartbeats are never
+// processed and the component is timed out. Ping replies and transfers are counted here and
+// handed to ping() and transfer().
+typedef struct
+{
+	HarnessNode *node;
+	JausComponent cmpt;
+	NodeManagerInterface nmi;
+	bool running;
+	pthread_t serviceThread;
+	pthread_mutex_t mutex;
+	pthread_cond_t condition;
+	JausAddress pingAddress;
+	unsigned long pongCount;
+	unsigned long transferCount;
+	unsigned long transferBytes;
+}HarnessComponent;
+
+class HarnessHandler : public EventHandler
+{
+public:
+	HarnessHandler(bool verbose)
+	{
+		this->verbose = verbose;
+	}
+
+	~HarnessHandler()
+	{
+
+	}
+
+	void handleEvent(NodeManagerEvent *e)
+	{
+		switch(e->getType())
+		{
+			case NodeManagerEvent::ErrorEvent:
+				printf("%s\n", ((ErrorEvent *)e)->toString().c_str());
+				break;
+
+			case NodeManagerEvent::SystemTreeEvent:
+				if(verbose)
+				{
+					printf("%s\n", ((SystemTreeEvent *)e)->toString().c_str());
+				}
+				break;
+
+			default:
+				break;
+		}
+		delete e;
+	}
+
+private:
+	bool verbose;
+};
+
+static std::map<std::string, HarnessNode *> nodes;
+static std::vector<HarnessLink *> links;
+static std::vector<HarnessComponent *> components;
+static unsigned short nextProxyPort = HARNESS_DEFAULT_PROXY_PORT;
+static int routerThreads = 0;
+
+static void linkForward(HarnessLink *link, int side, unsigned char *buffer, int length)
+{
+	DatagramPacket packet = datagramPacketCreate();
+
+	packet->buffer = buffer;
+	packet->bufferSizeBytes = length;
+	packet->port = link->targetPort[!side];
+	packet->address->value = link->socket[!side]->address->value;
+	datagramSocketSend(link->socket[!side], packet);
+	datagramPacketDestroy(packet);
+}
+
+static void *linkReceiveThread(void *arg)
+{
+	HarnessLinkSide *linkSide = (HarnessLinkSide *)arg;
+	HarnessLink *link = linkSide->link;
+	DatagramPacket packet = datagramPacketCreate();
+	HarnessDatagram *datagram;
+	unsigned char buffer[HARNESS_DATAGRAM_SIZE_BYTES];
+	int bytes;
+
+	packet->buffer = buffer;
+	packet->bufferSizeBytes = HARNESS_DATAGRAM_SIZE_BYTES;
+
+	while(link->running)
+	{
+		bytes = datagramSocketReceive(link->socket[linkSide->side], packet);
+		if(bytes <= 0)
+		{
+			continue;
+		}
+
+		pthread_mutex_lock(&link->mutex);
+		if(link->lossPercent > 0 && 100.0 * rand() / ((double)RAND_MAX + 1.0) < link->lossPercent)
+		{
+			link->dropCount++;
+			pthread_mutex_unlock(&link->mutex);
+			continue;
+		}
+		link->forwardCount++;
+
+		if(link->latencySec <= 0)
+		{
+			pthread_mutex_unlock(&link->mutex);
+			linkForward(link, linkSide->side, buffer, bytes);
+			continue;
+		}
+
+		datagram = (HarnessDatagram *)malloc(sizeof(HarnessDatagram));
+		datagram->releaseTime = ojGetTimeSec() + link->latencySec;
+		datagram->side = linkSide->side;
+		datagram->length = bytes;
+		memcpy(datagram->buffer, buffer, bytes);
+		link->pending.insert(std::make_pair(datagram->releaseTime, datagram));
+		pthread_mutex_unlock(&link->mutex);
+	}
+
+	datagramPacketDestroy(packet);
+	return NULL;
+}
+
+static void *linkDeliveryThread(void *arg)
+{
+	HarnessLink *link = (HarnessLink *)arg;
+	HarnessDatagram *datagram;
+
+	while(link->running)
+	{
+		pthread_mutex_lock(&link->mutex);
+		while(!link->pending.empty() && link->pending.begin()->first <= ojGetTimeSec())
+		{
+			datagram = link->pending.begin()->second;
+			link->pending.erase(link->pending.begin());
+
+			pthread_mutex_unlock(&link->mutex);
+			linkForward(link, datagram->side, datagram->buffer, datagram->length);
+			free(datagram);
+			pthread_mutex_lock(&link->mutex);
+		}
+		pthread_mutex_unlock(&link->mutex);
+
+		ojSleepMsec(1);
+	}
+	return NULL;
+}
+
+static HarnessLink *linkCreate(unsigned short targetPort0, unsigned short targetPort1, double lossPercent, double latencyMsec)
+{
+	HarnessLink *link = new HarnessLink();
+	int i;
+
+	link->targetPort[0] = targetPort0;
+	link->targetPort[1] = targetPort1;
+	link->lossPercent = lossPercent;
+	link->latencySec = latencyMsec / 1000.0;
+	link->forwardCount = 0;
+	link->dropCount = 0;
+	link->running = true;
+	pthread_mutex_init(&link->mutex, NULL);
+
+	for(i = 0; i < 2; i++)
+	{
+		link->socket[i] = datagramSocketCreate(nextProxyPort++, inetAddressGetByString((char *)HARNESS_IP_ADDRESS));
+		if(!link->socket[i])
+		{
+			printf("Could not open link proxy port %d\n", nextProxyPort - 1);
+			exit(1);
+		}
+		datagramSocketSetTimeout(link->socket[i], HARNESS_PROXY_TIMEOUT_SEC);
+	}
+
+	for(i = 0; i < 2; i++)
+	{
+		link->sides[i].link = link;
+		link->sides[i].side = i;
+		pthread_create(&link->receiveThread[i], NULL, linkReceiveThread, &link->sides[i]);
+	}
+	pthread_create(&link->deliveryThread, NULL, linkDeliveryThread, link);
+
+	return link;
+}
+
+static void linkDestroy(HarnessLink *link)
+{
+	std::multimap<double, HarnessDatagram *>::iterator iter;
+	int i;
+
+	link->running = false;
+	pthread_join(link->receiveThread[0], NULL);
+	pthread_join(link->receiveThread[1], NULL);
+	pthread_join(link->deliveryThread, NULL);
+
+	for(iter = link->pending.begin(); iter != link->pending.end(); iter++)
+	{
+		free(iter->second);
+	}
+	for(i = 0; i < 2; i++)
+	{
+		inetAddressDestroy(link->socket[i]->address);
+		datagramSocketDestroy(link->socket[i]);
+	}
+	pthread_mutex_destroy(&link->mutex);
+	delete link;
+}
+
+static std::string peerList(std::vector<std::string> &peers)
+{
+	std::string list;
+	size_t i;
+
+	for(i = 0; i < peers.size(); i++)
+	{
+		list += (i? ", " : "") + peers[i];
+	}
+	return list;
+}
+
+// Writes the configuration of one node, only the interfaces its links need are enabled
+static bool nodeWriteConfig(HarnessNode *node, std::string fileName)
+{
+	std::ofstream file(fileName.c_str());
+
+	if(!file)
+	{
+		return false;
+	}
+
+	file << "[JAUS]\n";
+	file << "SubsystemId: " << node->subsystemId << "\n";
+	file << "NodeId: " << node->nodeId << "\n";
+	file << "Subsystem_Identification: Harness" << node->subsystemId << "\n";
+	file << "Node_Identification: " << node->name << "\n";
+	file << "Message_Router_Threads: " << routerThreads << "\n\n";
+
+	file << "[Component_Communications]\n";
+	file << "OpenJAUS_UDP_Interface: true\n";
+	file << "OpenJAUS_UDP_IP_Address: " << HARNESS_IP_ADDRESS << "\n";
+	file << "OpenJAUS_UDP_Port: " << node->basePort + HARNESS_INTERFACE_PORT_OFFSET << "\n";
+	file << "JAUS_OPC_UDP_Interface: true\n";
+	file << "JAUS_OPC_UDP_IP_Address: " << HARNESS_IP_ADDRESS << "\n";
+	file << "JAUS_OPC_UDP_Port: " << node->basePort + HARNESS_MESSAGE_PORT_OFFSET << "\n";
+	file << "JAUS_OPC_UDP_Multicast: false\n\n";
+
+	file << "[Node_Communications]\n";
+	file << "Enabled: " << (node->nodePeers.empty()? "false" : "true") << "\n";
+	file << "JUDP_Interface: true\n";
+	file << "JUDP_IP_Address: " << HARNESS_IP_ADDRESS << "\n";
+	file << "JUDP_Port: " << node->basePort + HARNESS_NODE_PORT_OFFSET << "\n";
+	file << "JUDP_Multicast: false\n";
+	file << "JUDP_Peers: " << peerList(node->nodePeers) << "\n\n";
+
+	file << "[Subsystem_Communications]\n";
+	file << "Enabled: " << (node->subsystemPeers.empty()? "false" : "true") << "\n";
+	file << "JUDP_Interface: true\n";
+	file << "JUDP_IP_Address: " << HARNESS_IP_ADDRESS << "\n";
+	file << "JUDP_Port: " << node->basePort + HARNESS_SUBSYSTEM_PORT_OFFSET << "\n";
+	file << "JUDP_Multicast: false\n";
+	file << "JUDP_Peers: " << peerList(node->subsystemPeers) << "\n";
+
+	return true;
+}
+
+static void *componentServiceThread(void *arg)
+{
+	HarnessComponent *component = (HarnessComponent *)arg;
+	JausMessage rxMessage;
+
+	while(component->running)
+	{
+		if(nodeManagerTimedReceive(component->nmi, &rxMessage, ojGetTimeSec() + HARNESS_SERVICE_TIMEOUT_SEC) != NMI_MESSAGE_RECEIVED)
+		{
+			continue;
+		}
+
+		pthread_mutex_lock(&component->mutex);
+		if(	rxMessage->commandCode == JAUS_REPORT_HEARTBEAT_PULSE &&
+			component->pingAddress &&
+			jausAddressEqual(rxMessage->source, component->pingAddress))
+		{
+			component->pongCount++;
+			pthread_cond_signal(&component->condition);
+		}
+		else if(rxMessage->commandCode == HARNESS_TRANSFER_COMMAND_CODE)
+		{
+			component->transferCount++;
+			component->transferBytes += rxMessage->dataSize;
+			pthread_cond_signal(&component->condition);
+			pthread_mutex_unlock(&component->mutex);
+			jausMessageDestroy(rxMessage);
+			continue;
+		}
+		pthread_mutex_unlock(&component->mutex);
+
+		defaultJausMessageProcessor(rxMessage, component->nmi, component->cmpt);
+	}
+	return NULL;
+}
+
+static bool waitForPong(HarnessComponent *component, unsigned long pongCount, double timeLimitSec)
+{
+	struct timespec timeLimitSpec;
+
+	timeLimitSpec.tv_sec = (long)timeLimitSec;
+	timeLimitSpec.tv_nsec = (long)(1e9 * (timeLimitSec - (double)timeLimitSpec.tv_sec));
+
+	while(component->pongCount == pongCount)
+	{
+		if(pthread_cond_timedwait(&component->condition, &component->mutex, &timeLimitSpec) != 0)
+		{
+			break;
+		}
+	}
+	return component->pongCount != pongCount;
+}
+
+static void ping(HarnessComponent *source, JausAddress destination, int count, double rateHz)
+{
+	QueryHeartbeatPulseMessage query = queryHeartbeatPulseMessageCreate();
+	JausMessage txMessage;
+	unsigned long pongCount;
+	double sendTime;
+	double delay;
+	double rtt;
+	double minRtt = 0, maxRtt = 0, sumRtt = 0;
+	int received = 0;
+	int i;
+	char addressString[64] = {0};
+
+	jausAddressCopy(query->source, source->cmpt->address);
+	jausAddressCopy(query->destination, destination);
+
+	pthread_mutex_lock(&source->mutex);
+	source->pingAddress = destination;
+
+	for(i = 0; i < count; i++)
+	{
+		txMessage = queryHeartbeatPulseMessageToJausMessage(query);
+		pongCount = source->pongCount;
+		sendTime = ojGetTimeSec();
+		nodeManagerSend(source->nmi, txMessage);
+		jausMessageDestroy(txMessage);
+
+		if(waitForPong(source, pongCount, sendTime + HARNESS_PING_TIMEOUT_SEC))
+		{
+			rtt = 1000.0 * (ojGetTimeSec() - sendTime);
+			minRtt = (received == 0 || rtt < minRtt)? rtt : minRtt;
+			maxRtt = (rtt > maxRtt)? rtt : maxRtt;
+			sumRtt += rtt;
+			received++;
+		}
+
+		if(rateHz > 0)
+		{
+			delay = 1.0 / rateHz - (ojGetTimeSec() - sendTime);
+			if(delay > 0)
+			{
+				pthread_mutex_unlock(&source->mutex);
+				ojSleepMsec((int)(1000.0 * delay));
+				pthread_mutex_lock(&source->mutex);
+			}
+		}
+	}
+
+	source->pingAddress = NULL;
+	pthread_mutex_unlock(&source->mutex);
+
+	jausAddressToString(destination, addressString);
+	printf("ping %s: sent %d received %d (%.1f%% loss)", addressString, count, received, count? 100.0 * (count - received) / count : 0.0);
+	if(received)
+	{
+		printf(" rtt min/avg/max %.2f/%.2f/%.2f msec", minRtt, sumRtt / received, maxRtt);
+	}
+	printf("\n");
+
+	queryHeartbeatPulseMessageDestroy(query);
+}
+
+static void lookup(HarnessComponent *source, JausAddress lookupAddress, int count)
+{
+	JausAddress address = jausAddressCreate();
+	JausAddressList *addressList;
+	JausAddressList *entry;
+	JausBoolean found = JAUS_FALSE;
+	int verified = 0;
+	int listCount = 0;
+	double startTime;
+	double lookupUsec;
+	double verifyUsec;
+	int i;
+	char addressString[64] = {0};
+
+	startTime = ojGetTimeSec();
+	for(i = 0; i < count; i++)
+	{
+		jausAddressCopy(address, lookupAddress);
+		found = nodeManagerLookupAddress(source->nmi, address);
+	}
+	lookupUsec = count? 1e6 * (ojGetTimeSec() - startTime) / count : 0.0;
+
+	startTime = ojGetTimeSec();
+	for(i = 0; i < count; i++)
+	{
+		verified = nodeManagerVerifyAddress(source->nmi, found? address : lookupAddress);
+	}
+	verifyUsec = count? 1e6 * (ojGetTimeSec() - startTime) / count : 0.0;
+
+	addressList = nodeManagerLookupAddressList(source->nmi, lookupAddress);
+	for(entry = addressList; entry; entry = entry->nextAddress)
+	{
+		listCount++;
+	}
+	nodeManagerDestroyAddressList(addressList);
+
+	jausAddressToString(found? address : lookupAddress, addressString);
+	printf("lookup %s: %s, verify %s, %d matching, avg %.3f/%.3f usec (directory refreshes %u)\n",
+			addressString, found? "found" : "not found", verified? "true" : "false", listCount,
+			lookupUsec, verifyUsec, source->nmi->directoryRefreshCount);
+
+	jausAddressDestroy(address);
+}
+
+// Sends count messages of sizeBytes to another harness component, which reassembles them
+static void transfer(HarnessComponent *source, HarnessComponent *destination, unsigned int sizeBytes, int count)
+{
+	JausMessage txMessage = jausMessageCreate();
+	LargeMessageHandlerStats stats;
+	LargeMessageHandlerStats sourceStats;
+	unsigned long transferCount;
+	unsigned long transferBytes;
+	double startTime;
+	double elapsedSec;
+	struct timespec timeLimitSpec;
+	double timeLimitSec;
+	unsigned int i;
+	int j;
+	char addressString[64] = {0};
+
+	txMessage->commandCode = HARNESS_TRANSFER_COMMAND_CODE;
+	jausAddressCopy(txMessage->source, source->cmpt->address);
+	jausAddressCopy(txMessage->destination, destination->cmpt->address);
+	txMessage->dataSize = sizeBytes;
+	txMessage->data = (JausByte *)malloc(sizeBytes);
+	for(i = 0; i < sizeBytes; i++)
+	{
+		txMessage->data[i] = (JausByte)i;
+	}
+
+	pthread_mutex_lock(&destination->mutex);
+	transferCount = destination->transferCount;
+	transferBytes = destination->transferBytes;
+	pthread_mutex_unlock(&destination->mutex);
+
+	startTime = ojGetTimeSec();
+	for(j = 0; j < count; j++)
+	{
+		nodeManagerSend(source->nmi, txMessage);
+	}
+
+	timeLimitSec = startTime + HARNESS_TRANSFER_TIMEOUT_SEC;
+	timeLimitSpec.tv_sec = (long)timeLimitSec;
+	timeLimitSpec.tv_nsec = (long)(1e9 * (timeLimitSec - (double)timeLimitSpec.tv_sec));
+
+	pthread_mutex_lock(&destination->mutex);
+	while(destination->transferCount - transferCount < (unsigned long)count)
+	{
+		if(pthread_cond_timedwait(&destination->condition, &destination->mutex, &timeLimitSpec) != 0)
+		{
+			break;
+		}
+	}
+	elapsedSec = ojGetTimeSec() - startTime;
+	transferCount = destination->transferCount - transferCount;
+	transferBytes = destination->transferBytes - transferBytes;
+	pthread_mutex_unlock(&destination->mutex);
+
+	lmHandlerGetStats(destination->nmi, &stats);
+	lmHandlerGetStats(source->nmi, &sourceStats);
+
+	jausAddressToString(destination->cmpt->address, addressString);
+	printf("transfer %s: sent %d x %u bytes received %lu (%lu bytes) in %.1f msec, reassembly completed %u timed out %u evicted %u discarded %u, naks %u retransmitted %u\n",
+			addressString, count, sizeBytes, transferCount, transferBytes, 1000.0 * elapsedSec,
+			stats.completedCount, stats.timedOutCount, stats.evictedCount, stats.discardedPacketCount,
+			stats.nakSentCount, sourceStats.retransmittedPacketCount);
+
+	jausMessageDestroy(txMessage);
+}
+
+static HarnessComponent *findComponent(std::string nodeName, int componentId)
+{
+	size_t i;
+
+	for(i = 0; i < components.size(); i++)
+	{
+		if(components[i]->node->name == nodeName && components[i]->cmpt->address->component == componentId)
+		{
+			return components[i];
+		}
+	}
+	return NULL;
+}
+
+static void printHelp()
+{
+	printf("Usage: ojNodeHarness <script> [-v]\n");
+	printf("Script commands, one per line ('#' starts a comment):\n");
+	printf("  node <name> <subsystemId> <nodeId> <basePort>\n");
+	printf("  proxy <basePort>\n");
+	printf("  router <threads>\n");
+	printf("  link <name> <name> [loss=<percent>] [latency=<msec>]\n");
+	printf("  start\n");
+	printf("  component <node> <componentId>\n");
+	printf("  wait <sec>\n");
+	printf("  ping <node> <componentId> <subsystem>.<node>.<component>.<instance> <count> [<rateHz>]\n");
+	printf("  lookup <node> <componentId> <subsystem>.<node>.<component>.<instance> <count>\n");
+	printf("  transfer <node> <componentId> <node> <componentId> <sizeBytes> <count>\n");
+	printf("  tree\n");
+}
+
+// Runs one script line, returns false on a syntax error
+static bool runCommand(std::vector<std::string> &args, HarnessHandler *handler, std::string scriptName)
+{
+	HarnessNode *node;
+	HarnessNode *peer;
+	HarnessComponent *component;
+	HarnessComponent *destination;
+	JausAddress address;
+	std::map<std::string, HarnessNode *>::iterator iter;
+	double lossPercent = 0;
+	double latencyMsec = 0;
+	unsigned short offset;
+	size_t i;
+
+	if(args[0] == "node" && args.size() == 5)
+	{
+		node = new HarnessNode();
+		node->name = args[1];
+		node->subsystemId = atoi(args[2].c_str());
+		node->nodeId = atoi(args[3].c_str());
+		node->basePort = (unsigned short) atoi(args[4].c_str());
+		node->configData = NULL;
+		node->nm = NULL;
+		nodes[node->name] = node;
+		return true;
+	}
+	else if(args[0] == "proxy" && args.size() == 2)
+	{
+		nextProxyPort = (unsigned short) atoi(args[1].c_str());
+		return true;
+	}
+	else if(args[0] == "router" && args.size() == 2)
+	{
+		routerThreads = atoi(args[1].c_str());
+		return true;
+	}
+	else if(args[0] == "link" && args.size() >= 3)
+	{
+		if(!nodes.count(args[1]) || !nodes.count(args[2]))
+		{
+			return false;
+		}
+		node = nodes[args[1]];
+		peer = nodes[args[2]];
+
+		for(i = 3; i < args.size(); i++)
+		{
+			if(args[i].find("loss=") == 0)
+			{
+				lossPercent = atof(args[i].substr(5).c_str());
+			}
+			else if(args[i].find("latency=") == 0)
+			{
+				latencyMsec = atof(args[i].substr(8).c_str());
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		// Nodes of one subsystem meet on their node interfaces, all others on their subsystem interfaces
+		offset = (node->subsystemId == peer->subsystemId)? HARNESS_NODE_PORT_OFFSET : HARNESS_SUBSYSTEM_PORT_OFFSET;
+		std::ostringstream nodeSide, peerSide;
+		nodeSide << HARNESS_IP_ADDRESS << ":" << nextProxyPort;
+		peerSide << HARNESS_IP_ADDRESS << ":" << nextProxyPort + 1;
+		if(offset == HARNESS_NODE_PORT_OFFSET)
+		{
+			node->nodePeers.push_back(nodeSide.str());
+			peer->nodePeers.push_back(peerSide.str());
+		}
+		else
+		{
+			node->subsystemPeers.push_back(nodeSide.str());
+			peer->subsystemPeers.push_back(peerSide.str());
+		}
+		links.push_back(linkCreate(node->basePort + offset, peer->basePort + offset, lossPercent, latencyMsec));
+		return true;
+	}
+	else if(args[0] == "start" && args.size() == 1)
+	{
+		for(iter = nodes.begin(); iter != nodes.end(); iter++)
+		{
+			node = iter->second;
+			if(node->nm)
+			{
+				continue;
+			}
+
+			std::string fileName = scriptName + "." + node->name + ".conf";
+			if(!nodeWriteConfig(node, fileName))
+			{
+				printf("Could not write %s\n", fileName.c_str());
+				return false;
+			}
+
+			node->configData = new FileLoader(fileName);
+			try
+			{
+				node->nm = new NodeManager(node->configData, handler);
+			}
+			catch(...)
+			{
+				printf("Node Manager %s Construction Failed.\n", node->name.c_str());
+				node->nm = NULL;
+			}
+		}
+		return true;
+	}
+	else if(args[0] == "component" && args.size() == 3)
+	{
+		if(!nodes.count(args[1]) || !nodes[args[1]]->nm)
+		{
+			return false;
+		}
+		node = nodes[args[1]];
+
+		component = new HarnessComponent();
+		component->node = node;
+		component->cmpt = jausComponentCreate();
+		component->cmpt->identification = (char *)malloc(args[1].size() + 16);
+		sprintf(component->cmpt->identification, "%s-%s", args[1].c_str(), args[2].c_str());
+		component->cmpt->address->component = atoi(args[2].c_str());
+		component->nmi = nodeManagerOpenAt(component->cmpt, (char *)HARNESS_IP_ADDRESS, node->basePort + HARNESS_INTERFACE_PORT_OFFSET, node->basePort + HARNESS_MESSAGE_PORT_OFFSET);
+		if(!component->nmi)
+		{
+			printf("Could not check component %s into Node Manager\n", component->cmpt->identification);
+			jausComponentDestroy(component->cmpt);
+			delete component;
+			return true;
+		}
+		component->running = true;
+		component->pingAddress = NULL;
+		component->pongCount = 0;
+		component->transferCount = 0;
+		component->transferBytes = 0;
+		pthread_mutex_init(&component->mutex, NULL);
+		pthread_cond_init(&component->condition, NULL);
+		pthread_create(&component->serviceThread, NULL, componentServiceThread, component);
+		components.push_back(component);
+		return true;
+	}
+	else if(args[0] == "wait" && args.size() == 2)
+	{
+		ojSleepMsec((int)(1000.0 * atof(args[1].c_str())));
+		return true;
+	}
+	else if(args[0] == "ping" && (args.size() == 5 || args.size() == 6))
+	{
+		component = findComponent(args[1], atoi(args[2].c_str()));
+		if(!component)
+		{
+			return false;
+		}
+
+		address = jausAddressCreate();
+		if(sscanf(args[3].c_str(), "%hhu.%hhu.%hhu.%hhu", &address->subsystem, &address->node, &address->component, &address->instance) != 4)
+		{
+			jausAddressDestroy(address);
+			return false;
+		}
+		ping(component, address, atoi(args[4].c_str()), args.size() == 6? atof(args[5].c_str()) : 0);
+		jausAddressDestroy(address);
+		return true;
+	}
+	else if(args[0] == "lookup" && args.size() == 5)
+	{
+		component = findComponent(args[1], atoi(args[2].c_str()));
+		if(!component)
+		{
+			return false;
+		}
+
+		address = jausAddressCreate();
+		if(sscanf(args[3].c_str(), "%hhu.%hhu.%hhu.%hhu", &address->subsystem, &address->node, &address->component, &address->instance) != 4)
+		{
+			jausAddressDestroy(address);
+			return false;
+		}
+		lookup(component, address, atoi(args[4].c_str()));
+		jausAddressDestroy(address);
+		return true;
+	}
+	else if(args[0] == "transfer" && args.size() == 7)
+	{
+		component = findComponent(args[1], atoi(args[2].c_str()));
+		destination = findComponent(args[3], atoi(args[4].c_str()));
+		if(!component || !destination)
+		{
+			return false;
+		}
+		transfer(component, destination, (unsigned int) atoi(args[5].c_str()), atoi(args[6].c_str()));
+		return true;
+	}
+	else if(args[0] == "tree" && args.size() == 1)
+	{
+		for(iter = nodes.begin(); iter != nodes.end(); iter++)
+		{
+			if(iter->second->nm)
+			{
+				printf("%s:\n%s\n", iter->first.c_str(), iter->second->nm->systemTreeToString().c_str());
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+int main(int argc, char *argv[])
+{
+	HarnessHandler *handler;
+	std::vector<std::string> args;
+	std::string line, word;
+	int lineNumber = 0;
+	int result = 0;
+	size_t i;
+
+	if(argc < 2)
+	{
+		printHelp();
+		return 1;
+	}
+
+	std::ifstream script(argv[1]);
+	if(!script)
+	{
+		printf("Could not open %s\n", argv[1]);
+		return 1;
+	}
+
+	handler = new HarnessHandler(argc > 2 && strcmp(argv[2], "-v") == 0);
+	srand(1);
+
+	while(std::getline(script, line))
+	{
+		lineNumber++;
+		line = line.substr(0, line.find('#'));
+
+		std::istringstream stream(line);
+		args.clear();
+		while(stream >> word)
+		{
+			args.push_back(word);
+		}
+
+		if(args.empty())
+		{
+			continue;
+		}
+
+		if(!runCommand(args, handler, argv[1]))
+		{
+			printf("%s:%d: cannot run \"%s\"\n", argv[1], lineNumber, line.c_str());
+			result = 1;
+			break;
+		}
+	}
+
+	for(i = 0; i < components.size(); i++)
+	{
+		components[i]->running = false;
+		pthread_join(components[i]->serviceThread, NULL);
+		pthread_cond_destroy(&components[i]->condition);
+		pthread_mutex_destroy(&components[i]->mutex);
+		nodeManagerClose(components[i]->nmi);
+		jausComponentDestroy(components[i]->cmpt);
+		delete components[i];
+	}
+
+	for(std::map<std::string, HarnessNode *>::iterator iter = nodes.begin(); iter != nodes.end(); iter++)
+	{
+		delete iter->second->nm;
+		delete iter->second->configData;
+		delete iter->second;
+	}
+
+	for(i = 0; i < links.size(); i++)
+	{
+		printf("link %d: forwarded %lu dropped %lu\n", (int)i, links[i]->forwardCount, links[i]->dropCount);
+		linkDestroy(links[i]);
+	}
+
+	delete handler;
+	return result;
+}
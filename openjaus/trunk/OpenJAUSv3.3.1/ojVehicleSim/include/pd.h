@@ -59,6 +59,8 @@
 #endif
 
 #define PD_THREAD_DESIRED_RATE_HZ			50.0	// USER: Modify this rate as needed
+#define PD_RT_RATE_HZ						1000.0	// Rate the commanded effort is applied to the vehicle at
+#define PD_RT_PRIORITY						80		// SCHED_FIFO priority of the real-time lane, where permitted
 
 // USER: All defines should start with "PD_", where your component acronym replaces "PD"
 
@@ -56,7 +56,11 @@
 
 // Private function prototypes
 void gposReadyState(OjCmpt gpos);
-void gposQueryGlobalPoseCallback(OjCmpt gpos, JausMessage query);
+void gposQueryGlobalPoseCallback(OjCmpt gpos, QueryGlobalPoseMessage query);
+JausMessage gposEncodeReportGlobalPose(void *data, JausUnsignedInteger presenceVector);
+JausBoolean gposReportGlobalPoseFieldValue(void *data, JausByte field, double *value);
+
+OJ_CMPT_TYPED_MESSAGE(QueryGlobalPoseMessage, queryGlobalPoseMessage)
 
 // Function: 	gposStartup
 // Access:		Public	
@@ -76,8 +80,9 @@ OjCmpt gposCreate(void)
 	ojCmptAddServiceOutputMessage(cmpt, JAUS_GLOBAL_POSE_SENSOR, JAUS_REPORT_GLOBAL_POSE, 0xFF);
 
 	ojCmptSetStateCallback(cmpt, JAUS_READY_STATE, gposReadyState);
-	ojCmptSetMessageCallback(cmpt, JAUS_QUERY_GLOBAL_POSE, gposQueryGlobalPoseCallback);
+	ojCmptSetTypedMessageCallback(cmpt, JAUS_QUERY_GLOBAL_POSE, queryGlobalPoseMessage, gposQueryGlobalPoseCallback);
 	ojCmptAddSupportedSc(cmpt, JAUS_REPORT_GLOBAL_POSE);
+	ojCmptAddSupportedEvent(cmpt, JAUS_REPORT_GLOBAL_POSE, gposReportGlobalPoseFieldValue);
 	
 	message = reportGlobalPoseMessageCreate();
 	gposAddr = ojCmptGetAddress(cmpt);
@@ -110,6 +115,7 @@ void gposDestroy(OjCmpt gpos)
 
 	// Remove support for ReportGlobalPose Service Connections
 	ojCmptRemoveSupportedSc(gpos, JAUS_REPORT_GLOBAL_POSE);	
+	ojCmptRemoveSupportedEvent(gpos, JAUS_REPORT_GLOBAL_POSE);
 	ojCmptDestroy(gpos);
 
 	reportGlobalPoseMessageDestroy(message);	
@@ -147,40 +153,25 @@ int gposGetScActive(OjCmpt gpos)
 	return ojCmptIsOutgoingScActive(gpos, JAUS_REPORT_GLOBAL_POSE);
 }
 
-void gposQueryGlobalPoseCallback(OjCmpt gpos, JausMessage query)
+void gposQueryGlobalPoseCallback(OjCmpt gpos, QueryGlobalPoseMessage query)
 {
 	ReportGlobalPoseMessage message;
 	JausMessage txMessage;
-	QueryGlobalPoseMessage queryGlobalPose;
 	
 	message = (ReportGlobalPoseMessage)ojCmptGetUserData(gpos);
 
-	queryGlobalPose = queryGlobalPoseMessageFromJausMessage(query);
-	if(queryGlobalPose)
-	{
-		jausAddressCopy(message->destination, queryGlobalPose->source);
-		message->presenceVector = queryGlobalPose->presenceVector;
-		message->sequenceNumber = 0;
-		message->properties.scFlag = 0;
-		
-		txMessage = reportGlobalPoseMessageToJausMessage(message);
-		ojCmptSendMessage(gpos, txMessage);		
-		jausMessageDestroy(txMessage);
-		
-		queryGlobalPoseMessageDestroy(queryGlobalPose);
-	}
-	else
-	{
-		////cError("gpos: Error unpacking %s message.\n", jausMessageCommandCodeString(message));
-	}
+	jausAddressCopy(message->destination, query->source);
+	message->presenceVector = query->presenceVector;
+	message->sequenceNumber = 0;
+	message->properties.scFlag = 0;
 	
+	txMessage = reportGlobalPoseMessageToJausMessage(message);
+	ojCmptSendMessage(gpos, txMessage);		
+	jausMessageDestroy(txMessage);
 }
 
 void gposReadyState(OjCmpt gpos)
 {
-	JausMessage txMessage;
-	ServiceConnection scList;
-	ServiceConnection sc;
 	PointLla vehiclePosLla;
 	ReportGlobalPoseMessage message;
 	
@@ -205,22 +196,59 @@ void gposReadyState(OjCmpt gpos)
 	// Send message
 	if(ojCmptIsOutgoingScActive(gpos, JAUS_REPORT_GLOBAL_POSE))
 	{
-		scList = ojCmptGetScSendList(gpos, JAUS_REPORT_GLOBAL_POSE);
-		sc = scList;
-		while(sc)
-		{
-			jausAddressCopy(message->destination, sc->address);
-			message->presenceVector = sc->presenceVector;
-			message->sequenceNumber = sc->sequenceNumber;
-			message->properties.scFlag = JAUS_SERVICE_CONNECTION_MESSAGE;
-			
-			txMessage = reportGlobalPoseMessageToJausMessage(message);
-			ojCmptSendMessage(gpos, txMessage);
-			jausMessageDestroy(txMessage);
-	
-			sc = sc->nextSc;
-		}
-		
-		ojCmptDestroySendList(scList);
+		ojCmptPublishSc(gpos, JAUS_REPORT_GLOBAL_POSE, gposEncodeReportGlobalPose, message);
+	}
+	ojCmptPublishEvents(gpos, JAUS_REPORT_GLOBAL_POSE, gposEncodeReportGlobalPose, message);
+}
+
+JausMessage gposEncodeReportGlobalPose(void *data, JausUnsignedInteger presenceVector)
+{
+	ReportGlobalPoseMessage message = (ReportGlobalPoseMessage)data;
+
+	message->presenceVector = presenceVector;
+	return reportGlobalPoseMessageToJausMessage(message);
+}
+
+// Report fields are numbered from the presence vector, which is field 1
+JausBoolean gposReportGlobalPoseFieldValue(void *data, JausByte field, double *value)
+{
+	ReportGlobalPoseMessage message = (ReportGlobalPoseMessage)data;
+
+	switch(field - 2)
+	{
+		case JAUS_POSE_PV_LATITUDE_BIT:
+			*value = message->latitudeDegrees;
+			return JAUS_TRUE;
+
+		case JAUS_POSE_PV_LONGITUDE_BIT:
+			*value = message->longitudeDegrees;
+			return JAUS_TRUE;
+
+		case JAUS_POSE_PV_ELEVATION_BIT:
+			*value = message->elevationMeters;
+			return JAUS_TRUE;
+
+		case JAUS_POSE_PV_POSITION_RMS_BIT:
+			*value = message->positionRmsMeters;
+			return JAUS_TRUE;
+
+		case JAUS_POSE_PV_ROLL_BIT:
+			*value = message->rollRadians;
+			return JAUS_TRUE;
+
+		case JAUS_POSE_PV_PITCH_BIT:
+			*value = message->pitchRadians;
+			return JAUS_TRUE;
+
+		case JAUS_POSE_PV_YAW_BIT:
+			*value = message->yawRadians;
+			return JAUS_TRUE;
+
+		case JAUS_POSE_PV_ATTITUDE_RMS_BIT:
+			*value = message->attitudeRmsRadians;
+			return JAUS_TRUE;
+
+		default:
+			return JAUS_FALSE;
 	}
 }
@@ -50,9 +50,20 @@
 
 // USER: Insert any private function prototypes here
 void pdSendReportWrenchEffort(OjCmpt pd);
+JausMessage pdEncodeReportWrenchEffort(void *data, JausUnsignedInteger presenceVector);
 void pdStandbyState(OjCmpt pd);
 void pdReadyState(OjCmpt pd);
 void pdProcessMessage(OjCmpt pd, JausMessage message);
+void pdSetCommand(OjCmpt pd, double throttle, double brake, double steering);
+void pdRtCycle(OjCmpt pd);
+
+// Effort handed to the real-time lane, and handed back once applied
+typedef struct
+{
+	double throttle;
+	double brake;
+	double steering;
+}PdCommand;
 
 typedef struct
 {
@@ -84,6 +95,7 @@ OjCmpt pdCreate(void)
 	ojCmptSetStateCallback(cmpt, JAUS_STANDBY_STATE, pdStandbyState);
 	ojCmptSetStateCallback(cmpt, JAUS_READY_STATE, pdReadyState);
 	ojCmptSetState(cmpt, JAUS_STANDBY_STATE);
+	ojCmptSetRtCallback(cmpt, PD_RT_RATE_HZ, PD_RT_PRIORITY, -1, sizeof(PdCommand), sizeof(PdCommand), pdRtCycle);
 	
 	pdAddr = ojCmptGetAddress(cmpt);
 
@@ -313,24 +325,25 @@ void pdReadyState(OjCmpt pd)
 			{
 				if(vehicleSimGetRunPause() == VEHICLE_SIM_RUN)
 				{
-					vehicleSimSetCommand(	data->setWrenchEffort->propulsiveLinearEffortXPercent,
-											data->setWrenchEffort->resistiveLinearEffortXPercent,
-											data->setWrenchEffort->propulsiveRotationalEffortZPercent
-										);
+					pdSetCommand(	pd,
+									data->setWrenchEffort->propulsiveLinearEffortXPercent,
+									data->setWrenchEffort->resistiveLinearEffortXPercent,
+									data->setWrenchEffort->propulsiveRotationalEffortZPercent
+								);
 				}
 				else
 				{
-					vehicleSimSetCommand(0, 80, data->setWrenchEffort->propulsiveRotationalEffortZPercent);					
+					pdSetCommand(pd, 0, 80, data->setWrenchEffort->propulsiveRotationalEffortZPercent);					
 				}
 			}
 			else
 			{
-				vehicleSimSetCommand(0, 80, 0);
+				pdSetCommand(pd, 0, 80, 0);
 			}			
 		}		
 		else
 		{
-			vehicleSimSetCommand(0, 80, 0);
+			pdSetCommand(pd, 0, 80, 0);
 		}		
 	}
 	else
@@ -343,36 +356,61 @@ void pdReadyState(OjCmpt pd)
 		
 		data->controllerStatus->primaryStatusCode = JAUS_UNKNOWN_STATE;
 		
-		vehicleSimSetCommand(0, 80, 0);
+		pdSetCommand(pd, 0, 80, 0);
 	}
 	
 }
 
+// Function: pdSetCommand
+// Access:		Private
+// Description:	Hands the effort to the real-time lane, which applies it to the vehicle on its next cycle.
+void pdSetCommand(OjCmpt pd, double throttle, double brake, double steering)
+{
+	PdCommand command;
+
+	command.throttle = throttle;
+	command.brake = brake;
+	command.steering = steering;
+	ojCmptRtWriteCommand(pd, &command);
+}
+
+// Function: pdRtCycle
+// Access:		Private
+// Description:	Real-time lane of the primitive driver. Applies the latest commanded effort and reports it back.
+void pdRtCycle(OjCmpt pd)
+{
+	PdCommand command;
+
+	if(ojCmptRtReadCommand(pd, &command))
+	{
+		vehicleSimSetCommand(command.throttle, command.brake, command.steering);
+		ojCmptRtWriteReport(pd, &command);
+	}
+}
+
 void pdSendReportWrenchEffort(OjCmpt pd)
 {
 	PdData *data;
-	JausMessage txMessage;
-	ServiceConnection scList;
-	ServiceConnection sc;
+	PdCommand applied;
 
 	data = (PdData*)ojCmptGetUserData(pd);
-	
-	scList = ojCmptGetScSendList(pd, JAUS_REPORT_WRENCH_EFFORT);
-	sc = scList;
-	while(sc)
-	{
-		jausAddressCopy(data->reportWrenchEffort->destination, sc->address);
-		data->reportWrenchEffort->presenceVector = sc->presenceVector;
-		data->reportWrenchEffort->sequenceNumber = sc->sequenceNumber;
-		data->reportWrenchEffort->properties.scFlag = JAUS_SERVICE_CONNECTION_MESSAGE;
-		
-		txMessage = reportWrenchEffortMessageToJausMessage(data->reportWrenchEffort);
-		ojCmptSendMessage(pd, txMessage);		
-		jausMessageDestroy(txMessage);
 
-		sc = sc->nextSc;
+	// Report the effort the real-time lane last applied
+	if(ojCmptRtReadReport(pd, &applied))
+	{
+		data->reportWrenchEffort->propulsiveLinearEffortXPercent = applied.throttle;
+		data->reportWrenchEffort->resistiveLinearEffortXPercent = applied.brake;
+		data->reportWrenchEffort->propulsiveRotationalEffortZPercent = applied.steering;
 	}
 	
-	ojCmptDestroySendList(scList);
+	ojCmptPublishSc(pd, JAUS_REPORT_WRENCH_EFFORT, pdEncodeReportWrenchEffort, data->reportWrenchEffort);
+}
+
+JausMessage pdEncodeReportWrenchEffort(void *data, JausUnsignedInteger presenceVector)
+{
+	ReportWrenchEffortMessage message = (ReportWrenchEffortMessage)data;
+
+	message->presenceVector = presenceVector;
+	return reportWrenchEffortMessageToJausMessage(message);
 }
 
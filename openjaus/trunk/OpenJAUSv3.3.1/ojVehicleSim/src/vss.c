@@ -46,7 +46,11 @@
 
 // Private function prototypes
 void vssReadyState(OjCmpt vss);
-void vssQueryVelocityStateCallback(OjCmpt vss, JausMessage query);
+void vssQueryVelocityStateCallback(OjCmpt vss, QueryVelocityStateMessage query);
+JausMessage vssEncodeReportVelocityState(void *data, JausUnsignedInteger presenceVector);
+JausBoolean vssReportVelocityStateFieldValue(void *data, JausByte field, double *value);
+
+OJ_CMPT_TYPED_MESSAGE(QueryVelocityStateMessage, queryVelocityStateMessage)
 
 
 OjCmpt vssCreate(void)
@@ -62,8 +66,9 @@ OjCmpt vssCreate(void)
 	ojCmptAddServiceOutputMessage(cmpt, JAUS_VELOCITY_STATE_SENSOR, JAUS_REPORT_VELOCITY_STATE, 0xFF);
 
 	ojCmptSetStateCallback(cmpt, JAUS_READY_STATE, vssReadyState);
-	ojCmptSetMessageCallback(cmpt, JAUS_QUERY_VELOCITY_STATE, vssQueryVelocityStateCallback);
+	ojCmptSetTypedMessageCallback(cmpt, JAUS_QUERY_VELOCITY_STATE, queryVelocityStateMessage, vssQueryVelocityStateCallback);
 	ojCmptAddSupportedSc(cmpt, JAUS_REPORT_VELOCITY_STATE);
+	ojCmptAddSupportedEvent(cmpt, JAUS_REPORT_VELOCITY_STATE, vssReportVelocityStateFieldValue);
 	
 	message = reportVelocityStateMessageCreate();
 	vssAddr = ojCmptGetAddress(cmpt);
@@ -90,6 +95,7 @@ void vssDestroy(OjCmpt vss)
 	message = (ReportVelocityStateMessage)ojCmptGetUserData(vss);
 
 	ojCmptRemoveSupportedSc(vss, JAUS_REPORT_VELOCITY_STATE);	
+	ojCmptRemoveSupportedEvent(vss, JAUS_REPORT_VELOCITY_STATE);
 	ojCmptDestroy(vss);
 
 	reportVelocityStateMessageDestroy(message);	
@@ -111,41 +117,26 @@ int vssGetScActive(OjCmpt vss)
 	return ojCmptIsOutgoingScActive(vss, JAUS_REPORT_VELOCITY_STATE);
 }
 
-void vssQueryVelocityStateCallback(OjCmpt vss, JausMessage query)
+void vssQueryVelocityStateCallback(OjCmpt vss, QueryVelocityStateMessage query)
 {
 	ReportVelocityStateMessage message;
 	JausMessage txMessage;
-	QueryVelocityStateMessage queryVelocityState;
 	
 	message = (ReportVelocityStateMessage)ojCmptGetUserData(vss);
 
-	queryVelocityState = queryVelocityStateMessageFromJausMessage(query);
-	if(queryVelocityState)
-	{
-		jausAddressCopy(message->destination, queryVelocityState->source);
-		message->presenceVector = queryVelocityState->presenceVector;
-		message->sequenceNumber = 0;
-		message->properties.scFlag = 0;
-		
-		txMessage = reportVelocityStateMessageToJausMessage(message);
-		ojCmptSendMessage(vss, txMessage);		
-		jausMessageDestroy(txMessage);
-		
-		queryVelocityStateMessageDestroy(queryVelocityState);
-	}
-	else
-	{
-		////cError("vss: Error unpacking %s message.\n", jausMessageCommandCodeString(message));
-	}
+	jausAddressCopy(message->destination, query->source);
+	message->presenceVector = query->presenceVector;
+	message->sequenceNumber = 0;
+	message->properties.scFlag = 0;
+	
+	txMessage = reportVelocityStateMessageToJausMessage(message);
+	ojCmptSendMessage(vss, txMessage);		
+	jausMessageDestroy(txMessage);
 }
 
 
 void vssReadyState(OjCmpt vss)
 {
-	JausMessage txMessage;
-	ServiceConnection scList;
-	ServiceConnection sc;
-
 	ReportVelocityStateMessage message;
 
 	message = (ReportVelocityStateMessage)ojCmptGetUserData(vss);
@@ -162,22 +153,59 @@ void vssReadyState(OjCmpt vss)
 	// send message
 	if(ojCmptIsOutgoingScActive(vss, JAUS_REPORT_VELOCITY_STATE))
 	{
-		scList = ojCmptGetScSendList(vss, JAUS_REPORT_VELOCITY_STATE);
-		sc = scList;
-		while(sc)
-		{
-			jausAddressCopy(message->destination, sc->address);
-			message->presenceVector = sc->presenceVector;
-			message->sequenceNumber = sc->sequenceNumber;
-			message->properties.scFlag = JAUS_SERVICE_CONNECTION_MESSAGE;
-			
-			txMessage = reportVelocityStateMessageToJausMessage(message);
-			ojCmptSendMessage(vss, txMessage);		
-			jausMessageDestroy(txMessage);
-	
-			sc = sc->nextSc;
-		}
-		
-		ojCmptDestroySendList(scList);
+		ojCmptPublishSc(vss, JAUS_REPORT_VELOCITY_STATE, vssEncodeReportVelocityState, message);
+	}
+	ojCmptPublishEvents(vss, JAUS_REPORT_VELOCITY_STATE, vssEncodeReportVelocityState, message);
+}
+
+JausMessage vssEncodeReportVelocityState(void *data, JausUnsignedInteger presenceVector)
+{
+	ReportVelocityStateMessage message = (ReportVelocityStateMessage)data;
+
+	message->presenceVector = presenceVector;
+	return reportVelocityStateMessageToJausMessage(message);
+}
+
+// Report fields are numbered from the presence vector, which is field 1
+JausBoolean vssReportVelocityStateFieldValue(void *data, JausByte field, double *value)
+{
+	ReportVelocityStateMessage message = (ReportVelocityStateMessage)data;
+
+	switch(field - 2)
+	{
+		case JAUS_VELOCITY_PV_VELOCITY_X_BIT:
+			*value = message->velocityXMps;
+			return JAUS_TRUE;
+
+		case JAUS_VELOCITY_PV_VELOCITY_Y_BIT:
+			*value = message->velocityYMps;
+			return JAUS_TRUE;
+
+		case JAUS_VELOCITY_PV_VELOCITY_Z_BIT:
+			*value = message->velocityZMps;
+			return JAUS_TRUE;
+
+		case JAUS_VELOCITY_PV_VELOCITY_RMS_BIT:
+			*value = message->velocityRmsMps;
+			return JAUS_TRUE;
+
+		case JAUS_VELOCITY_PV_ROLL_RATE_BIT:
+			*value = message->rollRateRps;
+			return JAUS_TRUE;
+
+		case JAUS_VELOCITY_PV_PITCH_RATE_BIT:
+			*value = message->pitchRateRps;
+			return JAUS_TRUE;
+
+		case JAUS_VELOCITY_PV_YAW_RATE_BIT:
+			*value = message->yawRateRps;
+			return JAUS_TRUE;
+
+		case JAUS_VELOCITY_PV_RATE_RMS_BIT:
+			*value = message->rateRmsRps;
+			return JAUS_TRUE;
+
+		default:
+			return JAUS_FALSE;
 	}
 }